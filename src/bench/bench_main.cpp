@@ -0,0 +1,649 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file bench_main.cpp Benchmarks of the game engine, running without a display. */
+
+#include "../stdafx.h"
+#include "../getoptdata.h"
+#include "../fileio.h"
+#include "../rev.h"
+#include "../map.h"
+#include "../path.h"
+#include "../path_finding.h"
+#include "../sprite_data.h"
+#include "../sprite_store.h"
+#include "../palette.h"
+#include "../rcdfile.h"
+#include "../loadsave.h"
+#include "../viewport.h"
+#include "../coaster.h"
+#include "../track_piece.h"
+#include "../ride_type.h"
+#include "../video.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+/** Operation to measure, it is called repeatedly. */
+typedef std::function<void()> BenchOperation;
+
+/**
+ * Prepares a benchmark.
+ * @param skip_reason [out] Why the benchmark cannot run, if it returns an empty operation.
+ * @return The operation to measure, or an empty operation if the benchmark cannot run.
+ */
+typedef std::function<BenchOperation(std::string *skip_reason)> BenchSetup;
+
+/** A benchmark of the suite. */
+struct Benchmark {
+	const char *name;  ///< Name of the benchmark, used for filtering and in the results.
+	BenchSetup setup;  ///< Preparation of the benchmark.
+};
+
+/** Measurements of a benchmark. */
+struct BenchResult {
+	std::string name;                ///< Name of the benchmark.
+	std::string skip_reason;         ///< If not empty, the benchmark did not run for this reason.
+	uint64 iterations;               ///< Number of operations in each repetition.
+	std::vector<double> ns_per_op;   ///< Average time of an operation in each repetition, in nanoseconds.
+};
+
+/** Values computed by benchmark operations, stored so the compiler cannot remove the computation. */
+static volatile uint32 _bench_sink;
+
+/** Settings of a run of the benchmarks. */
+struct BenchSettings {
+	std::string filter;     ///< Only run benchmarks whose name contains this text.
+	int repetitions = 5;    ///< Number of measured repetitions of each benchmark.
+	double min_time = 100;  ///< Minimal duration of a repetition, in milliseconds.
+};
+
+/**
+ * Time running an operation a number of times.
+ * @param op Operation to run.
+ * @param iterations Number of times to run the operation.
+ * @return Total duration in nanoseconds.
+ */
+static double TimeOperation(const BenchOperation &op, uint64 iterations)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64 i = 0; i < iterations; i++) op();
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Run a benchmark. The number of operations per repetition is chosen such that a repetition takes at least the minimal time.
+ * @param bench Benchmark to run.
+ * @param settings Settings of the run.
+ * @return The measurements.
+ */
+static BenchResult RunBenchmark(const Benchmark &bench, const BenchSettings &settings)
+{
+	BenchResult result;
+	result.name = bench.name;
+	result.iterations = 0;
+
+	BenchOperation op = bench.setup(&result.skip_reason);
+	if (!op) return result;
+
+	/* Calibrate, starting with a single (warm-up) operation. */
+	const double min_ns = settings.min_time * 1e6;
+	uint64 iterations = 1;
+	double elapsed = TimeOperation(op, iterations);
+	while (elapsed < min_ns / 10) {
+		iterations *= 10;
+		elapsed = TimeOperation(op, iterations);
+	}
+	result.iterations = std::max<uint64>(iterations, static_cast<uint64>(std::ceil(iterations * min_ns / elapsed)));
+
+	for (int r = 0; r < settings.repetitions; r++) {
+		result.ns_per_op.push_back(TimeOperation(op, result.iterations) / result.iterations);
+	}
+	return result;
+}
+
+/**
+ * Build a flat path at a voxel, connected to the paths around it.
+ * @param pos Voxel to build the path in.
+ */
+static void BuildFlatPath(const XYZPoint16 &pos)
+{
+	Voxel *voxel = _world.GetCreateVoxel(pos, true);
+	voxel->SetInstance(SRI_PATH);
+	const uint8 slope = AddRemovePathEdges(pos, PATH_EMPTY, EDGE_ALL, PAS_NORMAL_PATH);
+	voxel->SetInstanceData(MakePathInstanceData(slope, PAT_CONCRETE, PAS_NORMAL_PATH));
+
+	Voxel *above = _world.GetCreateVoxel(pos + XYZPoint16(0, 0, 1), true);
+	above->ClearVoxel();
+	above->SetInstance(SRI_PATH);
+	above->SetInstanceData(PATH_INVALID);
+}
+
+/**
+ * Create a flat world with a grid of paths: every fourth row and column is a path.
+ * @param size Length of the sides of the world.
+ */
+static void MakePathGridWorld(uint16 size)
+{
+	_world.SetWorldSize(size, size);
+	_world.MakeFlatWorld(8);
+	for (uint16 x = 1; x + 1 < size; x++) {
+		for (uint16 y = 1; y + 1 < size; y++) {
+			if (x % 4 == 1 || y % 4 == 1) BuildFlatPath(XYZPoint16(x, y, 8));
+		}
+	}
+}
+
+/**
+ * Create a synthetic image with a recolour layer.
+ * @param is_8bpp Make an 8bpp image rather than a 32bpp image.
+ * @param width Width of the image.
+ * @param height Height of the image.
+ * @param img [out] Image to fill.
+ */
+static void MakeImage(bool is_8bpp, uint16 width, uint16 height, ImageData *img)
+{
+	img->is_8bpp = is_8bpp;
+	img->width = width;
+	img->height = height;
+	img->xoffset = -width / 2;
+	img->yoffset = -height;
+
+	const size_t pixels = width * height;
+	const size_t nrecol = is_8bpp ? 1 : 2;
+	img->rgba.reset(new uint8[pixels * 4]);
+	img->recol.reset(new uint8[pixels * nrecol]);
+	for (size_t i = 0; i < pixels; i++) {
+		for (int c = 0; c < 4; c++) img->rgba[i * 4 + c] = (i * 7 + c * 31) & 0xFF;
+		if (is_8bpp) {
+			img->recol[i] = (i * 13) & 0xFF;
+		} else {
+			img->recol[i * 2] = (i % 3 == 0) ? 1 : 0;  // A third of the pixels is recoloured.
+			img->recol[i * 2 + 1] = i & 0xFF;
+		}
+	}
+}
+
+/**
+ * Benchmark of recolouring an image.
+ * @param is_8bpp Recolour an 8bpp image rather than a 32bpp image.
+ * @return The benchmark setup.
+ */
+static BenchSetup RecolourBenchmark(bool is_8bpp)
+{
+	return [is_8bpp](std::string *) -> BenchOperation {
+		auto img = std::make_shared<ImageData>();
+		MakeImage(is_8bpp, 128, 128, img.get());
+		auto recolour = std::make_shared<Recolouring>();
+		recolour->Set(0, RecolourEntry(COL_RANGE_GREY, COL_RANGE_DARK_RED));
+		return [img, recolour]() {
+			std::unique_ptr<uint8[]> rgba = img->GetRecoloured(GS_NIGHT, *recolour);
+		};
+	};
+}
+
+/**
+ * Benchmark of scaling an image. The scaled image cache is emptied after every operation.
+ * @param desired_width Width to scale the 128 pixels wide image to.
+ * @return The benchmark setup.
+ */
+static BenchSetup ScaleBenchmark(uint16 desired_width)
+{
+	return [desired_width](std::string *) -> BenchOperation {
+		auto img = std::make_shared<ImageData>();
+		MakeImage(false, 128, 128, img.get());
+		return [img, desired_width]() {
+			img->Scale(desired_width);
+			_image_variants.Clear();
+		};
+	};
+}
+
+/**
+ * Benchmark of finding a path over a grid of paths, from one corner of the world to the other.
+ * @param size Length of the sides of the world.
+ * @return The benchmark setup.
+ */
+static BenchSetup PathSearchBenchmark(uint16 size)
+{
+	return [size](std::string *skip_reason) -> BenchOperation {
+		MakePathGridWorld(size);
+		const XYZPoint16 start(1, 1, 8);
+		const XYZPoint16 dest(size - 3, size - 3, 8);
+		PathSearcher check(dest);
+		check.AddStart(start);
+		if (!check.Search()) {
+			*skip_reason = "No path found";
+			return BenchOperation();
+		}
+		return [start, dest]() {
+			PathSearcher searcher(dest);
+			searcher.AddStart(start);
+			searcher.Search();
+		};
+	};
+}
+
+/**
+ * Load the sprites of the RCD files of the installation, the first time they are needed.
+ * @param skip_reason [out] Why the sprites cannot be used, if they are not available.
+ * @return Whether the sprites for drawing a path grid world are available.
+ */
+static bool LoadSprites(std::string *skip_reason)
+{
+	static bool loaded = false;
+	if (!loaded) {
+		InitImageStorage();
+		_rcd_collection.ScanDirectories();
+		_sprite_manager.LoadRcdFiles();
+		loaded = true;
+	}
+	if (!_sprite_manager.HasPath(PAT_CONCRETE, PAS_NORMAL_PATH) ||
+			_sprite_manager.GetSprite(DEFAULT_ZOOM, &SpriteStorage::GetSurfaceSprite, GTP_GRASS0, SL_FLAT, VOR_NORTH) == nullptr) {
+		*skip_reason = "No ground and path sprites found, use --installdir";
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Benchmark of collecting the sprites of a full HD main display, like drawing the viewport does.
+ * @param size Length of the sides of the world.
+ * @param zoom Zoom scale.
+ * @return The benchmark setup.
+ */
+static BenchSetup CollectBenchmark(uint16 size, int zoom)
+{
+	return [size, zoom](std::string *skip_reason) -> BenchOperation {
+		if (!LoadSprites(skip_reason)) return BenchOperation();
+
+		MakePathGridWorld(size);
+		std::shared_ptr<Viewport> vp(new Viewport(XYZPoint32(size * 128, size * 128, 8 * 256)));
+		vp->zoom = zoom;
+		return [vp]() {
+			SpriteCollector collector(vp.get());
+			collector.SetWindowSize(-static_cast<int>(vp->rect.width / 2), -static_cast<int>(vp->rect.height / 2), vp->rect.width, vp->rect.height);
+			collector.Collect();
+			_bench_sink = collector.draw_images.size();
+		};
+	};
+}
+
+/**
+ * Write the world of a path grid to a memory buffer.
+ * @param size Length of the sides of the world.
+ * @return The saved data.
+ */
+static std::vector<uint8> SaveWorld(uint16 size)
+{
+	MakePathGridWorld(size);
+	FILE *fp = tmpfile();
+	if (fp == nullptr) return std::vector<uint8>();
+	Saver svr(fp);
+	_world.Save(svr);
+
+	std::vector<uint8> data(ftell(fp));
+	rewind(fp);
+	if (fread(data.data(), 1, data.size(), fp) != data.size()) data.clear();
+	fclose(fp);
+	return data;
+}
+
+/**
+ * Benchmark of saving the world.
+ * @param size Length of the sides of the world.
+ * @return The benchmark setup.
+ */
+static BenchSetup SaveBenchmark(uint16 size)
+{
+	return [size](std::string *skip_reason) -> BenchOperation {
+		MakePathGridWorld(size);
+		std::shared_ptr<FILE> fp(tmpfile(), fclose);
+		if (fp == nullptr) {
+			*skip_reason = "Cannot create a temporary file";
+			return BenchOperation();
+		}
+		return [fp]() {
+			rewind(fp.get());
+			Saver svr(fp.get());
+			_world.Save(svr);
+		};
+	};
+}
+
+/**
+ * Benchmark of loading the world.
+ * @param size Length of the sides of the world.
+ * @return The benchmark setup.
+ */
+static BenchSetup LoadBenchmark(uint16 size)
+{
+	return [size](std::string *skip_reason) -> BenchOperation {
+		auto data = std::make_shared<std::vector<uint8>>(SaveWorld(size));
+		if (data->empty()) {
+			*skip_reason = "Cannot save the world";
+			return BenchOperation();
+		}
+		return [data]() {
+			Loader ldr(data->data(), data->size());
+			_world.Load(ldr);
+		};
+	};
+}
+
+/**
+ * Benchmark of reading a synthetic RCD file field by field, like the loaders do.
+ * @return The benchmark setup.
+ */
+static BenchSetup RcdSyntheticBenchmark()
+{
+	return [](std::string *skip_reason) -> BenchOperation {
+		static const int BLOCK_COUNT = 2000; ///< Number of blocks in the file.
+		static const int BLOCK_SIZE = 256;   ///< Size of the data of a block.
+
+		const std::string fname = freerct_userdata_prefix() + DIR_SEP + "bench_synthetic.rcd";
+		MakeDirectory(freerct_userdata_prefix());
+		FILE *fp = fopen(fname.c_str(), "wb");
+		if (fp == nullptr) {
+			*skip_reason = "Cannot write " + fname;
+			return BenchOperation();
+		}
+		auto put32 = [fp](uint32 val) {
+			for (int i = 0; i < 4; i++) fputc((val >> (8 * i)) & 0xFF, fp);
+		};
+		fputs("RCDF", fp);
+		put32(2);
+		for (int b = 0; b < BLOCK_COUNT; b++) {
+			fputs("BNCH", fp);
+			put32(1);
+			put32(BLOCK_SIZE);
+			for (int i = 0; i < BLOCK_SIZE; i++) fputc((b + i) & 0xFF, fp);
+		}
+		fclose(fp);
+
+		return [fname]() {
+			RcdFileReader rcd_file(fname);
+			if (!rcd_file.CheckFileHeader("RCDF", 2)) error("Bad header of %s\n", fname.c_str());
+			uint32 sum = 0;
+			while (rcd_file.ReadBlockHeader()) {
+				for (uint32 i = 0; i < rcd_file.size; i += 4) sum += rcd_file.GetUInt32();
+			}
+			_bench_sink = sum;
+		};
+	};
+}
+
+/**
+ * Benchmark of reading all blocks of the RCD files of the installation.
+ * @return The benchmark setup.
+ */
+static BenchSetup RcdBundledBenchmark()
+{
+	return [](std::string *skip_reason) -> BenchOperation {
+		_rcd_collection.ScanDirectories();
+		if (_rcd_collection.rcdfiles.empty()) {
+			*skip_reason = "No RCD files found, use --installdir";
+			return BenchOperation();
+		}
+		auto files = std::make_shared<std::vector<std::string>>();
+		for (const auto &entry : _rcd_collection.rcdfiles) files->push_back(entry.second.path);
+
+		return [files]() {
+			std::vector<uint8> buffer;
+			for (const std::string &fname : *files) {
+				RcdFileReader rcd_file(fname);
+				if (!rcd_file.CheckFileHeader("RCDF", 2)) continue;
+				while (rcd_file.ReadBlockHeader()) {
+					buffer.resize(rcd_file.size);
+					if (!rcd_file.GetBlob(buffer.data(), rcd_file.size)) break;
+				}
+			}
+		};
+	};
+}
+
+/** A synthetic roller coaster, with a long straight powered track. */
+struct BenchCoaster {
+	BenchCoaster(int piece_count, int cars);
+
+	CoasterType type;                        ///< Type of the coaster.
+	CarType car_type;                        ///< Type of the cars.
+	std::shared_ptr<TrackPiece> piece;       ///< The track piece used for the entire track.
+	std::unique_ptr<CoasterInstance> coaster; ///< The coaster.
+};
+
+/**
+ * Construct the synthetic coaster.
+ * @param piece_count Number of track pieces.
+ * @param cars Number of cars of the train.
+ */
+BenchCoaster::BenchCoaster(int piece_count, int cars)
+{
+	/* Instances need an entrance and exit type to exist. */
+	if (_rides_manager.entrances.empty()) _rides_manager.entrances.emplace_back(new RideEntranceExitType);
+	if (_rides_manager.exits.empty()) _rides_manager.exits.emplace_back(new RideEntranceExitType);
+
+	this->car_type.car_length = 256 * 40;
+	this->car_type.inter_car_length = 256 * 4;
+
+	this->piece = std::make_shared<TrackPiece>();
+	this->piece->piece_length = 256 * 256;
+	this->piece->speed = 3;
+	this->piece->exit_dxyz = XYZPoint16(1, 0, 0);
+	this->piece->track_voxels.emplace_back(new TrackVoxel());
+	auto curve = [](int start, int end) {
+		BezierTrackCurve *bezier = new BezierTrackCurve();
+		bezier->curve.emplace_back(0, 256 * 256, start, start + (end - start) / 3, start + 2 * (end - start) / 3, end);
+		return bezier;
+	};
+	this->piece->car_xpos.reset(curve(0, 256));
+	this->piece->car_ypos.reset(curve(128, 128));
+	this->piece->car_zpos.reset(curve(0, 0));
+	this->piece->car_roll.reset(curve(0, 0));
+	this->piece->BakeSamples();
+
+	/* The train moves through the voxels of the world. */
+	_world.SetWorldSize(piece_count + 2, 8);
+	_world.MakeFlatWorld(8);
+
+	this->coaster.reset(new CoasterInstance(&this->type, &this->car_type));
+	this->coaster->index = SRI_FULL_RIDES;
+	uint32 distance = 0;
+	for (int i = 0; i < piece_count; i++) {
+		PositionedTrackPiece &ptp = this->coaster->pieces[i];
+		ptp = PositionedTrackPiece(XYZPoint16(i + 1, 4, 8), this->piece);
+		ptp.distance_base = distance;
+		distance += this->piece->piece_length;
+	}
+	this->coaster->coaster_length = distance;
+	this->coaster->UpdatePieceIndex(piece_count);
+	this->coaster->state = RIS_TESTING;
+
+	CoasterTrain &train = this->coaster->trains[0];
+	train.SetLength(cars);
+	train.station_policy = TSP_NO_STATION;
+	train.speed = 256 * 3;
+	this->coaster->number_of_trains = 1;
+}
+
+/**
+ * Benchmark of moving a coaster train over its track.
+ * @return The benchmark setup.
+ */
+static BenchSetup CoasterTrainBenchmark()
+{
+	return [](std::string *) -> BenchOperation {
+		auto bench = std::make_shared<BenchCoaster>(120, 8);
+		return [bench]() {
+			bench->coaster->trains[0].OnAnimate(30);
+		};
+	};
+}
+
+/** All benchmarks. */
+static const Benchmark _benchmarks[] = {
+	{"path_search/grid_64",           PathSearchBenchmark(64)},
+	{"path_search/grid_96",           PathSearchBenchmark(96)},
+	{"image/recolour_8bpp_128",       RecolourBenchmark(true)},
+	{"image/recolour_32bpp_128",      RecolourBenchmark(false)},
+	{"image/scale_down_128_to_64",    ScaleBenchmark(64)},
+	{"image/scale_up_128_to_256",     ScaleBenchmark(256)},
+	{"rcd/read_synthetic",            RcdSyntheticBenchmark()},
+	{"rcd/read_bundled",              RcdBundledBenchmark()},
+	{"savegame/save_world_96",        SaveBenchmark(96)},
+	{"savegame/load_world_96",        LoadBenchmark(96)},
+	{"viewport/collect_1080p_zoom0",  CollectBenchmark(96, 0)},
+	{"viewport/collect_1080p_zoom2",  CollectBenchmark(96, 2)},
+	{"coaster/train_animate",         CoasterTrainBenchmark()},
+};
+
+/**
+ * Write the results as JSON.
+ * @param fp File to write to.
+ * @param settings Settings of the run.
+ * @param results Measurements of the benchmarks.
+ */
+static void WriteResults(FILE *fp, const BenchSettings &settings, const std::vector<BenchResult> &results)
+{
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"version\": \"%s\",\n", _freerct_revision);
+	fprintf(fp, "  \"repetitions\": %d,\n", settings.repetitions);
+	fprintf(fp, "  \"benchmarks\": [");
+	const char *separator = "\n";
+	for (const BenchResult &result : results) {
+		fprintf(fp, "%s    {\"name\": \"%s\"", separator, result.name.c_str());
+		separator = ",\n";
+		if (!result.skip_reason.empty()) {
+			fprintf(fp, ", \"skipped\": \"%s\"}", result.skip_reason.c_str());
+			continue;
+		}
+
+		std::vector<double> sorted = result.ns_per_op;
+		std::sort(sorted.begin(), sorted.end());
+		double mean = 0;
+		for (double ns : sorted) mean += ns;
+		mean /= sorted.size();
+		const double median = (sorted.size() % 2 == 1) ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+
+		fprintf(fp, ", \"iterations\": %llu, \"min_ns\": %.1f, \"median_ns\": %.1f, \"mean_ns\": %.1f, \"max_ns\": %.1f}",
+				static_cast<unsigned long long>(result.iterations), sorted.front(), median, mean, sorted.back());
+	}
+	fprintf(fp, "\n  ]\n}\n");
+}
+
+/** Command-line options of the benchmark program. */
+static const OptionData _options[] = {
+	GETOPT_NOVAL('h', "--help"),
+	GETOPT_VALUE('f', "--filter"),
+	GETOPT_VALUE('o', "--output"),
+	GETOPT_VALUE('r', "--repetitions"),
+	GETOPT_VALUE('m', "--min-time"),
+	GETOPT_VALUE('i', "--installdir"),
+	GETOPT_VALUE('u', "--userdatadir"),
+	GETOPT_NOVAL('l', "--list"),
+	GETOPT_END()
+};
+
+/** Output command-line help. */
+static void PrintUsage()
+{
+	printf("Usage: freerct_bench [options]\n");
+	printf("Options:\n");
+	printf("  -h, --help             Display this help text and exit.\n");
+	printf("  -l, --list             List the benchmarks and exit.\n");
+	printf("  -f, --filter TEXT      Only run the benchmarks whose name contains TEXT.\n");
+	printf("  -o, --output FILE      Write the JSON results to FILE instead of the standard output.\n");
+	printf("  -r, --repetitions N    Number of measured repetitions of each benchmark (default 5).\n");
+	printf("  -m, --min-time MS      Minimal duration of a repetition in milliseconds (default 100).\n");
+	printf("  -i, --installdir DIR   Use the specified installation directory, for the RCD files.\n");
+	printf("  -u, --userdatadir DIR  Use the specified user data directory, for temporary files.\n");
+}
+
+/**
+ * Main entry point of the benchmarks.
+ * @param argc Argument count.
+ * @param argv Argument vector.
+ * @return The exit code of the program.
+ */
+int main(int argc, char **argv)
+{
+	GetOptData opt_data(argc - 1, argv + 1, _options);
+	BenchSettings settings;
+	std::string output_file;
+	int opt_id;
+	do {
+		opt_id = opt_data.GetOpt();
+		switch (opt_id) {
+			case 'h':
+				PrintUsage();
+				return 0;
+			case 'l':
+				for (const Benchmark &bench : _benchmarks) printf("%s\n", bench.name);
+				return 0;
+			case 'f':
+				if (opt_data.opt != nullptr) settings.filter = opt_data.opt;
+				break;
+			case 'o':
+				if (opt_data.opt != nullptr) output_file = opt_data.opt;
+				break;
+			case 'r':
+				settings.repetitions = (opt_data.opt != nullptr) ? atoi(opt_data.opt) : 0;
+				if (settings.repetitions < 1) {
+					fprintf(stderr, "ERROR: Invalid number of repetitions.\n");
+					return 1;
+				}
+				break;
+			case 'm':
+				settings.min_time = (opt_data.opt != nullptr) ? atof(opt_data.opt) : 0;
+				if (settings.min_time <= 0) {
+					fprintf(stderr, "ERROR: Invalid minimal time.\n");
+					return 1;
+				}
+				break;
+			case 'i':
+				OverrideInstallPrefix(opt_data.opt);
+				break;
+			case 'u':
+				OverrideUserdataPrefix(opt_data.opt);
+				break;
+
+			case -1:
+				break;
+
+			default:
+				fprintf(stderr, "ERROR while processing the command-line\n");
+				return 1;
+		}
+	} while (opt_id != -1);
+
+	_video.Initialize(); // There is no display, but the main display window takes its size.
+
+	std::vector<BenchResult> results;
+	for (const Benchmark &bench : _benchmarks) {
+		if (!settings.filter.empty() && std::string(bench.name).find(settings.filter) == std::string::npos) continue;
+		fprintf(stderr, "%-30s ", bench.name);
+		fflush(stderr);
+		results.push_back(RunBenchmark(bench, settings));
+
+		const BenchResult &result = results.back();
+		if (!result.skip_reason.empty()) {
+			fprintf(stderr, "skipped: %s\n", result.skip_reason.c_str());
+		} else {
+			fprintf(stderr, "%12.1f ns/op (best of %d)\n", *std::min_element(result.ns_per_op.begin(), result.ns_per_op.end()), settings.repetitions);
+		}
+	}
+
+	FILE *fp = output_file.empty() ? stdout : fopen(output_file.c_str(), "w");
+	if (fp == nullptr) {
+		fprintf(stderr, "ERROR: Cannot write %s\n", output_file.c_str());
+		return 1;
+	}
+	WriteResults(fp, settings, results);
+	if (fp != stdout) fclose(fp);
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file null_video.cpp Graphics system without a display, so the benchmarks do not need OpenGL. */
+
+#include "../stdafx.h"
+#include "../video.h"
+
+VideoSystem _video;           ///< The #VideoSystem singleton instance.
+TextRenderer _text_renderer;  ///< The #TextRenderer singleton instance.
+
+/* Text renderer without fonts, no text is ever drawn. */
+
+void TextRenderer::RasteriseFont([[maybe_unused]] const std::string &font_path, [[maybe_unused]] GLuint font_size, std::atomic<float> *progress)
+{
+	if (progress != nullptr) *progress = 1.0f;
+}
+
+void TextRenderer::UploadFont()
+{
+}
+
+GLuint TextRenderer::GetTextHeight() const
+{
+	return 0;
+}
+
+void TextRenderer::AddMemoryUsage([[maybe_unused]] MemoryReport &report) const
+{
+}
+
+/* Video system with a fixed full HD display that is never shown. */
+
+/** Initialize the display, it has a fixed size. */
+void VideoSystem::Initialize()
+{
+	this->width = 1920;
+	this->height = 1080;
+	this->mouse_x = 0;
+	this->mouse_y = 0;
+	this->mouse_dragging = MB_NONE;
+	this->average_frametime = 0;
+}
+
+void VideoSystem::EnableInput()
+{
+}
+
+void VideoSystem::ShowLoadingProgress([[maybe_unused]] float progress)
+{
+}
+
+void VideoSystem::MainLoop()
+{
+}
+
+void VideoSystem::Shutdown()
+{
+}
+
+double VideoSystem::FPS() const
+{
+	return 0;
+}
+
+double VideoSystem::AvgFPS() const
+{
+	return 0;
+}
+
+void VideoSystem::SetMouseDragging(MouseButtons button, bool dragging, [[maybe_unused]] bool hide_cursor)
+{
+	if (dragging) {
+		this->mouse_dragging |= button;
+	} else {
+		this->mouse_dragging &= ~button;
+	}
+}
+
+void VideoSystem::SetResolution([[maybe_unused]] const Point32 &res)
+{
+}
+
+void VideoSystem::GetTextSize([[maybe_unused]] const std::string &text, int *width, int *height, [[maybe_unused]] bool add_padding)
+{
+	if (width != nullptr) *width = 0;
+	if (height != nullptr) *height = 0;
+}
+
+void VideoSystem::GetNumberRangeSize([[maybe_unused]] int64 smallest, [[maybe_unused]] int64 biggest, int *width, int *height)
+{
+	if (width != nullptr) *width = 0;
+	if (height != nullptr) *height = 0;
+}
+
+void VideoSystem::BlitText([[maybe_unused]] const std::string &text, [[maybe_unused]] uint32 colour, [[maybe_unused]] int xpos,
+		[[maybe_unused]] int ypos, [[maybe_unused]] int width, [[maybe_unused]] Alignment align)
+{
+}
+
+void VideoSystem::TileImage([[maybe_unused]] const ImageData *img, [[maybe_unused]] const Rectangle32 &rect, [[maybe_unused]] bool tile_hor,
+		[[maybe_unused]] bool tile_vert, [[maybe_unused]] const Recolouring &recolour, [[maybe_unused]] GradientShift shift, [[maybe_unused]] uint32 col)
+{
+}
+
+void VideoSystem::BlitImage([[maybe_unused]] const Point32 &pos, [[maybe_unused]] const ImageData *img, [[maybe_unused]] const Recolouring &recolour,
+		[[maybe_unused]] GradientShift shift, [[maybe_unused]] uint32 col)
+{
+}
+
+void VideoSystem::DoDrawLine([[maybe_unused]] float x1, [[maybe_unused]] float y1, [[maybe_unused]] float x2, [[maybe_unused]] float y2,
+		[[maybe_unused]] uint32 colour)
+{
+}
+
+void VideoSystem::DoFillPlainColour([[maybe_unused]] float x1, [[maybe_unused]] float y1, [[maybe_unused]] float x2, [[maybe_unused]] float y2,
+		[[maybe_unused]] uint32 colour)
+{
+}
+
+void VideoSystem::PushClip(const Rectangle32 &rect)
+{
+	this->clip.push_back(rect);
+}
+
+void VideoSystem::PopClip()
+{
+	this->clip.pop_back();
+}
+
+void VideoSystem::FinishRepaint()
+{
+}
+
+void VideoSystem::AddMemoryUsage([[maybe_unused]] MemoryReport &report) const
+{
+}
@@ -18,6 +18,9 @@
 #include "people.h"
 #include "sprite_data.h"
 #include "viewport.h"
+#include "coaster_simulation.h"
+#include "trace.h"
+#include "memory_usage.h"
 
 #include "generated/coasters_strings.cpp"
 
@@ -337,6 +340,51 @@ int CoasterType::GetRotatedPieceIndex(ConstTrackPiecePtr p, uint8 orientation) c
 	return -1;
 }
 
+/**
+ * Get the track pieces of a saved design, rotated to a build direction.
+ * @param design Design of this coaster type.
+ * @param direction Direction to build the design in.
+ * @return The track pieces in the order of the design, or an empty vector if the design uses unknown pieces.
+ */
+std::vector<ConstTrackPiecePtr> CoasterType::GetDesignPieces(const TrackedRideDesign &design, uint8 direction) const
+{
+	std::vector<ConstTrackPiecePtr> result;
+	for (const TrackedRideDesign::AbstractTrackPiece &abstract_piece : design.pieces) {
+		const int index = this->GetPieceIndex(abstract_piece.piece_name);
+		const int piece_id = (index < 0) ? -1 : this->GetRotatedPieceIndex(this->pieces.at(index), direction);
+		if (piece_id < 0) return std::vector<ConstTrackPiecePtr>();
+		result.push_back(this->pieces.at(piece_id));
+	}
+	return result;
+}
+
+/**
+ * Combine all track voxels of a saved design into a single pseudo track piece, to preview and place the design as a whole.
+ * @param design Design of this coaster type.
+ * @param direction Direction to build the design in.
+ * @return The pseudo track piece, or \c nullptr if the design cannot be built.
+ */
+std::shared_ptr<TrackPiece> CoasterType::MakeDesignPiece(const TrackedRideDesign &design, uint8 direction) const
+{
+	const std::vector<ConstTrackPiecePtr> design_pieces = this->GetDesignPieces(design, direction);
+	if (design_pieces.empty()) return nullptr;
+
+	std::shared_ptr<TrackPiece> result(new TrackPiece);
+	result->entry_connect = (this->pieces.at(this->GetPieceIndex(design.pieces.at(0).piece_name))->entry_connect + direction) % 4;
+
+	XYZPoint16 relative_pos(0, 0, 0);
+	for (const ConstTrackPiecePtr &piece : design_pieces) {
+		for (const auto &track_voxel : piece->track_voxels) {
+			TrackVoxel *tv = new TrackVoxel(*track_voxel);
+			tv->dxyz += relative_pos;
+			result->track_voxels.emplace_back(tv);
+		}
+		result->cost += piece->cost;
+		relative_pos += piece->exit_dxyz;
+	}
+	return result;
+}
+
 /** Default constructor, no sprites available yet. */
 CoasterPlatform::CoasterPlatform() : bg(nullptr), fg(nullptr)
 {
@@ -388,7 +436,8 @@ VoxelObject::Overlays DisplayCoasterCar::GetOverlays(ViewOrientation orient, int
 }
 
 /**
- * Set the position and orientation of the car. It requests repainting of voxels.
+ * Set the position and orientation of the car.
+ * The car is not added to the voxel object lists of the world, viewports find the displayed cars through the trains.
  * @param vox_pos %Voxel position of car.
  * @param pix_pos Position within the voxel (may be outside the \c 0..255 boundary).
  * @param pitch Pitch of the car.
@@ -397,37 +446,11 @@ VoxelObject::Overlays DisplayCoasterCar::GetOverlays(ViewOrientation orient, int
  */
 void DisplayCoasterCar::Set(const XYZPoint16 &vox_pos, const XYZPoint16 &pix_pos, uint8 pitch, uint8 roll, uint8 yaw)
 {
-	bool change_voxel = this->vox_pos != vox_pos;
-
-	if (!change_voxel && this->pix_pos == pix_pos && this->pitch == pitch && this->roll == roll && this->yaw == yaw) {
-		return; // Nothing changed.
-	}
-
-	if (this->yaw != 0xff && change_voxel) {
-		/* Valid data, and changing voxel -> remove self from the old voxel. */
-		Voxel *v = _world.GetCreateVoxel(this->vox_pos, false);
-		this->RemoveSelf(v);
-	}
-
-	/* Update voxel and orientation. */
 	this->vox_pos = vox_pos;
 	this->pix_pos = pix_pos;
 	this->pitch = pitch;
 	this->roll = roll;
 	this->yaw = yaw;
-
-	if (this->yaw != 0xff) {
-		if (change_voxel) { // With a really new voxel, also add self to the new voxel.
-			Voxel *v = _world.GetCreateVoxel(this->vox_pos, false);
-			this->AddSelf(v);
-		}
-	}
-}
-
-/** Displayed car is about to be removed from the train, clean up if necessary. */
-void DisplayCoasterCar::PreRemove()
-{
-	/* Nothing to do currently. */
 }
 
 static const uint32 CURRENT_VERSION_DisplayCoasterCar = 1;   ///< Currently supported version of %DisplayCoasterCar.
@@ -445,11 +468,7 @@ void DisplayCoasterCar::Load(Loader &ldr)
 	this->roll = ldr.GetByte();
 	this->yaw = ldr.GetByte();
 
-	Voxel *v = _world.GetCreateVoxel(this->vox_pos, false);
-
-	if (v != nullptr) {
-		this->AddSelf(v);
-	} else {
+	if (this->yaw != 0xff && _world.GetCreateVoxel(this->vox_pos, false) == nullptr) {
 		throw LoadingError("Invalid world coordinates for coaster car.");
 	}
 	ldr.ClosePattern();
@@ -498,8 +517,6 @@ void CoasterCar::PreRemove()
 #ifndef NDEBUG
 	for (Guest *g : this->guests) assert(g == nullptr);
 #endif
-	this->front.PreRemove();
-	this->back.PreRemove();
 }
 
 CoasterTrain::CoasterTrain()
@@ -556,6 +573,203 @@ static void inline Unroll(uint roll, int32 *dy, int32 *dz)
 	*dz = new_dz;
 }
 
+/**
+ * Compute the position and orientation of a car at the track.
+ * @param pos [inout] Position of the back of the car (in 1/256 pixels), updated to the position of its front.
+ * @param car_length Length of the car (in 1/256 pixels).
+ * @param piece [inout] Track piece containing \a pos, updated to the piece containing the front of the car.
+ * @return Position and orientation of the car.
+ */
+CoasterCarPose CoasterTrack::GetCarPose(uint32 *pos, uint32 car_length, const PositionedTrackPiece **piece) const
+{
+	CoasterCarPose pose;
+	uint32 position = *pos;
+	const PositionedTrackPiece *ptp = *piece;
+
+	/* Get position of the back of the car. */
+	const TrackPosition back_curve = ptp->piece->GetCarPosition(position - ptp->distance_base);
+	int32 xpos_back = back_curve.xpos + (ptp->base_voxel.x << 8);
+	int32 ypos_back = back_curve.ypos + (ptp->base_voxel.y << 8);
+	int32 zpos_back = back_curve.zpos + (ptp->base_voxel.z << 8);
+
+	/* Get roll from the center of the car. */
+	position += car_length / 2;
+	if (position >= this->length) {
+		position -= this->length;
+		ptp = this->GetPieceAt(position);
+	}
+	while (ptp->distance_base + ptp->piece->piece_length < position) ptp++;
+	uint roll = ptp->piece->GetCarPosition(position - ptp->distance_base).roll;
+
+	/* Get position of the front of the car. */
+	position += car_length - car_length / 2;
+	if (position >= this->length) {
+		position -= this->length;
+		ptp = this->GetPieceAt(position);
+	}
+	while (ptp->distance_base + ptp->piece->piece_length < position) ptp++;
+	const TrackPosition front_curve = ptp->piece->GetCarPosition(position - ptp->distance_base);
+	int32 xpos_front = front_curve.xpos + (ptp->base_voxel.x << 8);
+	int32 ypos_front = front_curve.ypos + (ptp->base_voxel.y << 8);
+	int32 zpos_front = front_curve.zpos + (ptp->base_voxel.z << 8);
+
+	int32 xder = xpos_front - xpos_back;
+	int32 yder = ypos_front - ypos_back;
+	int32 zder = (zpos_front - zpos_back) / 2; // Tile height is half the width.
+
+	float total_speed  = sqrt(xder * xder + yder * yder + zder * zder);
+	/* Gravity */
+	pose.gravity = zder / total_speed * 9.8;
+
+	/* Unroll the orientation vector. */
+	Unroll(roll, &yder, &zder);
+	float horizontal_speed = std::hypot(xder, yder);
+
+	static const double TAN11_25 = 0.198912367379658;  // tan(11.25 degrees).
+	static const double TAN33_75 = 0.6681786379192989; // tan(3*11.25 degrees).
+
+	/* Compute pitch. */
+	bool swap_dz = false;
+	if (zder < 0) {
+		swap_dz = true;
+		zder = -zder;
+	}
+
+	uint pitch;
+	if (horizontal_speed < zder) {
+		if (horizontal_speed < zder * TAN11_25) {
+			pitch = 4;
+		} else if (horizontal_speed < zder * TAN33_75) {
+			pitch = 3;
+		} else {
+			pitch = 2;
+		}
+	} else {
+		if (zder < horizontal_speed * TAN11_25) {
+			pitch = 0;
+		} else if (zder < horizontal_speed * TAN33_75) {
+			pitch = 1;
+		} else {
+			pitch = 2;
+		}
+	}
+	if (swap_dz) pitch = (16 - pitch) & 0xf;
+
+	/* Compute yaw. */
+	bool swap_dx = false;
+	if (xder > 0) {
+		swap_dx = true;
+		xder = -xder;
+	}
+	bool swap_dy = false;
+	if (yder > 0) {
+		swap_dy = true;
+		yder = -yder;
+	}
+	uint yaw;
+	/* There are 16 yaw directions, the 360 degrees needs to be split in 16 pieces.
+	 * However the x and y axes are in the middle of a piece, so 360 degrees is split
+	 * in 32 parts, and 2 parts form one piece. */
+	if (xder < yder) {
+		/* In the first 45 degrees. It is split in 4 parts (4*11.25 degrees)
+		 * where the 1st part is for direction 0. The 2nd and 3rd part are for direction 1,
+		 * and the 4th part is for direction 2. */
+		if (xder * TAN11_25 < yder) {
+			yaw = 0;
+		} else if (xder * TAN33_75 < yder) {
+			yaw = 1;
+		} else {
+			yaw = 2;
+		}
+	} else {
+		/* In the second 45 degrees. It is also split in 4 parts (4*11.25 degrees)
+		 * where the 1st part is for direction 2. The 2nd and 3rd part are for direction 3,
+		 * and the 4th part is for direction 4.
+		 *
+		 * Rather than re-inventing a solution, re-use the same checks as
+		 * above with swapped xder and yder. */
+		if (yder * TAN11_25 < xder) {
+			yaw = 4;
+		} else if (yder * TAN33_75 < xder) {
+			yaw = 3;
+		} else {
+			yaw = 2;
+		}
+	}
+	if (swap_dx) yaw = 8 - yaw;
+	if (swap_dy) yaw = (16 - yaw) & 0xf;
+
+	pose.xpos_back  = xpos_back;
+	pose.ypos_back  = ypos_back;
+	pose.zpos_back  = zpos_back;
+	pose.xpos_front = xpos_front;
+	pose.ypos_front = ypos_front;
+	pose.zpos_front = zpos_front;
+	pose.pitch = pitch;
+	pose.roll  = roll;
+	pose.yaw   = yaw;
+
+	*pos = position;
+	*piece = ptp;
+	return pose;
+}
+
+/**
+ * Move along the track.
+ * @param pos Position at the track (in 1/256 pixels).
+ * @param speed Amount of forward motion / millisecond, in 1/256 pixels.
+ * @param delay Amount of time passed, in milliseconds.
+ * @return The new position at the track.
+ */
+uint32 CoasterTrack::Move(uint32 pos, int32 speed, int delay) const
+{
+	if (speed >= 0) {
+		pos += speed * delay;
+		if (pos >= this->length) pos -= this->length;
+	} else {
+		uint32 change = -speed * delay;
+		if (change > pos) {
+			pos = pos + this->length - change;
+		} else {
+			pos -= change;
+		}
+	}
+	return pos;
+}
+
+/**
+ * Apply the speed control of the track to a train.
+ * Powered tiles speed the car up if it is slow; station tiles set a fixed speed.
+ * @param speed Current speed of the train, in 1/256 pixels per millisecond.
+ * @param has_platform Whether a car of the train is at a station.
+ * @param has_power Whether a car of the train is at a powered track piece.
+ * @param delay Amount of time passed, in milliseconds.
+ * @return The new speed of the train.
+ */
+int32 GetTrackControlledSpeed(int32 speed, bool has_platform, bool has_power, int delay)
+{
+	if (has_platform || (has_power && speed < 65536 / 1000)) {
+		const int32 max_speed_change = delay;  // Determines how quickly trains accelerate and brake.
+		speed -= std::min<int32>(max_speed_change, std::max<int32>(-max_speed_change, speed - 65536 / 1000));
+	}
+	return speed;
+}
+
+/**
+ * Find the track piece at a position of the track.
+ * @param pos Position at the track (in 1/256 pixels).
+ * @return The positioned track piece containing the position.
+ * @pre \a pos must be less than #length.
+ */
+const PositionedTrackPiece *CoasterTrack::GetPieceAt(uint32 pos) const
+{
+	const PositionedTrackPiece *ptp = this->pieces;
+	uint32 bucket = pos >> PIECE_INDEX_SHIFT;
+	if (bucket < this->index_size) ptp += this->piece_index[bucket];
+	while (ptp->distance_base + ptp->piece->piece_length < pos) ptp++;
+	return ptp;
+}
+
 /**
  * Time has passed, update the position of the train.
  * @param delay Amount of time passed, in milliseconds.
@@ -572,26 +786,12 @@ void CoasterTrain::OnAnimate(int delay)
 		this->time_left_waiting = 0;
 	}
 
-	if (this->speed >= 0) {
-		this->back_position += this->speed * delay;
-		if (this->back_position >= this->coaster->coaster_length) {
-			this->back_position -= this->coaster->coaster_length;
-			this->cur_piece = this->coaster->pieces.get();
-		}
-		while (this->cur_piece->distance_base + this->cur_piece->piece->piece_length < this->back_position) this->cur_piece++;
-	} else {
-		uint32 change = -this->speed * delay;
-		if (change > this->back_position) {
-			this->back_position = this->back_position + this->coaster->coaster_length - change;
-			/* Update the track piece as well. There is no simple way to get
-			 * the last piece, so moving from the front will have to do. */
-			this->cur_piece = this->coaster->pieces.get();
-			while (this->cur_piece->distance_base + this->cur_piece->piece->piece_length < this->back_position) this->cur_piece++;
-		} else {
-			this->back_position -= change;
-			while (this->cur_piece->distance_base > this->back_position) this->cur_piece--;
-		}
-	}
+	const CoasterTrack track = this->coaster->GetTrack();
+	this->back_position = track.Move(this->back_position, this->speed, delay);
+	this->cur_piece = track.GetPieceAt(this->back_position);
+
+	/* Walk once from the back to the front of the train, positioning the cars and examining the track pieces below them. */
+	bool has_platform = false, has_power = false;
 	uint32 car_length = this->coaster->car_type->car_length;
 	uint32 position = this->back_position; // Back position of the train / last car.
 	const PositionedTrackPiece *ptp = this->cur_piece;
@@ -599,126 +799,30 @@ void CoasterTrain::OnAnimate(int delay)
 		CoasterCar &car = this->cars[i];
 		if (position >= this->coaster->coaster_length) {
 			position -= this->coaster->coaster_length;
-			ptp = this->coaster->pieces.get();
-		}
-		while (ptp->distance_base + ptp->piece->piece_length < position) ptp++;
-
-		/* Get position of the back of the car. */
-		int32 xpos_back = ptp->piece->car_xpos->GetValue(position - ptp->distance_base) + (ptp->base_voxel.x << 8);
-		int32 ypos_back = ptp->piece->car_ypos->GetValue(position - ptp->distance_base) + (ptp->base_voxel.y << 8);
-		int32 zpos_back = ptp->piece->car_zpos->GetValue(position - ptp->distance_base) * 2 + (ptp->base_voxel.z << 8);
-
-		/* Get roll from the center of the car. */
-		position += car_length / 2;
-		if (position >= this->coaster->coaster_length) {
-			position -= this->coaster->coaster_length;
-			ptp = this->coaster->pieces.get();
-		}
-		while (ptp->distance_base + ptp->piece->piece_length < position) ptp++;
-		uint roll = static_cast<uint>(ptp->piece->car_roll->GetValue(position - ptp->distance_base) + 0.5) & 0xf;
-
-		/* Get position of the front of the car. */
-		position += car_length / 2;
-		if (position >= this->coaster->coaster_length) {
-			position -= this->coaster->coaster_length;
-			ptp = this->coaster->pieces.get();
+			ptp = track.GetPieceAt(position);
 		}
 		while (ptp->distance_base + ptp->piece->piece_length < position) ptp++;
-		int32 xpos_front = ptp->piece->car_xpos->GetValue(position - ptp->distance_base) + (ptp->base_voxel.x << 8);
-		int32 ypos_front = ptp->piece->car_ypos->GetValue(position - ptp->distance_base) + (ptp->base_voxel.y << 8);
-		int32 zpos_front = ptp->piece->car_zpos->GetValue(position - ptp->distance_base) * 2 + (ptp->base_voxel.z << 8);
+		has_platform |= ptp->piece->HasPlatform();
+		has_power |= ptp->piece->HasPower();
 
-		int32 xder = xpos_front - xpos_back;
-		int32 yder = ypos_front - ypos_back;
-		int32 zder = (zpos_front - zpos_back) / 2; // Tile height is half the width.
-
-		int32 xpos_middle = xpos_back + xder / 2; // Compute center point of the car as position to render the car.
-		int32 ypos_middle = ypos_back + yder / 2;
-		int32 zpos_middle = zpos_back + zder;
-
-		float total_speed  = sqrt(xder * xder + yder * yder + zder * zder);
-		/* Gravity */
-		this->speed -= zder / total_speed * 9.8;
+		const CoasterCarPose pose = track.GetCarPose(&position, car_length, &ptp);
+		this->speed -= pose.gravity;
 
 		/** \todo Air and rail friction */
 
-		/* Unroll the orientation vector. */
-		Unroll(roll, &yder, &zder);
-		float horizontal_speed = std::hypot(xder, yder);
-
-		static const double TAN11_25 = 0.198912367379658;  // tan(11.25 degrees).
-		static const double TAN33_75 = 0.6681786379192989; // tan(3*11.25 degrees).
-
-		/* Compute pitch. */
-		bool swap_dz = false;
-		if (zder < 0) {
-			swap_dz = true;
-			zder = -zder;
-		}
+		int32 xpos_back  = pose.xpos_back;
+		int32 ypos_back  = pose.ypos_back;
+		int32 zpos_back  = pose.zpos_back;
+		int32 xpos_front = pose.xpos_front;
+		int32 ypos_front = pose.ypos_front;
+		int32 zpos_front = pose.zpos_front;
+		const uint pitch = pose.pitch;
+		const uint roll  = pose.roll;
+		const uint yaw   = pose.yaw;
 
-		uint pitch;
-		if (horizontal_speed < zder) {
-			if (horizontal_speed < zder * TAN11_25) {
-				pitch = 4;
-			} else if (horizontal_speed < zder * TAN33_75) {
-				pitch = 3;
-			} else {
-				pitch = 2;
-			}
-		} else {
-			if (zder < horizontal_speed * TAN11_25) {
-				pitch = 0;
-			} else if (zder < horizontal_speed * TAN33_75) {
-				pitch = 1;
-			} else {
-				pitch = 2;
-			}
-		}
-		if (swap_dz) pitch = (16 - pitch) & 0xf;
-
-		/* Compute yaw. */
-		bool swap_dx = false;
-		if (xder > 0) {
-			swap_dx = true;
-			xder = -xder;
-		}
-		bool swap_dy = false;
-		if (yder > 0) {
-			swap_dy = true;
-			yder = -yder;
-		}
-		uint yaw;
-		/* There are 16 yaw directions, the 360 degrees needs to be split in 16 pieces.
-		 * However the x and y axes are in the middle of a piece, so 360 degrees is split
-		 * in 32 parts, and 2 parts form one piece. */
-		if (xder < yder) {
-			/* In the first 45 degrees. It is split in 4 parts (4*11.25 degrees)
-			 * where the 1st part is for direction 0. The 2nd and 3rd part are for direction 1,
-			 * and the 4th part is for direction 2. */
-			if (xder * TAN11_25 < yder) {
-				yaw = 0;
-			} else if (xder * TAN33_75 < yder) {
-				yaw = 1;
-			} else {
-				yaw = 2;
-			}
-		} else {
-			/* In the second 45 degrees. It is also split in 4 parts (4*11.25 degrees)
-			 * where the 1st part is for direction 2. The 2nd and 3rd part are for direction 3,
-			 * and the 4th part is for direction 4.
-			 *
-			 * Rather than re-inventing a solution, re-use the same checks as
-			 * above with swapped xder and yder. */
-			if (yder * TAN11_25 < xder) {
-				yaw = 4;
-			} else if (yder * TAN33_75 < xder) {
-				yaw = 3;
-			} else {
-				yaw = 2;
-			}
-		}
-		if (swap_dx) yaw = 8 - yaw;
-		if (swap_dy) yaw = (16 - yaw) & 0xf;
+		int32 xpos_middle = xpos_back + (xpos_front - xpos_back) / 2; // Compute center point of the car as position to render the car.
+		int32 ypos_middle = ypos_back + (ypos_front - ypos_back) / 2;
+		int32 zpos_middle = zpos_back + (zpos_front - zpos_back) / 2; // Tile height is half the width.
 
 		xpos_back  &= 0xFFFFFF00; // Back and front positions to the north bottom corner of the voxel.
 		ypos_back  &= 0xFFFFFF00;
@@ -749,48 +853,34 @@ void CoasterTrain::OnAnimate(int delay)
 		}
 	}
 
-	bool has_platform = false, has_power = false;
-	uint32 indexed_car_position = this->back_position;
-	const PositionedTrackPiece *indexed_car_piece = this->cur_piece;
-	int car_index = cars.size();
-	do {
-		if (car_index > 0) {
-			if (indexed_car_piece->piece->HasPlatform()) {
-				has_platform = true;
-				if (this->station_policy == TSP_NO_STATION) {
-					this->station_policy = TSP_ENTERING_STATION;
-					this->time_left_waiting = this->coaster->state == RIS_TESTING ? TRAIN_DEPARTURE_INTERVAL_TESTING : this->coaster->max_idle_duration;
-					this->coaster->RecalculateRatings();  // Recalculate ratings whenever a train has completed a circuit.
-				}
-			}
-			has_power |= indexed_car_piece->piece->HasPower();
-		}
-		indexed_car_position += (car_length + this->coaster->car_type->inter_car_length);
-		if (indexed_car_position >= this->coaster->coaster_length) {
-			indexed_car_position -= this->coaster->coaster_length;
-			indexed_car_piece = this->coaster->pieces.get();
-		}
-		while (indexed_car_piece->distance_base + indexed_car_piece->piece->piece_length < indexed_car_position) {
-			indexed_car_piece++;
-		}
-		car_index--;
-	} while (car_index > 0);
-	const bool front_is_in_station = indexed_car_piece->piece->HasPlatform();
-	/* Powered tiles speed the car up if it is slow; station tiles set a fixed speed. */
-	if (has_platform || (has_power && this->speed < 65536 / 1000)) {
-		const int32 max_speed_change = delay;  // Determines how quickly trains accelerate and brake.
-		this->speed -= std::min<int32>(max_speed_change, std::max<int32>(-max_speed_change, this->speed - 65536 / 1000));
+	if (has_platform && this->station_policy == TSP_NO_STATION) {
+		this->station_policy = TSP_ENTERING_STATION;
+		this->time_left_waiting = this->coaster->state == RIS_TESTING ? TRAIN_DEPARTURE_INTERVAL_TESTING : this->coaster->max_idle_duration;
+		this->coaster->RecalculateRatings();  // Recalculate ratings whenever a train has completed a circuit.
+	}
+
+	/* Position just in front of the train. */
+	uint32 indexed_car_position = position;
+	if (this->cars.empty()) indexed_car_position += car_length + this->coaster->car_type->inter_car_length;
+	if (indexed_car_position >= this->coaster->coaster_length) {
+		indexed_car_position -= this->coaster->coaster_length;
+		ptp = track.GetPieceAt(indexed_car_position);
 	}
+	while (ptp->distance_base + ptp->piece->piece_length < indexed_car_position) ptp++;
+	const bool front_is_in_station = ptp->piece->HasPlatform();
+	this->speed = GetTrackControlledSpeed(this->speed, has_platform, has_power, delay);
 
+	/* Only the nearest train ahead can be hit or be too close. */
 	bool other_train_directly_in_front = false, other_train_in_station_front = false;
-	for (CoasterTrain &train : this->coaster->trains) {
-		if (&train == this || train.cars.empty() || this->back_position > train.back_position) continue;
-		if (delay > 0 && indexed_car_position > train.back_position) {
-			this->coaster->Crash(this, &train);
+	CoasterTrain *ahead = this->coaster->GetTrainAhead(this);
+	if (ahead != nullptr) {
+		if (delay > 0 && indexed_car_position > ahead->back_position) {
+			this->coaster->Crash(this, ahead);
 			return;
 		}
-		other_train_directly_in_front |= (indexed_car_position + 256 * this->coaster->GetTrainSpacing() > train.back_position);
-		other_train_in_station_front |= (indexed_car_position + 2 * 256 * this->coaster->GetTrainSpacing() > train.back_position);
+		const uint32 spacing = 256 * this->coaster->GetTrainSpacing();
+		other_train_directly_in_front = (indexed_car_position + spacing > ahead->back_position);
+		other_train_in_station_front = (indexed_car_position + 2 * spacing > ahead->back_position);
 	}
 
 	if (!has_platform && this->station_policy == TSP_LEAVING_STATION) this->station_policy = TSP_NO_STATION;
@@ -840,6 +930,7 @@ void CoasterTrain::Load(Loader &ldr)
 	}
 
 	this->back_position = ldr.GetLong();
+	this->cur_piece = this->coaster->GetPieceAt(this->back_position);
 	this->speed = (int32)ldr.GetLong();
 	this->station_policy = static_cast<TrainStationPolicy>(ldr.GetByte());
 	this->time_left_waiting = ldr.GetLong();
@@ -861,6 +952,89 @@ void CoasterTrain::Save(Saver &svr)
 	svr.EndPattern();
 }
 
+/**
+ * Add a measurement of a passing train to the data point.
+ * @param valid Whether the measurement should be considered for the ratings.
+ * @param speed Speed of the train.
+ * @param vg Vertical G force.
+ * @param hg Horizontal G force.
+ */
+void CoasterIntensityStatistics::AddSample(bool valid, int32 speed, int32 vg, int32 hg)
+{
+	if (this->precision == 0) {
+		*this = CoasterIntensityStatistics{valid, 1, speed, vg, hg};
+		return;
+	}
+	this->valid &= valid;
+	this->speed        = (this->precision * this->speed        + speed) / (this->precision + 1);
+	this->vertical_g   = (this->precision * this->vertical_g   + vg   ) / (this->precision + 1);
+	this->horizontal_g = (this->precision * this->horizontal_g + hg   ) / (this->precision + 1);
+	this->precision++;
+}
+
+/**
+ * Merge the measurements of another data point at the same position into this data point.
+ * @param other Data point to merge.
+ */
+void CoasterIntensityStatistics::Merge(const CoasterIntensityStatistics &other)
+{
+	if (other.precision == 0) return;
+	if (this->precision == 0) {
+		*this = other;
+		return;
+	}
+	const int32 total = this->precision + other.precision;
+	this->valid &= other.valid;
+	this->speed        = (static_cast<int64>(this->precision) * this->speed        + static_cast<int64>(other.precision) * other.speed       ) / total;
+	this->vertical_g   = (static_cast<int64>(this->precision) * this->vertical_g   + static_cast<int64>(other.precision) * other.vertical_g  ) / total;
+	this->horizontal_g = (static_cast<int64>(this->precision) * this->horizontal_g + static_cast<int64>(other.precision) * other.horizontal_g) / total;
+	this->precision = total;
+}
+
+CoasterRatingSums::CoasterRatingSums()
+{
+	this->Clear();
+}
+
+/** Reset the sums to having no data points. */
+void CoasterRatingSums::Clear()
+{
+	this->excitement = 0;
+	this->intensity = 0;
+	this->nausea = 0;
+	this->points = 0;
+}
+
+/**
+ * Add a data point to the sums.
+ * @param stats Data point to add, ignored if it is not valid.
+ */
+void CoasterRatingSums::Add(const CoasterIntensityStatistics &stats)
+{
+	if (!stats.valid || stats.precision == 0) return;
+	this->excitement += std::abs(stats.speed);
+	this->intensity += std::abs(stats.speed);
+	this->intensity += std::abs(stats.horizontal_g * stats.speed);
+	this->intensity += std::abs(stats.vertical_g   * stats.speed);
+	this->nausea += std::abs(stats.vertical_g   * stats.speed);
+	this->points++;
+}
+
+/**
+ * Remove a data point that was added before from the sums.
+ * @param stats Data point to remove, ignored if it is not valid.
+ */
+void CoasterRatingSums::Remove(const CoasterIntensityStatistics &stats)
+{
+	if (!stats.valid || stats.precision == 0) return;
+	this->excitement -= std::abs(stats.speed);
+	this->intensity -= std::abs(stats.speed);
+	this->intensity -= std::abs(stats.horizontal_g * stats.speed);
+	this->intensity -= std::abs(stats.vertical_g   * stats.speed);
+	this->nausea -= std::abs(stats.vertical_g   * stats.speed);
+	this->points--;
+}
+
 /** Default constructor for a station of length 0 with no entrance or exit. */
 CoasterStation::CoasterStation()
 :
@@ -880,21 +1054,32 @@ CoasterStation::CoasterStation()
 CoasterInstance::CoasterInstance(const CoasterType *ct, const CarType *init_car_type) : RideInstance(ct),
 	pieces(new PositionedTrackPiece[MAX_PLACED_TRACK_PIECES]()),
 	capacity(MAX_PLACED_TRACK_PIECES),
+	coaster_length(0),
 	number_of_trains(0),
 	cars_per_train(0),
 	car_type(init_car_type),
+	train_spacing(init_car_type->car_length / 512),  // Half a car length.
 	temp_entrance_pos(XYZPoint16::invalid()),
 	temp_exit_pos(XYZPoint16::invalid()),
 	max_idle_duration(30000),
-	min_idle_duration(5000)
+	min_idle_duration(5000),
+	scenery_bonus(0),
+	scenery_bonus_generation(0),
+	scenery_bonus_valid(false)
 {
 	for (uint i = 0; i < lengthof(this->trains); i++) {
 		CoasterTrain &train = this->trains[i];
 		train.coaster = this;
 		train.cur_piece = this->pieces.get();
+		this->train_order[i] = i;
 	}
 }
 
+CoasterInstance::~CoasterInstance()
+{
+	this->CancelSimulation();
+}
+
 const Recolouring *CoasterInstance::GetRecolours(const XYZPoint16 &pos) const
 {
 	if (pos == this->temp_entrance_pos) return &this->entrance_recolours;
@@ -927,6 +1112,9 @@ bool CoasterInstance::CanBeVisited(const XYZPoint16 &vox, TileEdge edge) const
 void CoasterInstance::OnAnimate(int delay)
 {
 	RideInstance::OnAnimate(delay);
+	if (this->simulation.valid() && this->simulation.wait_for(std::chrono::seconds(0)) != std::future_status::timeout) {
+		this->FinishSimulation();
+	}
 	if (this->broken) return;
 
 	for (uint i = 0; i < lengthof(this->trains); i++) {
@@ -947,6 +1135,50 @@ void CoasterInstance::TestRide()
 		this->ReinitializeTrains(true);
 	}
 	this->state = RIS_TESTING;
+	this->StartSimulation();
+}
+
+/** Start a test run of the coaster on another thread, to get its ratings without waiting for the trains. */
+void CoasterInstance::StartSimulation()
+{
+	this->CancelSimulation();
+
+	CoasterSimulation test_run(*this);
+	std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+#ifdef WEBASSEMBLY
+	const std::launch policy = std::launch::deferred;  // No threads, run it when the result is needed.
+#else
+	const std::launch policy = std::launch::async;
+#endif
+	this->simulation = std::async(policy, [test_run, cancelled]() { return test_run.Run(*cancelled); });
+	this->simulation_cancelled = std::move(cancelled);
+}
+
+/** Stop and drop the test run of the coaster, if there is one. Dropping a running test run waits for its thread, so it is told to stop first. */
+void CoasterInstance::CancelSimulation()
+{
+	if (this->simulation_cancelled != nullptr) this->simulation_cancelled->store(true, std::memory_order_relaxed);
+	this->simulation = std::future<std::vector<CoasterIntensityStatistics>>();
+	this->simulation_cancelled.reset();
+}
+
+/** Merge the results of the finished test run into the statistics of the coaster. */
+void CoasterInstance::FinishSimulation()
+{
+	std::vector<CoasterIntensityStatistics> results = this->simulation.get();
+	this->simulation_cancelled.reset();
+	if (this->state == RIS_CLOSED || results.empty()) return;
+
+	if (this->intensity_statistics.size() < results.size()) {
+		this->intensity_statistics.resize(results.size(), CoasterIntensityStatistics{false, 0, 0, 0, 0});
+	}
+	for (uint32 point = 0; point < results.size(); point++) {
+		CoasterIntensityStatistics &stats = this->intensity_statistics[point];
+		this->rating_sums.Remove(stats);
+		stats.Merge(results[point]);
+		this->rating_sums.Add(stats);
+	}
+	this->RecalculateRatings();
 }
 
 void CoasterInstance::OpenRide()
@@ -962,7 +1194,8 @@ void CoasterInstance::OpenRide()
 
 void CoasterInstance::CloseRide()
 {
-	this->intensity_statistics.clear();
+	this->CancelSimulation(); // The track may change, drop the test run.
+	this->ClearStatistics();
 	for (uint i = 0; i < lengthof(this->trains); i++) {
 		CoasterTrain &train = this->trains[i];
 		train.back_position = 0;
@@ -1067,7 +1300,6 @@ RideEntryResult CoasterInstance::EnterRide(int guest_id, const XYZPoint16 &vox,
 {
 	Guest *guest = _guests.GetExisting(guest_id);
 	if (guest->cash < GetSaleItemPrice(0)) return RER_REFUSED;
-	Random r;
 	for (const CoasterStation &s : this->stations) {
 		if (s.entrance != vox) continue;
 
@@ -1094,7 +1326,7 @@ RideEntryResult CoasterInstance::EnterRide(int guest_id, const XYZPoint16 &vox,
 		if (free_slots.empty()) return RER_WAIT;
 
 		auto it = free_slots.begin();
-		std::advance(it, r.Uniform(free_slots.size() - 1));
+		std::advance(it, this->rnd.Uniform(free_slots.size() - 1));
 		it->first->guests[it->second] = guest;
 		if (free_slots.size() == 1) {
 			/* Start the train as soon as the minimum idle duration has elapsed. */
@@ -1123,8 +1355,7 @@ XYZPoint32 CoasterInstance::GetExit([[maybe_unused]] int guest, TileEdge station
 	const CoasterStation &station = this->stations[static_cast<int>(station_index)];
 	const int direction = this->EntranceExitRotation(station.exit, &station);
 	XYZPoint32 p(station.exit.x * 256, station.exit.y * 256, station.exit.z * 256);
-	Random r;  // Don't put all guests on exactly the same spot.
-	const int d = 128 + r.Uniform(128) - 64;
+	const int d = 128 + this->rnd.Uniform(128) - 64;  // Don't put all guests on exactly the same spot.
 	switch (direction) {
 		case VOR_WEST:  p.x += d;       p.y -= 32;      break;
 		case VOR_EAST:  p.x += d;       p.y += 256+32;  break;
@@ -1239,10 +1470,12 @@ int CoasterInstance::FindSuccessorPiece(const XYZPoint16 &vox, uint8 entry_conne
 {
 	if (start < 0) start = 0;
 	if (end > MAX_PLACED_TRACK_PIECES) end = MAX_PLACED_TRACK_PIECES;
-	for (; start < end; start++) {
-		if (this->pieces[start].CanBeSuccessor(vox, entry_connect)) return start;
+	int found = -1;
+	auto range = this->entry_connections.equal_range(TrackConnectionKey(vox, entry_connect));
+	for (auto iter = range.first; iter != range.second; ++iter) {
+		if (iter->second >= start && iter->second < end && (found < 0 || iter->second < found)) found = iter->second;
 	}
-	return -1;
+	return found;
 }
 
 /**
@@ -1262,12 +1495,79 @@ int CoasterInstance::FindSuccessorPiece(const PositionedTrackPiece &placed)
  */
 int CoasterInstance::FindPredecessorPiece(const PositionedTrackPiece &placed)
 {
-	for (int i = 0; i < this->capacity; i++) {
-		if (placed.CanBeSuccessor(this->pieces[i])) {
-			return i;
+	if (placed.piece == nullptr) return -1;
+	int found = -1;
+	auto range = this->exit_connections.equal_range(TrackConnectionKey(placed.base_voxel, placed.piece->entry_connect));
+	for (auto iter = range.first; iter != range.second; ++iter) {
+		if (found < 0 || iter->second < found) found = iter->second;
+	}
+	return found;
+}
+
+/**
+ * Add the connections of a placed track piece to the connection lookup tables.
+ * @param index Index of the positioned track piece.
+ */
+void CoasterInstance::AddConnections(int index)
+{
+	const PositionedTrackPiece &ptp = this->pieces[index];
+	assert(ptp.piece != nullptr);
+	this->entry_connections.emplace(TrackConnectionKey(ptp.base_voxel, ptp.piece->entry_connect), index);
+	this->exit_connections.emplace(TrackConnectionKey(ptp.GetEndXYZ(), ptp.piece->exit_connect), index);
+}
+
+/**
+ * Remove an entry of a placed track piece from a connection lookup table.
+ * @param connections Lookup table to update.
+ * @param key Key of the connection.
+ * @param index Index of the positioned track piece.
+ */
+static void EraseConnection(std::unordered_multimap<uint64, int> &connections, uint64 key, int index)
+{
+	auto range = connections.equal_range(key);
+	for (auto iter = range.first; iter != range.second; ++iter) {
+		if (iter->second == index) {
+			connections.erase(iter);
+			return;
 		}
 	}
-	return -1;
+	NOT_REACHED();
+}
+
+/**
+ * Remove the connections of a placed track piece from the connection lookup tables.
+ * @param index Index of the positioned track piece.
+ */
+void CoasterInstance::RemoveConnections(int index)
+{
+	const PositionedTrackPiece &ptp = this->pieces[index];
+	assert(ptp.piece != nullptr);
+	EraseConnection(this->entry_connections, TrackConnectionKey(ptp.base_voxel, ptp.piece->entry_connect), index);
+	EraseConnection(this->exit_connections, TrackConnectionKey(ptp.GetEndXYZ(), ptp.piece->exit_connect), index);
+}
+
+/** Recompute the connection lookup tables from the positioned track pieces. */
+void CoasterInstance::RebuildConnections()
+{
+	this->entry_connections.clear();
+	this->exit_connections.clear();
+	for (int i = 0; i < this->capacity; i++) {
+		if (this->pieces[i].piece != nullptr) this->AddConnections(i);
+	}
+}
+
+/**
+ * Exchange two placed track pieces in the #pieces array, keeping the connection lookup tables up to date.
+ * @param a Index of the first positioned track piece.
+ * @param b Index of the second positioned track piece.
+ */
+void CoasterInstance::SwapPositionedPieces(int a, int b)
+{
+	if (this->pieces[a].piece != nullptr) this->RemoveConnections(a);
+	if (this->pieces[b].piece != nullptr) this->RemoveConnections(b);
+	std::swap(this->pieces[a], this->pieces[b]);
+	if (this->pieces[a].piece != nullptr) this->AddConnections(a);
+	if (this->pieces[b].piece != nullptr) this->AddConnections(b);
 }
 
 /**
@@ -1280,10 +1580,12 @@ int CoasterInstance::FindPredecessorPiece(const PositionedTrackPiece &placed)
 bool CoasterInstance::MakePositionedPiecesLooping(bool *modified)
 {
 	this->UpdateStations();
+	this->piece_index.clear();
 	if (modified != nullptr) *modified = false;
 
 	/* First step, move all non-null track pieces to the start of the array. */
 	int count = 0;
+	bool compacted = false;
 	for (int i = 0; i < this->capacity; i++) {
 		PositionedTrackPiece *ptp = this->pieces.get() + i;
 		if (ptp->piece == nullptr) continue;
@@ -1294,8 +1596,10 @@ bool CoasterInstance::MakePositionedPiecesLooping(bool *modified)
 		std::swap(this->pieces[count], *ptp);
 		if (modified != nullptr) *modified = true;
 		ptp->piece = nullptr;
+		compacted = true;
 		count++;
 	}
+	if (compacted) this->RebuildConnections();
 
 	/* Second step, find a loop from start to end. */
 	if (count < 2) return false; // 0 or 1 positioned pieces won't ever make a loop.
@@ -1313,7 +1617,7 @@ bool CoasterInstance::MakePositionedPiecesLooping(bool *modified)
 		if (j < 0) return false;
 		ptp++; // Now points to pieces[i].
 		if (i != j) {
-			std::swap(*ptp, this->pieces[j]); // Make piece 'j' the next positioned piece.
+			this->SwapPositionedPieces(i, j); // Make piece 'j' the next positioned piece.
 			if (modified != nullptr) *modified = true;
 		}
 		if (ptp->distance_base != distance) {
@@ -1323,6 +1627,7 @@ bool CoasterInstance::MakePositionedPiecesLooping(bool *modified)
 		distance += ptp->piece->piece_length;
 	}
 	this->coaster_length = distance;
+	this->UpdatePieceIndex(count);
 	this->UpdateStations();
 	return this->pieces[0].CanBeSuccessor(*ptp);
 }
@@ -1340,6 +1645,7 @@ int CoasterInstance::AddPositionedPiece(const PositionedTrackPiece &placed)
 		if (this->pieces[i].piece == nullptr) {
 			this->pieces[i] = placed;
 			this->pieces[i].return_cost = -this->pieces[i].piece->cost;
+			this->AddConnections(i);
 			if (placed.piece->IsStartingPiece()) this->UpdateStations();
 			return i;
 		}
@@ -1347,6 +1653,19 @@ int CoasterInstance::AddPositionedPiece(const PositionedTrackPiece &placed)
 	return -1;
 }
 
+/**
+ * Find the positioned track piece with its base at a voxel.
+ * @param base_voxel Base voxel of the piece.
+ * @return Index of the piece, or \c -1 if there is none.
+ */
+int CoasterInstance::GetPlacedPieceIndex(const XYZPoint16 &base_voxel) const
+{
+	for (int i = 0; i < this->capacity; i++) {
+		if (this->pieces[i].piece != nullptr && this->pieces[i].base_voxel == base_voxel) return i;
+	}
+	return -1;
+}
+
 /**
  * Try to remove a positioned track piece from the coaster instance.
  * @param piece Positioned track piece to remove.
@@ -1354,6 +1673,7 @@ int CoasterInstance::AddPositionedPiece(const PositionedTrackPiece &placed)
 void CoasterInstance::RemovePositionedPiece(PositionedTrackPiece &piece)
 {
 	assert(piece.piece != nullptr);
+	this->RemoveConnections(&piece - this->pieces.get());
 	this->RemoveTrackPieceInWorld(piece);
 	if (piece.piece->IsStartingPiece()) this->UpdateStations();
 	piece.piece = nullptr;
@@ -1441,7 +1761,51 @@ uint32 CoasterInstance::GetTrainLength(const int cars) const
  */
 uint32 CoasterInstance::GetTrainSpacing() const
 {
-	return this->car_type->car_length / 512;  // Half a car length.
+	return this->train_spacing;
+}
+
+/**
+ * Is a train behind another train in the #train_order?
+ * @param a First train.
+ * @param b Second train.
+ * @return Train \a a should be ordered before train \a b. Trains without cars come last.
+ */
+static bool IsTrainBehind(const CoasterTrain &a, const CoasterTrain &b)
+{
+	if (a.cars.empty()) return false;
+	if (b.cars.empty()) return true;
+	return a.back_position < b.back_position;
+}
+
+/**
+ * Find the nearest train ahead of a train. Trains at the start of the track are not considered to be ahead of trains near its end.
+ * @param train Train to look from.
+ * @return The nearest train at or beyond the back of \a train, or \c nullptr if there is none.
+ */
+CoasterTrain *CoasterInstance::GetTrainAhead(const CoasterTrain *train)
+{
+	if (train->cars.empty()) return nullptr;
+
+	/* Insertion sort, trains only change order when wrapping around the end of the track. */
+	for (uint i = 1; i < lengthof(this->train_order); i++) {
+		for (uint j = i; j > 0 && IsTrainBehind(this->trains[this->train_order[j]], this->trains[this->train_order[j - 1]]); j--) {
+			std::swap(this->train_order[j], this->train_order[j - 1]);
+		}
+	}
+
+	uint index = 0;
+	while (&this->trains[this->train_order[index]] != train) index++;
+
+	/* A train at the same position counts as ahead as well. */
+	if (index > 0) {
+		CoasterTrain *previous = &this->trains[this->train_order[index - 1]];
+		if (previous->back_position == train->back_position) return previous;
+	}
+	if (index + 1 < lengthof(this->train_order)) {
+		CoasterTrain *next = &this->trains[this->train_order[index + 1]];
+		if (!next->cars.empty()) return next;
+	}
+	return nullptr;
 }
 
 /**
@@ -1765,6 +2129,42 @@ uint32 CoasterInstance::PositionRelativeTo(uint32 pos, const uint32 offset) cons
 	return pos - offset;
 }
 
+/**
+ * Find the track piece at a position of the track.
+ * @param pos Position at the track (in 1/256 pixels).
+ * @return The positioned track piece containing the position.
+ * @pre \a pos must be less than #coaster_length.
+ */
+const PositionedTrackPiece *CoasterInstance::GetPieceAt(uint32 pos) const
+{
+	return this->GetTrack().GetPieceAt(pos);
+}
+
+/**
+ * Get a view of the track, for moving cars over it.
+ * @return The track of the coaster.
+ * @note The view is invalidated by changes of the track layout.
+ */
+CoasterTrack CoasterInstance::GetTrack() const
+{
+	return CoasterTrack{this->pieces.get(), this->piece_index.data(), static_cast<uint32>(this->piece_index.size()), this->coaster_length};
+}
+
+/**
+ * Compute the #piece_index of the track, for quickly finding the piece at a position.
+ * @param count Number of positioned pieces in the track loop.
+ */
+void CoasterInstance::UpdatePieceIndex(int count)
+{
+	this->piece_index.resize((this->coaster_length >> PIECE_INDEX_SHIFT) + 1);
+	int index = 0;
+	for (uint32 bucket = 0; bucket < this->piece_index.size(); bucket++) {
+		const uint32 pos = bucket << PIECE_INDEX_SHIFT;
+		while (index + 1 < count && this->pieces[index].distance_base + this->pieces[index].piece->piece_length < pos) index++;
+		this->piece_index[bucket] = index;
+	}
+}
+
 /**
  * Check whether an entrance or exit can be placed at the given location.
  * @param pos Absolute voxel in the world.
@@ -1865,47 +2265,54 @@ bool CoasterInstance::PlaceEntranceOrExit(const XYZPoint16 &pos, const bool entr
 void CoasterInstance::SampleStatistics(uint32 point, const bool valid, const int32 speed, const int32 vg, const int32 hg)
 {
 	point /= COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION;
-	auto it = this->intensity_statistics.find(point);
-	if (it == this->intensity_statistics.end()) {
-		this->intensity_statistics.emplace(std::make_pair(point, CoasterIntensityStatistics{valid, 1, speed, vg, hg}));
-	} else {
-		it->second.valid &= valid;
-		it->second.speed        = (it->second.precision * it->second.speed        + speed) / (it->second.precision + 1);
-		it->second.vertical_g   = (it->second.precision * it->second.vertical_g   + vg   ) / (it->second.precision + 1);
-		it->second.horizontal_g = (it->second.precision * it->second.horizontal_g + hg   ) / (it->second.precision + 1);
-		it->second.precision++;
+	if (point >= this->intensity_statistics.size()) {
+		const size_t count = std::max<size_t>(point + 1, this->coaster_length / COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION + 1);
+		this->intensity_statistics.resize(count, CoasterIntensityStatistics{false, 0, 0, 0, 0});
 	}
+	CoasterIntensityStatistics &stats = this->intensity_statistics[point];
+	this->rating_sums.Remove(stats);
+	stats.AddSample(valid, speed, vg, hg);
+	this->rating_sums.Add(stats);
 }
 
-void CoasterInstance::RecalculateRatings()
+/** Forget all intensity statistics of the coaster. */
+void CoasterInstance::ClearStatistics()
 {
-	uint64 exc = 100;  // Excitement rating in percent.
-	uint64 iny = 100;  // Intensity rating in percent.
-	uint64 nau = 100;  // Nausea rating in percent.
-	uint32 statpoints = 0;
-	for (const auto &pair : this->intensity_statistics) {
-		if (!pair.second.valid) continue;
-		exc += std::abs(pair.second.speed);
-		iny += std::abs(pair.second.speed);
-		iny += std::abs(pair.second.horizontal_g * pair.second.speed);
-		iny += std::abs(pair.second.vertical_g   * pair.second.speed);
-		nau += std::abs(pair.second.vertical_g   * pair.second.speed);
-		statpoints++;
-	}
-	if (statpoints == 0) {
-		this->excitement_rating = RATING_NOT_YET_CALCULATED;
-		this->intensity_rating = RATING_NOT_YET_CALCULATED;
-		this->nausea_rating = RATING_NOT_YET_CALCULATED;
-		return;
-	}
+	this->intensity_statistics.clear();
+	this->rating_sums.Clear();
+}
 
-	iny /= statpoints;
-	nau /= statpoints;
-	exc /= statpoints;
+/**
+ * Get the excitement bonus for the surroundings of the track.
+ * The bonus is only computed again after voxels in the world have changed.
+ * @return Excitement bonus in percent.
+ */
+uint64 CoasterInstance::GetSceneryBonus()
+{
+	if (this->scenery_bonus_valid && this->scenery_bonus_generation == _voxel_generation) return this->scenery_bonus;
 
-	std::set<XYZPoint16> considered_locations;
-	const uint16 index = this->GetIndex();
+	/* Bounding box of the considered voxels, to mark the voxels already counted in a bitmap. */
 	const int start_piece = GetFirstPlacedTrackPiece();
+	XYZPoint16 low = this->pieces[start_piece].base_voxel;
+	XYZPoint16 high = low;
+	for (int p = start_piece;;) {
+		const XYZPoint16 &base = this->pieces[p].base_voxel;
+		low.x = std::min(low.x, base.x);
+		low.y = std::min(low.y, base.y);
+		low.z = std::min(low.z, base.z);
+		high.x = std::max(high.x, base.x);
+		high.y = std::max(high.y, base.y);
+		high.z = std::max(high.z, base.z);
+		p = FindSuccessorPiece(this->pieces[p]);
+		if (p < 0 || p == start_piece) break;
+	}
+	const int size_x = high.x - low.x + 5;
+	const int size_y = high.y - low.y + 5;
+	const int size_z = high.z - low.z + 7;
+	std::vector<bool> considered_locations(size_x * size_y * size_z, false);
+
+	uint64 bonus = 0;
+	const uint16 index = this->GetIndex();
 	for (int p = start_piece;;) {
 		for (int dx = -2; dx <= 2; dx++) {
 			for (int dy = -2; dy <= 2; dy++) {
@@ -1914,15 +2321,16 @@ void CoasterInstance::RecalculateRatings()
 					XYZPoint16 pos(dx, dy, dh);
 					pos += this->pieces[p].base_voxel;
 
-					if (considered_locations.count(pos)) continue;
-					considered_locations.insert(pos);
+					const int bit = ((pos.x - low.x + 2) * size_y + (pos.y - low.y + 2)) * size_z + (pos.z - low.z + 4);
+					if (considered_locations[bit]) continue;
+					considered_locations[bit] = true;
 
-					Voxel *voxel = _world.GetCreateVoxel(pos, false);
+					const Voxel *voxel = _world.GetCreateVoxel(pos, false);
 					if (voxel == nullptr) continue;
 
-					if (IsImplodedSteepSlope(voxel->GetGroundSlope()))                 exc += 2;
-					if (voxel->instance == SRI_SCENERY)                                exc += 4;
-					if (voxel->instance >= SRI_FULL_RIDES && voxel->instance != index) exc += 7;
+					if (IsImplodedSteepSlope(voxel->GetGroundSlope()))                 bonus += 2;
+					if (voxel->instance == SRI_SCENERY)                                bonus += 4;
+					if (voxel->instance >= SRI_FULL_RIDES && voxel->instance != index) bonus += 7;
 					/* \todo Also give a bonus for accurately mowed lawns and building near water. */
 				}
 			}
@@ -1931,6 +2339,28 @@ void CoasterInstance::RecalculateRatings()
 		if (p < 0 || p == start_piece) break;
 	}
 
+	this->scenery_bonus = bonus;
+	this->scenery_bonus_generation = _voxel_generation;
+	this->scenery_bonus_valid = true;
+	return bonus;
+}
+
+void CoasterInstance::RecalculateRatings()
+{
+	TraceScope trace("CoasterInstance::RecalculateRatings");
+	if (this->rating_sums.points == 0) {
+		this->excitement_rating = RATING_NOT_YET_CALCULATED;
+		this->intensity_rating = RATING_NOT_YET_CALCULATED;
+		this->nausea_rating = RATING_NOT_YET_CALCULATED;
+		return;
+	}
+
+	/* Ratings in percent. */
+	uint64 iny = (100 + this->rating_sums.intensity) / this->rating_sums.points;
+	uint64 nau = (100 + this->rating_sums.nausea) / this->rating_sums.points;
+	uint64 exc = (100 + this->rating_sums.excitement) / this->rating_sums.points;
+	exc += this->GetSceneryBonus();
+
 	exc -= std::min(exc / 2, nau);
 	exc -= std::min(exc / 2, iny);
 
@@ -1967,10 +2397,12 @@ void CoasterInstance::Load(Loader &ldr)
 			this->pieces[i].piece = piece;
 			this->pieces[i].Load(ldr);
 			this->PlaceTrackPieceInWorld(this->pieces[i]);
+			this->AddConnections(i);
 		} else {
 			throw LoadingError("Invalid track piece.");
 		}
 	}
+	this->UpdatePieceIndex(saved_pieces);
 
 	this->number_of_trains = ldr.GetWord();
 	this->cars_per_train = ldr.GetWord();
@@ -2003,7 +2435,7 @@ void CoasterInstance::Load(Loader &ldr)
 		}
 	}
 
-	this->intensity_statistics.clear();
+	this->ClearStatistics();
 	for (long i = ldr.GetLong(); i > 0; i--) {
 		const uint32 point = ldr.GetLong();
 		const bool valid = ldr.GetByte() != 0;
@@ -2011,7 +2443,13 @@ void CoasterInstance::Load(Loader &ldr)
 		const int32 speed = ldr.GetLong();
 		const int32 vg = ldr.GetLong();
 		const int32 hg = ldr.GetLong();
-		this->intensity_statistics.emplace(std::make_pair(point, CoasterIntensityStatistics{valid, precision, speed, vg, hg}));
+		if (precision <= 0) throw LoadingError("Invalid coaster intensity statistics.");
+		if (point >= this->intensity_statistics.size()) {
+			const size_t count = std::max<size_t>(point + 1, this->coaster_length / COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION + 1);
+			this->intensity_statistics.resize(count, CoasterIntensityStatistics{false, 0, 0, 0, 0});
+		}
+		this->intensity_statistics[point] = CoasterIntensityStatistics{valid, precision, speed, vg, hg};
+		this->rating_sums.Add(this->intensity_statistics[point]);
 	}
 
 	this->InsertStationsIntoWorld();
@@ -2068,18 +2506,44 @@ void CoasterInstance::Save(Saver &svr)
 		}
 	}
 
-	svr.PutLong(this->intensity_statistics.size());
-	for (const auto &pair : this->intensity_statistics) {
-		svr.PutLong(pair.first);
-		svr.PutByte(pair.second.valid ? 1 : 0);
-		svr.PutLong(pair.second.precision);
-		svr.PutLong(pair.second.speed);
-		svr.PutLong(pair.second.vertical_g);
-		svr.PutLong(pair.second.horizontal_g);
+	svr.PutLong(std::count_if(this->intensity_statistics.begin(), this->intensity_statistics.end(),
+			[](const CoasterIntensityStatistics &stats) { return stats.precision > 0; }));
+	for (uint32 point = 0; point < this->intensity_statistics.size(); point++) {
+		const CoasterIntensityStatistics &stats = this->intensity_statistics[point];
+		if (stats.precision == 0) continue;
+		svr.PutLong(point);
+		svr.PutByte(stats.valid ? 1 : 0);
+		svr.PutLong(stats.precision);
+		svr.PutLong(stats.speed);
+		svr.PutLong(stats.vertical_g);
+		svr.PutLong(stats.horizontal_g);
 	}
 	svr.EndPattern();
 }
 
+/**
+ * Add the memory used by the track and the intensity statistics to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void CoasterInstance::AddMemoryUsage(MemoryReport &report) const
+{
+	constexpr size_t CONNECTION_SIZE = sizeof(std::pair<uint64, int>) + MemoryReport::NODE_OVERHEAD;
+
+	size_t bytes = this->capacity * sizeof(PositionedTrackPiece) + this->piece_index.capacity() * sizeof(uint16);
+	bytes += (this->entry_connections.size() + this->exit_connections.size()) * CONNECTION_SIZE;
+	bytes += (this->entry_connections.bucket_count() + this->exit_connections.bucket_count()) * sizeof(void *);
+	bytes += this->stations.capacity() * sizeof(CoasterStation);
+	for (const CoasterStation &station : this->stations) bytes += station.locations.capacity() * sizeof(XYZPoint16);
+	size_t placed = 0;
+	for (int i = 0; i < this->capacity; i++) {
+		if (this->pieces[i].piece != nullptr) placed++;
+	}
+	report.Add(MO_COASTER_TRACKS, placed, bytes);
+
+	report.Add(MO_COASTER_STATISTICS, this->intensity_statistics.size(),
+			this->intensity_statistics.capacity() * sizeof(CoasterIntensityStatistics));
+}
+
 /**
  * Save this coaster's track design.
  * @param file File to save to.
@@ -11,13 +11,30 @@
 #define COASTER_H
 
 #include <array>
+#include <atomic>
+#include <future>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "map.h"
 #include "person.h"
 #include "track_piece.h"
 
 static const int MAX_PLACED_TRACK_PIECES = 1024; ///< Maximum number of track pieces in a single roller coaster.
+/**
+ * Key of a track connection in a voxel, for looking up placed track pieces.
+ * @param vox Voxel of the connection.
+ * @param connect Connection code.
+ * @return Key of the connection.
+ */
+inline uint64 TrackConnectionKey(const XYZPoint16 &vox, uint8 connect)
+{
+	return (static_cast<uint64>(static_cast<uint16>(vox.x)) << 40) | (static_cast<uint64>(static_cast<uint16>(vox.y)) << 24) |
+			(static_cast<uint64>(static_cast<uint16>(vox.z)) << 8) | connect;
+}
+
+static const uint PIECE_INDEX_SHIFT = 12; ///< Log2 of the track length covered by one entry of CoasterInstance::piece_index, in 1/256 pixels.
 
 typedef std::map<uint32, ConstTrackPiecePtr> TrackPiecesMap; ///< Map of loaded track pieces.
 
@@ -72,6 +89,8 @@ public:
 	int GetPieceIndex(ConstTrackPiecePtr p) const;
 	int GetPieceIndex(const std::string &name) const;
 	int GetRotatedPieceIndex(ConstTrackPiecePtr p, uint8 orientation) const;
+	std::vector<ConstTrackPiecePtr> GetDesignPieces(const TrackedRideDesign &design, uint8 direction) const;
+	std::shared_ptr<TrackPiece> MakeDesignPiece(const TrackedRideDesign &design, uint8 direction) const;
 
 	uint16 coaster_kind;       ///< Kind of coaster. @see CoasterKind
 	uint8 platform_type;       ///< Type of platform. @see CoasterPlatformType
@@ -103,9 +122,38 @@ extern CoasterPlatform _coaster_platforms[];
 class CoasterCar;
 class CoasterTrain;
 
+/** Position and orientation of a car at a coaster track. */
+struct CoasterCarPose {
+	int32 xpos_back;  ///< X position of the back of the car, in 1/256 voxel.
+	int32 ypos_back;  ///< Y position of the back of the car, in 1/256 voxel.
+	int32 zpos_back;  ///< Z position of the back of the car, in 1/256 voxel.
+	int32 xpos_front; ///< X position of the front of the car, in 1/256 voxel.
+	int32 ypos_front; ///< Y position of the front of the car, in 1/256 voxel.
+	int32 zpos_front; ///< Z position of the front of the car, in 1/256 voxel.
+	uint8 pitch;      ///< Pitch of the car.
+	uint8 roll;       ///< Roll of the car.
+	uint8 yaw;        ///< Yaw of the car.
+	double gravity;   ///< Decrease of speed caused by gravity.
+};
+
+/** View of the positioned track pieces of a coaster, for moving cars over the track. */
+struct CoasterTrack {
+	const PositionedTrackPiece *pieces; ///< Positioned track pieces in driving order.
+	const uint16 *piece_index;          ///< Index from track position to track piece, see CoasterInstance::piece_index.
+	uint32 index_size;                  ///< Number of entries in #piece_index.
+	uint32 length;                      ///< Total length of the track (in 1/256 pixels).
+
+	uint32 Move(uint32 pos, int32 speed, int delay) const;
+	const PositionedTrackPiece *GetPieceAt(uint32 pos) const;
+	CoasterCarPose GetCarPose(uint32 *pos, uint32 car_length, const PositionedTrackPiece **piece) const;
+};
+
+int32 GetTrackControlledSpeed(int32 speed, bool has_platform, bool has_power, int delay);
+
 /**
  * Displayed car in a train.
  * Note that #yaw decides validness of the data.
+ * The car is not linked into the voxel object list of its voxel, the #SpriteCollector reads it from the trains of the coaster.
  */
 class DisplayCoasterCar : public VoxelObject {
 public:
@@ -115,7 +163,6 @@ public:
 	VoxelObject::Overlays GetOverlays(ViewOrientation orient, int zoom) const override;
 
 	void Set(const XYZPoint16 &vox_pos, const XYZPoint16 &pix_pos, uint8 pitch, uint8 roll, uint8 yaw);
-	void PreRemove();
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
@@ -197,9 +244,26 @@ struct CoasterIntensityStatistics {
 	int32 speed;         ///< Average speed of trains passing through here.
 	int32 vertical_g;    ///< Average vertical G force of trains passing through here.
 	int32 horizontal_g;  ///< Average horizontal G force of trains passing through here.
+
+	void AddSample(bool valid, int32 speed, int32 vg, int32 hg);
+	void Merge(const CoasterIntensityStatistics &other);
 };
 static const int COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION = 0x8000;  ///< Minimum distance of two points in a coaster's intensity statistics map.
 
+/** Running sums over the valid intensity statistics of a coaster, from which its ratings are computed. */
+struct CoasterRatingSums {
+	CoasterRatingSums();
+
+	void Clear();
+	void Add(const CoasterIntensityStatistics &stats);
+	void Remove(const CoasterIntensityStatistics &stats);
+
+	uint64 excitement; ///< Sum of the excitement of the valid data points.
+	uint64 intensity;  ///< Sum of the intensity of the valid data points.
+	uint64 nausea;     ///< Sum of the nausea of the valid data points.
+	uint32 points;     ///< Number of valid data points.
+};
+
 /**
  * A roller coaster in the world.
  * Since roller coaster rides need to be constructed by the user first, an instance can exist
@@ -208,6 +272,7 @@ static const int COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION = 0x8000;  ///<
 class CoasterInstance : public RideInstance {
 public:
 	CoasterInstance(const CoasterType *rt, const CarType *car_type);
+	~CoasterInstance();
 
 	bool IsAccessible();
 
@@ -244,15 +309,23 @@ public:
 	bool MakePositionedPiecesLooping(bool *modified);
 	int GetFirstPlacedTrackPiece() const;
 	int AddPositionedPiece(const PositionedTrackPiece &placed);
+	int GetPlacedPieceIndex(const XYZPoint16 &base_voxel) const;
 	void RemovePositionedPiece(PositionedTrackPiece &piece);
 
 	int FindSuccessorPiece(const XYZPoint16 &vox, uint8 entry_connect, int start = 0, int end = MAX_PLACED_TRACK_PIECES);
 	int FindSuccessorPiece(const PositionedTrackPiece &placed);
 	int FindPredecessorPiece(const PositionedTrackPiece &placed);
+	void AddConnections(int index);
+	void RemoveConnections(int index);
+	void RebuildConnections();
+	void SwapPositionedPieces(int a, int b);
 	void UpdateStations();
 	void InitializeStation(CoasterStation&) const;
 	bool IsInStation(uint32 pos, const CoasterStation&) const;
 	uint32 PositionRelativeTo(uint32 pos, uint32 offset) const;
+	const PositionedTrackPiece *GetPieceAt(uint32 pos) const;
+	CoasterTrack GetTrack() const;
+	void UpdatePieceIndex(int count);
 	bool CanPlaceEntranceOrExit(const XYZPoint16 &pos, bool entrance, const CoasterStation *station) const;
 	bool PlaceEntranceOrExit(const XYZPoint16 &pos, bool entrance, CoasterStation *station);
 	bool NeedsEntrance() const;
@@ -270,6 +343,7 @@ public:
 	uint32 GetShortestStation() const;
 	uint32 GetTrainLength(int cars_per_train) const;
 	uint32 GetTrainSpacing() const;
+	CoasterTrain *GetTrainAhead(const CoasterTrain *train);
 	int GetMaxNumberOfTrains(int cars_per_train) const;
 	int GetMaxNumberOfCars() const;
 	void SetNumberOfTrains(int number_trains);
@@ -277,9 +351,15 @@ public:
 	void ReinitializeTrains(bool test_mode);
 	void Crash(CoasterTrain *t1, CoasterTrain *t2);
 	void SampleStatistics(uint32 point, bool valid, int32 speed, int32 vg, int32 hg);
+	void ClearStatistics();
+	uint64 GetSceneryBonus();
+	void StartSimulation();
+	void FinishSimulation();
+	void CancelSimulation();
 
 	void Load(Loader &ldr) override;
 	void Save(Saver &svr) override;
+	void AddMemoryUsage(MemoryReport &report) const override;
 	void SaveDesign(const std::string &file, const std::string &design_name) const;
 
 	void RemoveStationsFromWorld();
@@ -292,16 +372,27 @@ public:
 	std::unique_ptr<PositionedTrackPiece[]> pieces; ///< Positioned track pieces.
 	int capacity;                 ///< Number of entries in the #pieces.
 	uint32 coaster_length;        ///< Total length of the roller coaster track (in 1/256 pixels).
+	std::vector<uint16> piece_index; ///< For every (1 << #PIECE_INDEX_SHIFT) track length, the index of the piece containing its start. Empty if not available.
+	std::unordered_multimap<uint64, int> entry_connections; ///< Placed pieces by base voxel and entry connection, see #TrackConnectionKey.
+	std::unordered_multimap<uint64, int> exit_connections;  ///< Placed pieces by end voxel and exit connection, see #TrackConnectionKey.
 	int number_of_trains;         ///< Current number of trains.
 	int cars_per_train;           ///< Current number of cars in each train.
 	CoasterTrain trains[4];       ///< Trains at the roller coaster (with an arbitrary max size). A train without cars means the train is not used.
+	uint8 train_order[lengthof(trains)]; ///< Indices of the #trains ordered by back position, trains without cars at the end.
 	const CarType *car_type;      ///< Type of cars running at the coaster.
+	const uint32 train_spacing;   ///< Minimal distance between two trains in pixels, see #GetTrainSpacing.
 	std::vector<CoasterStation> stations;  ///< All stations of this coaster.
 	XYZPoint16 temp_entrance_pos;          ///< Temporary location of one of the ride's entrance while the user is moving the entrance.
 	XYZPoint16 temp_exit_pos;              ///< Temporary location of one of the ride's exit while the user is moving the exit.
 	int max_idle_duration;                 ///< Maximum duration how long a train may wait in a station in milliseconds.
 	int min_idle_duration;                 ///< Minimum duration how long a train may wait in a station in milliseconds.
-	std::map<uint32, CoasterIntensityStatistics> intensity_statistics;  ///< Intensity along the track.
+	std::vector<CoasterIntensityStatistics> intensity_statistics;  ///< Intensity along the track, by sampling point. Points with zero precision have no data.
+	CoasterRatingSums rating_sums;     ///< Sums over the #intensity_statistics.
+	uint64 scenery_bonus;              ///< Excitement bonus for the surroundings of the track.
+	uint32 scenery_bonus_generation;   ///< Value of #_voxel_generation when #scenery_bonus was computed.
+	bool scenery_bonus_valid;          ///< Whether #scenery_bonus has been computed.
+	std::future<std::vector<CoasterIntensityStatistics>> simulation; ///< Test run of the coaster on another thread, if any.
+	std::shared_ptr<std::atomic<bool>> simulation_cancelled;         ///< Flag to stop the test run in #simulation early, shared with its thread.
 };
 
 void LoadCoasterPlatform(RcdFileReader *rcd_file);
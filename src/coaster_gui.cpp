@@ -15,6 +15,7 @@
 #include "ride_type.h"
 #include "coaster.h"
 #include "viewport.h"
+#include "command.h"
 #include "map.h"
 #include "gui_sprites.h"
 #include "entity_gui.h"
@@ -28,29 +29,37 @@ public:
 
 	void OnClick(WidgetNumber number, const Point16 &pos) override;
 	void SetWidgetStringParameters(WidgetNumber wid_num) const override;
+	bool IsStale() const override;
 
 private:
-	CoasterInstance *ci; ///< Roller coaster instance to remove.
+	CoasterInstance *ci;     ///< Roller coaster instance to remove.
+	uint16 ride_generation;  ///< Generation of the ride number when the window was opened, see #IsStale.
 };
 
 /**
  * Constructor of the roller coaster remove window.
  * @param ci Roller coaster instance to remove.
  */
-CoasterRemoveWindow::CoasterRemoveWindow(CoasterInstance *instance) : EntityRemoveWindow(WC_COASTER_REMOVE, instance->GetIndex()), ci(instance)
+CoasterRemoveWindow::CoasterRemoveWindow(CoasterInstance *instance) : EntityRemoveWindow(WC_COASTER_REMOVE, instance->GetIndex()), ci(instance),
+		ride_generation(_rides_manager.GetGeneration(instance->GetIndex()))
 {
 }
 
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool CoasterRemoveWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 void CoasterRemoveWindow::OnClick(WidgetNumber number, [[maybe_unused]] const Point16 &pos)
 {
 	if (number == ERW_YES) {
-		const Money cost = this->ci->ComputeReturnCost();
-		_finances_manager.PayRideConstruct(cost);
-		_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->ci->RepresentativeLocation());
-
 		delete GetWindowByType(WC_COASTER_MANAGER, this->ci->GetIndex());
 
-		_rides_manager.DeleteInstance(this->ci->GetIndex());
+		DoCommand(GCMD_REMOVE_RIDE, {this->ci->GetIndex()});
 	}
 	delete this;
 }
@@ -256,6 +265,7 @@ public:
 	void OnChange(ChangeCode code, uint32 parameter) override;
 	void SelectorMouseMoveEvent(Viewport *vp, const Point16 &pos) override;
 	void SelectorMouseButtonEvent(MouseButtons state) override;
+	bool IsStale() const override;
 
 	void SetGraphMode(GraphMode mode);
 	void SetCoasterState();
@@ -264,6 +274,7 @@ public:
 
 private:
 	CoasterInstance *ci;             ///< Roller coaster instance to display and control.
+	uint16 ride_generation;          ///< Generation of the ride number when the window was opened, see #IsStale.
 
 	void ChooseEntranceExitClicked(bool entrance);
 	RideMouseMode entrance_exit_placement;
@@ -275,7 +286,8 @@ private:
  * Constructor of the roller coaster instance window.
  * @param ci Roller coaster instance to display and control.
  */
-CoasterInstanceWindow::CoasterInstanceWindow(CoasterInstance *instance) : GuiWindow(WC_COASTER_MANAGER, instance->GetIndex()), ci(instance)
+CoasterInstanceWindow::CoasterInstanceWindow(CoasterInstance *instance) : GuiWindow(WC_COASTER_MANAGER, instance->GetIndex()), ci(instance),
+		ride_generation(_rides_manager.GetGeneration(instance->GetIndex()))
 {
 	this->SetupWidgetTree(_coaster_instance_gui_parts, lengthof(_coaster_instance_gui_parts));
 	this->SetCoasterState();
@@ -286,7 +298,7 @@ CoasterInstanceWindow::CoasterInstanceWindow(CoasterInstance *instance) : GuiWin
 	txt->SetText(this->ci->name);
 	txt->text_changed = [this, txt]()
 	{
-		this->ci->name = txt->GetText();
+		DoCommand(GCMD_SET_RIDE_NAME, {this->ci->GetIndex()}, XYZPoint16::invalid(), txt->GetText());
 	};
 
 	/* When opening the window of a newly built ride immediately prompt the user to place the entrance or exit. */
@@ -300,8 +312,9 @@ CoasterInstanceWindow::CoasterInstanceWindow(CoasterInstance *instance) : GuiWin
 CoasterInstanceWindow::~CoasterInstanceWindow()
 {
 	SetSelector(nullptr);
+	if (this->IsStale()) return;  // The coaster is gone already.
 	if (!GetWindowByType(WC_COASTER_BUILD, this->wnumber) && !this->ci->IsAccessible()) {
-		_rides_manager.DeleteInstance(this->ci->GetIndex());
+		DoCommand(GCMD_ABANDON_COASTER, {this->ci->GetIndex()});
 	}
 }
 
@@ -346,18 +359,20 @@ void CoasterInstanceWindow::DrawWidget(const WidgetNumber wid_num, const BaseWid
 	bool has_valid_datapoint = false;
 	std::set<Point32> datapoints;
 	int32 ymax = 1, ymin = 0;
-	for (const auto &pair : this->ci->intensity_statistics) {
+	for (uint32 point = 0; point < this->ci->intensity_statistics.size(); point++) {
+		const CoasterIntensityStatistics &stats = this->ci->intensity_statistics[point];
+		if (stats.precision == 0) continue;
 		int32 y;
 		switch (this->graph_mode) {
-			case GM_SPEED:  y = pair.second.speed;        break;
-			case GM_VERT_G: y = pair.second.vertical_g;   break;
-			case GM_HORZ_G: y = pair.second.horizontal_g; break;
+			case GM_SPEED:  y = stats.speed;        break;
+			case GM_VERT_G: y = stats.vertical_g;   break;
+			case GM_HORZ_G: y = stats.horizontal_g; break;
 			default: NOT_REACHED();
 		}
 		ymax = std::max(y, ymax);
 		ymin = std::min(y, ymin);
-		datapoints.insert(Point32((pos.width - GRAPH_LABELS_WIDTH) * pair.first * COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION / this->ci->coaster_length, y));
-		has_valid_datapoint |= pair.second.valid;
+		datapoints.insert(Point32((pos.width - GRAPH_LABELS_WIDTH) * point * COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION / this->ci->coaster_length, y));
+		has_valid_datapoint |= stats.valid;
 	}
 
 	if (!has_valid_datapoint) {
@@ -477,7 +492,7 @@ void CoasterInstanceWindow::OnClick(WidgetNumber widget, [[maybe_unused]] const
 			break;
 
 		case CIW_EDIT:
-			this->ci->CloseRide();
+			DoCommand(GCMD_SET_RIDE_STATE, {this->ci->GetIndex(), RIS_CLOSED});
 			ShowCoasterBuildGui(this->ci);
 			delete this;  // The user must not change ride settings while the coaster is under construction.
 			break;
@@ -488,58 +503,58 @@ void CoasterInstanceWindow::OnClick(WidgetNumber widget, [[maybe_unused]] const
 			break;
 
 		case CIW_MAINTENANCE_INCREASE:
-			this->ci->maintenance_interval += MAINTENANCE_INTERVAL_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_MAINTENANCE_INTERVAL, this->ci->maintenance_interval + MAINTENANCE_INTERVAL_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 		case CIW_MAINTENANCE_DECREASE:
-			this->ci->maintenance_interval -= MAINTENANCE_INTERVAL_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_MAINTENANCE_INTERVAL, this->ci->maintenance_interval - MAINTENANCE_INTERVAL_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 		case CIW_ENTRANCE_FEE_INCREASE:
-			this->ci->item_price[0] += RIDE_ENTRANCE_FEE_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_ENTRANCE_FEE, this->ci->item_price[0] + RIDE_ENTRANCE_FEE_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 		case CIW_ENTRANCE_FEE_DECREASE:
-			this->ci->item_price[0] = std::max<int>(0, this->ci->item_price[0] - RIDE_ENTRANCE_FEE_STEP_SIZE);
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_ENTRANCE_FEE, std::max<int>(0, this->ci->item_price[0] - RIDE_ENTRANCE_FEE_STEP_SIZE)});
 			this->SetCoasterState();
 			break;
 		case CIW_MAX_IDLE_INCREASE:
-			this->ci->max_idle_duration += IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_MAX_IDLE_DURATION, this->ci->max_idle_duration + IDLE_DURATION_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 		case CIW_MAX_IDLE_DECREASE:
-			this->ci->max_idle_duration -= IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_MAX_IDLE_DURATION, this->ci->max_idle_duration - IDLE_DURATION_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 		case CIW_MIN_IDLE_INCREASE:
-			this->ci->min_idle_duration += IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_MIN_IDLE_DURATION, this->ci->min_idle_duration + IDLE_DURATION_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 		case CIW_MIN_IDLE_DECREASE:
-			this->ci->min_idle_duration -= IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_MIN_IDLE_DURATION, this->ci->min_idle_duration - IDLE_DURATION_STEP_SIZE});
 			this->SetCoasterState();
 			break;
 
 		case CIW_CLOSE_RIDE_PANEL:
 		case CIW_CLOSE_RIDE_LIGHT:
-			this->ci->CloseRide();
+			DoCommand(GCMD_SET_RIDE_STATE, {this->ci->GetIndex(), RIS_CLOSED});
 			this->SetCoasterState();
 			break;
 		case CIW_TEST_RIDE_PANEL:
 		case CIW_TEST_RIDE_LIGHT:
-			this->ci->TestRide();
+			DoCommand(GCMD_SET_RIDE_STATE, {this->ci->GetIndex(), RIS_TESTING});
 			this->SetCoasterState();
 			break;
 		case CIW_OPEN_RIDE_PANEL:
 		case CIW_OPEN_RIDE_LIGHT:
-			if (this->ci->CanOpenRide()) this->ci->OpenRide();
+			if (this->ci->CanOpenRide()) DoCommand(GCMD_SET_RIDE_STATE, {this->ci->GetIndex(), RIS_OPEN});
 			this->SetCoasterState();
 			break;
 
 		case CIW_ENTRANCE_RECOLOUR1:
 		case CIW_ENTRANCE_RECOLOUR2:
 		case CIW_ENTRANCE_RECOLOUR3: {
-			RecolourEntry *re = &this->ci->entrance_recolours.entries[widget - CIW_ENTRANCE_RECOLOUR1];
+			const RecolourEntry *re = &this->ci->entrance_recolours.entries[widget - CIW_ENTRANCE_RECOLOUR1];
 			if (re->IsValid()) {
 				this->ShowRecolourDropdown(widget, re, COL_RANGE_DARK_RED);
 			}
@@ -548,7 +563,7 @@ void CoasterInstanceWindow::OnClick(WidgetNumber widget, [[maybe_unused]] const
 		case CIW_EXIT_RECOLOUR1:
 		case CIW_EXIT_RECOLOUR2:
 		case CIW_EXIT_RECOLOUR3: {
-			RecolourEntry *re = &this->ci->exit_recolours.entries[widget - CIW_EXIT_RECOLOUR1];
+			const RecolourEntry *re = &this->ci->exit_recolours.entries[widget - CIW_EXIT_RECOLOUR1];
 			if (re->IsValid()) {
 				this->ShowRecolourDropdown(widget, re, COL_RANGE_DARK_RED);
 			}
@@ -672,33 +687,53 @@ void CoasterInstanceWindow::SetRadioChecked(WidgetNumber radio, bool checked)
 void CoasterInstanceWindow::OnChange(const ChangeCode code, const uint32 parameter)
 {
 	switch (code) {
-		case CHG_DROPDOWN_RESULT:
-			switch ((parameter >> 16) & 0xFF) {
+		case CHG_DROPDOWN_RESULT: {
+			const int widget = (parameter >> 16) & 0xFF;
+			switch (widget) {
 				case CIW_CHOOSE_ENTRANCE:
-					this->ci->SetEntranceType(parameter & 0xFF);
+					DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_ENTRANCE_TYPE, parameter & 0xFF});
 					this->UpdateRecolourButtons();
 					break;
 				case CIW_CHOOSE_EXIT:
-					this->ci->SetExitType(parameter & 0xFF);
+					DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_EXIT_TYPE, parameter & 0xFF});
 					this->UpdateRecolourButtons();
 					break;
 				case CIW_NUMBER_TRAINS:
-					this->ci->SetNumberOfTrains((parameter & 0xFF) + 1 /* Counting from 1 on because there can not be 0 cars/trains. */);
+					/* Counting from 1 on because there can not be 0 cars/trains. */
+					DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_NUMBER_OF_TRAINS, (parameter & 0xFF) + 1});
 					break;
 				case CIW_NUMBER_CARS:
-					this->ci->SetNumberOfCars((parameter & 0xFF) + 1);
-					/* This also updates the positions of all trains in case the train length changed. */
-					this->ci->SetNumberOfTrains(std::min(this->ci->number_of_trains, this->ci->GetMaxNumberOfTrains(this->ci->number_of_trains)));
+					DoCommand(GCMD_SET_RIDE_SETTING, {this->ci->GetIndex(), RSET_CARS_PER_TRAIN, (parameter & 0xFF) + 1});
+					break;
+				case CIW_ENTRANCE_RECOLOUR1:
+				case CIW_ENTRANCE_RECOLOUR2:
+				case CIW_ENTRANCE_RECOLOUR3:
+					DoCommand(GCMD_SET_RIDE_COLOUR, {this->ci->GetIndex(), RCP_ENTRANCE, widget - CIW_ENTRANCE_RECOLOUR1, parameter & 0xFF});
+					break;
+				case CIW_EXIT_RECOLOUR1:
+				case CIW_EXIT_RECOLOUR2:
+				case CIW_EXIT_RECOLOUR3:
+					DoCommand(GCMD_SET_RIDE_COLOUR, {this->ci->GetIndex(), RCP_EXIT, widget - CIW_EXIT_RECOLOUR1, parameter & 0xFF});
 					break;
 				default:
 					break;
 			}
 			break;
+		}
 		default:
 			break;
 	}
 }
 
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool CoasterInstanceWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 void CoasterInstanceWindow::SelectorMouseMoveEvent(Viewport *vp, const Point16 &pos)
 {
 	const Point32 world_pos = vp->ComputeHorizontalTranslation(vp->rect.width / 2 - pos.x, vp->rect.height / 2 - pos.y);
@@ -738,7 +773,8 @@ void CoasterInstanceWindow::SelectorMouseButtonEvent(const MouseButtons state)
 	if (state != MB_LEFT) return;
 	if (entrance_exit_placement.area.width != 1 || entrance_exit_placement.area.height != 1) return;
 
-	if (this->ci->PlaceEntranceOrExit(this->is_placing_entrance ? this->ci->temp_entrance_pos : this->ci->temp_exit_pos, this->is_placing_entrance, nullptr)) {
+	if (DoCommand(this->is_placing_entrance ? GCMD_SET_RIDE_ENTRANCE : GCMD_SET_RIDE_EXIT, {this->ci->GetIndex()},
+			this->is_placing_entrance ? this->ci->temp_entrance_pos : this->ci->temp_exit_pos)) {
 		this->ci->temp_entrance_pos = XYZPoint16::invalid();
 		this->ci->temp_exit_pos = XYZPoint16::invalid();
 		SetSelector(nullptr);
@@ -771,17 +807,13 @@ void ShowCoasterManagementGui(RideInstance *coaster)
 	CoasterInstance *ci = static_cast<CoasterInstance *>(coaster);
 	assert(ci != nullptr);
 
-	if (!ci->MakePositionedPiecesLooping(nullptr)) {
+	/* Complete the construction process if necessary. */
+	if ((ci->state == RIS_BUILDING || ci->state == RIS_CLOSED) && !DoCommand(GCMD_FINISH_COASTER, {ci->GetIndex()})) {
 		assert(ci->state == RIS_BUILDING);
 		ShowCoasterBuildGui(ci);
 		return;
 	}
 
-	/* Complete the construction process if necessary. */
-	if (ci->state == RIS_BUILDING) ci->CloseRide();
-	if (ci->cars_per_train < 1) ci->SetNumberOfCars(ci->GetMaxNumberOfCars());
-	if (ci->number_of_trains < 1) ci->SetNumberOfTrains(ci->GetMaxNumberOfTrains(ci->cars_per_train));
-
 	Window *w = HighlightWindowByType(WC_COASTER_MANAGER, coaster->GetIndex());
 	if (w != nullptr) {
 		static_cast<CoasterInstanceWindow*>(w)->SetCoasterState();
@@ -991,10 +1023,12 @@ public:
 
 	void SelectorMouseMoveEvent(Viewport *vp, const Point16 &pos) override;
 	void SelectorMouseButtonEvent(MouseButtons state) override;
+	bool IsStale() const override;
 
 private:
-	CoasterInstance *ci; ///< Roller coaster instance to build or edit.
-	int16 design;        ///< Saved track design index (may be \c -1).
+	CoasterInstance *ci;     ///< Roller coaster instance to build or edit.
+	uint16 ride_generation;  ///< Generation of the ride number when the window was opened, see #IsStale.
+	int16 design;            ///< Saved track design index (may be \c -1).
 
 	PositionedTrackPiece *cur_piece;     ///< Current track piece, if available (else \c nullptr).
 	bool cur_after;                      ///< Position relative to #cur_piece, \c false means before, \c true means after.
@@ -1024,7 +1058,7 @@ private:
  */
 CoasterBuildWindow::CoasterBuildWindow(CoasterInstance *instance, int16 design)
 :
-	GuiWindow(WC_COASTER_BUILD, instance->GetIndex()), ci(instance),
+	GuiWindow(WC_COASTER_BUILD, instance->GetIndex()), ci(instance), ride_generation(_rides_manager.GetGeneration(instance->GetIndex())),
 	design(design >= static_cast<int>(ci->GetCoasterType()->designs.size()) ? -1 : design), piece_selector(instance)
 {
 	this->SetupWidgetTree(_coaster_construction_gui_parts, lengthof(_coaster_construction_gui_parts));
@@ -1053,9 +1087,10 @@ CoasterBuildWindow::CoasterBuildWindow(CoasterInstance *instance, int16 design)
 CoasterBuildWindow::~CoasterBuildWindow()
 {
 	this->SetSelector(nullptr);
+	if (this->IsStale()) return;  // The coaster is gone already.
 
 	if (!GetWindowByType(WC_COASTER_MANAGER, this->wnumber) && !this->ci->IsAccessible()) {
-		_rides_manager.DeleteInstance(this->ci->GetIndex());
+		DoCommand(GCMD_ABANDON_COASTER, {this->ci->GetIndex()});
 	} else {
 		ShowCoasterManagementGui(this->ci);
 	}
@@ -1081,6 +1116,15 @@ void CoasterBuildWindow::OnChange(ChangeCode code, [[maybe_unused]] uint32 param
 	}
 }
 
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool CoasterBuildWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 void CoasterBuildWindow::OnClick(WidgetNumber widget, [[maybe_unused]] const Point16 &pos)
 {
 	switch (widget) {
@@ -1121,12 +1165,8 @@ void CoasterBuildWindow::OnClick(WidgetNumber widget, [[maybe_unused]] const Poi
 			break;
 		}
 		case CCW_REMOVE: {
-			const Money cost = this->cur_piece->return_cost;
-			_finances_manager.PayRideConstruct(cost);
-			_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->cur_piece->base_voxel);
-
 			int pred_index = this->ci->FindPredecessorPiece(*this->cur_piece);
-			this->ci->RemovePositionedPiece(*this->cur_piece);
+			if (!DoCommand(GCMD_REMOVE_TRACK_PIECE, {this->ci->GetIndex()}, this->cur_piece->base_voxel)) break;
 
 			this->cur_piece = pred_index == -1 ? nullptr : &this->ci->pieces[pred_index];
 			this->UpdateSelectedPiece();
@@ -1267,25 +1307,8 @@ void CoasterBuildWindow::SetupSelection()
 	if (this->design >= 0) {
 		/* Copy all track voxels of the saved design into a single pseudo-trackpiece. */
 		const CoasterType *ct = this->ci->GetCoasterType();
-		const TrackedRideDesign &trd = ct->designs.at(this->design);
-		assert(!trd.pieces.empty());
-
-		this->design_preview_piece.reset(new TrackPiece);
-		this->design_preview_piece->entry_connect = (ct->pieces.at(ct->GetPieceIndex(trd.pieces.at(0).piece_name))->entry_connect + this->build_direction) % 4;
-
-		XYZPoint16 relative_pos(0, 0, 0);
-		for (const TrackedRideDesign::AbstractTrackPiece &abstract_piece : trd.pieces) {
-			int piece_id = ct->GetRotatedPieceIndex(ct->pieces.at(ct->GetPieceIndex(abstract_piece.piece_name)), this->build_direction);
-			assert(piece_id >= 0);
-			ConstTrackPiecePtr piece = ct->pieces.at(piece_id);
-			for (const auto &track_voxel : piece->track_voxels) {
-				TrackVoxel *tv = new TrackVoxel(*track_voxel);
-				tv->dxyz += relative_pos;
-				this->design_preview_piece->track_voxels.emplace_back(tv);
-			}
-			this->design_preview_piece->cost += piece->cost;
-			relative_pos += piece->exit_dxyz;
-		}
+		this->design_preview_piece = ct->MakeDesignPiece(ct->designs.at(this->design), this->build_direction);
+		assert(this->design_preview_piece != nullptr);
 
 		this->sel_piece = this->design_preview_piece;
 		directions = EDGE_ALL;
@@ -1464,41 +1487,20 @@ void CoasterBuildWindow::BuildTrackPiece()
 	if (this->selector == nullptr || this->piece_selector.pos_piece.piece == nullptr) return; // No active selector.
 	if (this->sel_piece == nullptr) return; // No piece.
 
-	/* Are we allowed to build here? */
-	StringID err = this->piece_selector.pos_piece.CanBePlaced();
-	if (err != STR_NULL) {
-		BestErrorMessageReason::ShowActionErrorMessage(BestErrorMessageReason::ACT_BUILD, err);
-		return;
-	}
-	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, this->piece_selector.pos_piece.piece->cost)) return;
-
-	/* Add the piece to the coaster instance. */
-	int ptp_index = -1;
+	const CoasterType *ct = this->ci->GetCoasterType();
+	XYZPoint16 last_pos = this->piece_selector.pos_piece.base_voxel; // Base voxel of the last added piece.
 	if (this->design < 0) {
-		ptp_index = this->ci->AddPositionedPiece(this->piece_selector.pos_piece);
+		if (!DoCommand(GCMD_BUILD_TRACK_PIECE, {this->ci->GetIndex(), ct->GetPieceIndex(this->piece_selector.pos_piece.piece), -1, EDGE_COUNT}, last_pos)) return;
 	} else {
-		const CoasterType *ct = this->ci->GetCoasterType();
-		const TrackedRideDesign &trd = ct->designs.at(this->design);
-
-		XYZPoint16 pos = this->piece_selector.pos_piece.base_voxel;
-		for (const TrackedRideDesign::AbstractTrackPiece &abstract_piece : trd.pieces) {
-			int piece_id = ct->GetRotatedPieceIndex(ct->pieces.at(ct->GetPieceIndex(abstract_piece.piece_name)), this->build_direction);
-			assert(piece_id >= 0);
-			ConstTrackPiecePtr piece = ct->pieces.at(piece_id);
-			ptp_index = this->ci->AddPositionedPiece(PositionedTrackPiece(pos, piece));
-			assert(ptp_index >= 0);  // We already checked that placing this design is permitted.
-			pos += piece->exit_dxyz;
-		}
-	}
-
-	assert(ptp_index >= 0);  // We already checked that placing this design is permitted.
+		if (!DoCommand(GCMD_BUILD_TRACK_PIECE, {this->ci->GetIndex(), -1, this->design, this->build_direction}, last_pos)) return;
 
-	this->ci->PlaceTrackPieceInWorld(this->piece_selector.pos_piece); // Add the piece to the world.
-
-	_finances_manager.PayRideConstruct(this->piece_selector.pos_piece.piece->cost);
-	_window_manager.GetViewport()->AddFloatawayMoneyAmount(this->piece_selector.pos_piece.piece->cost, this->piece_selector.pos_piece.base_voxel);
+		const std::vector<ConstTrackPiecePtr> pieces = ct->GetDesignPieces(ct->designs.at(this->design), this->build_direction);
+		for (size_t i = 0; i + 1 < pieces.size(); i++) last_pos += pieces[i]->exit_dxyz;
+	}
 
 	/* Piece was added, change the setup for the next piece. */
+	const int ptp_index = this->ci->GetPlacedPieceIndex(last_pos);
+	assert(ptp_index >= 0);
 	this->cur_piece = &this->ci->pieces[ptp_index];
 
 	this->design_preview_piece.reset();
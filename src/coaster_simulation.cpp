@@ -0,0 +1,80 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file coaster_simulation.cpp Test runs of roller coasters outside the world. */
+
+#include "stdafx.h"
+#include "coaster_simulation.h"
+
+static const int SIMULATION_STEP = 30;              ///< Simulated milliseconds per step, the same as a frame of the game as the train physics depend on it.
+static const uint32 MAX_SIMULATION_TIME = 1800000;  ///< Maximum simulated time in milliseconds, for trains that never return to a station.
+
+/**
+ * Copy the track and train configuration of a coaster.
+ * @param ci Coaster to test, should have a complete track.
+ */
+CoasterSimulation::CoasterSimulation(const CoasterInstance &ci) :
+	piece_index(ci.piece_index),
+	length(ci.coaster_length),
+	car_length(ci.car_type->car_length),
+	inter_car_length(ci.car_type->inter_car_length),
+	cars(ci.cars_per_train)
+{
+	for (int i = 0; i < ci.capacity && ci.pieces[i].piece != nullptr; i++) this->pieces.push_back(ci.pieces[i]);
+}
+
+/**
+ * Drive a train from the first track piece until it arrives at a station, like a train of a coaster being tested.
+ * @param cancelled Flag that is set when the results are no longer needed.
+ * @return Intensity statistics measured along the track, indexed by sampling point. Empty if the run was cancelled.
+ */
+std::vector<CoasterIntensityStatistics> CoasterSimulation::Run(const std::atomic<bool> &cancelled) const
+{
+	std::vector<CoasterIntensityStatistics> statistics;
+	if (this->pieces.empty() || this->cars <= 0 || this->length == 0) return statistics;
+	if (this->pieces.back().distance_base + this->pieces.back().piece->piece_length != this->length) return statistics; // Track is not complete.
+	statistics.resize(this->length / COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION + 1, CoasterIntensityStatistics{false, 0, 0, 0, 0});
+
+	const CoasterTrack track{this->pieces.data(), this->piece_index.data(), static_cast<uint32>(this->piece_index.size()), this->length};
+	uint32 back_position = 0;
+	int32 speed = 0;
+	bool left_station = false; // Whether the train has left the station, only then measurements are valid.
+	for (uint32 time = 0; time < MAX_SIMULATION_TIME; time += SIMULATION_STEP) {
+		if (cancelled.load(std::memory_order_relaxed)) return std::vector<CoasterIntensityStatistics>();
+		back_position = track.Move(back_position, speed, SIMULATION_STEP);
+
+		bool has_platform = false, has_power = false;
+		uint32 position = back_position;
+		const PositionedTrackPiece *ptp = track.GetPieceAt(position);
+		for (int i = 0; i < this->cars; i++) {
+			if (position >= this->length) {
+				position -= this->length;
+				ptp = track.GetPieceAt(position);
+			}
+			while (ptp->distance_base + ptp->piece->piece_length < position) ptp++;
+			has_platform |= ptp->piece->HasPlatform();
+			has_power |= ptp->piece->HasPower();
+
+			const CoasterCarPose pose = track.GetCarPose(&position, this->car_length, &ptp);
+			speed -= pose.gravity;
+			if (i == 0) {
+				statistics[back_position / COASTER_INTENSITY_STATISTICS_SAMPLING_PRECISION].AddSample(left_station, speed,
+						pose.pitch > 8 ? static_cast<int>(pose.pitch) - 16 : pose.pitch,
+						pose.roll  > 8 ? static_cast<int>(pose.roll)  - 16 : pose.roll);
+			}
+			position += this->inter_car_length;
+		}
+		speed = GetTrackControlledSpeed(speed, has_platform, has_power, SIMULATION_STEP);
+
+		if (!has_platform) {
+			left_station = true;
+		} else if (left_station) {
+			break; // Back in a station, the circuit is complete.
+		}
+	}
+	return statistics;
+}
@@ -0,0 +1,35 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file coaster_simulation.h Test runs of roller coasters outside the world. */
+
+#ifndef COASTER_SIMULATION_H
+#define COASTER_SIMULATION_H
+
+#include <atomic>
+#include <vector>
+#include "coaster.h"
+
+/**
+ * Test run of a roller coaster, driving one train over a copy of its track.
+ * The simulation does not use the world or other global state, so it can run on another thread.
+ */
+class CoasterSimulation {
+public:
+	explicit CoasterSimulation(const CoasterInstance &ci);
+
+	std::vector<CoasterIntensityStatistics> Run(const std::atomic<bool> &cancelled) const;
+
+	std::vector<PositionedTrackPiece> pieces; ///< Copy of the positioned track pieces, in driving order.
+	std::vector<uint16> piece_index;          ///< Copy of the index from track position to track piece.
+	uint32 length;                            ///< Total length of the track (in 1/256 pixels).
+	uint32 car_length;                        ///< Length of a car (in 1/256 pixels).
+	uint32 inter_car_length;                  ///< Length between two cars (in 1/256 pixels).
+	int cars;                                 ///< Number of cars in the train.
+};
+
+#endif
@@ -0,0 +1,846 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file command.cpp Actions of the player that change the game. */
+
+#include "stdafx.h"
+#include "command.h"
+#include "replay.h"
+#include "map.h"
+#include "viewport.h"
+#include "terraform.h"
+#include "path_build.h"
+#include "fence.h"
+#include "scenery.h"
+#include "finances.h"
+#include "gamecontrol.h"
+#include "gamelevel.h"
+#include "gameobserver.h"
+#include "fixed_ride_type.h"
+#include "gentle_thrill_ride_type.h"
+#include "coaster.h"
+#include "people.h"
+#include "window.h"
+
+/**
+ * Perform an action of the player that changes the game. All such actions should go through here,
+ * so they can be recorded for replaying the game.
+ * @param type Type of the command.
+ * @param args Arguments of the command, see #GameCommandType.
+ * @param pos Voxel the command applies to, if any.
+ * @param text Text argument of the command, if any.
+ * @return Whether the command succeeded.
+ * @note In #GameControl::action_test_mode, commands only show their cost and are not recorded.
+ */
+bool DoCommand(GameCommandType type, std::initializer_list<int64> args, const XYZPoint16 &pos, const std::string &text)
+{
+	assert(args.size() <= GAME_COMMAND_ARG_COUNT);
+	GameCommand cmd;
+	cmd.type = type;
+	cmd.pos = pos;
+	std::fill_n(cmd.args, GAME_COMMAND_ARG_COUNT, 0);
+	std::copy(args.begin(), args.end(), cmd.args);
+	cmd.text = text;
+
+	const bool result = ExecuteCommand(cmd);
+	if (!_game_control.action_test_mode) _replay_recorder.RecordCommand(cmd, result);
+	return result;
+}
+
+/**
+ * Check that the position of a command is inside the world.
+ * @param pos Position to check.
+ * @return Whether the position is valid.
+ */
+static bool IsValidCommandPosition(const XYZPoint16 &pos)
+{
+	return IsVoxelstackInsideWorld(pos.x, pos.y) && pos.z >= 0 && pos.z < WORLD_Z_SIZE;
+}
+
+/**
+ * Find the ride a command applies to.
+ * @param number Ride number from the command.
+ * @return The ride, or \c nullptr if there is no ride with this number.
+ */
+static RideInstance *GetCommandRide(int64 number)
+{
+	if (number < SRI_FULL_RIDES || number >= SRI_LAST) return nullptr;
+	RideInstance *ri = _rides_manager.GetRideInstance(number);
+	if (ri == nullptr || ri->state == RIS_ALLOCATED) return nullptr;
+	return ri;
+}
+
+/**
+ * Build or remove a fence at the ground.
+ * @param pos Ground voxel of the fence.
+ * @param edge Edge of the fence.
+ * @param fence_type Type of fence to build, #FENCE_TYPE_INVALID to remove the fence.
+ * @return Whether the command succeeded.
+ */
+static bool BuildFence(const XYZPoint16 &pos, int64 edge, int64 fence_type)
+{
+	if (edge < EDGE_BEGIN || edge >= EDGE_COUNT) return false;
+	if (_game_mode_mgr.InPlayMode() && _world.GetTileOwner(pos.x, pos.y) != OWN_PARK) return false;
+
+	VoxelStack *vs = _world.GetModifyStack(pos.x, pos.y);
+	uint16 fences = GetGroundFencesFromMap(vs, pos.z);
+
+	Money cost;
+	if (fence_type == FENCE_TYPE_INVALID) {
+		const FenceType f = GetFenceType(fences, static_cast<TileEdge>(edge));
+		if (f < FENCE_TYPE_BUILDABLE_BEGIN || f >= FENCE_TYPE_COUNT) return false;
+
+		cost = GetFenceCostRemove(f);
+		if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_REMOVE, cost)) return false;
+	} else {
+		if (fence_type < FENCE_TYPE_BUILDABLE_BEGIN || fence_type >= FENCE_TYPE_COUNT) return false;
+
+		cost = GetFenceCostBuild(static_cast<FenceType>(fence_type));
+		if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, cost)) return false;
+	}
+	fences = SetFenceType(fences, static_cast<TileEdge>(edge), static_cast<FenceType>(fence_type));
+
+	if (_game_control.action_test_mode) {
+		ShowCostOrReturnEstimate(cost);
+		return true;
+	}
+	_finances_manager.PayLandscaping(cost);
+	AddFloatawayMoneyAmount(cost, pos);
+
+	AddGroundFencesToMap(fences, vs, pos.z);
+	return true;
+}
+
+/**
+ * Place a scenery item.
+ * @param pos Base voxel of the item.
+ * @param type_index Index of the scenery type.
+ * @param orientation Orientation of the item.
+ * @return Whether the command succeeded.
+ */
+static bool PlaceScenery(const XYZPoint16 &pos, int64 type_index, int64 orientation)
+{
+	if (type_index < 0 || type_index > UINT16_MAX || orientation < 0 || orientation > 3) return false;
+	const SceneryType *type = _scenery.GetType(type_index);
+	if (type == nullptr) return false;
+
+	std::unique_ptr<SceneryInstance> item(new SceneryInstance(type));
+	item->orientation = orientation;
+	item->vox_pos = pos;
+	if (item->CanPlace() != STR_NULL) return false;
+
+	const Money &cost = type->buy_cost;
+	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, cost)) return false;
+	if (_game_control.action_test_mode) {
+		ShowCostOrReturnEstimate(cost);
+		return true;
+	}
+
+	_finances_manager.PayLandscaping(cost);
+	AddFloatawayMoneyAmount(cost, pos);
+	_scenery.AddItem(item.release());
+	return true;
+}
+
+/**
+ * Remove a scenery item.
+ * @param pos Base voxel of the item.
+ * @return Whether the command succeeded.
+ */
+static bool RemoveScenery(const XYZPoint16 &pos)
+{
+	const SceneryInstance *item = _scenery.GetItem(pos);
+	if (item == nullptr || item == _scenery.temp_item || item->vox_pos != pos) return false;
+
+	if (item->type->category == SCC_SCENARIO && _game_mode_mgr.InPlayMode()) {
+		BestErrorMessageReason::ShowActionErrorMessage(BestErrorMessageReason::ACT_REMOVE, GUI_ERROR_MESSAGE_UNREMOVABLE);
+		return false;
+	}
+
+	const Money &cost = item->IsDry() ? item->type->return_cost_dry : item->type->return_cost;
+	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_REMOVE, cost)) return false;
+	if (_game_control.action_test_mode) {
+		ShowCostOrReturnEstimate(cost);
+		return true;
+	}
+
+	_finances_manager.PayLandscaping(cost);
+	AddFloatawayMoneyAmount(cost, pos);
+	_scenery.RemoveItem(pos);
+	return true;
+}
+
+/**
+ * Place an object (bench, litter bin, lamp) at a path.
+ * @param pos Voxel of the path.
+ * @param type_id Type of the path object.
+ * @return Whether the command succeeded.
+ */
+static bool PlacePathObject(const XYZPoint16 &pos, int64 type_id)
+{
+	/* Only these types can be bought. */
+	const PathObjectType *type;
+	if (type_id == PathObjectType::BENCH.type_id) {
+		type = &PathObjectType::BENCH;
+	} else if (type_id == PathObjectType::LITTERBIN.type_id) {
+		type = &PathObjectType::LITTERBIN;
+	} else if (type_id == PathObjectType::LAMP.type_id) {
+		type = &PathObjectType::LAMP;
+	} else {
+		return false;
+	}
+
+	if (_game_mode_mgr.InPlayMode() && _world.GetTileOwner(pos.x, pos.y) != OWN_PARK) return false;
+	const Voxel *v = _world.GetVoxel(pos);
+	if (v == nullptr || !HasValidPath(v)) return false;
+	if (!type->can_exist_on_slope && GetImplodedPathSlope(v) >= PATH_FLAT_COUNT) return false;
+
+	const Money &cost = type->buy_cost;
+	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, cost)) return false;
+	if (_game_control.action_test_mode) {
+		ShowCostOrReturnEstimate(cost);
+		return true;
+	}
+
+	_finances_manager.PayLandscaping(cost);
+	AddFloatawayMoneyAmount(cost, pos);
+	_scenery.SetPathObjectInstance(pos, type);
+	return true;
+}
+
+/**
+ * Build a shop, gentle ride, or thrill ride. The user interface allocates the ride while the player
+ * decides where to place it, when replaying a game the ride is created here.
+ * @param pos Base voxel of the ride.
+ * @param number Ride number.
+ * @param type_index Index of the ride type.
+ * @param orientation Orientation of the ride.
+ * @return Whether the command succeeded.
+ */
+static bool BuildFixedRide(const XYZPoint16 &pos, int64 number, int64 type_index, int64 orientation)
+{
+	if (number < SRI_FULL_RIDES || number >= SRI_LAST || type_index < 0 || type_index > UINT16_MAX || orientation < 0 || orientation > 3) return false;
+	const RideType *type = _rides_manager.GetRideType(type_index);
+	if (type == nullptr || (type->kind != RTK_SHOP && type->kind != RTK_GENTLE && type->kind != RTK_THRILL)) return false;
+
+	RideInstance *ri = _rides_manager.GetRideInstance(number);
+	const bool created = (ri == nullptr);
+	if (created) {
+		if (!type->CanMakeInstance()) return false;
+		ri = _rides_manager.CreateInstance(type, number);
+	} else if (ri->GetRideType() != type || ri->state != RIS_ALLOCATED) {
+		return false;
+	}
+	FixedRideInstance *fri = static_cast<FixedRideInstance *>(ri);
+
+	BestErrorMessageReason reason(BestErrorMessageReason::ACT_BUILD);
+	bool allowed = CanPlaceFixedRide(fri->GetFixedRideType(), pos, orientation, &reason);
+	Money build_cost;
+	if (allowed) {
+		fri->SetRide(orientation, pos);
+		build_cost = fri->ComputeBuildCost();
+		allowed = BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, build_cost);
+	}
+	if (!allowed) {
+		if (created) _rides_manager.DeleteInstance(number);
+		return false;
+	}
+
+	_rides_manager.NewInstanceAdded(number);
+	AddRemovePathEdges(pos, PATH_EMPTY, fri->GetEntranceDirections(pos), PAS_QUEUE_PATH);
+	_finances_manager.PayRideConstruct(build_cost);
+	AddFloatawayMoneyAmount(build_cost, pos);
+	return true;
+}
+
+/**
+ * Start building a roller coaster.
+ * @param number Ride number.
+ * @param type_index Index of the ride type.
+ * @return Whether the command succeeded.
+ */
+static bool CreateCoaster(int64 number, int64 type_index)
+{
+	if (number < SRI_FULL_RIDES || number >= SRI_LAST || type_index < 0 || type_index > UINT16_MAX) return false;
+	const RideType *type = _rides_manager.GetRideType(type_index);
+	if (type == nullptr || type->kind != RTK_COASTER || !type->CanMakeInstance()) return false;
+	if (_rides_manager.GetRideInstance(number) != nullptr) return false;
+
+	_rides_manager.CreateInstance(type, number);
+	_rides_manager.NewInstanceAdded(number);
+	return true;
+}
+
+/**
+ * Find the roller coaster whose track a command changes.
+ * @param number Ride number from the command.
+ * @return The coaster, or \c nullptr if there is no coaster with this number, or its track cannot be changed.
+ */
+static CoasterInstance *GetCommandTrackCoaster(int64 number)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr || ri->GetKind() != RTK_COASTER) return nullptr;
+	if (ri->state != RIS_BUILDING && ri->state != RIS_CLOSED) return nullptr;
+	return static_cast<CoasterInstance *>(ri);
+}
+
+/**
+ * Build a track piece, or all pieces of a saved design, of a roller coaster.
+ * @param pos Base voxel of the (first) piece.
+ * @param number Ride number.
+ * @param piece_index Index of the track piece in the coaster type, if \a design is negative.
+ * @param design Index of the design, or \c -1 to build a single piece.
+ * @param direction Direction to build the design in.
+ * @return Whether the command succeeded.
+ */
+static bool BuildTrackPiece(const XYZPoint16 &pos, int64 number, int64 piece_index, int64 design, int64 direction)
+{
+	CoasterInstance *ci = GetCommandTrackCoaster(number);
+	if (ci == nullptr) return false;
+	const CoasterType *ct = ci->GetCoasterType();
+
+	/* The pieces to add to the coaster, and the piece covering them all to add to the world. */
+	std::vector<ConstTrackPiecePtr> pieces;
+	ConstTrackPiecePtr piece;
+	if (design < 0) {
+		if (piece_index < 0 || piece_index >= static_cast<int64>(ct->pieces.size())) return false;
+		piece = ct->pieces[piece_index];
+		pieces.push_back(piece);
+	} else {
+		if (design >= static_cast<int64>(ct->designs.size()) || direction < EDGE_BEGIN || direction >= EDGE_COUNT) return false;
+		pieces = ct->GetDesignPieces(ct->designs[design], direction);
+		piece = ct->MakeDesignPiece(ct->designs[design], direction);
+		if (piece == nullptr) return false;
+	}
+
+	const PositionedTrackPiece placed(pos, piece);
+	const StringID err = placed.CanBePlaced();
+	if (err != STR_NULL) {
+		BestErrorMessageReason::ShowActionErrorMessage(BestErrorMessageReason::ACT_BUILD, err);
+		return false;
+	}
+	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, piece->cost)) return false;
+
+	/* Check that all pieces fit, so the coaster is not changed halfway. */
+	XYZPoint16 piece_pos = pos;
+	for (const ConstTrackPiecePtr &p : pieces) {
+		if (!PositionedTrackPiece(piece_pos, p).IsOnWorld()) return false;
+		piece_pos += p->exit_dxyz;
+	}
+	const size_t free_count = std::count_if(ci->pieces.get(), ci->pieces.get() + ci->capacity, [](const PositionedTrackPiece &ptp) { return ptp.piece == nullptr; });
+	if (free_count < pieces.size()) return false;
+
+	if (_game_control.action_test_mode) {
+		ShowCostOrReturnEstimate(piece->cost);
+		return true;
+	}
+
+	piece_pos = pos;
+	for (const ConstTrackPiecePtr &p : pieces) {
+		ci->AddPositionedPiece(PositionedTrackPiece(piece_pos, p));
+		piece_pos += p->exit_dxyz;
+	}
+	ci->PlaceTrackPieceInWorld(placed);
+
+	_finances_manager.PayRideConstruct(piece->cost);
+	AddFloatawayMoneyAmount(piece->cost, pos);
+	return true;
+}
+
+/**
+ * Remove a track piece of a roller coaster, and get back its return cost.
+ * @param pos Base voxel of the piece.
+ * @param number Ride number.
+ * @return Whether the command succeeded.
+ */
+static bool RemoveTrackPiece(const XYZPoint16 &pos, int64 number)
+{
+	CoasterInstance *ci = GetCommandTrackCoaster(number);
+	if (ci == nullptr) return false;
+	const int index = ci->GetPlacedPieceIndex(pos);
+	if (index < 0) return false;
+
+	PositionedTrackPiece &piece = ci->pieces[index];
+	const Money cost = piece.return_cost;
+	_finances_manager.PayRideConstruct(cost);
+	AddFloatawayMoneyAmount(cost, pos);
+
+	ci->RemovePositionedPiece(piece);
+	return true;
+}
+
+/**
+ * Finish building or changing the track of a roller coaster. The pieces are put in the order of the loop they form,
+ * and a new coaster gets its trains.
+ * @param number Ride number.
+ * @return Whether the track forms a loop.
+ */
+static bool FinishCoaster(int64 number)
+{
+	CoasterInstance *ci = GetCommandTrackCoaster(number);
+	if (ci == nullptr || !ci->MakePositionedPiecesLooping(nullptr)) return false;
+
+	if (ci->state == RIS_BUILDING) ci->CloseRide();
+	if (ci->cars_per_train < 1) ci->SetNumberOfCars(ci->GetMaxNumberOfCars());
+	if (ci->number_of_trains < 1) ci->SetNumberOfTrains(ci->GetMaxNumberOfTrains(ci->cars_per_train));
+	return true;
+}
+
+/**
+ * Delete a roller coaster that the player stopped building before it got an entrance. Its cost is not returned.
+ * @param number Ride number.
+ * @return Whether the command succeeded.
+ */
+static bool AbandonCoaster(int64 number)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr || ri->GetKind() != RTK_COASTER || static_cast<CoasterInstance *>(ri)->IsAccessible()) return false;
+
+	_rides_manager.DeleteInstance(number);
+	return true;
+}
+
+/**
+ * Place the entrance or the exit of a ride.
+ * @param pos Voxel of the entrance or exit.
+ * @param number Ride number.
+ * @param entrance Place the entrance (\c true) or the exit (\c false).
+ * @return Whether the command succeeded.
+ */
+static bool SetRideEntranceOrExit(const XYZPoint16 &pos, int64 number, bool entrance)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr) return false;
+
+	switch (ri->GetKind()) {
+		case RTK_GENTLE:
+		case RTK_THRILL: {
+			GentleThrillRideInstance *ride = static_cast<GentleThrillRideInstance *>(ri);
+			if (ride->state != RIS_CLOSED || !ride->CanPlaceEntranceOrExit(pos, entrance)) return false;
+			if (entrance) {
+				ride->SetEntrancePos(pos);
+			} else {
+				ride->SetExitPos(pos);
+			}
+			return true;
+		}
+
+		case RTK_COASTER:
+			return static_cast<CoasterInstance *>(ri)->PlaceEntranceOrExit(pos, entrance, nullptr);
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Remove a ride, and get back the return cost.
+ * @param number Ride number.
+ * @return Whether the command succeeded.
+ */
+static bool RemoveRide(int64 number)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr) return false;
+
+	const Money cost = ri->ComputeReturnCost();
+	_finances_manager.PayRideConstruct(cost);
+	AddFloatawayMoneyAmount(cost, ri->RepresentativeLocation());
+
+	_rides_manager.DeleteInstance(number);
+	return true;
+}
+
+/**
+ * Open, close, or test a ride.
+ * @param number Ride number.
+ * @param state New state of the ride, #RIS_OPEN, #RIS_CLOSED, or #RIS_TESTING (coasters only).
+ * @return Whether the command succeeded.
+ */
+static bool SetRideState(int64 number, int64 state)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr) return false;
+
+	switch (state) {
+		case RIS_OPEN:
+			if (ri->state == RIS_OPEN || !ri->CanOpenRide()) return false;
+			ri->OpenRide();
+			return true;
+
+		case RIS_CLOSED:
+			/* Coasters always close, to stop a test run. */
+			if (ri->state == RIS_CLOSED && ri->GetKind() != RTK_COASTER) return false;
+			ri->CloseRide();
+			return true;
+
+		case RIS_TESTING:
+			if (ri->GetKind() != RTK_COASTER) return false;
+			static_cast<CoasterInstance *>(ri)->TestRide();
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Change a setting of a ride.
+ * @param number Ride number.
+ * @param setting Setting to change.
+ * @param value New value of the setting.
+ * @return Whether the command succeeded.
+ */
+static bool SetRideSetting(int64 number, int64 setting, int64 value)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr || value < 0) return false;
+
+	int *min_idle = nullptr;
+	int *max_idle = nullptr;
+	switch (ri->GetKind()) {
+		case RTK_GENTLE:
+		case RTK_THRILL:
+			min_idle = &static_cast<FixedRideInstance *>(ri)->min_idle_duration;
+			max_idle = &static_cast<FixedRideInstance *>(ri)->max_idle_duration;
+			break;
+		case RTK_COASTER:
+			min_idle = &static_cast<CoasterInstance *>(ri)->min_idle_duration;
+			max_idle = &static_cast<CoasterInstance *>(ri)->max_idle_duration;
+			break;
+		default:
+			break;
+	}
+
+	switch (setting) {
+		case RSET_ENTRANCE_FEE:
+			ri->item_price[0] = value;
+			return true;
+
+		case RSET_WORKING_CYCLES:
+			if (ri->GetKind() != RTK_GENTLE && ri->GetKind() != RTK_THRILL) return false;
+			if (value > INT16_MAX) return false;
+			static_cast<FixedRideInstance *>(ri)->working_cycles = value;
+			return true;
+
+		case RSET_MIN_IDLE_DURATION:
+			if (min_idle == nullptr || value > INT_MAX) return false;
+			*min_idle = value;
+			return true;
+
+		case RSET_MAX_IDLE_DURATION:
+			if (max_idle == nullptr || value > INT_MAX) return false;
+			*max_idle = value;
+			return true;
+
+		case RSET_MAINTENANCE_INTERVAL:
+			if (value > UINT32_MAX) return false;
+			ri->maintenance_interval = value;
+			return true;
+
+		case RSET_ENTRANCE_TYPE:
+			if (ri->GetKind() == RTK_SHOP || value >= static_cast<int64>(_rides_manager.entrances.size())) return false;
+			ri->SetEntranceType(value);
+			return true;
+
+		case RSET_EXIT_TYPE:
+			if (ri->GetKind() == RTK_SHOP || value >= static_cast<int64>(_rides_manager.exits.size())) return false;
+			ri->SetExitType(value);
+			return true;
+
+		case RSET_NUMBER_OF_TRAINS: {
+			if (ri->GetKind() != RTK_COASTER || ri->state != RIS_CLOSED) return false;
+			CoasterInstance *ci = static_cast<CoasterInstance *>(ri);
+			if (value < 1 || value > ci->GetMaxNumberOfTrains(ci->cars_per_train)) return false;
+			ci->SetNumberOfTrains(value);
+			return true;
+		}
+
+		case RSET_CARS_PER_TRAIN: {
+			if (ri->GetKind() != RTK_COASTER || ri->state != RIS_CLOSED) return false;
+			CoasterInstance *ci = static_cast<CoasterInstance *>(ri);
+			if (value < 1 || value > ci->GetMaxNumberOfCars()) return false;
+			ci->SetNumberOfCars(value);
+			/* This also updates the positions of all trains in case the train length changed. */
+			ci->SetNumberOfTrains(std::min(ci->number_of_trains, ci->GetMaxNumberOfTrains(ci->cars_per_train)));
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Change a colour of a ride.
+ * @param number Ride number.
+ * @param part Part of the ride to recolour.
+ * @param index Index of the recolouring.
+ * @param colour New colour range.
+ * @return Whether the command succeeded.
+ */
+static bool SetRideColour(int64 number, int64 part, int64 index, int64 colour)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr || index < 0 || index >= MAX_RECOLOUR || colour < 0 || colour >= COL_RANGE_COUNT) return false;
+
+	Recolouring *recolours;
+	switch (part) {
+		case RCP_RIDE:     recolours = &ri->recolours;          break;
+		case RCP_ENTRANCE: recolours = &ri->entrance_recolours; break;
+		case RCP_EXIT:     recolours = &ri->exit_recolours;     break;
+		default: return false;
+	}
+	RecolourEntry &entry = recolours->entries[index];
+	if (!entry.IsValid() || GB(entry.dest_set, colour, 1) == 0) return false;
+
+	entry.dest = static_cast<ColourRange>(colour);
+	return true;
+}
+
+/**
+ * Rename a ride.
+ * @param number Ride number.
+ * @param name New name of the ride.
+ * @return Whether the command succeeded.
+ */
+static bool SetRideName(int64 number, const std::string &name)
+{
+	RideInstance *ri = GetCommandRide(number);
+	if (ri == nullptr) return false;
+
+	ri->name = name;
+	return true;
+}
+
+/**
+ * Dismiss a staff member.
+ * @param type Type of the staff member.
+ * @param id Id of the person.
+ * @return Whether the command succeeded.
+ */
+static bool DismissStaff(int64 type, int64 id)
+{
+	if (type != PERSON_MECHANIC && type != PERSON_HANDYMAN && type != PERSON_GUARD && type != PERSON_ENTERTAINER) return false;
+
+	const PersonType t = static_cast<PersonType>(type);
+	for (uint i = 0; i < _staff.Count(t); i++) {
+		StaffMember *m = _staff.Get(t, i);
+		if (m->id == id) {
+			_staff.Dismiss(m);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Take or repay a loan.
+ * @param amount Amount to take (if positive) or repay (if negative).
+ * @return Whether the command succeeded.
+ */
+static bool ChangeLoan(int64 amount)
+{
+	if (amount > 0) {
+		if (amount > _scenario.max_loan - _finances_manager.GetLoan()) return false;
+		_finances_manager.TakeLoan(amount);
+	} else {
+		if (amount == 0 || -amount > _finances_manager.GetLoan() || -amount > _finances_manager.GetCash()) return false;
+		_finances_manager.RepayLoan(-amount);
+	}
+	return true;
+}
+
+/**
+ * Change a setting of the scenario in the scenario editor.
+ * @param setting Setting to change.
+ * @param value New value of the setting.
+ * @return Whether the command succeeded.
+ */
+static bool SetScenarioSetting(int64 setting, int64 value)
+{
+	if (!_game_mode_mgr.InEditorMode()) return false;
+	switch (setting) {
+		case SSET_MAX_GUESTS:
+			if (value < 0 || value > UINT32_MAX) return false;
+			_scenario.max_guests = value;
+			return true;
+
+		case SSET_ALLOW_ENTRANCE_FEE:
+			_scenario.allow_entrance_fee = value != 0;
+			if (!_scenario.allow_entrance_fee) _game_observer.entrance_fee = 0;
+			return true;
+
+		case SSET_MAX_LOAN:
+			if (value < 0) return false;
+			_scenario.max_loan = value;
+			return true;
+
+		case SSET_INTEREST:
+			if (value < 0 || value > UINT16_MAX) return false;
+			_scenario.interest = value;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Change the objective of the scenario in the scenario editor.
+ * @param timeout Deadline of the objective, with the timeout policy in bits 32 and up.
+ * @param guests Number of guests to achieve, \c -1 for no guests objective.
+ * @param park_value Park value to achieve, \c -1 for no park value objective.
+ * @param rating Park rating to achieve, with the number of days it may be lower in bits 16 and up, \c -1 for no park rating objective.
+ * @return Whether the command succeeded.
+ */
+static bool SetObjective(int64 timeout, int64 guests, int64 park_value, int64 rating)
+{
+	if (!_game_mode_mgr.InEditorMode()) return false;
+
+	const int64 policy = timeout >> 32;
+	if (policy != TIMEOUT_NONE && policy != TIMEOUT_EXACT && policy != TIMEOUT_BEFORE) return false;
+	const int year  = (timeout >> CDB_YEAR_START)  & ((1 << CDB_YEAR_LENGTH)  - 1);
+	const int month = (timeout >> CDB_MONTH_START) & ((1 << CDB_MONTH_LENGTH) - 1);
+	const int day   = (timeout >> CDB_DAY_START)   & ((1 << CDB_DAY_LENGTH)   - 1);
+	if (month < 1 || month > 12 || day < 1 || day > _days_per_month[month]) return false;
+	if (guests < -1 || guests > UINT32_MAX || park_value < -1 || rating < -1 || rating > UINT32_MAX) return false;
+
+	std::vector<std::shared_ptr<AbstractObjective>> objectives;
+	if (guests >= 0) objectives.emplace_back(new ObjectiveGuests(0, guests));
+	if (park_value >= 0) objectives.emplace_back(new ObjectiveParkValue(0, Money(park_value)));
+	if (rating >= 0) objectives.emplace_back(new ObjectiveParkRating(rating >> 16, rating & 0xFFFF));
+	if (objectives.empty()) objectives.emplace_back(new ObjectiveNone);
+
+	_scenario.objective.reset(new ScenarioObjective(0, static_cast<ObjectiveTimeoutPolicy>(policy), Date(day, month, year), objectives));
+	return true;
+}
+
+/**
+ * Change the owner of an area of tiles in the scenario editor.
+ * @param pos Base of the area.
+ * @param width Length of the area in X direction.
+ * @param height Length of the area in Y direction.
+ * @param owner New owner of the tiles.
+ * @return Whether the command succeeded.
+ */
+static bool SetTileOwner(const XYZPoint16 &pos, int64 width, int64 height, int64 owner)
+{
+	if (!_game_mode_mgr.InEditorMode()) return false;
+	if (owner < OWN_NONE || owner >= OWN_COUNT || width < 1 || height < 1) return false;
+	if (pos.x < 0 || pos.y < 0 || pos.x + width > _world.GetXSize() || pos.y + height > _world.GetYSize()) return false;
+
+	_world.SetTileOwnerRect(pos.x, pos.y, width, height, static_cast<TileOwner>(owner));
+	return true;
+}
+
+/**
+ * Execute a command, without recording it. The arguments are checked before use, so invalid commands just fail.
+ * @param cmd Command to execute.
+ * @return Whether the command succeeded.
+ */
+bool ExecuteCommand(const GameCommand &cmd)
+{
+	const int64 *args = cmd.args;
+	switch (cmd.type) {
+		case GCMD_SET_SPEED:
+			if (args[0] < GSP_PAUSE || args[0] >= GSP_COUNT) return false;
+			_game_control.speed = static_cast<GameSpeed>(args[0]);
+			return true;
+
+		case GCMD_SET_PARK_ENTRANCE_FEE:
+			if (args[0] < 0) return false;
+			_game_observer.entrance_fee = args[0];
+			return true;
+
+		case GCMD_HIRE_STAFF:
+			switch (args[0]) {
+				case PERSON_MECHANIC:    _staff.HireMechanic();    return true;
+				case PERSON_HANDYMAN:    _staff.HireHandyman();    return true;
+				case PERSON_GUARD:       _staff.HireGuard();       return true;
+				case PERSON_ENTERTAINER: _staff.HireEntertainer(); return true;
+				default: return false;
+			}
+
+		case GCMD_DISMISS_STAFF:   return DismissStaff(args[0], args[1]);
+		case GCMD_CHANGE_LOAN:     return ChangeLoan(args[0]);
+		case GCMD_REMOVE_RIDE:     return RemoveRide(args[0]);
+		case GCMD_SET_RIDE_STATE:  return SetRideState(args[0], args[1]);
+		case GCMD_SET_RIDE_SETTING: return SetRideSetting(args[0], args[1], args[2]);
+		case GCMD_CREATE_COASTER:  return CreateCoaster(args[0], args[1]);
+		case GCMD_FINISH_COASTER:  return FinishCoaster(args[0]);
+		case GCMD_ABANDON_COASTER: return AbandonCoaster(args[0]);
+		case GCMD_SET_RIDE_COLOUR: return SetRideColour(args[0], args[1], args[2], args[3]);
+		case GCMD_SET_RIDE_NAME:   return SetRideName(args[0], cmd.text);
+
+		case GCMD_SET_PARK_NAME:
+			_game_observer.park_name = cmd.text;
+			return true;
+
+		case GCMD_SET_PARK_OPEN:
+			_game_observer.SetParkOpen(args[0] != 0);
+			return true;
+
+		case GCMD_SET_SCENARIO_SETTING: return SetScenarioSetting(args[0], args[1]);
+		case GCMD_SET_OBJECTIVE:        return SetObjective(args[0], args[1], args[2], args[3]);
+		case GCMD_SET_TILE_OWNER:       return SetTileOwner(cmd.pos, args[0], args[1], args[2]);  // The area is not a voxel.
+
+		case GCMD_CHANGE_CASH:  // Negative cash is allowed in the scenario editor.
+			if (!_game_mode_mgr.InEditorMode()) return false;
+			_finances_manager.DoTransaction(args[0]);
+			return true;
+
+		case GCMD_TERRAFORM_AREA:  // The area may extend beyond the edge of the world.
+			if (args[0] < 0 || args[0] > UINT16_MAX || args[1] < 0 || args[1] > UINT16_MAX) return false;
+			ChangeAreaCursorMode(Rectangle16(cmd.pos.x, cmd.pos.y, args[0], args[1]), args[2] != 0, args[3]);
+			return true;
+
+		default:
+			break;
+	}
+
+	/* All other commands apply to a voxel. */
+	if (!IsValidCommandPosition(cmd.pos)) return false;
+	switch (cmd.type) {
+		case GCMD_BUILD_FLAT_PATH:
+		case GCMD_BUILD_UPWARD_PATH:
+		case GCMD_BUILD_DOWNWARD_PATH:
+		case GCMD_CHANGE_PATH: {
+			if (args[0] < 0 || args[0] >= PAT_COUNT || args[1] < 0 || args[1] >= PAS_COUNT) return false;
+			const PathType path_type = static_cast<PathType>(args[0]);
+			const PathStatus path_status = static_cast<PathStatus>(args[1]);
+			if (cmd.type == GCMD_BUILD_FLAT_PATH) return BuildFlatPath(cmd.pos, path_type, path_status, false, true);
+			if (cmd.type == GCMD_CHANGE_PATH) return ChangePath(cmd.pos, path_type, path_status, false, true);
+
+			if (args[2] < EDGE_BEGIN || args[2] >= EDGE_COUNT) return false;
+			const TileEdge edge = static_cast<TileEdge>(args[2]);
+			if (cmd.type == GCMD_BUILD_UPWARD_PATH) return BuildUpwardPath(cmd.pos, edge, path_type, path_status, false, true);
+			return BuildDownwardPath(cmd.pos, edge, path_type, path_status, false, true);
+		}
+
+		case GCMD_REMOVE_PATH:
+			return RemovePath(cmd.pos, false, true);
+
+		case GCMD_TERRAFORM_TILE:
+			if (args[0] < CUR_TYPE_NORTH || args[0] > CUR_TYPE_TILE) return false;
+			ChangeTileCursorMode(Point16(cmd.pos.x, cmd.pos.y), static_cast<CursorType>(args[0]), args[1] != 0, args[2], args[3] != 0);
+			return true;
+
+		case GCMD_BUILD_FENCE:        return BuildFence(cmd.pos, args[0], args[1]);
+		case GCMD_PLACE_SCENERY:      return PlaceScenery(cmd.pos, args[0], args[1]);
+		case GCMD_REMOVE_SCENERY:     return RemoveScenery(cmd.pos);
+		case GCMD_PLACE_PATH_OBJECT:  return PlacePathObject(cmd.pos, args[0]);
+		case GCMD_BUILD_FIXED_RIDE:   return BuildFixedRide(cmd.pos, args[0], args[1], args[2]);
+		case GCMD_SET_RIDE_ENTRANCE:  return SetRideEntranceOrExit(cmd.pos, args[0], true);
+		case GCMD_SET_RIDE_EXIT:      return SetRideEntranceOrExit(cmd.pos, args[0], false);
+		case GCMD_BUILD_TRACK_PIECE:  return BuildTrackPiece(cmd.pos, args[0], args[1], args[2], args[3]);
+		case GCMD_REMOVE_TRACK_PIECE: return RemoveTrackPiece(cmd.pos, args[0]);
+
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file command.h Actions of the player that change the game. */
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <initializer_list>
+#include <string>
+#include "geometry.h"
+
+/**
+ * Types of commands. The numbers are stored in replay files, only add new commands at the end.
+ * The meaning of the position and the arguments is documented with each command.
+ */
+enum GameCommandType {
+	GCMD_SET_SPEED,           ///< Change the game speed. Args: #GameSpeed.
+	GCMD_BUILD_FLAT_PATH,     ///< Build a flat path at the position. Args: #PathType, #PathStatus.
+	GCMD_BUILD_UPWARD_PATH,   ///< Build an upward path at the position. Args: #PathType, #PathStatus, #TileEdge.
+	GCMD_BUILD_DOWNWARD_PATH, ///< Build a downward path at the position. Args: #PathType, #PathStatus, #TileEdge.
+	GCMD_CHANGE_PATH,         ///< Change the path at the position. Args: #PathType, #PathStatus.
+	GCMD_REMOVE_PATH,         ///< Remove the path at the position.
+	GCMD_TERRAFORM_TILE,      ///< Raise or lower the ground at the position. Args: #CursorType, levelling, direction, whole world.
+	GCMD_TERRAFORM_AREA,      ///< Raise or lower an area of ground with its base at the position. Args: width, height, levelling, direction.
+	GCMD_BUILD_FENCE,         ///< Build or remove a fence at the ground at the position. Args: #TileEdge, #FenceType (#FENCE_TYPE_INVALID to remove).
+	GCMD_PLACE_SCENERY,       ///< Place a scenery item at the position. Args: index of the scenery type, orientation.
+	GCMD_REMOVE_SCENERY,      ///< Remove the scenery item at the position.
+	GCMD_PLACE_PATH_OBJECT,   ///< Place a path object at the position. Args: path object type.
+	GCMD_BUILD_FIXED_RIDE,    ///< Build a shop, gentle ride, or thrill ride at the position. Args: ride number, index of the ride type, orientation.
+	GCMD_SET_RIDE_ENTRANCE,   ///< Place the entrance of a ride at the position. Args: ride number.
+	GCMD_SET_RIDE_EXIT,       ///< Place the exit of a ride at the position. Args: ride number.
+	GCMD_REMOVE_RIDE,         ///< Remove a ride. Args: ride number.
+	GCMD_SET_RIDE_STATE,      ///< Open, close, or test a ride. Args: ride number, #RideInstanceState.
+	GCMD_SET_RIDE_SETTING,    ///< Change a setting of a ride. Args: ride number, #RideSetting, new value.
+	GCMD_SET_PARK_ENTRANCE_FEE, ///< Change the entrance fee of the park. Args: new fee.
+	GCMD_HIRE_STAFF,          ///< Hire a staff member. Args: #PersonType.
+	GCMD_DISMISS_STAFF,       ///< Dismiss a staff member. Args: #PersonType, id of the person.
+	GCMD_CHANGE_LOAN,         ///< Take (positive amount) or repay (negative amount) a loan. Args: amount.
+	GCMD_CREATE_COASTER,      ///< Start building a roller coaster. Args: ride number, index of the ride type.
+	GCMD_BUILD_TRACK_PIECE,   ///< Build track at the position. Args: ride number, index of the track piece (\c -1 for a design), index of the design (\c -1 for a single piece), #TileEdge to build a design in.
+	GCMD_REMOVE_TRACK_PIECE,  ///< Remove the track piece with its base voxel at the position. Args: ride number.
+	GCMD_FINISH_COASTER,      ///< Finish building a roller coaster, if its track forms a loop. Args: ride number.
+	GCMD_ABANDON_COASTER,     ///< Delete a roller coaster without entrance, without returning its cost. Args: ride number.
+	GCMD_SET_RIDE_COLOUR,     ///< Change a colour of a ride. Args: ride number, #RideColourPart, index of the recolouring, #ColourRange.
+	GCMD_SET_RIDE_NAME,       ///< Rename a ride. Args: ride number. Text: new name.
+	GCMD_SET_PARK_NAME,       ///< Rename the park. Text: new name.
+	GCMD_SET_PARK_OPEN,       ///< Open or close the park. Args: whether to open the park.
+	GCMD_SET_SCENARIO_SETTING, ///< Change a setting of the scenario in the scenario editor. Args: #ScenarioSetting, new value.
+	GCMD_CHANGE_CASH,         ///< Add (positive amount) or remove (negative amount) cash in the scenario editor. Args: amount.
+	GCMD_SET_OBJECTIVE,       ///< Change the objective of the scenario in the scenario editor. Args: deadline (#CompressedDate) with the #ObjectiveTimeoutPolicy in bits 32 and up, number of guests, park value, park rating with the days allowed below it in bits 16 and up (\c -1 for no guests, park value, or park rating objective).
+	GCMD_SET_TILE_OWNER,      ///< Change the owner of an area of tiles with its base at the position in the scenario editor. Args: width, height, #TileOwner.
+
+	GCMD_COUNT,               ///< Number of command types.
+};
+
+/** Settings of a ride that can be changed with #GCMD_SET_RIDE_SETTING. */
+enum RideSetting {
+	RSET_ENTRANCE_FEE,          ///< Entrance fee of the ride.
+	RSET_WORKING_CYCLES,        ///< Number of working cycles of a fixed ride.
+	RSET_MIN_IDLE_DURATION,     ///< Minimum idle duration, in milliseconds.
+	RSET_MAX_IDLE_DURATION,     ///< Maximum idle duration, in milliseconds.
+	RSET_MAINTENANCE_INTERVAL,  ///< Maintenance interval, in milliseconds.
+	RSET_ENTRANCE_TYPE,         ///< Index of the entrance type.
+	RSET_EXIT_TYPE,             ///< Index of the exit type.
+	RSET_NUMBER_OF_TRAINS,      ///< Number of trains of a roller coaster.
+	RSET_CARS_PER_TRAIN,        ///< Number of cars in each train of a roller coaster.
+};
+
+/** Settings of the scenario that can be changed with #GCMD_SET_SCENARIO_SETTING. */
+enum ScenarioSetting {
+	SSET_MAX_GUESTS,          ///< Maximum number of guests in the park.
+	SSET_ALLOW_ENTRANCE_FEE,  ///< Whether the player may set a park entrance fee.
+	SSET_MAX_LOAN,            ///< Maximum loan the player can take.
+	SSET_INTEREST,            ///< Annual interest rate in 0.1 percent.
+};
+
+/** Parts of a ride that can be recoloured with #GCMD_SET_RIDE_COLOUR. */
+enum RideColourPart {
+	RCP_RIDE,      ///< The ride itself.
+	RCP_ENTRANCE,  ///< The entrance of the ride.
+	RCP_EXIT,      ///< The exit of the ride.
+};
+
+static const int GAME_COMMAND_ARG_COUNT = 4; ///< Number of arguments of a command.
+
+/** A command with its arguments, as executed and recorded. */
+struct GameCommand {
+	GameCommandType type;                 ///< Type of the command.
+	XYZPoint16 pos;                       ///< Voxel the command applies to, if any.
+	int64 args[GAME_COMMAND_ARG_COUNT];   ///< Arguments of the command, unused arguments are \c 0.
+	std::string text;                     ///< Text argument of the command, if any.
+};
+
+bool DoCommand(GameCommandType type, std::initializer_list<int64> args, const XYZPoint16 &pos = XYZPoint16::invalid(), const std::string &text = std::string());
+bool ExecuteCommand(const GameCommand &cmd);
+
+#endif
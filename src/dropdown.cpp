@@ -193,7 +193,7 @@ void GuiWindow::ShowDropdownMenu(WidgetNumber widnum, const DropdownList &items,
 /** Dropdown for picking a colour to use for recolouring. */
 class RecolourDropdownWindow : public GuiWindow {
 public:
-	RecolourDropdownWindow(WindowTypes parent_type, WindowNumber parent_num, int parent_btn, const Point16 &pos, ColourRange colour, RecolourEntry *entry);
+	RecolourDropdownWindow(WindowTypes parent_type, WindowNumber parent_num, int parent_btn, const Point16 &pos, ColourRange colour, const RecolourEntry *entry);
 
 	void DrawWidget(WidgetNumber wid_num, const BaseWidget *wid) const override;
 	void OnClick(WidgetNumber widget, const Point16 &pos) override;
@@ -201,7 +201,7 @@ public:
 	WindowTypes parent_type; ///< Parent window type.
 	WindowNumber parent_num; ///< Parent window number.
 	int parent_btn;          ///< Object the dropdown originated from. Usually a #WidgetNumber.
-	RecolourEntry *entry;    ///< Entry being changed.
+	const RecolourEntry *entry; ///< Entry being changed.
 };
 
 /** Widgets of the #RecolourDropdownWindow. */
@@ -258,9 +258,9 @@ static const WidgetPart _recolour_dropdown_widgets[] = {
  * @param parent_btn Unique number within the parent (to differentiate between different dropdowns from the same parent).
  * @param pos Initial position of the window (top left).
  * @param colour Requested colour of dropdown.
- * @param entry Recolour entry being changed (will be changed when clicked on a selectable different colour).
+ * @param entry Recolour entry being changed. Clicking a selectable different colour notifies the parent with a #CHG_DROPDOWN_RESULT.
  */
-RecolourDropdownWindow::RecolourDropdownWindow(WindowTypes parent_type, WindowNumber parent_num, int parent_btn, const Point16 &pos, ColourRange colour, RecolourEntry *entry)
+RecolourDropdownWindow::RecolourDropdownWindow(WindowTypes parent_type, WindowNumber parent_num, int parent_btn, const Point16 &pos, ColourRange colour, const RecolourEntry *entry)
 		: GuiWindow(WC_DROPDOWN, ALL_WINDOWS_OF_TYPE), parent_type(parent_type), parent_num(parent_num), parent_btn(parent_btn), entry(entry)
 {
 	this->SetupWidgetTree(_recolour_dropdown_widgets, lengthof(_recolour_dropdown_widgets));
@@ -279,7 +279,7 @@ void RecolourDropdownWindow::OnClick(WidgetNumber widget, [[maybe_unused]] const
 		if (GB(this->entry->dest_set, widget - RD_BUTTON_00, 1) == 0) return;
 
 		if (this->entry->dest != widget - RD_BUTTON_00) {
-			this->entry->dest = static_cast<ColourRange>(widget - RD_BUTTON_00);
+			NotifyChange(this->parent_type, this->parent_num, CHG_DROPDOWN_RESULT, this->parent_btn << 16 | (widget - RD_BUTTON_00));
 		}
 
 		delete this;
@@ -296,10 +296,10 @@ void RecolourDropdownWindow::DrawWidget(WidgetNumber wid_num, const BaseWidget *
 /**
  * Open a recolour dropdown from widget \a widnum.
  * @param widnum Associated dropdown button.
- * @param entry Recolour entry being changed (will be changed when clicked on a selectable different colour).
+ * @param entry Recolour entry being changed. The window gets a #CHG_DROPDOWN_RESULT with the new #ColourRange when a selectable different colour is clicked.
  * @param colour Requested colour of dropdown.
  */
-void GuiWindow::ShowRecolourDropdown(WidgetNumber widnum, RecolourEntry *entry, ColourRange colour)
+void GuiWindow::ShowRecolourDropdown(WidgetNumber widnum, const RecolourEntry *entry, ColourRange colour)
 {
 	Window *w = GetWindowByType(WC_DROPDOWN, ALL_WINDOWS_OF_TYPE);
 	delete w;
@@ -89,6 +89,8 @@ void ErrorMessageWindow::TimeoutCallback()
  */
 void ShowErrorMessage(const StringID str1, const StringID str2, const std::function<void()> &string_params, const uint32 timeout)
 {
+	if (_window_manager.GetViewport() == nullptr) return;  // No display to show the message in, for example while replaying a game.
+
 	Window *w;
 	do {
 		w = HighlightWindowByType(WC_ERROR_MESSAGE, ALL_WINDOWS_OF_TYPE);
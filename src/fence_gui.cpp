@@ -16,6 +16,7 @@
 #include "language.h"
 #include "finances.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "gui_sprites.h"
 #include "sprite_data.h"
 
@@ -266,33 +267,8 @@ void FenceGui::SelectorMouseButtonEvent(MouseButtons state)
 	if (this->fence_edge == INVALID_EDGE) return;
 	if (_game_mode_mgr.InPlayMode() && _world.GetTileOwner(this->fence_base.x, this->fence_base.y) != OWN_PARK) return;
 
-	VoxelStack *vs = _world.GetModifyStack(this->fence_base.x, this->fence_base.y);
-	uint16 fences = GetGroundFencesFromMap(vs, this->fence_base.z);
-
-	Money cost;
-	if ((state & MB_RIGHT) != 0) {  // Remove a fence.
-		const FenceType f = GetFenceType(fences, this->fence_edge);
-		if (f < FENCE_TYPE_BUILDABLE_BEGIN || f >= FENCE_TYPE_COUNT) return;
-
-		cost = GetFenceCostRemove(f);
-		if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_REMOVE, cost)) return;
-
-		fences = SetFenceType(fences, this->fence_edge, FENCE_TYPE_INVALID);
-	} else {  // Build a fence.
-		cost = GetFenceCostBuild(this->fence_type);
-		if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, cost)) return;
-
-		fences = SetFenceType(fences, this->fence_edge, this->fence_type);
-	}
-
-	if (_game_control.action_test_mode) {
-		ShowCostOrReturnEstimate(cost);
-		return;
-	}
-	_finances_manager.PayLandscaping(cost);
-	_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->fence_base);
-
-	AddGroundFencesToMap(fences, vs, this->fence_base.z);
+	const FenceType fence_type = ((state & MB_RIGHT) != 0) ? FENCE_TYPE_INVALID : this->fence_type;  // Remove or build a fence.
+	DoCommand(GCMD_BUILD_FENCE, {this->fence_edge, fence_type}, this->fence_base);
 }
 
 /**
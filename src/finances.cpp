@@ -214,8 +214,10 @@ void FinancesManager::RecomputeParkValue()
 {
 	this->park_value = 0;
 
-	for (const auto &pair : _rides_manager.instances) {
-		this->park_value += std::max(Money(0), -pair.second->ComputeReturnCost());
+	for (const auto &kind : _rides_manager.kind_instances) {
+		for (const RideInstance *ri : kind) {
+			this->park_value += std::max(Money(0), -ri->ComputeReturnCost());
+		}
 	}
 
 	/* \todo Also consider other sellable items such as scenery and paths. */
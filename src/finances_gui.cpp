@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "window.h"
+#include "command.h"
 #include "viewport.h"
 #include "terraform.h"
 #include "sprite_store.h"
@@ -206,31 +207,31 @@ void FinancesGui::OnClick(WidgetNumber widget, [[maybe_unused]] const Point16 &p
 {
 	switch (widget) {
 		case FIN_INCREASE_LOAN:
-			_finances_manager.TakeLoan(std::min(LOAN_STEP_SIZE, _scenario.max_loan - _finances_manager.GetLoan()));
+			DoCommand(GCMD_CHANGE_LOAN, {std::min(LOAN_STEP_SIZE, _scenario.max_loan - _finances_manager.GetLoan())});
 			break;
 		case FIN_DECREASE_LOAN:
-			_finances_manager.RepayLoan(std::min(LOAN_STEP_SIZE, std::min(_finances_manager.GetLoan(), _finances_manager.GetCash())));
+			DoCommand(GCMD_CHANGE_LOAN, {-std::min(LOAN_STEP_SIZE, std::min(_finances_manager.GetLoan(), _finances_manager.GetCash()))});
 			break;
 
 		case FIN_INCREASE_CASH:
-			if (_game_mode_mgr.InEditorMode()) _finances_manager.DoTransaction(CASH_STEP_SIZE);
+			if (_game_mode_mgr.InEditorMode()) DoCommand(GCMD_CHANGE_CASH, {CASH_STEP_SIZE});
 			break;
 		case FIN_DECREASE_CASH:
-			if (_game_mode_mgr.InEditorMode()) _finances_manager.DoTransaction(-CASH_STEP_SIZE);  // No check here, negative cash is allowed.
+			if (_game_mode_mgr.InEditorMode()) DoCommand(GCMD_CHANGE_CASH, {-CASH_STEP_SIZE});  // No check here, negative cash is allowed.
 			break;
 
 		case FIN_INCREASE_MAX_LOAN:
-			if (_game_mode_mgr.InEditorMode()) _scenario.max_loan += LOAN_STEP_SIZE;
+			if (_game_mode_mgr.InEditorMode()) DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_MAX_LOAN, _scenario.max_loan + LOAN_STEP_SIZE});
 			break;
 		case FIN_DECREASE_MAX_LOAN:
-			if (_game_mode_mgr.InEditorMode()) _scenario.max_loan = std::max(_scenario.max_loan - LOAN_STEP_SIZE, Money(0));
+			if (_game_mode_mgr.InEditorMode()) DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_MAX_LOAN, std::max(_scenario.max_loan - LOAN_STEP_SIZE, Money(0))});
 			break;
 
 		case FIN_INCREASE_INTEREST:
-			if (_game_mode_mgr.InEditorMode()) ++_scenario.interest;
+			if (_game_mode_mgr.InEditorMode()) DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_INTEREST, _scenario.interest + 1});
 			break;
 		case FIN_DECREASE_INTEREST:
-			if (_game_mode_mgr.InEditorMode()) --_scenario.interest;
+			if (_game_mode_mgr.InEditorMode()) DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_INTEREST, _scenario.interest - 1});
 			break;
 
 		default: break;
@@ -16,6 +16,9 @@
 #include "fileio.h"
 #include "math_func.h"
 #include "viewport.h"
+#include "shop_type.h"
+#include "path_build.h"
+#include "gamecontrol.h"
 
 FixedRideType::FixedRideType(const RideTypeKind k) : RideType(k),
 	width_x(0),
@@ -185,17 +188,13 @@ void FixedRideInstance::SetRide(uint8 orientation, const XYZPoint16 &pos)
 
 void FixedRideInstance::RemoveAllPeople()
 {
-	for (GuestBatch &gb : this->onride_guests.batches) {
+	for (int i = 0; i < this->onride_guests.num_batches; i++) {
+		GuestBatch &gb = this->onride_guests.GetBatch(i);
 		if (gb.state == BST_EMPTY) continue;
 
-		for (GuestData &gd : gb.guests) {
-			if (!gd.IsEmpty()) {
-				_guests.GetExisting(gd.guest)->ExitRide(this, gd.entry);
-
-				gd.Clear();
-			}
-		}
-		gb.state = BST_EMPTY;
+		GuestData gd;
+		while (gb.RemoveGuest(&gd)) _guests.GetExisting(gd.guest)->ExitRide(this, gd.entry);
+		this->onride_guests.SetBatchState(i, BST_EMPTY);
 	}
 }
 
@@ -291,48 +290,31 @@ void FixedRideInstance::OnAnimate(const int delay)
 	}
 
 	/* Kick out guests that are done. */
-	int start = -1;
-	for (;;) {
-		start = this->onride_guests.GetFinishedBatch(start);
-		if (start < 0) break;
-
-		GuestBatch &gb = this->onride_guests.batches.at(start);
-		bool is_empty = true;
-		for (GuestData &gd : gb.guests) {
-			if (!gd.IsEmpty()) {
-				_guests.GetExisting(gd.guest)->ExitRide(this, gd.entry);
-				gd.Clear();
-				/* Kick out only one guest at a time so they appear to be walking out in a nice, ordered line. */
-				is_empty = false;
-				break;
-			}
+	for (int index = this->onride_guests.GetFinishedBatch(); index >= 0;) {
+		const int next = this->onride_guests.GetFinishedBatch(index);
+		/* Kick out only one guest at a time so they appear to be walking out in a nice, ordered line. */
+		GuestData gd;
+		if (this->onride_guests.GetBatch(index).RemoveGuest(&gd)) {
+			_guests.GetExisting(gd.guest)->ExitRide(this, gd.entry);
+		} else {
+			this->onride_guests.SetBatchState(index, BST_EMPTY);
 		}
-		if (is_empty) gb.state = BST_EMPTY;
+		index = next;
 	}
 
 	/* Ensure there is always a Loading batch, except when all batches are Running. */
-	start = this->onride_guests.GetLoadingBatch();
+	int start = this->onride_guests.GetLoadingBatch();
 	if (start < 0) {
 		start = this->onride_guests.GetFreeBatch();
 	}
 	if (start >= 0) {
-		GuestBatch &batch = this->onride_guests.GetBatch(start);
-		batch.state = BST_LOADING;
+		this->onride_guests.SetBatchState(start, BST_LOADING);
 		/* Start the batch when it is full or when the timeout has elapsed. */
-		bool is_full = true;
-		if (!force_start) {
-			for (GuestData &gd : batch.guests) {
-				if (gd.IsEmpty()) {
-					is_full = false;
-					break;
-				}
-			}
-		}
 		/* \todo Only start if the waiting time exceeded #min_idle_duration. */
-		if (is_full) {
+		if (force_start || this->onride_guests.GetBatch(start).IsFull()) {
 			this->is_working = true;
 			this->time_left_in_phase = this->working_cycles * t->working_duration;
-			batch.Start(this->time_left_in_phase);
+			this->onride_guests.StartBatch(start, this->time_left_in_phase);
 		}
 	}
 }
@@ -380,3 +362,111 @@ void FixedRideInstance::Save(Saver &svr)
 	svr.PutLongLong(this->return_cost);
 	svr.EndPattern();
 }
+
+/**
+ * Checks whether the air space above the ground at the given location is suited to place a fixed ride of the given height.
+ * @param position Coordinate of the base voxel.
+ * @param height Height of the object.
+ * @return The space is suited to build the ride.
+ */
+static bool CheckSufficientVerticalSpace(const XYZPoint16& position, const int8 height)
+{
+	for (int8 h = 0; h < height; ++h) {
+		const Voxel *v = _world.GetVoxel(position + XYZPoint16(0, 0, h));
+		if (v == nullptr) continue;
+
+		if (h > 0 && v->GetGroundType() != GTP_INVALID) return false;
+		if (!v->CanPlaceInstance() || v->GetGroundSlope() != SL_FLAT) return false;
+	}
+	return true;
+}
+
+/**
+ * Checks whether the given location is suited to place a fixed ride on flat ground.
+ * @param position Coordinate of the base voxel.
+ * @return The space is flat and suited to build the ride.
+ */
+static bool CanPlaceFixedRideOnFlatGround(const XYZPoint16& position)
+{
+	const Voxel *vx = _world.GetVoxel(position);
+	return vx != nullptr && vx->GetGroundType() != GTP_INVALID && vx->GetGroundSlope() == SL_FLAT;
+}
+
+/**
+ * Checks whether the given location is suited to place a fixed ride on a slope.
+ * @param position Coordinate of the base voxel.
+ * @return The space is suited to build the ride.
+ */
+static bool CanPlaceFixedRideOnSlope(const XYZPoint16& position)
+{
+	const Voxel *vx = _world.GetVoxel(position + XYZPoint16(0, 0, -1));
+	if (vx == nullptr || vx->GetGroundType() == GTP_INVALID || vx->GetGroundSlope() == SL_FLAT) return false;
+	const Voxel *top_voxel = _world.GetVoxel(position);
+	return top_voxel == nullptr || !IsImplodedSteepSlope(top_voxel->GetGroundSlope());
+}
+
+/**
+ * Can a fixed ride be placed at the given voxel?
+ * @param selected_ride Ride to place.
+ * @param pos Coordinate of the voxel.
+ * @param ride_orient Orientation of the ride.
+ * @param reason [inout] Reason why the ride cannot be placed, updated if appropriate.
+ * @pre voxel coordinate must be valid in the world.
+ * @pre \a selected_ride may not be \c nullptr.
+ * @return Ride can be placed at the given position.
+ */
+bool CanPlaceFixedRide(const FixedRideType *selected_ride, const XYZPoint16 &pos, uint8 ride_orient, BestErrorMessageReason *reason)
+{
+	/* 1. Can the position itself be used to build a ride? */
+	for (int x = 0; x < selected_ride->width_x; ++x) {
+		for (int y = 0; y < selected_ride->width_y; ++y) {
+			const XYZPoint16 location = OrientatedOffset(ride_orient, x, y) + pos;
+			if (!IsVoxelstackInsideWorld(location.x, location.y)) {
+				reason->UpdateReason(GUI_ERROR_MESSAGE_BAD_LOCATION);
+				return false;
+			}
+			if (_world.GetTileOwner(location.x, location.y) != OWN_PARK) {
+				reason->UpdateReason(GUI_ERROR_MESSAGE_UNOWNED_LAND);
+				return false;
+			}
+		}
+	}
+	bool can_place_base = false;
+	bool can_place_air = true;
+	for (int x = 0; x < selected_ride->width_x; ++x) {
+		for (int y = 0; y < selected_ride->width_y; ++y) {
+			const XYZPoint16 location = pos + OrientatedOffset(ride_orient, x, y);
+			can_place_base |= CanPlaceFixedRideOnFlatGround(location);
+			can_place_air &= CheckSufficientVerticalSpace(location, selected_ride->GetHeight(x, y));
+		}
+	}
+	if (!can_place_air) {
+		reason->UpdateReason(can_place_base ? GUI_ERROR_MESSAGE_OCCUPIED : GUI_ERROR_MESSAGE_BAD_LOCATION);
+		return false;
+	}
+	if (can_place_base) return true;
+
+	/* 2. Is the ride just above non-flat ground? */
+	if (pos.z > 0) {
+		for (int x = 0; x < selected_ride->width_x; ++x) {
+			for (int y = 0; y < selected_ride->width_y; ++y) {
+				const XYZPoint16 location = pos + OrientatedOffset(ride_orient, x, y);
+				if (CanPlaceFixedRideOnSlope(location)) return true;
+			}
+		}
+	}
+
+	/* 3. For shops only: Is there a path at the right place? */
+	if (selected_ride->kind != RTK_SHOP) {
+		reason->UpdateReason(GUI_ERROR_MESSAGE_BAD_LOCATION);
+		return false;
+	}
+	const ShopType *selected_shop = static_cast<const ShopType*>(selected_ride);
+	for (TileEdge entrance = EDGE_BEGIN; entrance < EDGE_COUNT; entrance++) { // Loop over the 4 unrotated directions.
+		if ((selected_shop->flags & (1 << entrance)) == 0) continue; // No entrance here.
+		TileEdge entr = static_cast<TileEdge>((entrance + ride_orient) & 3); // Perform rotation of the ride.
+		if (PathExistsAtBottomEdge(pos, entr)) return true;
+	}
+	reason->UpdateReason(GUI_ERROR_MESSAGE_BAD_LOCATION);
+	return false;
+}
@@ -13,6 +13,8 @@
 #include "ride_type.h"
 #include "guest_batches.h"
 
+class BestErrorMessageReason;
+
 /**
  * A 'ride' where you can buy food, drinks, and other stuff you need for a visit.
  */
@@ -102,4 +104,6 @@ protected:
 	int time_left_in_phase; /// Number of milliseconds left in the current phase.
 };
 
+bool CanPlaceFixedRide(const FixedRideType *selected_ride, const XYZPoint16 &pos, uint8 ride_orient, BestErrorMessageReason *reason);
+
 #endif
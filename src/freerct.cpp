@@ -24,6 +24,13 @@
 #include "ride_type.h"
 #include "string_func.h"
 #include "rev.h"
+#include "headless.h"
+#include "park_generator.h"
+#include "replay.h"
+#include "memory_usage.h"
+#include "task_graph.h"
+#include "dates.h"
+#include "trace.h"
 
 #ifdef WEBASSEMBLY
 #include <emscripten.h>
@@ -61,6 +68,15 @@ static const OptionData _options[] = {
 	GETOPT_VALUE('a', "--language"),
 	GETOPT_VALUE('i', "--installdir"),
 	GETOPT_VALUE('u', "--userdatadir"),
+	GETOPT_VALUE('s', "--simulate"),
+	GETOPT_VALUE('d', "--days"),
+	GETOPT_VALUE('t', "--ticks"),
+	GETOPT_VALUE('o', "--output"),
+	GETOPT_VALUE('T', "--trace"),
+	GETOPT_VALUE('g', "--generate"),
+	GETOPT_VALUE('R', "--record"),
+	GETOPT_VALUE('p', "--replay"),
+	GETOPT_NOVAL('m', "--memory-report"),
 	GETOPT_END()
 };
 
@@ -77,6 +93,19 @@ static void PrintUsage()
 	printf("  -a, --language LANG    Use the specified language.\n");
 	printf("  -i, --installdir DIR   Use the specified installation directory.\n");
 	printf("  -u, --userdatadir DIR  Use the specified user data directory.\n");
+	printf("  -s, --simulate FILE    Simulate the game in the specified file without display, and exit.\n");
+	printf("  -d, --days N           Number of days to simulate with --simulate.\n");
+	printf("  -t, --ticks N          Number of ticks to simulate with --simulate.\n");
+	printf("  -o, --output FILE      Save the game to the specified file after --simulate, --generate, or --replay.\n");
+	printf("  -T, --trace FILE       Record a timeline of the program to the specified trace file.\n");
+	printf("  -g, --generate SPEC    Generate a park, save it to the --output file, and exit.\n");
+	printf("                         SPEC is a preset (small, medium, huge) followed by optional settings,\n");
+	printf("                         for example 'medium,seed=3,rides=10'. Settings are seed, size, coverage,\n");
+	printf("                         paths, rides, shops, coasters, scenery, and guests.\n");
+	printf("  -R, --record FILE      Record the commands of the first played game to the specified replay file.\n");
+	printf("  -p, --replay FILE      Replay the specified replay file without display, verify it, and exit.\n");
+	printf("  -m, --memory-report    Print the memory used by the parts of the program when the game ends.\n");
+	printf("                         A report is also printed when the program receives SIGUSR1.\n");
 
 	printf("\nValid languages are:\n   ");
 	int length = 0;
@@ -169,6 +198,13 @@ int freerct_main(int argc, char **argv)
 	std::string file_name;
 	std::string preferred_language;
 	GameMode game_mode = GM_PLAY;
+	std::string simulate_file;
+	std::string output_file;
+	std::string trace_file;
+	std::string generate_spec;
+	std::string record_file;
+	std::string replay_file;
+	long simulate_ticks = -1;
 	[[maybe_unused]] bool has_install_prefix_override = false;
 	do {
 		opt_id = opt_data.GetOpt();
@@ -199,6 +235,36 @@ int freerct_main(int argc, char **argv)
 				game_mode = GM_EDITOR;
 				if (opt_data.opt != nullptr) file_name = opt_data.opt;
 				break;
+			case 's':
+				if (opt_data.opt != nullptr) simulate_file = opt_data.opt;
+				break;
+			case 'd':
+			case 't':
+				simulate_ticks = (opt_data.opt != nullptr) ? strtol(opt_data.opt, nullptr, 10) : -1;
+				if (simulate_ticks < 0 || simulate_ticks > (opt_id == 'd' ? 1000000 : 300000000)) {
+					fprintf(stderr, "ERROR: Invalid number of %s.\n", opt_id == 'd' ? "days" : "ticks");
+					return 1;
+				}
+				if (opt_id == 'd') simulate_ticks *= TICK_COUNT_PER_DAY;
+				break;
+			case 'o':
+				if (opt_data.opt != nullptr) output_file = opt_data.opt;
+				break;
+			case 'T':
+				if (opt_data.opt != nullptr) trace_file = opt_data.opt;
+				break;
+			case 'g':
+				if (opt_data.opt != nullptr) generate_spec = opt_data.opt;
+				break;
+			case 'R':
+				if (opt_data.opt != nullptr) record_file = opt_data.opt;
+				break;
+			case 'p':
+				if (opt_data.opt != nullptr) replay_file = opt_data.opt;
+				break;
+			case 'm':
+				_memory_report_at_exit = true;
+				break;
 
 			case -1:
 				break;
@@ -210,6 +276,15 @@ int freerct_main(int argc, char **argv)
 		}
 	} while (opt_id != -1);
 
+	if (!simulate_file.empty() && simulate_ticks < 0) {
+		fprintf(stderr, "ERROR: --simulate needs --days or --ticks.\n");
+		return 1;
+	}
+	if (!generate_spec.empty() && output_file.empty()) {
+		fprintf(stderr, "ERROR: --generate needs --output.\n");
+		return 1;
+	}
+
 #if _WIN32
 	/* Windows needs help finding the installation directory. */
 	if (!has_install_prefix_override) {
@@ -239,36 +314,95 @@ int freerct_main(int argc, char **argv)
 	/* Scan for savegames and config files in outdated locations. */
 	MigrateOldFiles();
 
-	/* Load RCD files. */
-	InitImageStorage();
-	_rcd_collection.ScanDirectories();
-	_sprite_manager.LoadRcdFiles();
-	_rides_manager.LoadDesigns();
+	std::string cfg_file_path = freerct_userdata_prefix();
+	cfg_file_path += DIR_SEP;
+	cfg_file_path += "freerct.cfg";
+	ConfigFile cfg_file(cfg_file_path);
+
+	/* Start tracing before loading anything, so the loaders are traced as well. */
+	if (trace_file.empty()) trace_file = cfg_file.GetValue("debug", "trace_file");
+	if (!trace_file.empty()) {
+		int64 capacity = cfg_file.GetNum("debug", "trace_events");
+		_tracer.Start(trace_file, capacity > 0 ? capacity : Tracer::DEFAULT_CAPACITY);
+	}
+
+	InstallMemoryReportSignal();
 
-	InitLanguage();
+	const bool headless = !simulate_file.empty() || !generate_spec.empty() || !replay_file.empty();
+	std::string font_path;
+	int font_size = 0;
+	if (!headless) {
+		font_path = cfg_file.GetValue("font", "medium-path");
+		font_size = cfg_file.GetNum("font", "medium-size");
+
+		/* Use default values if no font has been set. */
+		if (font_path.empty()) font_path = FindDataFile(std::string("data") + DIR_SEP + "font" + DIR_SEP + "FreeSans.ttf");
+		if (font_size < 1) font_size = 15;
+	}
+
+	/*
+	 * Load the game data. Everything else needs the RCD files, but the window and the font do not,
+	 * so they are prepared while the RCD files are being loaded. OpenGL may only be used by the main thread.
+	 */
+	TaskGraph startup;
+	const TaskGraph::TaskID rcd_task = startup.Add("LoadRcdFiles", [](std::atomic<float> &progress) {
+		InitImageStorage();
+		_rcd_collection.ScanDirectories();
+		_sprite_manager.LoadRcdFiles(&progress);
+	}, {}, 10.0f);
+	startup.Add("LoadDesigns", [](std::atomic<float> &) { _rides_manager.LoadDesigns(); }, {rcd_task});
+	startup.Add("InitLanguage", [](std::atomic<float> &) { InitLanguage(); }, {rcd_task});  // Needs the strings of the RCD files.
+	if (headless) {
+		startup.Run();
+	} else {
+		const TaskGraph::TaskID video_task = startup.Add("InitVideo", [](std::atomic<float> &) { _video.Initialize(); }, {}, 1.0f, true);
+		const TaskGraph::TaskID font_task = startup.Add("RasteriseFont", [&font_path, font_size](std::atomic<float> &progress) {
+			_text_renderer.RasteriseFont(font_path, font_size, &progress);
+		}, {}, 3.0f);
+		startup.Add("UploadFont", [](std::atomic<float> &) { _text_renderer.UploadFont(); }, {video_task, font_task}, 1.0f, true);
+		startup.Run([&startup]() { _video.ShowLoadingProgress(startup.GetProgress()); });
+	}
 
 	if (!_gui_sprites.HasSufficientGraphics()) {
 		fprintf(stderr, "Insufficient graphics loaded.\n");
+		if (!headless) _video.Shutdown();
+		_tracer.Stop();
 		return 1;
 	}
 
-	std::string cfg_file_path = freerct_userdata_prefix();
-	cfg_file_path += DIR_SEP;
-	cfg_file_path += "freerct.cfg";
-	ConfigFile cfg_file(cfg_file_path);
+	if (!simulate_file.empty()) {
+		int result = RunHeadlessSimulation(simulate_file, simulate_ticks, output_file);
+		UninitLanguage();
+		DestroyImageStorage();
+		_tracer.Stop();
+		return result;
+	}
+	if (!generate_spec.empty()) {
+		int result = RunParkGenerator(generate_spec, output_file);
+		UninitLanguage();
+		DestroyImageStorage();
+		_tracer.Stop();
+		return result;
+	}
+	if (!replay_file.empty()) {
+		int result = RunReplay(replay_file, output_file);
+		UninitLanguage();
+		DestroyImageStorage();
+		_tracer.Stop();
+		return result;
+	}
+	_replay_recorder.requested_file = record_file;
 
-	std::string font_path = cfg_file.GetValue("font", "medium-path");
-	int font_size = cfg_file.GetNum("font", "medium-size");
 	if (cfg_file.GetNum("saveloading", "auto-resave") > 0) _automatically_resave_files = true;
 
 	{
 		int autosaves = cfg_file.GetNum("saveloading", "max_autosaves");
 		if (autosaves >= 0) _max_autosaves = autosaves;
 	}
-
-	/* Use default values if no font has been set. */
-	if (font_path.empty()) font_path = FindDataFile(std::string("data") + DIR_SEP + "font" + DIR_SEP + "FreeSans.ttf");
-	if (font_size < 1) font_size = 15;
+	{
+		int budget = cfg_file.GetNum("game", "turbo_frame_budget");
+		if (budget > 0) _turbo_frame_budget = budget;
+	}
 
 	/* Overwrite the default language settings if the user specified a custom language on the command line or in the config file. */
 	bool language_set = false;
@@ -302,8 +436,8 @@ int freerct_main(int argc, char **argv)
 	/* Read keyboard shortcuts. */
 	_shortcuts.ReadConfig(cfg_file);
 
-	/* Initialize video. */
-	_video.Initialize(font_path, font_size);
+	/* Loading is done, the game can handle input now. */
+	_video.EnableInput();
 
 	_game_control.Initialize(file_name, game_mode);
 
@@ -315,6 +449,7 @@ int freerct_main(int argc, char **argv)
 #endif
 
 	_game_control.Uninitialize();
+	_tracer.Stop();
 
 	UninitLanguage();
 	DestroyImageStorage();
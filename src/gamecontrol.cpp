@@ -14,16 +14,22 @@
 #include "messages.h"
 #include "sprite_store.h"
 #include "path_build.h"
+#include "path_graph.h"
+#include "queue.h"
 #include "person.h"
 #include "people.h"
 #include "window.h"
 #include "dates.h"
 #include "scenery.h"
+#include "profiler.h"
+#include "trace.h"
 #include "viewport.h"
 #include "weather.h"
 #include "freerct.h"
 #include "fileio.h"
 #include "rev.h"
+#include "replay.h"
+#include "memory_usage.h"
 
 GameModeManager _game_mode_mgr; ///< Game mode manager object.
 
@@ -36,6 +42,7 @@ void OnNewYear()
 /** Runs various procedures that have to be done monthly. */
 void OnNewMonth()
 {
+	TraceScope trace("OnNewMonth");
 	Autosave();
 	_finances_manager.AdvanceMonth();
 	_staff.OnNewMonth();
@@ -45,6 +52,7 @@ void OnNewMonth()
 /** Runs various procedures that have to be done daily. */
 void OnNewDay()
 {
+	TraceScope trace("OnNewDay");
 	_rides_manager.OnNewDay();
 	_guests.OnNewDay();
 	_staff.OnNewDay();
@@ -66,6 +74,7 @@ static int speed_factor(GameSpeed speed)
 		case GSP_2:     return 2;
 		case GSP_4:     return 4;
 		case GSP_8:     return 8;
+		case GSP_TURBO: NOT_REACHED(); // Depends on the time budget, see #OnNewFrame.
 		default:       NOT_REACHED();
 	}
 }
@@ -76,22 +85,78 @@ static int speed_factor(GameSpeed speed)
 */
 void OnNewFrame(const uint32 frame_delay)
 {
+	TraceScope trace("OnNewFrame");
+	HandleMemoryReportSignal();
 	_image_variants.Tick();
 	_window_manager.Tick();
 	_inbox.Tick(frame_delay);
-	for (int i = speed_factor(_game_control.speed); i > 0; i--) {
-		_guests.DoTick();
-		_staff.DoTick();
-		DateOnTick();
-		_game_observer.DoTick();
-		_guests.OnAnimate(frame_delay);
-		_staff.OnAnimate(frame_delay);
-		_rides_manager.OnAnimate(frame_delay);
-		_scenery.OnAnimate(frame_delay);
+
+	TickSubsystemTimes tick_times;
+	TickSubsystemTimes *times = _profiler.IsEnabled() ? &tick_times : nullptr;
+
+	uint32 ticks = 0;
+	if (_game_control.speed == GSP_TURBO) {
+		/* Simulate until the budget is used up; the intermediate states of the game are never drawn. */
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_turbo_frame_budget);
+		do {
+			OnNewTick(frame_delay, times);
+			ticks++;
+		} while (std::chrono::steady_clock::now() < deadline);
+	} else {
+		for (int i = speed_factor(_game_control.speed); i > 0; i--) {
+			OnNewTick(frame_delay, times);
+			ticks++;
+		}
 	}
+	_game_control.CountTicks(ticks);
+	if (times != nullptr) _profiler.AddTickTimes(tick_times);
+	_window_manager.CloseStaleWindows();
+}
+
+/** Names of the tick subsystems, for reporting. */
+const char * const _tick_subsystem_names[TSS_COUNT] = {
+	"guests",
+	"guest-anim",
+	"staff",
+	"date",
+	"observer",
+	"rides",
+	"scenery",
+};
+
+/**
+ * Run one tick of the game simulation. Unlike #OnNewFrame, it does not touch the user interface.
+ * @param frame_delay Number of milliseconds of game time in the tick.
+ * @param times [inout] If not \c nullptr, the time spent by each subsystem is added to it.
+ */
+void OnNewTick(const uint32 frame_delay, TickSubsystemTimes *times)
+{
+	auto run = [times](TickSubsystem subsystem, auto &&update) {
+		TraceScope trace(_tick_subsystem_names[subsystem]);
+		if (times == nullptr) {
+			update();
+			return;
+		}
+		const auto start = std::chrono::steady_clock::now();
+		update();
+		times->duration[subsystem] += std::chrono::steady_clock::now() - start;
+	};
+
+	run(TSS_GUESTS,         []() { _guests.DoTick(); });
+	run(TSS_STAFF,          []() { _staff.DoTick(); });
+	run(TSS_DATE,           []() { DateOnTick(); });
+	run(TSS_OBSERVER,       []() { _game_observer.DoTick(); });
+	run(TSS_GUESTS_ANIMATE, [frame_delay]() { _guests.OnAnimate(frame_delay); });
+	run(TSS_STAFF,          [frame_delay]() { _staff.OnAnimate(frame_delay); });
+	run(TSS_RIDES,          [frame_delay]() { _rides_manager.OnAnimate(frame_delay); });
+	run(TSS_SCENERY,        [frame_delay]() { _scenery.OnAnimate(frame_delay); });
+
+	_replay_recorder.OnTick();
+	HandleMemoryReportSignal();  // Also in the simulation loops without display.
 }
 
 int _max_autosaves(3);  ///< How many autosave files are retained at most. 0 disables autosave.
+uint32 _turbo_frame_budget(100);  ///< Number of milliseconds per frame spent on simulating the game at #GSP_TURBO speed.
 
 /**
  * Get the file path for an autosave with index #i.
@@ -110,6 +175,7 @@ static std::string AutosaveFilename(int i)
 /** Create a new automatic savegame, and roll older autosaves. */
 void Autosave()
 {
+	TraceScope trace("Autosave");
 	if (_max_autosaves < 1) return;
 
 	/* Roll old autosaves. */
@@ -129,10 +195,31 @@ GameControl::GameControl()
 	running(false),
 	main_menu(false),
 	speed(GSP_1),
+	speed_multiplier(1),
 	action_test_mode(false),
 	next_action(GCA_NONE),
-	next_scenario(nullptr)
+	next_scenario(nullptr),
+	speed_measure_start(std::chrono::steady_clock::now()),
+	speed_measure_ticks(0)
+{
+}
+
+/**
+ * Account for the ticks run in a frame, and update the measured game speed #speed_multiplier when enough time has passed.
+ * @param ticks Number of ticks run in the frame.
+ */
+void GameControl::CountTicks(uint32 ticks)
 {
+	static const uint32 MEASURE_PERIOD = 1000; ///< Minimum number of milliseconds of a speed measurement.
+
+	this->speed_measure_ticks += ticks;
+	const auto now = std::chrono::steady_clock::now();
+	const uint32 elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - this->speed_measure_start).count();
+	if (elapsed < MEASURE_PERIOD) return;
+
+	this->speed_multiplier = (static_cast<uint64>(this->speed_measure_ticks) * FRAME_DELAY + elapsed / 2) / elapsed;
+	this->speed_measure_start = now;
+	this->speed_measure_ticks = 0;
 }
 
 /**
@@ -161,6 +248,7 @@ void GameControl::Initialize(const std::string &fname, GameMode game_mode)
 /** Uninitialize the game controller. */
 void GameControl::Uninitialize()
 {
+	if (_memory_report_at_exit) PrintMemoryReport(stdout);
 	this->ShutdownLevel();
 }
 
@@ -315,12 +403,19 @@ void GameControl::StartLevel(GameMode game_mode)
 		ShowToolbar();
 		ShowBottomToolbar();
 	}
+
+	/* Only the first game is recorded. */
+	if (game_mode == GM_PLAY && !this->main_menu && !_replay_recorder.requested_file.empty()) {
+		_replay_recorder.Start(_replay_recorder.requested_file);
+		_replay_recorder.requested_file.clear();
+	}
 }
 
 /** Shutdown the game interaction. */
 void GameControl::ShutdownLevel()
 {
 	/// \todo Clean out the game data structures.
+	_replay_recorder.Stop();
 	_game_mode_mgr.SetGameMode(GM_NONE);
 	_window_manager.CloseAllWindows();
 	_rides_manager.DeleteAllRideInstances();
@@ -328,6 +423,8 @@ void GameControl::ShutdownLevel()
 	_game_observer.Uninitialize();
 	_guests.Uninitialize();
 	_staff.Uninitialize();
+	_path_graph.Clear();
+	_queues.Clear();
 }
 
 GameModeManager::GameModeManager() : game_mode(GM_NONE)
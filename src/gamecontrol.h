@@ -10,18 +10,43 @@
 #ifndef GAMECONTROL_H
 #define GAMECONTROL_H
 
+#include <chrono>
 #include "enum_type.h"
 #include "language.h"
 #include "money.h"
 
 struct MissionScenario;
 
+static const uint32 FRAME_DELAY = 30; ///< Minimum number of milliseconds between two frames, and the game time passing in one tick at normal speed.
+
+/** Subsystems of the game that are updated every tick. */
+enum TickSubsystem {
+	TSS_GUESTS,          ///< Guests making decisions, see Guests::DoTick.
+	TSS_GUESTS_ANIMATE,  ///< Guests walking around, see Guests::OnAnimate.
+	TSS_STAFF,           ///< Staff members, see #Staff.
+	TSS_DATE,            ///< Date, including the daily, monthly, and yearly updates.
+	TSS_OBSERVER,        ///< Park statistics, see #GameObserver.
+	TSS_RIDES,           ///< Ride instances, see #RidesManager.
+	TSS_SCENERY,         ///< Scenery items, see #SceneryManager.
+
+	TSS_COUNT,           ///< Number of subsystems.
+};
+
+/** Time spent by the subsystems of the game in #OnNewTick. */
+struct TickSubsystemTimes {
+	std::chrono::nanoseconds duration[TSS_COUNT] = {}; ///< Total time spent, for each subsystem.
+};
+
+extern const char * const _tick_subsystem_names[TSS_COUNT];
+
 void OnNewDay();
 void OnNewMonth();
 void OnNewYear();
 void OnNewFrame(uint32 frame_delay);
+void OnNewTick(uint32 frame_delay, TickSubsystemTimes *times = nullptr);
 void Autosave();
 extern int _max_autosaves;
+extern uint32 _turbo_frame_budget;
 
 /** Actions that can be run to control the game. */
 enum GameControlAction {
@@ -42,6 +67,7 @@ enum GameSpeed {
 	GSP_2,      ///< Double speed.
 	GSP_4,      ///< 4 times speed.
 	GSP_8,      ///< 8 times speed.
+	GSP_TURBO,  ///< As many ticks as fit in #_turbo_frame_budget every frame.
 	GSP_COUNT   ///< Number of entries.
 };
 DECLARE_POSTFIX_INCREMENT(GameSpeed)
@@ -85,7 +111,10 @@ public:
 	bool running;    ///< Indicates whether a game is currently running.
 	bool main_menu;  ///< Indicates whether the main menu is currently open.
 
-	GameSpeed speed;  ///< Speed of the game.
+	void CountTicks(uint32 ticks);
+
+	GameSpeed speed;          ///< Speed of the game.
+	uint32 speed_multiplier;  ///< Measured speed of the game relative to normal speed, updated about once a second.
 
 	bool action_test_mode;  ///< Don't perform any actions, only check what they would cost.
 
@@ -98,6 +127,9 @@ private:
 	GameControlAction next_action; ///< Action game control wants to run, or #GCA_NONE for 'no action'.
 	std::string fname;             ///< Filename of game level to load from or save to.
 	MissionScenario *next_scenario;  ///< The scenario to load on the next tick.
+
+	std::chrono::steady_clock::time_point speed_measure_start;  ///< Start of the current game speed measurement.
+	uint32 speed_measure_ticks;  ///< Number of ticks run in the current game speed measurement.
 };
 
 extern GameControl _game_control;
@@ -32,6 +32,7 @@ void GameObserver::Uninitialize()
 {
 	this->guest_count_history.clear();
 	this->park_rating_history.clear();
+	this->rnd = Random(RSK_PARK_RATING, 0);
 	this->current_guest_count = 0;
 	this->current_park_rating = 0;
 	this->max_guests = 0;
@@ -68,6 +69,8 @@ void GameObserver::Win()
 
 	if (_game_mode_mgr.InPlayMode() && !_scenario.wrapper->solved.has_value()) {
 		this->won_lost = SCENARIO_WON_FIRST;
+		/* Without a display nobody is playing, for example while simulating or replaying a game. */
+		if (_window_manager.GetViewport() == nullptr) return;
 
 		std::string username;
 		for (const auto& var : {"USER", "USERNAME"}) {
@@ -87,7 +90,7 @@ void GameObserver::Win()
 		_scenario.wrapper->mission->UpdateUnlockData();
 	}
 
-	ShowParkManagementGui(PARK_MANAGEMENT_TAB_OBJECTIVE);
+	if (_window_manager.GetViewport() != nullptr) ShowParkManagementGui(PARK_MANAGEMENT_TAB_OBJECTIVE);
 }
 
 /** The game has been lost. */
@@ -97,7 +100,7 @@ void GameObserver::Lose()
 	this->won_lost = SCENARIO_LOST;
 	_inbox.SendMessage(new Message(GUI_MESSAGE_SCENARIO_LOST));
 	this->SetParkOpen(false);
-	ShowParkManagementGui(PARK_MANAGEMENT_TAB_OBJECTIVE);
+	if (_window_manager.GetViewport() != nullptr) ShowParkManagementGui(PARK_MANAGEMENT_TAB_OBJECTIVE);
 }
 
 /**
@@ -116,11 +119,10 @@ void GameObserver::SetParkOpen(bool open)
  */
 int GameObserver::CalculateParkRating()
 {
-	Random r;
-	return std::max(0, std::min(MAX_PARK_RATING, this->current_park_rating + r.Uniform(60) - 20));
+	return std::max(0, std::min(MAX_PARK_RATING, this->current_park_rating + this->rnd.Uniform(60) - 20));
 }
 
-static const uint32 CURRENT_VERSION_GOBS = 1;   ///< Currently supported version of the GOBS Pattern.
+static const uint32 CURRENT_VERSION_GOBS = 2;   ///< Currently supported version of the GOBS Pattern.
 
 /**
  * Load game observer data from the save game.
@@ -135,6 +137,7 @@ void GameObserver::Load(Loader &ldr)
 			break;
 
 		case 1:
+		case 2:
 			this->won_lost = static_cast<WonLost>(ldr.GetByte());
 			this->park_open = ldr.GetByte() > 0;
 			this->park_name = ldr.GetText();
@@ -144,6 +147,7 @@ void GameObserver::Load(Loader &ldr)
 			this->max_guests = ldr.GetLong();
 			for (size_t i = ldr.GetLong(); i > 0; --i) this->park_rating_history.push_back(ldr.GetWord());
 			for (size_t i = ldr.GetLong(); i > 0; --i) this->guest_count_history.push_back(ldr.GetLong());
+			if (version >= 2) this->rnd.LoadState(ldr);
 			break;
 
 		default:
@@ -173,6 +177,7 @@ void GameObserver::Save(Saver &svr)
 	for (int i : this->park_rating_history) svr.PutWord(i);
 	svr.PutLong(this->guest_count_history.size());
 	for (int i : this->guest_count_history) svr.PutLong(i);
+	this->rnd.SaveState(svr);
 
 	svr.EndPattern();
 }
@@ -15,6 +15,7 @@
 
 #include "dates.h"
 #include "money.h"
+#include "random.h"
 
 /** Whether the scenario has been won or lost. */
 enum WonLost {
@@ -59,6 +60,8 @@ public:
 
 private:
 	int CalculateParkRating();
+
+	Random rnd;  ///< Random number generator for the park rating.
 };
 
 extern GameObserver _game_observer;
@@ -18,6 +18,7 @@
 #include "finances.h"
 #include "mouse_mode.h"
 #include "viewport.h"
+#include "command.h"
 #include "generated/entrance_exit_strings.h"
 
 /** Window to prompt for removing a gentle/thrill ride. */
@@ -27,9 +28,11 @@ public:
 
 	void OnClick(WidgetNumber number, const Point16 &pos) override;
 	void SetWidgetStringParameters(WidgetNumber wid_num) const override;
+	bool IsStale() const override;
 
 private:
-	GentleThrillRideInstance *si; ///< Gentle/Thrill ride instance to remove.
+	GentleThrillRideInstance *si;  ///< Gentle/Thrill ride instance to remove.
+	uint16 ride_generation;        ///< Generation of the ride number when the window was opened, see #IsStale.
 };
 
 /**
@@ -37,20 +40,25 @@ private:
  * @param si Gentle/Thrill ride instance to remove.
  */
 GentleThrillRideRemoveWindow::GentleThrillRideRemoveWindow(GentleThrillRideInstance *instance)
-: EntityRemoveWindow(WC_GENTLE_THRILL_RIDE_REMOVE, instance->GetIndex()), si(instance)
+: EntityRemoveWindow(WC_GENTLE_THRILL_RIDE_REMOVE, instance->GetIndex()), si(instance), ride_generation(_rides_manager.GetGeneration(instance->GetIndex()))
 {
 }
 
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool GentleThrillRideRemoveWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 void GentleThrillRideRemoveWindow::OnClick(WidgetNumber number, [[maybe_unused]] const Point16 &pos)
 {
 	if (number == ERW_YES) {
-		const Money cost = this->si->ComputeReturnCost();
-		_finances_manager.PayRideConstruct(cost);
-		_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->si->RepresentativeLocation());
-
 		delete GetWindowByType(WC_GENTLE_THRILL_RIDE_MANAGER, this->si->GetIndex());
 
-		_rides_manager.DeleteInstance(this->si->GetIndex());
+		DoCommand(GCMD_REMOVE_RIDE, {this->si->GetIndex()});
 	}
 	delete this;
 }
@@ -228,9 +236,11 @@ public:
 	void OnChange(ChangeCode code, uint32 parameter) override;
 	void SelectorMouseMoveEvent(Viewport *vp, const Point16 &pos) override;
 	void SelectorMouseButtonEvent(MouseButtons state) override;
+	bool IsStale() const override;
 
 private:
 	GentleThrillRideInstance *ride;  ///< Gentle/Thrill ride instance getting managed by this window.
+	uint16 ride_generation;          ///< Generation of the ride number when the window was opened, see #IsStale.
 
 	void UpdateButtons();
 	void UpdateRecolourButtons();
@@ -247,6 +257,7 @@ private:
 GentleThrillRideManagerWindow::GentleThrillRideManagerWindow(GentleThrillRideInstance *ri) : GuiWindow(WC_GENTLE_THRILL_RIDE_MANAGER, ri->GetIndex())
 {
 	this->ride = ri;
+	this->ride_generation = _rides_manager.GetGeneration(ri->GetIndex());
 	this->SetRideType(this->ride->GetGentleThrillRideType());
 	this->SetupWidgetTree(_gentle_thrill_ride_manager_gui_parts, lengthof(_gentle_thrill_ride_manager_gui_parts));
 	this->UpdateButtons();
@@ -256,7 +267,7 @@ GentleThrillRideManagerWindow::GentleThrillRideManagerWindow(GentleThrillRideIns
 	txt->SetText(this->ride->name);
 	txt->text_changed = [this, txt]()
 	{
-		this->ride->name = txt->GetText();
+		DoCommand(GCMD_SET_RIDE_NAME, {this->ride->GetIndex()}, XYZPoint16::invalid(), txt->GetText());
 	};
 
 	SetSelector(nullptr);
@@ -391,7 +402,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused
 		case GTRMW_OPEN_RIDE_LIGHT:
 		case GTRMW_OPEN_RIDE_PANEL:
 			if (this->ride->CanOpenRide()) {
-				this->ride->OpenRide();
+				DoCommand(GCMD_SET_RIDE_STATE, {this->ride->GetIndex(), RIS_OPEN});
 				this->UpdateButtons();
 			}
 			break;
@@ -399,7 +410,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused
 		case GTRMW_CLOSE_RIDE_LIGHT:
 		case GTRMW_CLOSE_RIDE_PANEL:
 			if (this->ride->state != RIS_CLOSED) {
-				this->ride->CloseRide();
+				DoCommand(GCMD_SET_RIDE_STATE, {this->ride->GetIndex(), RIS_CLOSED});
 				this->UpdateButtons();
 			}
 			break;
@@ -407,7 +418,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused
 		case GTRMW_RECOLOUR1:
 		case GTRMW_RECOLOUR2:
 		case GTRMW_RECOLOUR3: {
-			RecolourEntry *re = &this->ride->recolours.entries[wid_num - GTRMW_RECOLOUR1];
+			const RecolourEntry *re = &this->ride->recolours.entries[wid_num - GTRMW_RECOLOUR1];
 			if (re->IsValid()) {
 				this->ShowRecolourDropdown(wid_num, re, COL_RANGE_DARK_RED);
 			}
@@ -416,7 +427,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused
 		case GTRMW_ENTRANCE_RECOLOUR1:
 		case GTRMW_ENTRANCE_RECOLOUR2:
 		case GTRMW_ENTRANCE_RECOLOUR3: {
-			RecolourEntry *re = &this->ride->entrance_recolours.entries[wid_num - GTRMW_ENTRANCE_RECOLOUR1];
+			const RecolourEntry *re = &this->ride->entrance_recolours.entries[wid_num - GTRMW_ENTRANCE_RECOLOUR1];
 			if (re->IsValid()) {
 				this->ShowRecolourDropdown(wid_num, re, COL_RANGE_DARK_RED);
 			}
@@ -425,7 +436,7 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused
 		case GTRMW_EXIT_RECOLOUR1:
 		case GTRMW_EXIT_RECOLOUR2:
 		case GTRMW_EXIT_RECOLOUR3: {
-			RecolourEntry *re = &this->ride->exit_recolours.entries[wid_num - GTRMW_EXIT_RECOLOUR1];
+			const RecolourEntry *re = &this->ride->exit_recolours.entries[wid_num - GTRMW_EXIT_RECOLOUR1];
 			if (re->IsValid()) {
 				this->ShowRecolourDropdown(wid_num, re, COL_RANGE_DARK_RED);
 			}
@@ -433,43 +444,43 @@ void GentleThrillRideManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused
 		}
 
 		case GTRMW_ENTRANCE_FEE_INCREASE:
-			this->ride->item_price[0] += RIDE_ENTRANCE_FEE_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_ENTRANCE_FEE, this->ride->item_price[0] + RIDE_ENTRANCE_FEE_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case GTRMW_ENTRANCE_FEE_DECREASE:
-			this->ride->item_price[0] = std::max<int>(0, this->ride->item_price[0] - RIDE_ENTRANCE_FEE_STEP_SIZE);
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_ENTRANCE_FEE, std::max<int>(0, this->ride->item_price[0] - RIDE_ENTRANCE_FEE_STEP_SIZE)});
 			this->UpdateButtons();
 			break;
 		case GTRMW_CYCLES_INCREASE:
-			this->ride->working_cycles++;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_WORKING_CYCLES, this->ride->working_cycles + 1});
 			this->UpdateButtons();
 			break;
 		case GTRMW_CYCLES_DECREASE:
-			this->ride->working_cycles--;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_WORKING_CYCLES, this->ride->working_cycles - 1});
 			this->UpdateButtons();
 			break;
 		case GTRMW_MAX_IDLE_INCREASE:
-			this->ride->max_idle_duration += IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_MAX_IDLE_DURATION, this->ride->max_idle_duration + IDLE_DURATION_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case GTRMW_MAX_IDLE_DECREASE:
-			this->ride->max_idle_duration -= IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_MAX_IDLE_DURATION, this->ride->max_idle_duration - IDLE_DURATION_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case GTRMW_MIN_IDLE_INCREASE:
-			this->ride->min_idle_duration += IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_MIN_IDLE_DURATION, this->ride->min_idle_duration + IDLE_DURATION_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case GTRMW_MIN_IDLE_DECREASE:
-			this->ride->min_idle_duration -= IDLE_DURATION_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_MIN_IDLE_DURATION, this->ride->min_idle_duration - IDLE_DURATION_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case GTRMW_MAINTENANCE_INCREASE:
-			this->ride->maintenance_interval += MAINTENANCE_INTERVAL_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_MAINTENANCE_INTERVAL, this->ride->maintenance_interval + MAINTENANCE_INTERVAL_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case GTRMW_MAINTENANCE_DECREASE:
-			this->ride->maintenance_interval -= MAINTENANCE_INTERVAL_STEP_SIZE;
+			DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_MAINTENANCE_INTERVAL, this->ride->maintenance_interval - MAINTENANCE_INTERVAL_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 
@@ -560,10 +571,10 @@ void GentleThrillRideManagerWindow::SelectorMouseButtonEvent(const MouseButtons
 
 	if (this->is_placing_entrance) {
 		assert(this->ride->CanPlaceEntranceOrExit(this->ride->temp_entrance_pos, true));
-		this->ride->SetEntrancePos(this->ride->temp_entrance_pos);
+		DoCommand(GCMD_SET_RIDE_ENTRANCE, {this->ride->GetIndex()}, this->ride->temp_entrance_pos);
 	} else {
 		assert(this->ride->CanPlaceEntranceOrExit(this->ride->temp_exit_pos, false));
-		this->ride->SetExitPos(this->ride->temp_exit_pos);
+		DoCommand(GCMD_SET_RIDE_EXIT, {this->ride->GetIndex()}, this->ride->temp_exit_pos);
 	}
 
 	this->ride->temp_entrance_pos = XYZPoint16::invalid();
@@ -582,25 +593,51 @@ void GentleThrillRideManagerWindow::SelectorMouseButtonEvent(const MouseButtons
 void GentleThrillRideManagerWindow::OnChange(const ChangeCode code, const uint32 parameter)
 {
 	switch (code) {
-		case CHG_DROPDOWN_RESULT:
-			switch ((parameter >> 16) & 0xFF) {
+		case CHG_DROPDOWN_RESULT: {
+			const int widget = (parameter >> 16) & 0xFF;
+			switch (widget) {
 				case GTRMW_CHOOSE_ENTRANCE:
-					this->ride->SetEntranceType(parameter & 0xFF);
+					DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_ENTRANCE_TYPE, parameter & 0xFF});
 					this->UpdateRecolourButtons();
 					break;
 				case GTRMW_CHOOSE_EXIT:
-					this->ride->SetExitType(parameter & 0xFF);
+					DoCommand(GCMD_SET_RIDE_SETTING, {this->ride->GetIndex(), RSET_EXIT_TYPE, parameter & 0xFF});
 					this->UpdateRecolourButtons();
 					break;
+				case GTRMW_RECOLOUR1:
+				case GTRMW_RECOLOUR2:
+				case GTRMW_RECOLOUR3:
+					DoCommand(GCMD_SET_RIDE_COLOUR, {this->ride->GetIndex(), RCP_RIDE, widget - GTRMW_RECOLOUR1, parameter & 0xFF});
+					break;
+				case GTRMW_ENTRANCE_RECOLOUR1:
+				case GTRMW_ENTRANCE_RECOLOUR2:
+				case GTRMW_ENTRANCE_RECOLOUR3:
+					DoCommand(GCMD_SET_RIDE_COLOUR, {this->ride->GetIndex(), RCP_ENTRANCE, widget - GTRMW_ENTRANCE_RECOLOUR1, parameter & 0xFF});
+					break;
+				case GTRMW_EXIT_RECOLOUR1:
+				case GTRMW_EXIT_RECOLOUR2:
+				case GTRMW_EXIT_RECOLOUR3:
+					DoCommand(GCMD_SET_RIDE_COLOUR, {this->ride->GetIndex(), RCP_EXIT, widget - GTRMW_EXIT_RECOLOUR1, parameter & 0xFF});
+					break;
 				default:
 					break;
 			}
 			break;
+		}
 		default:
 			break;
 	}
 }
 
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool GentleThrillRideManagerWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 /**
  * Open a window to manage a given gentle/thrill ride.
  * @param number Ride to manage.
@@ -14,6 +14,7 @@
 #include "people.h"
 #include "fileio.h"
 #include "gentle_thrill_ride_type.h"
+#include "trace.h"
 #include "generated/gentle_thrill_rides_strings.cpp"
 
 GentleThrillRideType::GentleThrillRideType() : FixedRideType(RTK_GENTLE /* Kind will be set later in Load(). */)
@@ -202,7 +203,7 @@ RideEntryResult GentleThrillRideInstance::EnterRide(int guest, [[maybe_unused]]
 	assert(vox == this->entrance_pos);
 	if (_guests.GetExisting(guest)->cash < GetSaleItemPrice(0)) return RER_REFUSED;
 	const int b = onride_guests.GetLoadingBatch();
-	return (b >= 0 && this->onride_guests.batches[b].AddGuest(guest, entry)) ? RER_ENTERED : RER_WAIT;
+	return (b >= 0 && this->onride_guests.GetBatch(b).AddGuest(guest, entry)) ? RER_ENTERED : RER_WAIT;
 }
 
 EdgeCoordinate GentleThrillRideInstance::GetMechanicEntrance() const
@@ -214,8 +215,7 @@ XYZPoint32 GentleThrillRideInstance::GetExit([[maybe_unused]] int guest, [[maybe
 {
 	const int direction = this->EntranceExitRotation(this->exit_pos);
 	XYZPoint32 p(this->exit_pos.x * 256, this->exit_pos.y * 256, this->vox_pos.z * 256);
-	Random r;  // Don't put all guests on exactly the same spot.
-	const int d = 128 + r.Uniform(128) - 64;
+	const int d = 128 + this->rnd.Uniform(128) - 64;  // Don't put all guests on exactly the same spot.
 	switch (direction) {
 		case VOR_WEST:  p.x += d;       p.y -= 32;      break;
 		case VOR_EAST:  p.x += d;       p.y += 256+32;  break;
@@ -368,6 +368,7 @@ bool GentleThrillRideInstance::CanBeVisited(const XYZPoint16 &vox, const TileEdg
 
 void GentleThrillRideInstance::RecalculateRatings()
 {
+	TraceScope trace("GentleThrillRideInstance::RecalculateRatings");
 	const GentleThrillRideType *t = this->GetGentleThrillRideType();
 	this->intensity_rating = t->intensity_base;
 	this->nausea_rating = t->nausea_base;
@@ -58,30 +58,22 @@ void GuestData::Save(Saver &svr)
 	svr.EndPattern();
 }
 
-/**
- * Return whether the batch is entirely empty.
- * @return Whether the batch is entirely empty.
- */
-bool GuestBatch::IsEmpty() const
-{
-	for (const GuestData &val : this->guests) if (!val.IsEmpty()) return false;
-	return true;
-}
-
 /**
  * Configure a batch of guests.
  * @param batch_size Number of guests in a batch.
  */
 void GuestBatch::Configure(int batch_size)
 {
-	assert(this->IsEmpty());
-
 	this->guests.clear();
 	this->guests.resize(batch_size);
 
 	this->state = BST_EMPTY;
 	this->remaining = 0;
 	this->gate = 0;
+	this->loaded = 0;
+	this->unloaded = 0;
+	this->prev = -1;
+	this->next = -1;
 }
 
 /**
@@ -92,39 +84,35 @@ void GuestBatch::Configure(int batch_size)
  */
 bool GuestBatch::AddGuest(int guest, TileEdge entry)
 {
-	for (GuestData &val : this->guests) {
-		if (!val.IsEmpty()) continue;
+	if (this->IsFull()) return false;
 
-		val.Set(guest, entry);
-		return true;
-	}
-	return false;
+	this->guests[this->loaded].Set(guest, entry);
+	this->loaded++;
+	return true;
 }
 
 /**
- * Start the ride (make it #BST_RUNNING).
- * @param ride_time Length of the ride in milli-seconds.
+ * Take the guest that entered first out of the batch.
+ * @param [out] gd Data of the removed guest.
+ * @return Whether a guest was removed, \c false means the batch was already empty.
  */
-void GuestBatch::Start(int ride_time)
+bool GuestBatch::RemoveGuest(GuestData *gd)
 {
-	this->state = BST_RUNNING;
-	this->remaining = ride_time;
+	if (this->IsEmpty()) return false;
+
+	GuestData &entry = this->guests[this->unloaded];
+	*gd = entry;
+	entry.Clear();
+	this->unloaded++;
+	return true;
 }
 
-/**
- * Update the state of the ride due to passage of time.
- * @param delay Amount of time that has passed (milli-seconds).
- */
-void GuestBatch::OnAnimate(int delay)
+/** Forget all guests of the batch, making room for new guests. */
+void GuestBatch::Clear()
 {
-	if (this->state != BST_RUNNING) return;
-
-	if (this->remaining > delay) {
-		this->remaining -= delay;
-	} else {
-		this->remaining = 0;
-		this->state = BST_FINISHED;
-	}
+	for (int i = this->unloaded; i < this->loaded; i++) this->guests[i].Clear();
+	this->loaded = 0;
+	this->unloaded = 0;
 }
 
 void GuestBatch::Load(Loader &ldr)
@@ -135,7 +123,16 @@ void GuestBatch::Load(Loader &ldr)
 	this->state = static_cast<BatchState>(ldr.GetByte());
 	this->remaining = ldr.GetLong();
 	this->gate = ldr.GetWord();
-	for (GuestData &g : this->guests) g.Load(ldr);
+	if (this->state >= BST_COUNT) throw LoadingError("Invalid guest batch state %d.", this->state);
+
+	/* Move the guests to the front of the array, older saves may have gaps between them. */
+	this->loaded = 0;
+	this->unloaded = 0;
+	for (size_t i = 0; i < this->guests.size(); i++) {
+		GuestData gd;
+		gd.Load(ldr);
+		if (!gd.IsEmpty()) this->guests[this->loaded++] = gd;
+	}
 	ldr.ClosePattern();
 }
 
@@ -173,24 +170,90 @@ void OnRideGuests::Configure(int batch_size, int num_batches)
 
 	this->batch_size = batch_size;
 	this->num_batches = num_batches;
+
+	std::fill_n(this->first, lengthof(this->first), -1);
+	std::fill_n(this->last, lengthof(this->last), -1);
+	for (int i = 0; i < num_batches; i++) this->LinkBatch(i);
+}
+
+/**
+ * Add a batch at the end of the list of batches with its state.
+ * @param index Index of the batch.
+ */
+void OnRideGuests::LinkBatch(int index)
+{
+	GuestBatch &gb = this->batches[index];
+	gb.prev = this->last[gb.state];
+	gb.next = -1;
+	if (gb.prev >= 0) {
+		this->batches[gb.prev].next = index;
+	} else {
+		this->first[gb.state] = index;
+	}
+	this->last[gb.state] = index;
+}
+
+/**
+ * Remove a batch from the list of batches with its state.
+ * @param index Index of the batch.
+ */
+void OnRideGuests::UnlinkBatch(int index)
+{
+	GuestBatch &gb = this->batches[index];
+	if (gb.prev >= 0) {
+		this->batches[gb.prev].next = gb.next;
+	} else {
+		this->first[gb.state] = gb.next;
+	}
+	if (gb.next >= 0) {
+		this->batches[gb.next].prev = gb.prev;
+	} else {
+		this->last[gb.state] = gb.prev;
+	}
+	gb.prev = -1;
+	gb.next = -1;
+}
+
+/**
+ * Change the state of a batch.
+ * @param index Index of the batch.
+ * @param state New state of the batch.
+ * @note A batch becoming #BST_EMPTY loses its guests.
+ */
+void OnRideGuests::SetBatchState(int index, BatchState state)
+{
+	GuestBatch &gb = this->batches[index];
+	if (state == BST_EMPTY) gb.Clear();
+	if (gb.state == state) return;
+
+	this->UnlinkBatch(index);
+	gb.state = state;
+	this->LinkBatch(index);
+}
+
+/**
+ * Start the ride for a batch (make it #BST_RUNNING).
+ * @param index Index of the batch.
+ * @param ride_time Length of the ride in milli-seconds.
+ */
+void OnRideGuests::StartBatch(int index, int ride_time)
+{
+	this->SetBatchState(index, BST_RUNNING);
+	this->batches[index].remaining = ride_time;
 }
 
 /**
  * Get the index of the next batch with a given state.
  * @param state State of the batch to look for.
- * @param start Last returned index number, or \c -1 to look from the first batch.
- * @return Index of the first batch with the given state after \a start, or \c -1 if no such batch exists.
+ * @param start Last returned index number, or \c -1 to get the first batch with the state.
+ * @return Index of the next batch with the given state, or \c -1 if no such batch exists.
  */
 int OnRideGuests::GetNextBatch(BatchState state, int start)
 {
-	start++;
-	while (start < static_cast<int>(this->batches.size())) {
-		const GuestBatch &gb = this->batches.at(start);
-		if (gb.state == state) return start;
+	if (start < 0) return this->first[state];
 
-		start++;
-	}
-	return -1;
+	assert(this->batches[start].state == state);
+	return this->batches[start].next;
 }
 
 /**
@@ -199,16 +262,19 @@ int OnRideGuests::GetNextBatch(BatchState state, int start)
  */
 void OnRideGuests::OnAnimate(int delay)
 {
-	int start = -1;
-	for (;;) {
-		start = this->GetNextBatch(BST_RUNNING, start);
-		if (start < 0) break;
-
-		this->batches.at(start).OnAnimate(delay);
+	for (int index = this->first[BST_RUNNING]; index >= 0;) {
+		GuestBatch &gb = this->batches[index];
+		const int next = gb.next;
+		if (gb.remaining > delay) {
+			gb.remaining -= delay;
+		} else {
+			gb.remaining = 0;
+			this->SetBatchState(index, BST_FINISHED);
+		}
+		index = next;
 	}
 }
 
-
 void OnRideGuests::Load(Loader &ldr)
 {
 	const uint32 version = ldr.OpenPattern("onrg");
@@ -218,6 +284,10 @@ void OnRideGuests::Load(Loader &ldr)
 	this->num_batches = ldr.GetWord();
 	this->Configure(this->batch_size, this->num_batches);
 	for (GuestBatch &b : this->batches) b.Load(ldr);
+
+	std::fill_n(this->first, lengthof(this->first), -1);
+	std::fill_n(this->last, lengthof(this->last), -1);
+	for (int i = 0; i < this->num_batches; i++) this->LinkBatch(i);
 	ldr.ClosePattern();
 }
 
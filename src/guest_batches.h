@@ -48,24 +48,50 @@ enum BatchState {
 	BST_RUNNING,   ///< Batch is running the ride.
 	BST_FINISHED,  ///< Batch has finished running, guests are waiting for unloading.
 	BST_UNLOADING, ///< Batch is unloading.
+
+	BST_COUNT,     ///< Number of batch states.
 };
 
 
-/** A batch (a group) of guests riding together. */
+/**
+ * A batch (a group) of guests riding together.
+ * Guests enter at the back of the #guests array and leave from its front, the entries in use are
+ * from #unloaded up to #loaded.
+ */
 struct GuestBatch {
-	std::vector<GuestData> guests; ///< Guests in the batch.
-	BatchState state; ///< State of the batch.
+	std::vector<GuestData> guests; ///< Guests in the batch, its size is the capacity of the batch.
+	BatchState state; ///< State of the batch. Change it with OnRideGuests::SetBatchState.
 	int remaining;    ///< Amount of time until the end of the ride (in milli-seconds). Positive means time is running,
 	                  ///< \c 0 means the batch has reached the end.
 	int gate;         ///< Gate used by the guests to enter the ride (or for any other purpose as the ride sees fit).
+	int loaded;       ///< Number of guests that entered the batch.
+	int unloaded;     ///< Number of guests that left the batch again.
+	int prev;         ///< Index of the previous batch with the same #state, \c -1 if it is the first one.
+	int next;         ///< Index of the next batch with the same #state, \c -1 if it is the last one.
+
+	/**
+	 * Return whether the batch is entirely empty.
+	 * @return Whether the batch is entirely empty.
+	 */
+	inline bool IsEmpty() const
+	{
+		return this->unloaded == this->loaded;
+	}
+
+	/**
+	 * Return whether no more guests can enter the batch.
+	 * @return Whether the batch is full.
+	 */
+	inline bool IsFull() const
+	{
+		return this->loaded == static_cast<int>(this->guests.size());
+	}
 
-	bool IsEmpty() const;
 	void Configure(int batch_size);
 
 	bool AddGuest(int guest, TileEdge entry);
-	void Start(int ride_time);
-
-	void OnAnimate(int delay);
+	bool RemoveGuest(GuestData *gd);
+	void Clear();
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
@@ -88,9 +114,12 @@ public:
 		return this->batches[index];
 	}
 
+	void SetBatchState(int index, BatchState state);
+	void StartBatch(int index, int ride_time);
+
 	/**
 	 * Get an empty batch.
-	 * @param start Index where the last search ended, or \c -1 to search from the start.
+	 * @param start Index of the previous returned batch (which must still have the same state), or \c -1 to get the first one.
 	 * @return Index of a free batch, or \c -1 if no free batch exists.
 	 */
 	inline int GetFreeBatch(int start = -1)
@@ -100,7 +129,7 @@ public:
 
 	/**
 	 * Get a batch that is being loaded.
-	 * @param start Index where the last search ended, or \c -1 to search from the start.
+	 * @param start Index of the previous returned batch (which must still have the same state), or \c -1 to get the first one.
 	 * @return Index of a loading batch, or \c -1 if no loading batch exists.
 	 */
 	inline int GetLoadingBatch(int start = -1)
@@ -110,7 +139,7 @@ public:
 
 	/**
 	 * Get a batch that has finished the ride.
-	 * @param start Index where the last search ended, or \c -1 to search from the start.
+	 * @param start Index of the previous returned batch (which must still have the same state), or \c -1 to get the first one.
 	 * @return Index of a finished batch, or \c -1 if no finished batch exists.
 	 */
 	inline int GetFinishedBatch(int start = -1)
@@ -120,7 +149,7 @@ public:
 
 	/**
 	 * Get a batch that is being unloaded.
-	 * @param start Index where the last search ended, or \c -1 to search from the start.
+	 * @param start Index of the previous returned batch (which must still have the same state), or \c -1 to get the first one.
 	 * @return Index of an unloading batch, or \c -1 if no unloading batch exists.
 	 */
 	inline int GetUnloadingBatch(int start = -1)
@@ -139,6 +168,11 @@ public:
 
 private:
 	int GetNextBatch(BatchState state, int start);
+	void LinkBatch(int index);
+	void UnlinkBatch(int index);
+
+	int first[BST_COUNT]; ///< For each batch state, index of the first batch in that state (\c -1 if none).
+	int last[BST_COUNT];  ///< For each batch state, index of the last batch in that state (\c -1 if none).
 };
 
 #endif
@@ -0,0 +1,83 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file headless.cpp Running the game simulation without user interface. */
+
+#include "stdafx.h"
+#include "headless.h"
+#include "gamecontrol.h"
+#include "gameobserver.h"
+#include "finances.h"
+#include "fileio.h"
+#include "loadsave.h"
+#include "dates.h"
+#include "people.h"
+#include "ride_type.h"
+
+/**
+ * Convert a duration to seconds.
+ * @param duration Duration to convert.
+ * @return The duration in seconds.
+ */
+static double ToSeconds(std::chrono::nanoseconds duration)
+{
+	return std::chrono::duration<double>(duration).count();
+}
+
+/**
+ * Load a saved game and run its simulation for some time without creating any window, then report
+ * the simulation speed, the time spent in each subsystem, and the state of the park.
+ * @param fname Name of the savegame file to load.
+ * @param ticks Number of ticks to simulate.
+ * @param save_fname If not empty, the file to save the resulting park to.
+ * @return Exit code of the program.
+ * @pre The RCD files and the language must have been loaded.
+ */
+int RunHeadlessSimulation(const std::string &fname, uint32 ticks, const std::string &save_fname)
+{
+	if (!LoadGameFile(fname.c_str())) {
+		fprintf(stderr, "ERROR: Loading '%s' failed.\n", fname.c_str());
+		return 1;
+	}
+	_game_mode_mgr.SetGameMode(GM_PLAY);
+
+	printf("Simulating %u ticks (%.1f days) of '%s'.\n", ticks, ticks / static_cast<double>(TICK_COUNT_PER_DAY), fname.c_str());
+
+	TickSubsystemTimes times;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32 tick = 0; tick < ticks; tick++) OnNewTick(FRAME_DELAY, &times);
+	const double total = ToSeconds(std::chrono::steady_clock::now() - start);
+
+	printf("Simulated %u ticks in %.3f s: %.1f ticks/s\n", ticks, total, total > 0 ? ticks / total : 0.0);
+	printf("Subsystem times:\n");
+	for (int i = 0; i < TSS_COUNT; i++) {
+		const double seconds = ToSeconds(times.duration[i]);
+		printf("  %-10s %9.3f s  %5.1f%%\n", _tick_subsystem_names[i], seconds, total > 0 ? 100.0 * seconds / total : 0.0);
+	}
+
+	uint32 rides = 0;
+	for (const auto &kind : _rides_manager.kind_instances) rides += kind.size();
+	printf("Park statistics on %d-%02d-%02d:\n", _date.year, _date.month, _date.day);
+	printf("  Guests in park : %u (%u active)\n", _guests.CountGuestsInPark(), _guests.CountActiveGuests());
+	printf("  Park rating    : %u\n", _game_observer.current_park_rating);
+	printf("  Cash           : %.2f\n", static_cast<int64>(_finances_manager.GetCash()) / 100.0);
+	printf("  Park value     : %.2f\n", static_cast<int64>(_finances_manager.GetParkValue()) / 100.0);
+	printf("  Rides          : %u\n", rides);
+
+	int result = 0;
+	if (!save_fname.empty()) {
+		if (SaveGameFile(save_fname.c_str())) {
+			printf("Saved the park to '%s'.\n", save_fname.c_str());
+		} else {
+			fprintf(stderr, "ERROR: Saving to '%s' failed.\n", save_fname.c_str());
+			result = 1;
+		}
+	}
+
+	_game_control.Uninitialize();
+	return result;
+}
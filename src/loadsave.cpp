@@ -14,12 +14,15 @@
 #include "map.h"
 #include "messages.h"
 #include "scenery.h"
+#include "path_graph.h"
+#include "queue.h"
 #include "string_func.h"
 #include "person.h"
 #include "people.h"
 #include "gamelevel.h"
 #include "gameobserver.h"
 #include "rev.h"
+#include "trace.h"
 
 /** Whether savegame files should automatically be resaved after loading. */
 bool _automatically_resave_files = false;
@@ -81,7 +84,10 @@ uint32 Loader::OpenPattern(const char *name, bool may_fail, bool name_only)
 				i--;
 				this->PutByte(name[i]);
 			}
-			if (may_fail) return UINT32_MAX;
+			if (may_fail) {
+				this->pattern_names.pop_back();
+				return UINT32_MAX;
+			}
 			throw LoadingError("Missing pattern name for %s", name);
 			return 0;
 		}
@@ -226,7 +232,12 @@ void Loader::VersionMismatch(uint saved_version, uint current_version)
  * Constructor for the saver.
  * @param file Output file stream to write to.
  */
-Saver::Saver(FILE *file) : fp(file)
+Saver::Saver(FILE *file) : fp(file), checksum(0)
+{
+}
+
+/** Constructor for a saver that does not write the data anywhere, but computes a checksum of it. */
+Saver::Saver() : fp(nullptr), checksum(UINT64_C(0xcbf29ce484222325))
 {
 }
 
@@ -277,7 +288,11 @@ void Saver::EndPattern()
  */
 void Saver::PutByte(uint8 val)
 {
-	putc(val, this->fp);
+	if (this->fp != nullptr) {
+		putc(val, this->fp);
+	} else {
+		this->checksum = (this->checksum ^ val) * UINT64_C(0x100000001b3); // FNV-1a.
+	}
 }
 
 /**
@@ -408,21 +423,19 @@ static void LoadElements(Loader &ldr, const PreloadData &preload)
 	_staff.Load(ldr);
 	_inbox.Load(ldr);
 	Random::Load(ldr);
+
+	_path_graph.Rebuild();
+	_queues.Rebuild();
 }
 
 /**
- * Write the game elements to the output stream.
+ * Write the state of the game to the output stream, that is, the game elements without the savegame header.
  * @param svr Output stream to write to.
+ * @param with_inbox Whether to write the inbox messages.
  * @note Order of saving should be the same as in #LoadElements.
  */
-static void SaveElements(Saver &svr)
+static void SaveGameState(Saver &svr, bool with_inbox = true)
 {
-	svr.StartPattern("FCTS", CURRENT_VERSION_FCTS);
-	svr.PutLongLong(std::time(nullptr));
-	svr.PutText(_freerct_revision);
-	_scenario.Save(svr);
-	svr.EndPattern();
-
 	SaveDate(svr);
 	_world.Save(svr);
 	_finances_manager.Save(svr);
@@ -432,12 +445,27 @@ static void SaveElements(Saver &svr)
 	_scenery.Save(svr);
 	_guests.Save(svr);
 	_staff.Save(svr);
-	_inbox.Save(svr);
+	if (with_inbox) _inbox.Save(svr);
 	Random::Save(svr);
 
 	svr.CheckNoOpenPattern();
 }
 
+/**
+ * Write the game elements to the output stream.
+ * @param svr Output stream to write to.
+ */
+static void SaveElements(Saver &svr)
+{
+	svr.StartPattern("FCTS", CURRENT_VERSION_FCTS);
+	svr.PutLongLong(std::time(nullptr));
+	svr.PutText(_freerct_revision);
+	_scenario.Save(svr);
+	svr.EndPattern();
+
+	SaveGameState(svr);
+}
+
 /**
  * Load a file as saved game.
  * @param ldr Loader to read the game data.
@@ -448,6 +476,15 @@ void LoadGame(Loader &ldr)
 	LoadElements(ldr, pd);
 }
 
+/**
+ * Write the game as saved game.
+ * @param svr Saver to write the game data.
+ */
+void SaveGame(Saver &svr)
+{
+	SaveElements(svr);
+}
+
 /**
  * Load a file as saved game. Loading from \c nullptr means initializing to default.
  * @param fname Name of the file to load. Use \c nullptr to initialize to default.
@@ -455,6 +492,7 @@ void LoadGame(Loader &ldr)
  */
 bool LoadGameFile(const char *fname)
 {
+	TraceScope trace("LoadGameFile");
 	try {
 		FILE *fp = nullptr;
 		if (fname != nullptr) {
@@ -518,6 +556,7 @@ PreloadData PreloadGameFile(const char *fname)
  */
 bool SaveGameFile(const char *fname)
 {
+	TraceScope trace("SaveGameFile");
 	FILE *fp = fopen(fname, "wb");
 	if (fp == nullptr) return false;
 
@@ -532,3 +571,19 @@ bool SaveGameFile(const char *fname)
 	return true;
 }
 
+
+/**
+ * Compute a checksum of the current game state, without writing it anywhere.
+ * @return Checksum of the data that would be written to a saved game, except the inbox messages.
+ */
+uint64 ComputeGameChecksum()
+{
+	TraceScope trace("ComputeGameChecksum");
+	/* The item being placed by the scenery window is shown in the world, but is not part of the park. */
+	SceneryInstance *preview = _scenery.temp_item;
+	if (preview != nullptr) preview->RemoveFromWorld();
+	Saver svr;
+	SaveGameState(svr, false);  // The inbox only notifies the player, its messages follow from the rest of the game.
+	if (preview != nullptr) preview->InsertIntoWorld();
+	return svr.GetChecksum();
+}
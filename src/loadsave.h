@@ -58,6 +58,7 @@ private:
 class Saver {
 public:
 	Saver(FILE *fp);
+	Saver();
 
 	void StartPattern(const char *name);
 	void StartPattern(const char *name, uint32 version);
@@ -71,8 +72,20 @@ public:
 
 	void CheckNoOpenPattern() const;
 
+	/**
+	 * Get the checksum of the data written so far.
+	 * @return Checksum of the written data.
+	 * @pre The saver does not write to a file.
+	 */
+	inline uint64 GetChecksum() const
+	{
+		assert(this->fp == nullptr);
+		return this->checksum;
+	}
+
 private:
-	FILE *fp; ///< Output file stream.
+	FILE *fp;        ///< Output file stream, \c nullptr to only compute a checksum of the data.
+	uint64 checksum; ///< Checksum of the data written so far, if not writing to a file.
 	std::vector<std::string> pattern_names; ///< Stack of the current pattern names.
 };
 
@@ -97,10 +110,12 @@ struct PreloadData {
 };
 
 void LoadGame(Loader &ldr);
+void SaveGame(Saver &svr);
 bool LoadGameFile(const char *fname);
 bool SaveGameFile(const char *fname);
 PreloadData Preload(Loader &ldr);
 PreloadData PreloadGameFile(const char *fname);
+uint64 ComputeGameChecksum();
 
 extern bool _automatically_resave_files;
 
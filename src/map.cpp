@@ -17,6 +17,7 @@
 #include "viewport.h"
 #include "math_func.h"
 #include "sprite_store.h"
+#include "memory_usage.h"
 
 /**
  * The game world.
@@ -24,9 +25,12 @@
  */
 VoxelWorld _world;
 
+uint32 _voxel_generation = 0; ///< Number of changes of voxel ride instances and ground slopes, for detecting changes in the surroundings of rides.
+
 /** Make the voxel empty. */
 void Voxel::ClearVoxel()
 {
+	this->ground = 0; // Also clear the unused bits, to make saved games reproducible.
 	this->SetGroundType(GTP_INVALID);
 	this->SetFoundationType(FDT_INVALID);
 	this->SetGroundSlope(ISL_FLAT);
@@ -49,7 +53,7 @@ void Voxel::Load(Loader &ldr)
 	this->ClearVoxel();
 	if (version >= 1 && version <= CURRENT_VERSION_Voxel) {
 		this->ground = ldr.GetLong(); /// \todo Check sanity of the data.
-		this->instance = ldr.GetByte();
+		this->instance = ldr.GetByte(); // Only small ride instances are stored in the voxel, they always fit in a byte.
 		if (this->instance == SRI_FREE) {
 			this->instance_data = 0; // Full rides load after the world, overwriting map data.
 		} else if (this->instance >= SRI_RIDES_START && this->instance < SRI_FULL_RIDES) {
@@ -78,6 +82,7 @@ void Voxel::Save(Saver &svr) const
 	svr.StartPattern("voxl", CURRENT_VERSION_Voxel);
 	svr.PutLong(this->ground);
 	if (this->instance >= SRI_RIDES_START && this->instance < SRI_FULL_RIDES) {
+		static_assert(SRI_FULL_RIDES <= 0x100, "Small ride instances are saved as a byte.");
 		svr.PutByte(this->instance);
 		svr.PutWord(this->instance_data);
 	} else {
@@ -393,11 +398,15 @@ void VoxelStack::Load(Loader &ldr)
 void VoxelStack::Save(Saver &svr) const
 {
 	svr.CheckNoOpenPattern();
+	/* Empty voxels at the top of the stack hold no data, and only exist because some code asked for them (for example a preview of a scenery item). */
+	uint16 height = this->height;
+	while (height > 0 && this->voxels[height - 1]->IsEmpty() && this->voxels[height - 1]->GetFences() == ALL_INVALID_FENCES) height--;
+
 	svr.StartPattern("VSTK", CURRENT_VERSION_VSTK);
 	svr.PutWord(this->base);
-	svr.PutWord(this->height);
+	svr.PutWord(height);
 	svr.PutByte(this->owner);
-	for (uint i = 0; i < this->height; i++) this->voxels[i]->Save(svr);
+	for (uint i = 0; i < height; i++) this->voxels[i]->Save(svr);
 	svr.EndPattern();
 }
 
@@ -775,6 +784,25 @@ void VoxelWorld::Load(Loader &ldr)
 	if (version == 0) this->MakeFlatWorld(8);
 }
 
+/**
+ * Add the memory used by the voxel stacks and the voxels to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void VoxelWorld::AddMemoryUsage(MemoryReport &report) const
+{
+	size_t stack_bytes = sizeof(this->stacks) + this->edges_without_border_fence.size() *
+			(sizeof(*this->edges_without_border_fence.begin()) + MemoryReport::NODE_OVERHEAD);
+	size_t voxel_count = 0;
+	for (const VoxelStack &vs : this->stacks) {
+		stack_bytes += vs.voxels.capacity() * sizeof(vs.voxels[0]);
+		for (const auto &voxel : vs.voxels) {
+			if (voxel != nullptr) voxel_count++;
+		}
+	}
+	report.Add(MO_VOXEL_STACKS, this->x_size * this->y_size, stack_bytes);
+	report.Add(MO_VOXELS, voxel_count, voxel_count * sizeof(Voxel));
+}
+
 /**
  * Save the world to a file.
  * @param svr Output stream to save to.
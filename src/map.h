@@ -20,6 +20,7 @@
 #include <set>
 
 class Viewport;
+class MemoryReport;
 
 static const int WORLD_X_SIZE = 128; ///< Maximal length of the X side (North-West side) of the world.
 static const int WORLD_Y_SIZE = 128; ///< Maximal length of the Y side (North-East side) of the world.
@@ -43,11 +44,13 @@ enum SmallRideInstance {
 	SRI_SCENERY,                ///< Scenery items.
 	SRI_FULL_RIDES, ///< First ride instance number for normal rides (created and stored in #RidesManager).
 
-	SRI_LAST = 255, ///< Biggest possible ride number.
+	SRI_LAST = 0xFFFE, ///< Biggest possible ride number.
 };
 
 class VoxelObject;
 
+extern uint32 _voxel_generation;
+
 /**
  * One voxel cell in the world.
  * A voxel consists of four parts and the ground data.
@@ -61,7 +64,7 @@ class VoxelObject;
  */
 struct Voxel {
 public:
-	uint8 instance;       ///< Ride instances that uses this voxel.
+	uint16 instance;      ///< Ride instances that uses this voxel. Uses the padding before #instance_data, the voxel does not get bigger by it.
 	uint16 instance_data; ///< %Voxel data of the #instance stored here.
 
 	/** Constructor */
@@ -86,6 +89,7 @@ public:
 	inline void SetInstance(SmallRideInstance instance)
 	{
 		this->instance = instance;
+		_voxel_generation++;
 	}
 
 	/**
@@ -248,6 +252,7 @@ public:
 	{
 		assert(gnd_slope < 15 + 4 + 4); // 15 non-steep, 4 bottom, 4 top sprites.
 		SB(this->ground, 16, 5, gnd_slope);
+		_voxel_generation++;
 	}
 
 	/**
@@ -646,6 +651,7 @@ public:
 
 	void Save(Saver &svr) const;
 	void Load(Loader &ldr);
+	void AddMemoryUsage(MemoryReport &report) const;
 
 private:
 	uint16 x_size; ///< Current max x size (in voxels).
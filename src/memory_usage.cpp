@@ -0,0 +1,184 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file memory_usage.cpp Accounting of the memory used by the large data structures of the program. */
+
+#include "stdafx.h"
+#include "memory_usage.h"
+#include "fileio.h"
+#include "rev.h"
+#include "string_func.h"
+#include "sprite_data.h"
+#include "video.h"
+#include "map.h"
+#include "people.h"
+#include "scenery.h"
+#include "ride_type.h"
+#include "trace.h"
+#include <chrono>
+#include <csignal>
+#include <ctime>
+
+bool _memory_report_at_exit = false; ///< Whether to print the memory report when the game is uninitialized.
+
+static volatile std::sig_atomic_t _memory_report_requested = 0; ///< Whether a memory report was requested by a signal.
+
+/** Names of the memory owners, for reporting. */
+static const char * const _memory_owner_names[MO_COUNT] = {
+	"sprites",
+	"scaled",
+	"textures",
+	"glyphs",
+	"stacks",
+	"voxels",
+	"guests",
+	"guest-colours",
+	"guest-names",
+	"staff",
+	"scenery",
+	"coaster-track",
+	"coaster-stats",
+};
+
+MemoryReport::MemoryReport()
+{
+	for (MemoryUsage &mu : this->usage) mu = {0, 0};
+}
+
+/**
+ * Get the name of a memory owner.
+ * @param owner Owner to name.
+ * @return Short name of the owner.
+ */
+/* static */ const char *MemoryReport::GetOwnerName(MemoryOwner owner)
+{
+	assert(owner < MO_COUNT);
+	return _memory_owner_names[owner];
+}
+
+/**
+ * Get the memory used by all owners together.
+ * @return Total number of bytes.
+ */
+size_t MemoryReport::GetTotalBytes() const
+{
+	size_t total = 0;
+	for (const MemoryUsage &mu : this->usage) total += mu.bytes;
+	return total;
+}
+
+/**
+ * Format the report as a table with a line for every owner, and the total.
+ * @return Lines of the table.
+ */
+std::vector<std::string> MemoryReport::GetLines() const
+{
+	std::vector<std::string> lines;
+	lines.push_back(Format("%-13s %9s %11s", "owner", "count", "KiB"));
+	for (int o = 0; o < MO_COUNT; o++) {
+		const MemoryUsage &mu = this->usage[o];
+		lines.push_back(Format("%-13s %9zu %11.1f", GetOwnerName(static_cast<MemoryOwner>(o)), mu.count, mu.bytes / 1024.0));
+	}
+	lines.push_back(Format("%-13s %9s %11.1f", "total", "", this->GetTotalBytes() / 1024.0));
+	return lines;
+}
+
+/**
+ * Walk over the owners, and collect the memory they use.
+ * @return The memory used by every owner.
+ */
+MemoryReport CollectMemoryReport()
+{
+	TraceScope trace("CollectMemoryReport");
+	MemoryReport report;
+	AddImageMemoryUsage(report);
+	_image_variants.AddMemoryUsage(report);
+	_video.AddMemoryUsage(report);
+	_text_renderer.AddMemoryUsage(report);
+	_world.AddMemoryUsage(report);
+	_guests.AddMemoryUsage(report);
+	_staff.AddMemoryUsage(report);
+	_scenery.AddMemoryUsage(report);
+	_rides_manager.AddMemoryUsage(report);
+	return report;
+}
+
+/**
+ * Get a memory report for displaying it every frame. Walking over the world is too slow to do every frame,
+ * so the report is collected again only if it is older than a second.
+ * @return A recent memory report.
+ */
+const MemoryReport &GetRecentMemoryReport()
+{
+	static MemoryReport report;
+	static std::chrono::steady_clock::time_point collected;
+
+	const auto now = std::chrono::steady_clock::now();
+	if (collected.time_since_epoch().count() == 0 || now - collected >= std::chrono::seconds(1)) {
+		report = CollectMemoryReport();
+		collected = now;
+	}
+	return report;
+}
+
+/**
+ * Collect a memory report, and print it.
+ * @param fp Output stream to print to.
+ */
+void PrintMemoryReport(FILE *fp)
+{
+	fprintf(fp, "Memory usage (estimated, textures and glyphs are in graphics memory):\n");
+	for (const std::string &line : CollectMemoryReport().GetLines()) fprintf(fp, "  %s\n", line.c_str());
+	fflush(fp);
+}
+
+/**
+ * Write a memory report to a new file in the user data directory.
+ * @return Name of the written file, or an empty string if writing failed.
+ */
+std::string ExportMemoryReport()
+{
+	char stamp[32];
+	const std::time_t now = std::time(nullptr);
+	std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+	const std::string fname = freerct_userdata_prefix() + DIR_SEP + "memory_" + stamp + ".txt";
+
+	FILE *fp = fopen(fname.c_str(), "w");
+	if (fp == nullptr) return std::string();
+
+	PrintMemoryReport(fp);
+	const bool ok = ferror(fp) == 0;
+	fclose(fp);
+	return ok ? fname : std::string();
+}
+
+#ifdef SIGUSR1
+/**
+ * Signal handler requesting a memory report. Collecting the report is not safe inside a signal handler,
+ * it is done by #HandleMemoryReportSignal instead.
+ */
+static void MemoryReportSignalHandler(int)
+{
+	_memory_report_requested = 1;
+}
+#endif
+
+/** Print a memory report when the program receives \c SIGUSR1, on systems that have it. */
+void InstallMemoryReportSignal()
+{
+#ifdef SIGUSR1
+	std::signal(SIGUSR1, MemoryReportSignalHandler);
+#endif
+}
+
+/** Print the memory report requested by a signal, if any. Called from the game loop. */
+void HandleMemoryReportSignal()
+{
+	if (_memory_report_requested == 0) return;
+	_memory_report_requested = 0;
+	PrintMemoryReport(stdout);
+}
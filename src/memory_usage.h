@@ -0,0 +1,91 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file memory_usage.h Accounting of the memory used by the large data structures of the program. */
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <string>
+#include <vector>
+
+/** Owners of memory that are accounted for. */
+enum MemoryOwner {
+	MO_SPRITES,             ///< Decoded sprites of the RCD files, see #ImageData.
+	MO_SCALED_SPRITES,      ///< Scaled copies of sprites, see #ImageVariants.
+	MO_SPRITE_TEXTURES,     ///< Textures of the sprites in graphics memory, see VideoSystem::GetImageTexture.
+	MO_GLYPH_TEXTURES,      ///< Textures of the font glyphs in graphics memory, see #TextRenderer.
+	MO_VOXEL_STACKS,        ///< Voxel stacks of the world, see #VoxelStack.
+	MO_VOXELS,              ///< Voxels of the world, see #Voxel.
+	MO_GUESTS,              ///< Guest slots without their colours and names, see #Guests.
+	MO_GUEST_COLOURS,       ///< Recolourings of the guest slots, see #Recolouring.
+	MO_GUEST_NAMES,         ///< Custom names of guests.
+	MO_STAFF,               ///< Staff members, see #Staff.
+	MO_SCENERY,             ///< Scenery items and path objects in the world, see #SceneryManager.
+	MO_COASTER_TRACKS,      ///< Placed track pieces of the roller coasters, see #CoasterInstance.
+	MO_COASTER_STATISTICS,  ///< Intensity statistics along the tracks of the roller coasters.
+
+	MO_COUNT,               ///< Number of memory owners.
+};
+
+/** Memory used by one owner. */
+struct MemoryUsage {
+	size_t count; ///< Number of objects of the owner.
+	size_t bytes; ///< Number of bytes used by the owner, including the bookkeeping of its containers.
+};
+
+/**
+ * Estimate of the memory used by the owners. Containers are counted by their capacity, and a node of a
+ * map, set, or list costs #NODE_OVERHEAD bytes next to its value, so the numbers are not exact.
+ */
+class MemoryReport {
+public:
+	static constexpr size_t NODE_OVERHEAD = 4 * sizeof(void *); ///< Estimated bookkeeping of a node of a map, set, or list.
+
+	MemoryReport();
+
+	/**
+	 * Add memory to an owner.
+	 * @param owner Owner of the memory.
+	 * @param count Number of objects added.
+	 * @param bytes Number of bytes added.
+	 */
+	inline void Add(MemoryOwner owner, size_t count, size_t bytes)
+	{
+		this->usage[owner].count += count;
+		this->usage[owner].bytes += bytes;
+	}
+
+	size_t GetTotalBytes() const;
+	std::vector<std::string> GetLines() const;
+
+	static const char *GetOwnerName(MemoryOwner owner);
+
+	MemoryUsage usage[MO_COUNT]; ///< Memory used by each owner.
+};
+
+/**
+ * Get the memory allocated by a string outside its own object.
+ * @param str String to examine.
+ * @return Number of bytes allocated for the characters, \c 0 if they are stored inside the string.
+ */
+inline size_t GetStringHeapSize(const std::string &str)
+{
+	return (str.capacity() > std::string().capacity()) ? str.capacity() + 1 : 0;
+}
+
+MemoryReport CollectMemoryReport();
+const MemoryReport &GetRecentMemoryReport();
+void PrintMemoryReport(FILE *fp);
+std::string ExportMemoryReport();
+
+void InstallMemoryReportSignal();
+void HandleMemoryReportSignal();
+
+extern bool _memory_report_at_exit;
+
+#endif
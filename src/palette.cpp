@@ -141,11 +141,12 @@ void Recolouring::Set(int index, const RecolourEntry &entry)
 	this->InvalidateColourMap();
 }
 
-/** Select random destination colour ranges for the recolour entries. */
-void Recolouring::AssignRandomColours()
+/**
+ * Select random destination colour ranges for the recolour entries.
+ * @param rnd Random number generator to use.
+ */
+void Recolouring::AssignRandomColours(Random &rnd)
 {
-	Random rnd;
-
 	for (uint i = 0; i < lengthof(this->entries); i++) {
 		RecolourEntry &re = this->entries[i];
 		if (re.source != COL_RANGE_INVALID && re.dest == COL_RANGE_INVALID) {
@@ -440,7 +440,7 @@ public:
 
 	void Reset();
 	void Set(int index, const RecolourEntry &entry);
-	void AssignRandomColours();
+	void AssignRandomColours(Random &rnd);
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
@@ -0,0 +1,676 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file park_generator.cpp Building large parks automatically, for testing and profiling. */
+
+#include "stdafx.h"
+#include "park_generator.h"
+#include "map.h"
+#include "path_build.h"
+#include "viewport.h"
+#include "terraform.h"
+#include "shop_type.h"
+#include "gentle_thrill_ride_type.h"
+#include "coaster.h"
+#include "scenery.h"
+#include "gamecontrol.h"
+#include "gamelevel.h"
+#include "gameobserver.h"
+#include "loadsave.h"
+#include "messages.h"
+#include "weather.h"
+#include "dates.h"
+#include "random.h"
+#include <cmath>
+
+/** A named set of park generator settings. */
+struct ParkGeneratorPreset {
+	const char *name;     ///< Name of the preset.
+	uint16 world_size;    ///< Length of the sides of the world.
+	uint16 coverage;      ///< Percentage of the world owned by the park.
+	uint16 path_density;  ///< Density of the path network.
+	uint16 rides;         ///< Number of gentle and thrill rides.
+	uint16 shops;         ///< Number of shops.
+	uint16 coasters;      ///< Number of roller coasters.
+	uint16 scenery;       ///< Percentage of the remaining park tiles with scenery.
+	uint32 guests;        ///< Guest target.
+};
+
+/** Presets of the park generator, the first one is the default. */
+static const ParkGeneratorPreset _park_generator_presets[] = {
+	{"small",   48, 60, 40,  6,  6, 1, 20,  500},
+	{"medium",  80, 70, 50, 20, 20, 3, 30, 2000},
+	{"huge",   127, 85, 60, 60, 60, 8, 40, 8000},
+};
+
+static const int MAX_PLACEMENT_ATTEMPTS = 4000; ///< Maximal number of positions tried for placing a single ride.
+
+ParkGeneratorSettings::ParkGeneratorSettings() : seed(1)
+{
+	this->SetPreset(_park_generator_presets[0].name);
+}
+
+/**
+ * Use the settings of a preset.
+ * @param name Name of the preset.
+ * @return Whether the preset exists.
+ */
+bool ParkGeneratorSettings::SetPreset(const std::string &name)
+{
+	for (const ParkGeneratorPreset &p : _park_generator_presets) {
+		if (name != p.name) continue;
+
+		this->preset = p.name;
+		this->world_size = p.world_size;
+		this->coverage = p.coverage;
+		this->path_density = p.path_density;
+		this->rides = p.rides;
+		this->shops = p.shops;
+		this->coasters = p.coasters;
+		this->scenery = p.scenery;
+		this->guests = p.guests;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Set the settings from a textual specification, like <tt>medium,seed=3,coasters=5</tt>.
+ * The specification is a comma-separated list of an optional preset name and \c key=value assignments.
+ * @param spec Specification of the settings.
+ * @return Whether the specification is valid. If not, an error has been printed.
+ */
+bool ParkGeneratorSettings::Parse(const std::string &spec)
+{
+	size_t start = 0;
+	while (start <= spec.size()) {
+		size_t end = spec.find(',', start);
+		if (end == std::string::npos) end = spec.size();
+		const std::string item = spec.substr(start, end - start);
+		start = end + 1;
+		if (item.empty()) continue;
+
+		const size_t eq = item.find('=');
+		if (eq == std::string::npos) {
+			if (!this->SetPreset(item)) {
+				fprintf(stderr, "ERROR: Unknown park generator preset '%s'.\n", item.c_str());
+				return false;
+			}
+			continue;
+		}
+
+		const std::string key = item.substr(0, eq);
+		const std::string value = item.substr(eq + 1);
+		char *value_end;
+		const unsigned long long number = strtoull(value.c_str(), &value_end, 10);
+		if (value.empty() || *value_end != '\0') {
+			fprintf(stderr, "ERROR: Invalid value '%s' of park generator setting '%s'.\n", value.c_str(), key.c_str());
+			return false;
+		}
+
+		/* Setting, minimal value, and maximal value for each key. */
+		uint64 max = 10000;
+		uint64 min = 0;
+		if (key == "seed" || key == "guests") {
+			max = (key == "seed") ? (1ULL << 56) - 1 : 1000000;  // The seed identifies a random stream, see Random::SetStream.
+			if (number > max) {
+				fprintf(stderr, "ERROR: Park generator setting '%s' must be between 0 and %llu.\n", key.c_str(),
+						static_cast<unsigned long long>(max));
+				return false;
+			}
+			if (key == "seed") {
+				this->seed = number;
+			} else {
+				this->guests = number;
+			}
+			continue;
+		}
+		uint16 *setting;
+		if (key == "size") {
+			setting = &this->world_size;
+			min = 16;
+			max = std::min(WORLD_X_SIZE, WORLD_Y_SIZE) - 1;
+		} else if (key == "coverage") {
+			setting = &this->coverage;
+			min = 10;
+			max = 100;
+		} else if (key == "paths") {
+			setting = &this->path_density;
+			max = 100;
+		} else if (key == "scenery") {
+			setting = &this->scenery;
+			max = 100;
+		} else if (key == "rides") {
+			setting = &this->rides;
+		} else if (key == "shops") {
+			setting = &this->shops;
+		} else if (key == "coasters") {
+			setting = &this->coasters;
+		} else {
+			fprintf(stderr, "ERROR: Unknown park generator setting '%s'.\n", key.c_str());
+			return false;
+		}
+		if (number < min || number > max) {
+			fprintf(stderr, "ERROR: Park generator setting '%s' must be between %u and %u.\n", key.c_str(),
+					static_cast<uint>(min), static_cast<uint>(max));
+			return false;
+		}
+		*setting = number;
+	}
+	return true;
+}
+
+/** Number of things the park generator built. */
+struct ParkGeneratorStatistics {
+	uint32 paths = 0;         ///< Number of path tiles.
+	uint32 path_objects = 0;  ///< Number of benches, litter bins, and lamps.
+	uint32 scenery = 0;       ///< Number of scenery items.
+	uint32 rides = 0;         ///< Number of gentle and thrill rides.
+	uint32 shops = 0;         ///< Number of shops.
+	uint32 coasters = 0;      ///< Number of roller coasters.
+};
+
+/**
+ * Builds a park in an empty world, through the same functions the construction windows use.
+ *
+ * The park is a square in the middle of the world. It is divided into lots by a grid of streets, with a road leading
+ * from the north-west edge of the world to the park for the arriving guests. Rides, shops, and coasters are placed in
+ * the lots with their entrances and exits next to a street, the remaining tiles get scenery. The land around the park
+ * gets hills.
+ */
+class ParkGenerator {
+public:
+	explicit ParkGenerator(const ParkGeneratorSettings &settings);
+
+	void Generate();
+
+	ParkGeneratorStatistics stats;  ///< What was built.
+
+private:
+	void MakeTerrain();
+	void MakeStreets();
+	void PlaceRides();
+	bool PlaceShop(const ShopType *type);
+	bool PlaceGentleThrillRide(const GentleThrillRideType *type);
+	bool PlaceCoaster(const CoasterType *type, const TrackedRideDesign &design);
+	bool PlaceCoasterEntrances(CoasterInstance *ci);
+	void PlacePathObjects();
+	void PlaceScenery();
+	void SetupScenario();
+
+	bool IsStreet(int x, int y) const;
+	bool IsNextToPath(const XYZPoint16 &pos) const;
+	XYZPoint16 GroundVoxel(int x, int y) const;
+	std::vector<Point16> GetShuffledLotTiles(bool next_to_street);
+
+	const ParkGeneratorSettings &settings;  ///< Settings of the generator.
+	Random rnd;                             ///< Random number generator.
+	Rectangle16 park;                       ///< Area of the park.
+	uint16 spacing;                         ///< Distance between two parallel streets.
+	uint16 road_x;                          ///< X coordinate of the road leading to the park.
+};
+
+/**
+ * Constructor of the park generator.
+ * @param settings Settings of the generator.
+ */
+ParkGenerator::ParkGenerator(const ParkGeneratorSettings &settings) : settings(settings), rnd(RSK_PARK_GENERATOR, settings.seed)
+{
+	const uint16 size = settings.world_size;
+	const uint16 side = std::max<int>(8, std::min<int>(size, std::lround(size * std::sqrt(settings.coverage / 100.0))));
+	this->park = Rectangle16((size - side) / 2, (size - side) / 2, side, side);
+	this->spacing = 12 - settings.path_density * 9 / 100;
+
+	/* The road joins the street column nearest to the middle of the world. */
+	const int columns = (side - 1) / this->spacing;
+	this->road_x = this->park.base.x + (columns / 2) * this->spacing;
+}
+
+/** Build the park. */
+void ParkGenerator::Generate()
+{
+	_world.SetWorldSize(this->settings.world_size, this->settings.world_size);
+	_world.MakeFlatWorld(8);
+	this->MakeTerrain();
+
+	_world.SetTileOwnerGlobally(OWN_FOR_SALE);
+	_world.SetTileOwnerRect(this->park.base.x, this->park.base.y, this->park.width, this->park.height, OWN_PARK);
+	if (this->park.base.y > 0) _world.AddEdgesWithoutBorderFence(Point16(this->road_x, this->park.base.y - 1), EDGE_SE);
+
+	this->MakeStreets();
+	this->PlaceRides();
+	this->PlacePathObjects();
+	this->PlaceScenery();
+	this->SetupScenario();
+}
+
+/**
+ * Is the given tile part of the street grid of the park, or of the road leading to it?
+ * @param x X coordinate of the tile.
+ * @param y Y coordinate of the tile.
+ * @return Whether a street is built at the tile.
+ */
+bool ParkGenerator::IsStreet(int x, int y) const
+{
+	if (x == this->road_x && y < this->park.base.y) return true;
+	if (!this->park.IsPointInside(Point16(x, y))) return false;
+	return (x - this->park.base.x) % this->spacing == 0 || (y - this->park.base.y) % this->spacing == 0;
+}
+
+/**
+ * Get the voxel at the ground of a tile.
+ * @param x X coordinate of the tile.
+ * @param y Y coordinate of the tile.
+ * @return Coordinate of the ground voxel.
+ */
+XYZPoint16 ParkGenerator::GroundVoxel(int x, int y) const
+{
+	return XYZPoint16(x, y, _world.GetBaseGroundHeight(x, y));
+}
+
+/**
+ * Is a path running at the bottom of one of the neighbouring voxels?
+ * @param pos Coordinate of the voxel.
+ * @return Whether the voxel can be reached from a path.
+ */
+bool ParkGenerator::IsNextToPath(const XYZPoint16 &pos) const
+{
+	for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+		if (PathExistsAtBottomEdge(pos, edge)) return true;
+	}
+	return false;
+}
+
+/**
+ * Get the park tiles that are not part of a street, in random order.
+ * @param next_to_street Only return tiles that are next to a street.
+ * @return The tiles.
+ */
+std::vector<Point16> ParkGenerator::GetShuffledLotTiles(bool next_to_street)
+{
+	std::vector<Point16> tiles;
+	for (int x = this->park.base.x; x < this->park.base.x + this->park.width; x++) {
+		for (int y = this->park.base.y; y < this->park.base.y + this->park.height; y++) {
+			if (this->IsStreet(x, y)) continue;
+			if (next_to_street && !this->IsStreet(x - 1, y) && !this->IsStreet(x + 1, y) &&
+					!this->IsStreet(x, y - 1) && !this->IsStreet(x, y + 1)) {
+				continue;
+			}
+			tiles.emplace_back(x, y);
+		}
+	}
+	for (size_t i = tiles.size(); i > 1; i--) std::swap(tiles[i - 1], tiles[this->rnd.Uniform(i - 1)]);
+	return tiles;
+}
+
+/** Raise hills on the land around the park, keeping some distance from the park and the road. */
+void ParkGenerator::MakeTerrain()
+{
+	Rectangle16 keep_flat(this->park);
+	keep_flat.AddPoint(this->park.base.x - 2, this->park.base.y - 2);
+	keep_flat.AddPoint(this->park.base.x + this->park.width + 1, this->park.base.y + this->park.height + 1);
+
+	const int size = this->settings.world_size;
+	const int hills = (size * size - this->park.width * this->park.height) / 150;
+	for (int hill = 0; hill < hills; hill++) {
+		const int cx = this->rnd.Uniform(size - 1);
+		const int cy = this->rnd.Uniform(size - 1);
+		const int radius = 2 + this->rnd.Uniform(4);
+		/* Every layer raises a smaller square, to make a hill with gentle slopes. */
+		for (int layer = radius; layer > 0; layer--) {
+			Rectangle16 area(cx - layer, cy - layer, 2 * layer + 1, 2 * layer + 1);
+			area.RestrictTo(0, 0, size, size);
+			if (area.width == 0 || area.height == 0) continue;
+
+			TerrainChanges changes(area.base, area.width, area.height);
+			bool changed = false;
+			for (int x = area.base.x; x < area.base.x + area.width; x++) {
+				for (int y = area.base.y; y < area.base.y + area.height; y++) {
+					if (keep_flat.IsPointInside(Point16(x, y)) || std::abs(x - this->road_x) <= 2) continue;
+					if (!changes.ChangeVoxel(Point16(x, y), WORLD_Z_SIZE, 1)) continue;
+					changed = true;
+				}
+			}
+			if (changed) changes.ModifyWorld(1, false);
+		}
+	}
+}
+
+/** Build the street grid of the park, and the road leading to it. */
+void ParkGenerator::MakeStreets()
+{
+	for (int x = 0; x < this->settings.world_size; x++) {
+		for (int y = 0; y < this->settings.world_size; y++) {
+			if (!this->IsStreet(x, y)) continue;
+
+			PathType type;
+			if (!this->park.IsPointInside(Point16(x, y))) {
+				type = PAT_CONCRETE;
+			} else if ((x - this->park.base.x) % (3 * this->spacing) == 0 || (y - this->park.base.y) % (3 * this->spacing) == 0) {
+				type = PAT_ASPHALT;  // Avenues.
+			} else {
+				type = PAT_TILED;
+			}
+			if (BuildFlatPath(this->GroundVoxel(x, y), type, PAS_NORMAL_PATH, false, false)) this->stats.paths++;
+		}
+	}
+}
+
+/** Build the requested number of shops, gentle and thrill rides, and coasters, picking their types at random. */
+void ParkGenerator::PlaceRides()
+{
+	std::vector<const ShopType *> shops;
+	std::vector<const GentleThrillRideType *> rides;
+	std::vector<std::pair<const CoasterType *, const TrackedRideDesign *>> designs;
+	for (uint16 i = 0;; i++) {
+		const RideType *type = _rides_manager.GetRideType(i);
+		if (type == nullptr) break;
+
+		switch (type->kind) {
+			case RTK_SHOP:
+				shops.push_back(static_cast<const ShopType *>(type));
+				break;
+			case RTK_GENTLE:
+			case RTK_THRILL:
+				rides.push_back(static_cast<const GentleThrillRideType *>(type));
+				break;
+			case RTK_COASTER:
+				for (const TrackedRideDesign &design : type->designs) {
+					if (!design.pieces.empty()) designs.emplace_back(static_cast<const CoasterType *>(type), &design);
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	/* Coasters first, they need the most space. */
+	for (uint16 i = 0; i < this->settings.coasters && !designs.empty(); i++) {
+		const auto &design = designs[this->rnd.Uniform(designs.size() - 1)];
+		if (this->PlaceCoaster(design.first, *design.second)) this->stats.coasters++;
+	}
+	for (uint16 i = 0; i < this->settings.rides && !rides.empty(); i++) {
+		if (this->PlaceGentleThrillRide(rides[this->rnd.Uniform(rides.size() - 1)])) this->stats.rides++;
+	}
+	for (uint16 i = 0; i < this->settings.shops && !shops.empty(); i++) {
+		if (this->PlaceShop(shops[this->rnd.Uniform(shops.size() - 1)])) this->stats.shops++;
+	}
+}
+
+/**
+ * Build a shop next to a street, facing the street.
+ * @param type Type of the shop.
+ * @return Whether the shop was built.
+ */
+bool ParkGenerator::PlaceShop(const ShopType *type)
+{
+	const uint16 number = _rides_manager.GetFreeInstance(type);
+	if (number == INVALID_RIDE_INSTANCE) return false;
+	ShopInstance *shop = static_cast<ShopInstance *>(_rides_manager.CreateInstance(type, number));
+
+	BestErrorMessageReason reason(BestErrorMessageReason::ACT_BUILD);
+	int attempts = MAX_PLACEMENT_ATTEMPTS;
+	for (const Point16 &tile : this->GetShuffledLotTiles(true)) {
+		if (--attempts < 0) break;
+
+		const XYZPoint16 pos = this->GroundVoxel(tile.x, tile.y);
+		for (uint8 orientation = 0; orientation < 4; orientation++) {
+			if (!CanPlaceFixedRide(type, pos, orientation, &reason)) continue;
+			shop->SetRide(orientation, pos);
+
+			const uint8 entrances = shop->GetEntranceDirections(pos);
+			bool reachable = false;
+			for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+				if (GB(entrances, edge, 1) != 0 && PathExistsAtBottomEdge(pos, edge)) reachable = true;
+			}
+			if (!reachable) continue;
+
+			_rides_manager.NewInstanceAdded(number);
+			AddRemovePathEdges(pos, PATH_EMPTY, entrances, PAS_QUEUE_PATH);
+			shop->OpenRide();
+			return true;
+		}
+	}
+	_rides_manager.DeleteInstance(number);
+	return false;
+}
+
+/**
+ * Build a gentle or thrill ride with its entrance and exit next to a street.
+ * @param type Type of the ride.
+ * @return Whether the ride was built.
+ */
+bool ParkGenerator::PlaceGentleThrillRide(const GentleThrillRideType *type)
+{
+	const uint16 number = _rides_manager.GetFreeInstance(type);
+	if (number == INVALID_RIDE_INSTANCE) return false;
+	GentleThrillRideInstance *ride = static_cast<GentleThrillRideInstance *>(_rides_manager.CreateInstance(type, number));
+
+	BestErrorMessageReason reason(BestErrorMessageReason::ACT_BUILD);
+	int attempts = MAX_PLACEMENT_ATTEMPTS;
+	for (const Point16 &tile : this->GetShuffledLotTiles(false)) {
+		if (--attempts < 0) break;
+
+		const XYZPoint16 pos = this->GroundVoxel(tile.x, tile.y);
+		for (uint8 orientation = 0; orientation < 4; orientation++) {
+			if (!CanPlaceFixedRide(type, pos, orientation, &reason)) continue;
+			ride->SetRide(orientation, pos);
+
+			/* Find reachable tiles for the entrance and the exit around the ride. */
+			const XYZPoint16 corner = pos + OrientatedOffset(orientation, type->width_x - 1, type->width_y - 1);
+			XYZPoint16 entrance = XYZPoint16::invalid();
+			XYZPoint16 exit = XYZPoint16::invalid();
+			for (int x = std::min(pos.x, corner.x) - 1; x <= std::max(pos.x, corner.x) + 1; x++) {
+				for (int y = std::min(pos.y, corner.y) - 1; y <= std::max(pos.y, corner.y) + 1; y++) {
+					const XYZPoint16 p(x, y, pos.z);
+					if (!IsVoxelstackInsideWorld(x, y) || !this->IsNextToPath(p)) continue;
+					if (entrance == XYZPoint16::invalid() && ride->CanPlaceEntranceOrExit(p, true)) {
+						entrance = p;
+					} else if (exit == XYZPoint16::invalid() && ride->CanPlaceEntranceOrExit(p, false)) {
+						exit = p;
+					}
+				}
+			}
+			if (entrance == XYZPoint16::invalid() || exit == XYZPoint16::invalid()) continue;
+
+			_rides_manager.NewInstanceAdded(number);
+			ride->SetEntrancePos(entrance);
+			ride->SetExitPos(exit);
+			ride->OpenRide();
+			return true;
+		}
+	}
+	_rides_manager.DeleteInstance(number);
+	return false;
+}
+
+/**
+ * Build a roller coaster from a saved track design.
+ * @param type Type of the coaster.
+ * @param design Design of the track.
+ * @return Whether the coaster was built.
+ */
+bool ParkGenerator::PlaceCoaster(const CoasterType *type, const TrackedRideDesign &design)
+{
+	int attempts = MAX_PLACEMENT_ATTEMPTS;
+	for (const Point16 &tile : this->GetShuffledLotTiles(false)) {
+		if (--attempts < 0) break;
+
+		for (uint8 direction = 0; direction < 4; direction++) {
+			/* Check whether the whole design fits here. */
+			std::vector<PositionedTrackPiece> pieces;
+			XYZPoint16 pos = this->GroundVoxel(tile.x, tile.y);
+			for (const TrackedRideDesign::AbstractTrackPiece &abstract_piece : design.pieces) {
+				const int index = type->GetPieceIndex(abstract_piece.piece_name);
+				if (index < 0) return false;  // The design does not match the coaster type.
+				const int piece_id = type->GetRotatedPieceIndex(type->pieces.at(index), direction);
+				if (piece_id < 0) break;
+
+				PositionedTrackPiece placed(pos, type->pieces.at(piece_id));
+				if (placed.CanBePlaced() != STR_NULL) break;
+				pieces.push_back(placed);
+				pos += placed.piece->exit_dxyz;
+			}
+			if (pieces.size() != design.pieces.size()) continue;
+
+			const uint16 number = _rides_manager.GetFreeInstance(type);
+			if (number == INVALID_RIDE_INSTANCE) return false;
+			CoasterInstance *ci = static_cast<CoasterInstance *>(_rides_manager.CreateInstance(type, number));
+			_rides_manager.NewInstanceAdded(number);
+			for (const PositionedTrackPiece &placed : pieces) {
+				ci->AddPositionedPiece(placed);
+				ci->PlaceTrackPieceInWorld(placed);
+			}
+			if (!ci->MakePositionedPiecesLooping(nullptr)) {
+				_rides_manager.DeleteInstance(number);
+				return false;  // The design is not a closed loop.
+			}
+
+			ci->CloseRide();
+			ci->SetNumberOfCars(ci->GetMaxNumberOfCars());
+			ci->SetNumberOfTrains(ci->GetMaxNumberOfTrains(ci->cars_per_train));
+			if (!this->PlaceCoasterEntrances(ci) || !ci->CanOpenRide()) {
+				_rides_manager.DeleteInstance(number);
+				continue;
+			}
+			ci->OpenRide();
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Give every station of a coaster an entrance and an exit next to a path.
+ * @param ci Coaster to build the entrances and exits of.
+ * @return Whether all stations got an entrance and an exit.
+ */
+bool ParkGenerator::PlaceCoasterEntrances(CoasterInstance *ci)
+{
+	for (CoasterStation &station : ci->stations) {
+		for (bool entrance : {true, false}) {
+			bool placed = false;
+			for (const XYZPoint16 &location : station.locations) {
+				for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT && !placed; edge++) {
+					const XYZPoint16 p(location.x + _tile_dxy[edge].x, location.y + _tile_dxy[edge].y, location.z);
+					if (!IsVoxelstackInsideWorld(p.x, p.y) || !this->IsNextToPath(p)) continue;
+					if (!ci->CanPlaceEntranceOrExit(p, entrance, &station)) continue;
+					placed = ci->PlaceEntranceOrExit(p, entrance, &station);
+				}
+				if (placed) break;
+			}
+			if (!placed) return false;
+		}
+	}
+	return true;
+}
+
+/** Put benches, litter bins, and lamps along the streets of the park. */
+void ParkGenerator::PlacePathObjects()
+{
+	for (int x = this->park.base.x; x < this->park.base.x + this->park.width; x++) {
+		for (int y = this->park.base.y; y < this->park.base.y + this->park.height; y++) {
+			if (!this->IsStreet(x, y)) continue;
+
+			const PathObjectType *type;
+			switch (this->rnd.Uniform(11)) {
+				case 0: case 1: type = &PathObjectType::BENCH;     break;
+				case 2: case 3: type = &PathObjectType::LITTERBIN; break;
+				case 4:         type = &PathObjectType::LAMP;      break;
+				default: continue;
+			}
+			_scenery.SetPathObjectInstance(this->GroundVoxel(x, y), type);
+			this->stats.path_objects++;
+		}
+	}
+}
+
+/** Put scenery items on the free tiles of the park. */
+void ParkGenerator::PlaceScenery()
+{
+	std::vector<const SceneryType *> types;
+	for (SceneryCategory cat : {SCC_TREES, SCC_FLOWERBEDS, SCC_FOUNTAINS}) {
+		for (const SceneryType *type : _scenery.GetAllTypes(cat)) types.push_back(type);
+	}
+	if (types.empty() || this->settings.scenery == 0) return;
+
+	for (const Point16 &tile : this->GetShuffledLotTiles(false)) {
+		if (!this->rnd.Success(this->settings.scenery)) continue;
+
+		std::unique_ptr<SceneryInstance> item(new SceneryInstance(types[this->rnd.Uniform(types.size() - 1)]));
+		item->vox_pos = this->GroundVoxel(tile.x, tile.y);
+		item->orientation = this->rnd.Uniform(3);
+		if (item->CanPlace() != STR_NULL) {
+			item->vox_pos = XYZPoint16::invalid();  // The item is not in the world, do not remove it when deleting.
+			continue;
+		}
+
+		_scenery.AddItem(item.release());
+		this->stats.scenery++;
+	}
+}
+
+/** Set the scenario of the park, with the guest target as objective. */
+void ParkGenerator::SetupScenario()
+{
+	_scenario.SetDefaultScenario();
+	_scenario.name = "Generated park (" + this->settings.preset + ", seed " + std::to_string(this->settings.seed) + ")";
+	_scenario.max_guests = this->settings.guests;
+	_scenario.spawn_lowest = 600;
+	_scenario.spawn_highest = 1000;
+	for (auto &objective : _scenario.objective->objectives) {
+		if (objective->Type() == OJT_GUESTS) static_cast<ObjectiveGuests *>(objective.get())->nr_guests = this->settings.guests;
+	}
+}
+
+/**
+ * Generate a park without creating any window, and save it.
+ * @param spec Settings of the generator, see ParkGeneratorSettings::Parse.
+ * @param fname Name of the savegame file to write.
+ * @return Exit code of the program.
+ * @pre The RCD files and the language must have been loaded.
+ */
+int RunParkGenerator(const std::string &spec, const std::string &fname)
+{
+	ParkGeneratorSettings settings;
+	if (!settings.Parse(spec)) return 1;
+
+	/* Start from an empty game, with the generator seed as park seed to make the park reproducible. */
+	LoadGameFile(nullptr);
+	Random::SetParkSeed(settings.seed);
+	_inbox.Clear();
+	_date.Initialize();
+	_weather.Initialize();
+	_game_observer.Initialize();
+	_game_mode_mgr.SetGameMode(GM_EDITOR);
+
+	printf("Generating a %s park with seed %llu in a world of %u x %u tiles.\n", settings.preset.c_str(),
+			static_cast<unsigned long long>(settings.seed), settings.world_size, settings.world_size);
+	ParkGenerator generator(settings);
+	generator.Generate();
+
+	const ParkGeneratorStatistics &stats = generator.stats;
+	printf("  Paths          : %u\n", stats.paths);
+	printf("  Path objects   : %u\n", stats.path_objects);
+	printf("  Scenery items  : %u\n", stats.scenery);
+	printf("  Rides          : %u of %u\n", stats.rides, settings.rides);
+	printf("  Shops          : %u of %u\n", stats.shops, settings.shops);
+	printf("  Coasters       : %u of %u\n", stats.coasters, settings.coasters);
+	printf("  Guest target   : %u\n", settings.guests);
+
+	_game_mode_mgr.SetGameMode(GM_PLAY);
+	int result = 0;
+	if (SaveGameFile(fname.c_str())) {
+		printf("Saved the park to '%s'.\n", fname.c_str());
+	} else {
+		fprintf(stderr, "ERROR: Saving to '%s' failed.\n", fname.c_str());
+		result = 1;
+	}
+
+	_game_control.Uninitialize();
+	return result;
+}
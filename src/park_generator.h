@@ -0,0 +1,36 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file park_generator.h Building large parks automatically, for testing and profiling. */
+
+#ifndef PARK_GENERATOR_H
+#define PARK_GENERATOR_H
+
+#include <string>
+
+/** Settings of the park generator. */
+struct ParkGeneratorSettings {
+	ParkGeneratorSettings();
+
+	bool SetPreset(const std::string &name);
+	bool Parse(const std::string &spec);
+
+	std::string preset;   ///< Name of the preset the settings are based on.
+	uint64 seed;          ///< Seed of the park generator and of the random generators of the park.
+	uint16 world_size;    ///< Length of the sides of the world.
+	uint16 coverage;      ///< Percentage of the world owned by the park.
+	uint16 path_density;  ///< Density of the path network, between \c 0 (sparse) and \c 100 (dense).
+	uint16 rides;         ///< Number of gentle and thrill rides to build.
+	uint16 shops;         ///< Number of shops to build.
+	uint16 coasters;      ///< Number of roller coasters to build.
+	uint16 scenery;       ///< Percentage of the remaining park tiles that get a scenery item.
+	uint32 guests;        ///< Guest target of the scenario.
+};
+
+int RunParkGenerator(const std::string &spec, const std::string &fname);
+
+#endif
@@ -17,6 +17,7 @@
 #include "finances.h"
 #include "people.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "gui_sprites.h"
 #include "sprite_data.h"
 #include "gameobserver.h"
@@ -280,7 +281,7 @@ ParkManagementGui::ParkManagementGui(ParkManagementGuiTabs tab) : GuiWindow(WC_P
 	txt->SetText(_game_observer.park_name);
 	txt->text_changed = [txt]()
 	{
-		_game_observer.park_name = txt->GetText();
+		DoCommand(GCMD_SET_PARK_NAME, {}, XYZPoint16::invalid(), txt->GetText());
 	};
 
 	/* Initialize objective editor with some default values. */
@@ -404,34 +405,29 @@ void ParkManagementGui::OnClick(WidgetNumber number, [[maybe_unused]] const Poin
 
 		case PM_MAX_GUESTS_INCREASE:
 			if (_game_mode_mgr.InEditorMode()) {
-				_scenario.max_guests += MAX_GUESTS_STEP_SIZE;
+				DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_MAX_GUESTS, _scenario.max_guests + MAX_GUESTS_STEP_SIZE});
 				this->UpdateButtons();
 			}
 			break;
 		case PM_MAX_GUESTS_DECREASE:
 			if (_game_mode_mgr.InEditorMode()) {
-				if (_scenario.max_guests > MIN_MAX_GUESTS + MAX_GUESTS_STEP_SIZE) {
-					_scenario.max_guests -= MAX_GUESTS_STEP_SIZE;
-				} else {
-					_scenario.max_guests = MIN_MAX_GUESTS;
-				}
+				DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_MAX_GUESTS, std::max<int64>(MIN_MAX_GUESTS, static_cast<int64>(_scenario.max_guests) - MAX_GUESTS_STEP_SIZE)});
 				this->UpdateButtons();
 			}
 			break;
 
 		case PM_ENTRANCE_FEE_INCREASE:
-			_game_observer.entrance_fee += PARK_ENTRANCE_FEE_STEP_SIZE;
+			DoCommand(GCMD_SET_PARK_ENTRANCE_FEE, {_game_observer.entrance_fee + PARK_ENTRANCE_FEE_STEP_SIZE});
 			this->UpdateButtons();
 			break;
 		case PM_ENTRANCE_FEE_DECREASE:
-			_game_observer.entrance_fee = std::max<int>(0, _game_observer.entrance_fee - PARK_ENTRANCE_FEE_STEP_SIZE);
+			DoCommand(GCMD_SET_PARK_ENTRANCE_FEE, {std::max<int>(0, _game_observer.entrance_fee - PARK_ENTRANCE_FEE_STEP_SIZE)});
 			this->UpdateButtons();
 			break;
 
 		case PM_ENTRANCE_FEE_ENABLE:
 			if (_game_mode_mgr.InEditorMode()) {
-				_scenario.allow_entrance_fee = !_scenario.allow_entrance_fee;
-				if (!_scenario.allow_entrance_fee) _game_observer.entrance_fee = 0;
+				DoCommand(GCMD_SET_SCENARIO_SETTING, {SSET_ALLOW_ENTRANCE_FEE, !_scenario.allow_entrance_fee});
 				this->UpdateButtons();
 			}
 			break;
@@ -543,25 +539,13 @@ void ParkManagementGui::OnClick(WidgetNumber number, [[maybe_unused]] const Poin
 			break;
 
 		case PM_OBJECTIVE_APPLY: {
-			std::vector<std::shared_ptr<AbstractObjective>> new_objectives;
-
-			if (obj_editing_guests.second) {
-				new_objectives.emplace_back(new ObjectiveGuests(0, obj_editing_guests.first));
-			}
-			if (obj_editing_park_value.second) {
-				new_objectives.emplace_back(new ObjectiveParkValue(0, obj_editing_park_value.first));
-			}
-			if (obj_editing_rating.second) {
-				new_objectives.emplace_back(new ObjectiveParkRating(obj_editing_drop_policy.second ? obj_editing_drop_policy.first : 0, obj_editing_rating.first));
-			}
-
-			if (new_objectives.empty()) {
-				new_objectives.emplace_back(new ObjectiveNone);
-			}
-
-			_scenario.objective.reset(new ScenarioObjective(0,
-					obj_editing_timeout.second ? obj_editing_timeout.first.second ? TIMEOUT_BEFORE : TIMEOUT_EXACT : TIMEOUT_NONE,
-					obj_editing_timeout.first.first, new_objectives));
+			const int64 policy = obj_editing_timeout.second ? obj_editing_timeout.first.second ? TIMEOUT_BEFORE : TIMEOUT_EXACT : TIMEOUT_NONE;
+			const uint32 drop_days = obj_editing_drop_policy.second ? obj_editing_drop_policy.first : 0;
+			DoCommand(GCMD_SET_OBJECTIVE, {
+					(policy << 32) | obj_editing_timeout.first.first.Compress(),
+					obj_editing_guests.second ? static_cast<int64>(obj_editing_guests.first) : -1,
+					obj_editing_park_value.second ? static_cast<int64>(obj_editing_park_value.first) : -1,
+					obj_editing_rating.second ? (static_cast<int64>(drop_days) << 16) | obj_editing_rating.first : -1});
 			this->UpdateButtons();
 			break;
 		}
@@ -578,12 +562,12 @@ void ParkManagementGui::OnClick(WidgetNumber number, [[maybe_unused]] const Poin
 
 		case PM_CLOSE_PARK_PANEL:
 		case PM_CLOSE_PARK_LIGHT:
-			_game_observer.SetParkOpen(false);
+			DoCommand(GCMD_SET_PARK_OPEN, {false});
 			this->UpdateButtons();
 			break;
 		case PM_OPEN_PARK_PANEL:
 		case PM_OPEN_PARK_LIGHT:
-			_game_observer.SetParkOpen(true);
+			DoCommand(GCMD_SET_PARK_OPEN, {true});
 			this->UpdateButtons();
 			break;
 
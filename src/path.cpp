@@ -10,6 +10,8 @@
 #include "stdafx.h"
 #include "path.h"
 #include "map.h"
+#include "path_graph.h"
+#include "queue.h"
 #include "ride_type.h"
 #include "scenery.h"
 #include "viewport.h"
@@ -316,6 +318,39 @@ bool TravelQueuePath(XYZPoint16 *voxel_pos, TileEdge *entry)
 	}
 }
 
+/**
+ * Find the path tile connected to a path tile at the given edge, in the same way as the path finder moves between tiles.
+ * @param pos Coordinate of the path tile.
+ * @param exits Exits of the path tile, see #GetPathExits.
+ * @param edge Edge to examine.
+ * @param ngb [out] Coordinate of the connected path tile, if it exists.
+ * @return Whether a connected path tile exists at the edge.
+ */
+bool GetPathNeighbour(const XYZPoint16 &pos, uint8 exits, TileEdge edge, XYZPoint16 *ngb)
+{
+	if ((exits & (0x11 << edge)) == 0) return false;
+
+	Point16 dxy = _tile_dxy[edge];
+	if (!IsVoxelstackInsideWorld(pos.x + dxy.x, pos.y + dxy.y)) return false;
+
+	int extra_z = ((exits & (0x10 << edge)) != 0);
+	if (pos.z + extra_z >= WORLD_Z_SIZE) return false;
+
+	XYZPoint16 other(pos.x + dxy.x, pos.y + dxy.y, pos.z + extra_z);
+	const Voxel *v2 = _world.GetVoxel(other);
+	if (v2 == nullptr) return false;
+
+	TileEdge rev_edge = (TileEdge)((edge + 2) % 4);
+	if ((GetPathExits(v2) & (1 << rev_edge)) == 0) { // No path here, try one voxel below.
+		if (other.z == 0) return false;
+		other.z--;
+		v2 = _world.GetVoxel(other);
+		if (v2 == nullptr || (GetPathExits(v2) & (0x10 << rev_edge)) == 0) return false;
+	}
+	*ngb = other;
+	return true;
+}
+
 /**
  * Set the edge of a path sprite. Also updates the corner pieces of the flat path tiles.
  * @param slope Current path slope (imploded).
@@ -449,6 +484,9 @@ uint8 AddRemovePathEdges(const XYZPoint16 &voxel_pos, uint8 slope, uint8 dirs, P
 	Voxel *v = _world.GetCreateVoxel(voxel_pos, false);
 	uint16 fences = v->GetFences();
 
+	_path_graph.NotifyPathChanged(voxel_pos);
+	_queues.NotifyPathChanged(voxel_pos);
+
 	std::fill_n(ngb_status, lengthof(ngb_status), PAS_UNUSED); // Clear path all statuses to prevent connecting to it if an edge is skipped.
 	for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
 		if ((dirs & (1 << edge)) == 0) continue; // Skip directions that should not be updated.
@@ -130,6 +130,7 @@ uint8 GetPathExits(PathSprites slope, bool use_path_connections);
 uint8 GetPathExits(const Voxel *v);
 
 bool TravelQueuePath(XYZPoint16 *voxel_pos, TileEdge *entry);
+bool GetPathNeighbour(const XYZPoint16 &pos, uint8 exits, TileEdge edge, XYZPoint16 *ngb);
 
 bool PathExistsAtBottomEdge(XYZPoint16 voxel_pos, TileEdge edge);
 
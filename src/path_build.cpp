@@ -63,7 +63,7 @@ static void BuildPathAtTile(const XYZPoint16 &voxel_pos, PathType path_type, Pat
 	}
 	if (pay) {
 		_finances_manager.PayRideConstruct(cost);
-		_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, voxel_pos);
+		AddFloatawayMoneyAmount(cost, voxel_pos);
 	}
 
 	av->SetInstance(SRI_PATH);
@@ -117,7 +117,7 @@ static void RemovePathAtTile(const XYZPoint16 &voxel_pos, uint8 path_spr, bool p
 
 	if (pay) {
 		_finances_manager.PayRideConstruct(CONSTRUCTION_COST_PATH_RETURN);
-		_window_manager.GetViewport()->AddFloatawayMoneyAmount(CONSTRUCTION_COST_PATH_RETURN, voxel_pos);
+		AddFloatawayMoneyAmount(CONSTRUCTION_COST_PATH_RETURN, voxel_pos);
 	}
 }
 
@@ -151,7 +151,7 @@ static void ChangePathAtTile(const XYZPoint16 &voxel_pos, PathType path_type, Pa
 
 	if (pay) {
 		_finances_manager.PayRideConstruct(CONSTRUCTION_COST_PATH_CHANGE);
-		_window_manager.GetViewport()->AddFloatawayMoneyAmount(CONSTRUCTION_COST_PATH_CHANGE, voxel_pos);
+		AddFloatawayMoneyAmount(CONSTRUCTION_COST_PATH_CHANGE, voxel_pos);
 	}
 }
 
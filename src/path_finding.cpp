@@ -11,6 +11,10 @@
 #include "path_finding.h"
 #include "map.h"
 
+static const uint32 INVALID_WALKED_POSITION = UINT32_MAX; ///< Index denoting 'no position'.
+
+static thread_local std::vector<std::unique_ptr<PathSearchContext>> _search_contexts; ///< Data structures of finished path searches in this thread, for reuse.
+
 /**
  * Constructor of a walked position.
  * @param cur_vox Current voxel position.
@@ -24,38 +28,87 @@ WalkedPosition::WalkedPosition(const XYZPoint16 &cur_vox, uint32 traveled, uint3
 }
 
 /**
-* Compare two walked positions, and order on position.
-* @param wp1 First position to compare.
-* @param wp2 Second position to compare.
-* @return Whether \a wp1 should come before \a wp2.
-*/
-bool operator<(const WalkedPosition &wp1, const WalkedPosition &wp2)
+ * Compare two open points, and order on minimal total distance.
+ * @param wd1 First distance to compare.
+ * @param wd2 Second distance to compare.
+ * @return Whether \a wd1 should be examined after \a wd2.
+ */
+static inline bool IsWorseOpenPoint(const WalkedDistance &wd1, const WalkedDistance &wd2)
+{
+	uint32 total1 = wd1.traveled + wd1.estimate;
+	uint32 total2 = wd2.traveled + wd2.estimate;
+	if (total1 != total2) return total1 > total2;
+	if (wd1.traveled != wd2.traveled) return wd1.traveled > wd2.traveled;
+	return wd1.order > wd2.order;
+}
+
+PathSearchContext::PathSearchContext() : generation(0), next_order(0), x_size(0), y_size(0)
 {
-	return wp1.cur_vox < wp2.cur_vox;
+}
+
+/** Prepare the data structures for a new search. */
+void PathSearchContext::Start()
+{
+	if (this->x_size != _world.GetXSize() || this->y_size != _world.GetYSize()) {
+		this->x_size = _world.GetXSize();
+		this->y_size = _world.GetYSize();
+		const size_t count = static_cast<size_t>(this->x_size) * this->y_size;
+		this->stack_stamps.assign(count, 0);
+		this->stack_offsets.resize(count);
+		this->generation = 0;
+	}
+
+	this->generation++;
+	if (this->generation == 0) { // Wrapped around, old stamps may look current.
+		std::fill(this->stack_stamps.begin(), this->stack_stamps.end(), 0);
+		this->generation = 1;
+	}
+
+	this->indices.clear();
+	this->positions.clear();
+	this->parents.clear();
+	this->open_points.clear();
+	this->destinations.clear();
+	this->next_order = 0;
 }
 
 /**
- * Walked distance constructor.
- * @param traveled Length of travel from the starting point to \a pos.
- * @param estimate Estimated length of remaining travel from \a pos to the destination.
- * @param pos Current position.
+ * Get the index of a voxel in #indices. The voxels of a voxel stack get their entries when the search first examines the stack.
+ * @param vox Coordinate of the voxel.
+ * @return Index of the voxel, or #INVALID_WALKED_POSITION if the voxel is not in a voxel stack of the world.
  */
-WalkedDistance::WalkedDistance(uint32 traveled, uint32 estimate, const WalkedPosition *pos) : traveled(traveled), estimate(estimate), pos(pos)
+uint32 PathSearchContext::GetVoxelIndex(const XYZPoint16 &vox)
 {
+	if (vox.x < 0 || vox.x >= this->x_size || vox.y < 0 || vox.y >= this->y_size) return INVALID_WALKED_POSITION;
+
+	const VoxelStack *stack = _world.GetStack(vox.x, vox.y);
+	if (vox.z < stack->base || vox.z >= stack->base + stack->height) return INVALID_WALKED_POSITION;
+
+	const uint32 stack_index = static_cast<uint32>(vox.x) * this->y_size + vox.y;
+	if (this->stack_stamps[stack_index] != this->generation) {
+		this->stack_stamps[stack_index] = this->generation;
+		this->stack_offsets[stack_index] = this->indices.size();
+		this->indices.resize(this->indices.size() + stack->height, INVALID_WALKED_POSITION);
+		this->destinations.resize(this->indices.size(), false);
+	}
+	return this->stack_offsets[stack_index] + (vox.z - stack->base);
 }
 
 /**
- * Compare two walked distances, and order on minimal total distance.
- * @param wd1 First distance to compare.
- * @param wd2 Second distance to compare.
- * @return Whether \a wd1 should come before \a wd2.
+ * Get the data structures for a new path search, reusing those of a finished search if possible.
+ * @return The data structures, prepared for searching.
  */
-bool operator<(const WalkedDistance &wd1, const WalkedDistance &wd2)
+static std::unique_ptr<PathSearchContext> AcquireSearchContext()
 {
-	uint32 total1 = wd1.traveled + wd1.estimate;
-	uint32 total2 = wd2.traveled + wd2.estimate;
-	if (total1 != total2) return total1 < total2;
-	return wd1.traveled < wd2.traveled;
+	std::unique_ptr<PathSearchContext> context;
+	if (_search_contexts.empty()) {
+		context.reset(new PathSearchContext);
+	} else {
+		context = std::move(_search_contexts.back());
+		_search_contexts.pop_back();
+	}
+	context->Start();
+	return context;
 }
 
 /**
@@ -63,17 +116,44 @@ bool operator<(const WalkedDistance &wd1, const WalkedDistance &wd2)
  * @param init_dest_vox Coordinate of the destination voxel.
  */
 PathSearcher::PathSearcher(const XYZPoint16 &init_dest_vox)
-: dest_vox(init_dest_vox), dest_pos(nullptr)
+: dest_vox(init_dest_vox), dest_pos(nullptr), context(AcquireSearchContext()), nearest(false)
 {
 }
 
+/**
+ * Constructor, find a path to the nearest of several destinations. Give destinations through PathSearcher::AddDestination
+ * before giving starting points through PathSearcher::AddStart.
+ */
+PathSearcher::PathSearcher()
+: dest_vox(XYZPoint16::invalid()), dest_pos(nullptr), context(AcquireSearchContext()), nearest(true)
+{
+}
+
+/** Destructor, the data structures of the search are kept for reuse by a later search. */
+PathSearcher::~PathSearcher()
+{
+	_search_contexts.push_back(std::move(this->context));
+}
+
+/**
+ * Add a destination to a search for the nearest destination.
+ * @param vox Coordinate of the destination voxel.
+ * @note A voxel outside the voxel stacks of the world cannot be walked to, and is ignored.
+ */
+void PathSearcher::AddDestination(const XYZPoint16 &vox)
+{
+	assert(this->nearest && this->context->positions.empty());
+	const uint32 voxel_index = this->context->GetVoxelIndex(vox);
+	if (voxel_index != INVALID_WALKED_POSITION) this->context->destinations[voxel_index] = true;
+}
+
 /**
  * Add a starting point to the searcher.
  * @param start_vox Coordinate of the start voxel.
  */
 void PathSearcher::AddStart(const XYZPoint16 &start_vox)
 {
-	this->AddOpen(start_vox, 0, nullptr);
+	this->AddOpen(start_vox, 0, INVALID_WALKED_POSITION);
 }
 
 /**
@@ -83,38 +163,58 @@ void PathSearcher::AddStart(const XYZPoint16 &start_vox)
  */
 inline uint32 PathSearcher::GetEstimate(const XYZPoint16 &vox)
 {
+	if (this->nearest) return 0; // No single destination to aim for.
+
 	int32 val = abs(vox.x - this->dest_vox.x) + abs(vox.y - this->dest_vox.y);
 	if (val < abs(vox.z - this->dest_vox.z)) return abs(vox.z - this->dest_vox.z);
 	return val;
 }
 
+/**
+ * Is the given voxel a destination of the search?
+ * @param vox Position to check.
+ * @return Whether a path to the position completes the search.
+ */
+inline bool PathSearcher::IsDestination(const XYZPoint16 &vox)
+{
+	if (!this->nearest) return vox == this->dest_vox;
+
+	const uint32 voxel_index = this->context->GetVoxelIndex(vox);
+	return voxel_index != INVALID_WALKED_POSITION && this->context->destinations[voxel_index];
+}
+
 /**
  * Add a new open position to the set of open points, if it is better than already available.
  * @param vox Position of the current position.
  * @param traveled Distance traveled to get to the current position.
- * @param prev_pos Previous position (\c nullptr for the start position).
+ * @param prev_pos Index of the previous position (#INVALID_WALKED_POSITION for the start position).
  */
-void PathSearcher::AddOpen(const XYZPoint16 &vox, uint32 traveled, const WalkedPosition *prev_pos)
+void PathSearcher::AddOpen(const XYZPoint16 &vox, uint32 traveled, uint32 prev_pos)
 {
+	PathSearchContext *ctx = this->context.get();
 	uint32 estimate = this->GetEstimate(vox);
-	WalkedPosition wp(vox, traveled, estimate, prev_pos);
 
 	/* Find the position. */
-	PositionSet::iterator pos_iter = this->positions.find(wp);
-	if (pos_iter == positions.end()) { // New position.
-		pos_iter = this->positions.insert(wp).first;
-		this->open_points.emplace(traveled, estimate, &(*pos_iter));
-		return;
-	}
-	/* Existing position, update if needed. */
-	const WalkedPosition *pwp = &(*pos_iter);
-	if (pwp->traveled + pwp->estimate <= traveled + estimate) return;
+	uint32 voxel_index = ctx->GetVoxelIndex(vox);
+	uint32 pos;
+	if (voxel_index != INVALID_WALKED_POSITION && ctx->indices[voxel_index] != INVALID_WALKED_POSITION) {
+		/* Existing position, update if needed. */
+		pos = ctx->indices[voxel_index];
+		WalkedPosition &wp = ctx->positions[pos];
+		if (wp.traveled + wp.estimate <= traveled + estimate) return;
 
-	/* New one is better, update. */
-	pwp->traveled = traveled;
-	pwp->estimate = estimate; // The sum is changed, making any old open points invalid.
-	pwp->prev_pos = prev_pos;
-	this->open_points.emplace(traveled, estimate, pwp);
+		/* New one is better, update. */
+		wp.traveled = traveled;
+		wp.estimate = estimate; // The sum is changed, making any old open points invalid.
+		ctx->parents[pos] = prev_pos;
+	} else { // New position.
+		pos = ctx->positions.size();
+		ctx->positions.emplace_back(vox, traveled, estimate, nullptr);
+		ctx->parents.push_back(prev_pos);
+		if (voxel_index != INVALID_WALKED_POSITION) ctx->indices[voxel_index] = pos;
+	}
+	ctx->open_points.push_back({traveled, estimate, ctx->next_order++, pos});
+	std::push_heap(ctx->open_points.begin(), ctx->open_points.end(), IsWorseOpenPoint);
 }
 
 /**
@@ -123,22 +223,36 @@ void PathSearcher::AddOpen(const XYZPoint16 &vox, uint32 traveled, const WalkedP
  */
 bool PathSearcher::Search()
 {
+	PathSearchContext *ctx = this->context.get();
 	this->dest_pos = nullptr;
-	while (!this->open_points.empty()) {
-		WalkedDistance wd = *this->open_points.begin();
-		this->open_points.erase(this->open_points.begin());
+	while (!ctx->open_points.empty()) {
+		std::pop_heap(ctx->open_points.begin(), ctx->open_points.end(), IsWorseOpenPoint);
+		WalkedDistance wd = ctx->open_points.back();
+		ctx->open_points.pop_back();
 
-		if (wd.traveled != wd.pos->traveled || wd.estimate != wd.pos->estimate) continue; // Invalid open point.
+		/* Copy the position data, adding open points may move the positions. */
+		const WalkedPosition wp = ctx->positions[wd.pos];
+		if (wd.traveled != wp.traveled || wd.estimate != wp.estimate) continue; // Invalid open point.
 
 		/* Reached the destination? */
-		const WalkedPosition *wp = wd.pos;
-		if (wp->cur_vox == this->dest_vox) {
-			this->dest_pos = wp;
+		if (this->IsDestination(wp.cur_vox)) {
+			/* Link the positions of the path. */
+			uint32 pos = wd.pos;
+			for (;;) {
+				uint32 prev = ctx->parents[pos];
+				if (prev == INVALID_WALKED_POSITION) {
+					ctx->positions[pos].prev_pos = nullptr;
+					break;
+				}
+				ctx->positions[pos].prev_pos = &ctx->positions[prev];
+				pos = prev;
+			}
+			this->dest_pos = &ctx->positions[wd.pos];
 			return true;
 		}
 
 		/* Add new open points. */
-		const Voxel *v = _world.GetVoxel(wp->cur_vox);
+		const Voxel *v = _world.GetVoxel(wp.cur_vox);
 		if (v == nullptr) continue; // No voxel at the expected point, don't bother.
 
 		uint8 exits = GetPathExits(v);
@@ -147,29 +261,29 @@ bool PathSearcher::Search()
 
 			/* There is an outgoing connection, is it also on the world? */
 			Point16 dxy = _tile_dxy[edge];
-			if (dxy.x < 0 && wp->cur_vox.x == 0) continue;
-			if (dxy.x > 0 && wp->cur_vox.x + 1 == _world.GetXSize()) continue;
-			if (dxy.y < 0 && wp->cur_vox.y == 0) continue;
-			if (dxy.y > 0 && wp->cur_vox.y + 1 == _world.GetYSize()) continue;
+			if (dxy.x < 0 && wp.cur_vox.x == 0) continue;
+			if (dxy.x > 0 && wp.cur_vox.x + 1 == _world.GetXSize()) continue;
+			if (dxy.y < 0 && wp.cur_vox.y == 0) continue;
+			if (dxy.y > 0 && wp.cur_vox.y + 1 == _world.GetYSize()) continue;
 
 			int extra_z = ((exits & (0x10 << edge)) != 0);
-			if (wp->cur_vox.z + extra_z < 0 || wp->cur_vox.z + extra_z >= WORLD_Z_SIZE) continue;
+			if (wp.cur_vox.z + extra_z < 0 || wp.cur_vox.z + extra_z >= WORLD_Z_SIZE) continue;
 
 			/* Now check the other side, new_z is the voxel where the path should be at the bottom. */
-			const Voxel *v2 = _world.GetVoxel(wp->cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
+			const Voxel *v2 = _world.GetVoxel(wp.cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
 			if (v2 == nullptr) continue;
 
 			uint8 other_exits = GetPathExits(v2);
 			if ((other_exits & (1 << ((edge + 2) % 4))) == 0) { // No path here, try one voxel below
 				extra_z--;
-				if (wp->cur_vox.z + extra_z < 0) continue;
-				v2 = _world.GetVoxel(wp->cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
+				if (wp.cur_vox.z + extra_z < 0) continue;
+				v2 = _world.GetVoxel(wp.cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z));
 				if (v2 == nullptr) continue;
 				other_exits = GetPathExits(v2);
 				if ((other_exits & (0x10 << ((edge + 2) % 4))) == 0) continue;
 			}
 			/* Add new open point to the path finder. */
-			this->AddOpen(wp->cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z), wp->traveled + 1, wp);
+			this->AddOpen(wp.cur_vox + XYZPoint16(dxy.x, dxy.y, extra_z), wp.traveled + 1, wd.pos);
 		}
 	}
 	return false;
@@ -178,8 +292,6 @@ bool PathSearcher::Search()
 /** Clear the used data structures of the path searcher. */
 void PathSearcher::Clear()
 {
-	this->open_points.clear();
-	this->positions.clear();
+	this->context->Start();
 	this->dest_pos = nullptr;
 }
-
@@ -10,7 +10,8 @@
 #ifndef PATH_FINDING_H
 #define PATH_FINDING_H
 
-#include <set>
+#include <memory>
+#include <vector>
 
 #include "geometry.h"
 
@@ -20,29 +21,48 @@ public:
 	WalkedPosition(const XYZPoint16 &cur_vox, uint32 traveled, uint32 estimate, const WalkedPosition *prev_pos);
 
 	XYZPoint16 cur_vox; ///< Coordinate of the current position.
-	mutable uint32 traveled; ///< Length of the traveled path so far.
-	mutable uint32 estimate; ///< Estimated distance to the destination.
-	mutable const WalkedPosition *prev_pos; ///< Position coming from (\c nullptr for initial position).
+	uint32 traveled; ///< Length of the traveled path so far.
+	uint32 estimate; ///< Estimated distance to the destination.
+	const WalkedPosition *prev_pos; ///< Position coming from (\c nullptr for initial position). Only set for the positions of the found path.
 };
 
 /** Guessed path length at a (partially) explored position. */
-class WalkedDistance {
-public:
-	WalkedDistance(uint32 traveled, uint32 estimate, const WalkedPosition *pos);
-
+struct WalkedDistance {
 	uint32 traveled; ///< Length of the traveled path so far.
 	uint32 estimate; ///< Estimated distance to the destination.
-	const WalkedPosition *pos; ///< Current position.
+	uint32 order;    ///< Sequence number of the open point, to examine equally good points in the order of adding them.
+	uint32 pos;      ///< Index of the current position in PathSearchContext::positions.
 };
 
-typedef std::set<WalkedPosition> PositionSet;	  ///< Visited positions (best solution so far).
-typedef std::multiset<WalkedDistance> OpenPoints; ///< Points for further exploration.
+/** Data structures of a path search, reused by later searches in the same thread. */
+class PathSearchContext {
+public:
+	PathSearchContext();
+
+	void Start();
+	uint32 GetVoxelIndex(const XYZPoint16 &vox);
+
+	std::vector<WalkedPosition> positions;   ///< Examined positions.
+	std::vector<uint32> parents;             ///< For each examined position, the index of the previous position.
+	std::vector<WalkedDistance> open_points; ///< Binary heap of open points to examine further.
+	std::vector<uint32> stack_stamps;        ///< For each voxel stack in the world, the generation of the last search that examined it.
+	std::vector<uint32> stack_offsets;       ///< For each voxel stack, the index of its bottom voxel in #indices (only valid if its stamp is the current #generation).
+	std::vector<uint32> indices;             ///< For each voxel of the examined voxel stacks, its index in #positions if it has one.
+	std::vector<bool> destinations;          ///< For each voxel of the examined voxel stacks, whether it is a destination of a search for the nearest destination.
+	uint32 generation;                       ///< Generation of the current search.
+	uint32 next_order;                       ///< Sequence number of the next open point.
+	uint16 x_size;                           ///< Size of the world in X direction that #stack_stamps and #stack_offsets are made for.
+	uint16 y_size;                           ///< Size of the world in Y direction that #stack_stamps and #stack_offsets are made for.
+};
 
 /** Class for searching (and hopefully finding) a path between tiles. */
 class PathSearcher {
 public:
 	PathSearcher(const XYZPoint16 &dest_vox);
+	PathSearcher();
+	~PathSearcher();
 
+	void AddDestination(const XYZPoint16 &vox);
 	void AddStart(const XYZPoint16 &start_vox);
 	bool Search();
 	void Clear();
@@ -51,11 +71,12 @@ public:
 	const WalkedPosition *dest_pos; ///< If path was found, this points to the end-point of the walk.
 
 protected:
-	PositionSet positions;   ///< Examined positions.
-	OpenPoints  open_points; ///< Open points to examine further.
+	std::unique_ptr<PathSearchContext> context; ///< Data structures of the search.
+	bool nearest;               ///< Search for the nearest of the voxels marked in PathSearchContext::destinations rather than for #dest_vox.
 
 	inline uint32 GetEstimate(const XYZPoint16 &vox);
-	void AddOpen(const XYZPoint16 &vox, uint32 traveled, const WalkedPosition *prev_pos);
+	inline bool IsDestination(const XYZPoint16 &vox);
+	void AddOpen(const XYZPoint16 &vox, uint32 traveled, uint32 prev_pos);
 };
 
 #endif
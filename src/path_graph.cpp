@@ -0,0 +1,361 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file path_graph.cpp Connected parts of the path network, using a compressed graph of the path tiles. */
+
+#include "stdafx.h"
+#include "path_graph.h"
+#include "map.h"
+
+PathGraph _path_graph; ///< Graph of the path network in the world.
+
+static const uint32 INVALID_COMPONENT = UINT32_MAX; ///< Component number of a node that has not been assigned a component yet.
+
+PathGraphNode::PathGraphNode() : pos(XYZPoint16::invalid()), flags(PGNF_NONE), exits(0), component(INVALID_COMPONENT)
+{
+	std::fill_n(this->edges, lengthof(this->edges), INVALID_PATH_GRAPH_EDGE);
+}
+
+/**
+ * Examine the connections of a path tile.
+ * @param pos Coordinate of the path tile.
+ * @param info [out] Node data of the tile, #PathGraphNode::flags is #PGNF_NONE if the tile is part of a path run.
+ * @param neighbours [out] Coordinates of the connected path tiles, for each edge in #PathGraphNode::exits.
+ * @return Whether a path exists at the given position.
+ */
+static bool ExaminePathTile(const XYZPoint16 &pos, PathGraphNode *info, XYZPoint16 *neighbours)
+{
+	const Voxel *v = _world.GetVoxel(pos);
+	if (v == nullptr || !HasValidPath(v)) return false;
+
+	*info = PathGraphNode();
+	info->pos = pos;
+
+	uint8 exits = GetPathExits(v);
+	int count = 0;
+	for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+		if (GetPathNeighbour(pos, exits, edge, &neighbours[edge])) {
+			info->exits |= 1 << edge;
+			count++;
+		}
+	}
+	if (count <= 1) info->flags |= PGNF_DEAD_END;
+	if (count >= 3) info->flags |= PGNF_JUNCTION;
+	return true;
+}
+
+PathGraph::PathGraph() : next_edge(0), changes(0), needs_rebuild(true), components_valid(false)
+{
+}
+
+/** Remove all data of the graph. It gets rebuilt from the world when needed. */
+void PathGraph::Clear()
+{
+	this->nodes.clear();
+	this->edges.clear();
+	this->run_tiles.clear();
+	this->dirty.clear();
+	this->next_edge = 0;
+	this->changes++;
+	this->needs_rebuild = true;
+	this->components_valid = false;
+}
+
+/** Construct the graph from all path tiles in the world. */
+void PathGraph::Rebuild()
+{
+	this->Clear();
+	this->needs_rebuild = false;
+
+	std::set<XYZPoint16> loose;
+	XYZPoint16 neighbours[EDGE_COUNT];
+	for (uint16 x = 0; x < _world.GetXSize(); x++) {
+		for (uint16 y = 0; y < _world.GetYSize(); y++) {
+			const VoxelStack *vs = _world.GetStack(x, y);
+			for (uint16 i = 0; i < vs->height; i++) {
+				XYZPoint16 pos(x, y, vs->base + i);
+				PathGraphNode info;
+				if (!ExaminePathTile(pos, &info, neighbours)) continue;
+
+				if (info.flags != PGNF_NONE) {
+					this->AddNode(info);
+				} else {
+					loose.insert(pos);
+				}
+			}
+		}
+	}
+
+	std::vector<XYZPoint16> node_positions;
+	node_positions.reserve(this->nodes.size());
+	for (const auto &node : this->nodes) node_positions.push_back(node.first);
+	for (const XYZPoint16 &pos : node_positions) this->TraceNode(pos);
+
+	this->CoverLooseTiles(loose);
+}
+
+/**
+ * A path tile has been built, removed, or changed. The graph is updated before the next query.
+ * @param pos Coordinate of the changed path tile.
+ */
+void PathGraph::NotifyPathChanged(const XYZPoint16 &pos)
+{
+	this->changes++;
+	if (this->needs_rebuild) return;
+	this->dirty.insert(pos);
+	this->components_valid = false;
+}
+
+/**
+ * Can a path tile be reached by walking over the path network from another path tile?
+ * @param from Coordinate of the start tile.
+ * @param to Coordinate of the destination tile.
+ * @return Whether both tiles are in the same connected part of the path network.
+ */
+bool PathGraph::IsReachable(const XYZPoint16 &from, const XYZPoint16 &to)
+{
+	if (from == to) return true;
+
+	const PathGraphNode *start = this->GetRepresentative(from);
+	const PathGraphNode *dest = this->GetRepresentative(to);
+	if (start == nullptr || dest == nullptr) return false;
+
+	this->UpdateComponents();
+	return start->component == dest->component;
+}
+
+/**
+ * Get a node in the same connected part of the path network as a path tile.
+ * @param pos Coordinate of the path tile.
+ * @return The node at the tile or at the start of its run, or \c nullptr if the tile is not a path.
+ */
+const PathGraphNode *PathGraph::GetRepresentative(const XYZPoint16 &pos)
+{
+	this->Update();
+	auto node = this->nodes.find(pos);
+	if (node != this->nodes.end()) return &node->second;
+
+	auto run = this->run_tiles.find(pos);
+	if (run == this->run_tiles.end()) return nullptr;
+	return &this->nodes.at(this->edges.at(run->second).ends[0]);
+}
+
+/** Process the changed path tiles. */
+void PathGraph::Update()
+{
+	if (this->needs_rebuild) {
+		this->Rebuild();
+		return;
+	}
+	if (this->dirty.empty()) return;
+
+	/* Remove everything around the changed tiles, a change affects the connections of its neighbours too. */
+	std::set<XYZPoint16> ends;  // Nodes that lost one or more of their edges.
+	std::set<XYZPoint16> loose; // Path tiles that lost their node or run.
+	for (const XYZPoint16 &pos : this->dirty) {
+		this->RemoveTile(pos, &ends, &loose);
+		for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+			Point16 dxy = _tile_dxy[edge];
+			for (int dz = -1; dz <= 1; dz++) {
+				this->RemoveTile(pos + XYZPoint16(dxy.x, dxy.y, dz), &ends, &loose);
+			}
+		}
+	}
+	this->dirty.clear();
+
+	/* Make new nodes where needed, and connect them again. */
+	XYZPoint16 neighbours[EDGE_COUNT];
+	for (const XYZPoint16 &pos : loose) {
+		PathGraphNode info;
+		if (!ExaminePathTile(pos, &info, neighbours) || info.flags == PGNF_NONE) continue;
+		this->AddNode(info);
+		ends.insert(pos);
+	}
+	for (const XYZPoint16 &pos : ends) this->TraceNode(pos);
+
+	this->CoverLooseTiles(loose);
+	this->components_valid = false;
+}
+
+/** Assign connected component numbers to all nodes, if needed. */
+void PathGraph::UpdateComponents()
+{
+	if (this->components_valid) return;
+
+	for (auto &node : this->nodes) node.second.component = INVALID_COMPONENT;
+
+	uint32 component = 0;
+	std::vector<PathGraphNode *> stack;
+	for (auto &start : this->nodes) {
+		if (start.second.component != INVALID_COMPONENT) continue;
+
+		start.second.component = component;
+		stack.push_back(&start.second);
+		while (!stack.empty()) {
+			const PathGraphNode *node = stack.back();
+			stack.pop_back();
+			for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+				if (node->edges[edge] == INVALID_PATH_GRAPH_EDGE) continue;
+
+				const PathGraphEdge &ge = this->edges.at(node->edges[edge]);
+				const XYZPoint16 &other_pos = (ge.ends[0] == node->pos && ge.directions[0] == edge) ? ge.ends[1] : ge.ends[0];
+				PathGraphNode &other = this->nodes.at(other_pos);
+				if (other.component != INVALID_COMPONENT) continue;
+
+				other.component = component;
+				stack.push_back(&other);
+			}
+		}
+		component++;
+	}
+	this->components_valid = true;
+}
+
+/**
+ * Add a node to the graph, without edges.
+ * @param info Data of the node.
+ * @return The added node.
+ */
+PathGraphNode *PathGraph::AddNode(const PathGraphNode &info)
+{
+	PathGraphNode &node = this->nodes[info.pos];
+	node = info;
+	return &node;
+}
+
+/**
+ * Remove an edge from the graph.
+ * @param edge Number of the edge to remove.
+ * @param ends [inout] Nodes that lost an edge, extended with the end nodes of the removed edge.
+ * @param loose [inout] Path tiles without node or run, extended with the tiles of the removed edge.
+ */
+void PathGraph::RemoveEdge(uint32 edge, std::set<XYZPoint16> *ends, std::set<XYZPoint16> *loose)
+{
+	auto iter = this->edges.find(edge);
+	if (iter == this->edges.end()) return;
+
+	const PathGraphEdge &ge = iter->second;
+	for (int i = 0; i < 2; i++) {
+		auto node = this->nodes.find(ge.ends[i]);
+		if (node == this->nodes.end() || node->second.edges[ge.directions[i]] != edge) continue;
+
+		node->second.edges[ge.directions[i]] = INVALID_PATH_GRAPH_EDGE;
+		ends->insert(ge.ends[i]);
+	}
+	for (const XYZPoint16 &pos : ge.tiles) {
+		this->run_tiles.erase(pos);
+		loose->insert(pos);
+	}
+	this->edges.erase(iter);
+}
+
+/**
+ * Remove a path tile from the graph, including the node or run it belongs to.
+ * @param pos Coordinate of the path tile.
+ * @param ends [inout] Nodes that lost an edge.
+ * @param loose [inout] Path tiles without node or run.
+ */
+void PathGraph::RemoveTile(const XYZPoint16 &pos, std::set<XYZPoint16> *ends, std::set<XYZPoint16> *loose)
+{
+	if (!IsVoxelstackInsideWorld(pos.x, pos.y) || pos.z < 0 || pos.z >= WORLD_Z_SIZE) return;
+	loose->insert(pos);
+
+	auto run = this->run_tiles.find(pos);
+	if (run != this->run_tiles.end()) this->RemoveEdge(run->second, ends, loose);
+
+	auto node = this->nodes.find(pos);
+	if (node == this->nodes.end()) return;
+
+	for (uint32 edge : node->second.edges) {
+		if (edge != INVALID_PATH_GRAPH_EDGE) this->RemoveEdge(edge, ends, loose);
+	}
+	this->nodes.erase(node);
+}
+
+/**
+ * Follow the path runs from all unconnected edges of a node, and add them to the graph.
+ * @param pos Coordinate of the node.
+ */
+void PathGraph::TraceNode(const XYZPoint16 &pos)
+{
+	auto start_iter = this->nodes.find(pos);
+	if (start_iter == this->nodes.end()) return;
+	PathGraphNode &start = start_iter->second;
+
+	PathGraphNode info;
+	XYZPoint16 neighbours[EDGE_COUNT];
+	ExaminePathTile(pos, &info, neighbours);
+
+	for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
+		if ((start.exits & (1 << edge)) == 0 || start.edges[edge] != INVALID_PATH_GRAPH_EDGE) continue;
+
+		PathGraphEdge ge;
+		ge.ends[0] = pos;
+		ge.directions[0] = edge;
+
+		XYZPoint16 cur = neighbours[edge];
+		TileEdge travel = edge;
+		PathGraphNode *end = nullptr;
+		for (;;) {
+			auto iter = this->nodes.find(cur);
+			if (iter != this->nodes.end()) {
+				end = &iter->second;
+				break;
+			}
+			if (this->run_tiles.find(cur) != this->run_tiles.end()) break; // Already part of another run, connections are not symmetric.
+
+			XYZPoint16 cur_neighbours[EDGE_COUNT];
+			PathGraphNode cur_info;
+			ExaminePathTile(cur, &cur_info, cur_neighbours);
+			TileEdge back = (TileEdge)((travel + 2) % 4);
+			if ((cur_info.exits & (1 << back)) == 0) cur_info.flags |= PGNF_ANCHOR; // Connection is one-way, stop here.
+			if (cur_info.flags != PGNF_NONE) {
+				end = this->AddNode(cur_info);
+				break;
+			}
+
+			TileEdge next = EDGE_BEGIN;
+			while (next == back || (cur_info.exits & (1 << next)) == 0) next++;
+
+			ge.tiles.push_back(cur);
+			cur = cur_neighbours[next];
+			travel = next;
+		}
+
+		TileEdge arrival = (TileEdge)((travel + 2) % 4);
+		if (end == nullptr || end->edges[arrival] != INVALID_PATH_GRAPH_EDGE || (end->exits & (1 << arrival)) == 0) continue;
+
+		ge.ends[1] = end->pos;
+		ge.directions[1] = arrival;
+
+		uint32 number = this->next_edge++;
+		start.edges[edge] = number;
+		end->edges[arrival] = number;
+		for (const XYZPoint16 &tile : ge.tiles) this->run_tiles[tile] = number;
+		this->edges[number] = std::move(ge);
+	}
+}
+
+/**
+ * Add path tiles that are not yet part of the graph.
+ * Such tiles are in a closed loop of path without nodes. One tile of the loop becomes a node, and the loop gets traced from it.
+ * @param loose Path tiles that may not be in the graph.
+ */
+void PathGraph::CoverLooseTiles(const std::set<XYZPoint16> &loose)
+{
+	XYZPoint16 neighbours[EDGE_COUNT];
+	for (const XYZPoint16 &pos : loose) {
+		if (this->nodes.find(pos) != this->nodes.end() || this->run_tiles.find(pos) != this->run_tiles.end()) continue;
+
+		PathGraphNode info;
+		if (!ExaminePathTile(pos, &info, neighbours)) continue;
+
+		info.flags |= PGNF_ANCHOR;
+		this->AddNode(info);
+		this->TraceNode(pos);
+	}
+}
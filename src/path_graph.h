@@ -0,0 +1,95 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file path_graph.h Connected parts of the path network, using a compressed graph of the path tiles. */
+
+#ifndef PATH_GRAPH_H
+#define PATH_GRAPH_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "geometry.h"
+#include "tile.h"
+
+static const uint32 INVALID_PATH_GRAPH_EDGE = UINT32_MAX; ///< Edge number denoting 'no edge'.
+
+/** Reasons for a path tile to be a node in the path graph (bit flags). */
+enum PathGraphNodeFlags {
+	PGNF_NONE      = 0,      ///< Not a node, the tile is part of a path run.
+	PGNF_JUNCTION  = 1 << 0, ///< The path tile connects to three or more path tiles.
+	PGNF_DEAD_END  = 1 << 1, ///< The path tile connects to at most one path tile.
+	PGNF_ANCHOR    = 1 << 2, ///< Arbitrary tile in a cycle of path runs without other nodes, or at a one-way connection.
+};
+
+/** Node in the path graph, a path tile with something interesting about it. */
+struct PathGraphNode {
+	PathGraphNode();
+
+	XYZPoint16 pos;           ///< Coordinate of the path tile.
+	uint8 flags;              ///< Why this tile is a node, bitset of #PathGraphNodeFlags.
+	uint8 exits;              ///< Edges with a connected neighbouring path tile (bitset of #TileEdge).
+	uint32 edges[EDGE_COUNT]; ///< Graph edge leaving at each edge, #INVALID_PATH_GRAPH_EDGE if none.
+	uint32 component;         ///< Connected component of the node (only valid while the components are up to date).
+};
+
+/** Edge in the path graph, a run of path tiles between two nodes. */
+struct PathGraphEdge {
+	XYZPoint16 ends[2];             ///< Coordinates of the nodes at both ends.
+	TileEdge directions[2];         ///< Edge of the end node where the run leaves.
+	std::vector<XYZPoint16> tiles;  ///< Tiles between the end nodes, in order from \c ends[0] to \c ends[1].
+};
+
+/**
+ * Connected parts of the path network, to quickly reject path searches that cannot succeed.
+ * The path tiles are kept as a graph with junctions and dead ends as nodes, and runs of path tiles between them as edges,
+ * so a change of a path tile only needs to retrace the runs around it. The connected components are labelled on the nodes.
+ * Changes of path tiles are recorded with #NotifyPathChanged, and processed before the next query.
+ */
+class PathGraph {
+public:
+	PathGraph();
+
+	void Clear();
+	void Rebuild();
+	void NotifyPathChanged(const XYZPoint16 &pos);
+
+	bool IsReachable(const XYZPoint16 &from, const XYZPoint16 &to);
+
+	/**
+	 * Get the number of changes of the path network so far, to detect that an earlier query may have a different answer now.
+	 * @return Change counter of the path network.
+	 */
+	inline uint32 GetChanges() const
+	{
+		return this->changes;
+	}
+
+private:
+	std::map<XYZPoint16, PathGraphNode> nodes;  ///< Nodes of the graph, by position.
+	std::map<uint32, PathGraphEdge> edges;      ///< Edges of the graph, by number.
+	std::map<XYZPoint16, uint32> run_tiles;     ///< Path tiles between nodes, and the edge containing them.
+	std::set<XYZPoint16> dirty;                 ///< Changed path tiles that still need processing.
+	uint32 next_edge;                           ///< Number of the next created edge.
+	uint32 changes;                             ///< Number of changes of the path network, see #GetChanges.
+	bool needs_rebuild;                         ///< The graph should be rebuilt from scratch before use.
+	bool components_valid;                      ///< Whether the connected components of the nodes are up to date.
+
+	void Update();
+	void UpdateComponents();
+	PathGraphNode *AddNode(const PathGraphNode &info);
+	void RemoveEdge(uint32 edge, std::set<XYZPoint16> *ends, std::set<XYZPoint16> *loose);
+	void RemoveTile(const XYZPoint16 &pos, std::set<XYZPoint16> *ends, std::set<XYZPoint16> *loose);
+	void TraceNode(const XYZPoint16 &pos);
+	void CoverLooseTiles(const std::set<XYZPoint16> &loose);
+	const PathGraphNode *GetRepresentative(const XYZPoint16 &pos);
+};
+
+extern PathGraph _path_graph;
+
+#endif
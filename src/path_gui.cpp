@@ -15,6 +15,7 @@
 #include "viewport.h"
 #include "language.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "mouse_mode.h"
 #include "path_build.h"
 #include "gui_sprites.h"
@@ -243,7 +244,7 @@ void PathBuildGui::TryAddRemovePath(uint8 m_state)
 	if ((m_state & MB_LEFT) != 0) {
 		this->BuildSinglePath(this->mouse_pos); // Build new path or change type of path.
 	} else if (instance == SRI_PATH && (m_state & MB_RIGHT) != 0) {
-		RemovePath(this->mouse_pos, false, true);
+		DoCommand(GCMD_REMOVE_PATH, {}, this->mouse_pos);
 	}
 }
 
@@ -373,21 +374,21 @@ void PathBuildGui::BuildSinglePath(const XYZPoint16 &pos)
 		/* Rebuilding the same path type can be useful for queue paths after their neighbours have
 		 * changed, as queue paths prefer to connect to other queue paths.
 		 */
-		ChangePath(pos, this->path_type, this->path_status, false, true);
+		DoCommand(GCMD_CHANGE_PATH, {this->path_type, this->path_status}, pos);
 		return;
 	}
 	if (sri != SRI_FREE) return; // Some other ride here.
 
 	TileSlope ts = ExpandTileSlope(v->GetGroundSlope());
 	if (ts == SL_FLAT) {
-		BuildFlatPath(pos, this->path_type, this->path_status, false, true);
+		DoCommand(GCMD_BUILD_FLAT_PATH, {this->path_type, this->path_status}, pos);
 		return;
 	}
 
 	ts ^= TSB_NORTH | TSB_EAST | TSB_SOUTH | TSB_WEST; // Swap raised and not raised corners.
 	for (TileEdge edge = EDGE_BEGIN; edge < EDGE_COUNT; edge++) {
 		if (ts == _corners_at_edge[edge]) { // 'edge' is at the low end due to swapping.
-			BuildUpwardPath(pos, edge, this->path_type, this->path_status, false, true);
+			DoCommand(GCMD_BUILD_UPWARD_PATH, {this->path_type, this->path_status, edge}, pos);
 			return;
 		}
 	}
@@ -730,16 +731,16 @@ void PathBuildGui::BuyPathTile()
 	switch (this->sel_slope) {
 		case TSL_UP: {
 			TileEdge start_edge = static_cast<TileEdge>((this->build_direction + 2) % 4);
-			BuildUpwardPath(path_pos, start_edge, this->path_type, this->path_status, false, true);
+			DoCommand(GCMD_BUILD_UPWARD_PATH, {this->path_type, this->path_status, start_edge}, path_pos);
 			break;
 		}
 		case TSL_FLAT:
-			BuildFlatPath(path_pos, this->path_type, this->path_status, false, true);
+			DoCommand(GCMD_BUILD_FLAT_PATH, {this->path_type, this->path_status}, path_pos);
 			break;
 
 		case TSL_DOWN: {
 			TileEdge start_edge = static_cast<TileEdge>((this->build_direction + 2) % 4);
-			BuildDownwardPath(path_pos, start_edge, this->path_type, this->path_status, false, true);
+			DoCommand(GCMD_BUILD_DOWNWARD_PATH, {this->path_type, this->path_status, start_edge}, path_pos);
 			path_pos.z--;
 			break;
 		}
@@ -766,7 +767,7 @@ void PathBuildGui::RemovePathTile()
 		if (!this->MoveSelection(false)) {
 			this->build_pos.x = -1; // Moving failed, let the user select a new tile.
 		}
-		RemovePath(remove_pos, false, true);
+		DoCommand(GCMD_REMOVE_PATH, {}, remove_pos);
 		this->SetButtons();
 		this->SetupSelector();
 	}
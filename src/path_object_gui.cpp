@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "finances.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "mouse_mode.h"
 #include "scenery.h"
 #include "viewport.h"
@@ -178,17 +179,7 @@ void PathObjectGui::SelectorMouseButtonEvent(MouseButtons state)
 	if (state != MB_LEFT) return;
 	if (this->object == nullptr) return;
 
-	const Money &cost = this->type->buy_cost;
-	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, cost)) return;
-	if (_game_control.action_test_mode) {
-		ShowCostOrReturnEstimate(cost);
-		return;
-	}
-
-	_finances_manager.PayLandscaping(cost);
-	_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->object->vox_pos);
-	_scenery.SetPathObjectInstance(this->object->vox_pos, this->type);
-	this->object.reset();
+	if (DoCommand(GCMD_PLACE_PATH_OBJECT, {this->type->type_id}, this->object->vox_pos) && !_game_control.action_test_mode) this->object.reset();
 }
 
 /**
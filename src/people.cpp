@@ -16,11 +16,15 @@
 #include "person_type.h"
 #include "ride_type.h"
 #include "path_finding.h"
+#include "path_graph.h"
+#include "queue.h"
 #include "person.h"
 #include "people.h"
 #include "gamelevel.h"
 #include "gameobserver.h"
 #include "finances.h"
+#include "trace.h"
+#include "memory_usage.h"
 #include <limits>
 
 Guests _guests; ///< %Guests in the world/park.
@@ -88,7 +92,7 @@ constexpr int GUEST_BLOCK_SIZE = 64;  ///< Number of guests to batch-allocate.
 #define FOR_EACH_ACTIVE_GUEST(block, g) for (auto &block : this->guests) for (Guest *g = block.get(); g < block.get() + GUEST_BLOCK_SIZE; ++g) if (g->IsActive())
 
 Guests::Guests()
-: start_voxel(-1, -1), rnd(), daily_frac(0)
+: start_voxel(-1, -1), rnd(RSK_GUEST_SPAWN, 0), daily_frac(0), next_guest_serial(0)
 {
 }
 
@@ -101,11 +105,13 @@ void Guests::Uninitialize()
 	this->start_voxel.x = -1;
 	this->start_voxel.y = -1;
 	this->daily_frac = 0;
+	this->rnd = Random(RSK_GUEST_SPAWN, 0);
+	this->next_guest_serial = 0;
 
 	for (Complaint &c : this->complaints) c = Complaint();
 }
 
-static const uint32 CURRENT_VERSION_GSTS = 2;   ///< Currently supported version of the GSTS Pattern.
+static const uint32 CURRENT_VERSION_GSTS = 3;   ///< Currently supported version of the GSTS Pattern.
 
 /**
  * Load guests from the save game.
@@ -118,17 +124,19 @@ void Guests::Load(Loader &ldr)
 		case 0:
 			break;
 		case 1:
-		case 2: {
+		case 2:
+		case 3: {
 			this->start_voxel.x = ldr.GetWord();
 			this->start_voxel.y = ldr.GetWord();
 			this->daily_frac = ldr.GetWord();
 			ldr.GetWord();  // Next daily index, currently unused.
-			ldr.GetLong();  // Next guest ID, currently unused.
+			this->next_guest_serial = ldr.GetLong();  // Always 0 before version 3.
 
 			if (version > 1) {
 				for (Complaint &c : this->complaints) c.counter = ldr.GetWord();
 				for (Complaint &c : this->complaints) c.time_since_message = ldr.GetLong();
 			}
+			if (version > 2) this->rnd.LoadState(ldr);
 
 			std::set<uint32> active_indices;
 			for (long i = ldr.GetLong(); i > 0; i--) {
@@ -167,10 +175,11 @@ void Guests::Save(Saver &svr)
 	svr.PutWord(this->start_voxel.y);
 	svr.PutWord(this->daily_frac);
 	svr.PutWord(0);  // Next daily index, currently unused.
-	svr.PutLong(0);  // Next guest ID, currently unused.
+	svr.PutLong(this->next_guest_serial);
 
 	for (const Complaint &c : this->complaints) svr.PutWord(c.counter);
 	for (const Complaint &c : this->complaints) svr.PutLong(c.time_since_message);
+	this->rnd.SaveState(svr);
 
 	svr.PutLong(this->CountActiveGuests());
 	FOR_EACH_ACTIVE_GUEST(block, g) {
@@ -180,6 +189,28 @@ void Guests::Save(Saver &svr)
 	svr.EndPattern();
 }
 
+/**
+ * Add the memory used by the guests to a memory report.
+ * The recolourings and the names are reported separately, as they are a large part of a guest.
+ * @param report [inout] Report to add to.
+ */
+void Guests::AddMemoryUsage(MemoryReport &report) const
+{
+	const size_t slots = this->guests.size() * GUEST_BLOCK_SIZE;
+	report.Add(MO_GUESTS, this->CountActiveGuests(), slots * (sizeof(Guest) - sizeof(Recolouring)) +
+			this->guests.capacity() * sizeof(this->guests[0]) + this->free_guest_indices.capacity() * sizeof(int));
+	report.Add(MO_GUEST_COLOURS, slots, slots * sizeof(Recolouring));
+
+	size_t names = 0;
+	size_t bytes = 0;
+	FOR_EACH_ACTIVE_GUEST(block, g) {
+		const size_t size = g->GetNameMemorySize();
+		if (size > 0) names++;
+		bytes += size;
+	}
+	report.Add(MO_GUEST_NAMES, names, bytes);
+}
+
 /**
  * Count the number of active guests in the world.
  * @return The number of active guests in the world.
@@ -212,6 +243,7 @@ uint32 Guests::CountGuestsInPark() const
  */
 void Guests::OnAnimate(int delay)
 {
+	_queues.OnAnimate(delay);
 	for (Complaint &c : this->complaints) c.time_since_message += delay;
 
 	FOR_EACH_ACTIVE_GUEST(block, g) {
@@ -262,6 +294,7 @@ void Guests::OnNewDay()
 		g = this->GetCreate(this->free_guest_indices.back());
 		this->free_guest_indices.pop_back();
 	}
+	g->SetRandomStream(RSK_GUEST, this->next_guest_serial++);
 	g->Activate(this->start_voxel, PERSON_GUEST);
 }
 
@@ -349,6 +382,7 @@ void Guests::Complain(const ComplaintType type)
 }
 
 static const uint16 STAFF_BASE_ID = std::numeric_limits<uint16>::max();  // Counting staff IDs backwards to avoid conflicts with %Guests.
+static const int MAX_MECHANIC_DISPATCHES_PER_TICK = 4;  ///< Maximum number of mechanic requests handled in a single tick.
 
 /** Remove all staff and reset all variables. */
 void Staff::Uninitialize()
@@ -435,6 +469,27 @@ void Staff::Save(Saver &svr)
 	svr.EndPattern();
 }
 
+/**
+ * Add the memory used by the staff to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void Staff::AddMemoryUsage(MemoryReport &report) const
+{
+	size_t count = 0;
+	size_t bytes = this->mechanic_requests.size() * (sizeof(RideInstance *) + MemoryReport::NODE_OVERHEAD);
+	auto add_list = [&count, &bytes](const auto &list) {
+		for (const auto &m : list) {
+			count++;
+			bytes += sizeof(*m) + sizeof(m) + MemoryReport::NODE_OVERHEAD + m->GetNameMemorySize() + m->route.capacity() * sizeof(m->route[0]);
+		}
+	};
+	add_list(this->mechanics);
+	add_list(this->handymen);
+	add_list(this->guards);
+	add_list(this->entertainers);
+	report.Add(MO_STAFF, count, bytes);
+}
+
 /**
  * Generates a unique ID for a newly hired staff member.
  * @return The ID to use.
@@ -471,6 +526,7 @@ Mechanic *Staff::HireMechanic()
 {
 	Mechanic *m = new Mechanic;
 	m->id = this->GenerateID();
+	m->SetRandomStream(RSK_STAFF, m->id);
 	m->Activate(Point16(9, 2), PERSON_MECHANIC);  // \todo Allow the player to decide where to put the new mechanic.
 	this->mechanics.push_back(std::unique_ptr<Mechanic>(m));
 	NameNewStaff(m, GUI_STAFF_NAME_MECHANIC);
@@ -485,6 +541,7 @@ Handyman *Staff::HireHandyman()
 {
 	Handyman *m = new Handyman;
 	m->id = this->GenerateID();
+	m->SetRandomStream(RSK_STAFF, m->id);
 	m->Activate(Point16(9, 2), PERSON_HANDYMAN);  // \todo Allow the player to decide where to put the new handyman.
 	this->handymen.push_back(std::unique_ptr<Handyman>(m));
 	NameNewStaff(m, GUI_STAFF_NAME_HANDYMAN);
@@ -499,6 +556,7 @@ Guard *Staff::HireGuard()
 {
 	Guard *m = new Guard;
 	m->id = this->GenerateID();
+	m->SetRandomStream(RSK_STAFF, m->id);
 	m->Activate(Point16(9, 2), PERSON_GUARD);  // \todo Allow the player to decide where to put the new guard.
 	this->guards.push_back(std::unique_ptr<Guard>(m));
 	NameNewStaff(m, GUI_STAFF_NAME_GUARD);
@@ -513,6 +571,7 @@ Entertainer *Staff::HireEntertainer()
 {
 	Entertainer *m = new Entertainer;
 	m->id = this->GenerateID();
+	m->SetRandomStream(RSK_STAFF, m->id);
 	m->Activate(Point16(9, 2), PERSON_ENTERTAINER);  // \todo Allow the player to decide where to put the new entertainer.
 	this->entertainers.push_back(std::unique_ptr<Entertainer>(m));
 	NameNewStaff(m, GUI_STAFF_NAME_ENTERTAINER);
@@ -659,36 +718,44 @@ void Staff::OnAnimate(const int delay)
 /** A new frame arrived. */
 void Staff::DoTick()
 {
-	/* Assign one mechanic request to the nearest available mechanic, if any. */
-	if (!this->mechanic_requests.empty() && !this->mechanics.empty()) {
-		EdgeCoordinate destination = this->mechanic_requests.front()->GetMechanicEntrance();
-		destination.coords.x += _tile_dxy[destination.edge].x;
-		destination.coords.y += _tile_dxy[destination.edge].y;
-
-		Mechanic *best = nullptr;
-		uint32 distance = 0;
+	TraceScope trace("Staff::DoTick");
+	/* Assign mechanic requests to the nearest available mechanic, if any. */
+	int handled = 0;
+	for (auto it = this->mechanic_requests.begin(); it != this->mechanic_requests.end() && handled < MAX_MECHANIC_DISPATCHES_PER_TICK; handled++) {
+		EdgeCoordinate destination = (*it)->GetMechanicEntrance();
+		XYZPoint16 p(destination.coords);
+		p.x += _tile_dxy[destination.edge].x;
+		p.y += _tile_dxy[destination.edge].y;
+		const XYZPoint16 below = p + XYZPoint16(0, 0, -1);  // In case the path leading to the mechanic entrance is sloping upwards.
+
+		/* Search from the ride to the nearest idle mechanic that can reach it. */
+		PathSearcher ps;
+		bool any_idle = false;
+		bool any_reachable = false;
 		for (auto &m : this->mechanics) {
 			if (m->ride != nullptr) continue;
+			any_idle = true;
+			if (!_path_graph.IsReachable(m->vox_pos, p) && !_path_graph.IsReachable(m->vox_pos, below)) continue;
 
-			PathSearcher ps(m->vox_pos);
-			XYZPoint16 p(destination.coords);
-			ps.AddStart(p);
-			p.z--;
-			ps.AddStart(p);  // In case the path leading to the mechanic entrance is sloping upwards.
+			ps.AddDestination(m->vox_pos);
+			any_reachable = true;
+		}
+		if (!any_idle) break;
 
-			if (!ps.Search()) continue;  // No path exists.
-			uint32 d = 0;
-			for (const WalkedPosition *it = ps.dest_pos; it->prev_pos != nullptr; it = it->prev_pos) d++;
+		ps.AddStart(p);
+		ps.AddStart(below);
+		if (!any_reachable || !ps.Search()) {
+			++it;  // No mechanic can get there now, try again later.
+			continue;
+		}
 
-			if (best == nullptr || d < distance) {
-				best = m.get();
-				distance = d;
+		for (auto &m : this->mechanics) {
+			if (m->ride == nullptr && m->vox_pos == ps.dest_pos->cur_vox) {
+				m->Assign(*it, ps.dest_pos);
+				break;
 			}
 		}
-		if (best != nullptr) {
-			best->Assign(this->mechanic_requests.front());
-			this->mechanic_requests.pop_front();
-		}
+		it = this->mechanic_requests.erase(it);
 	}
 }
 
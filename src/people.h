@@ -15,6 +15,8 @@
 
 #include "person.h"
 
+class MemoryReport;
+
 /**
  * All our guests.
  * @todo Allow to have several blocks of guests.
@@ -27,6 +29,7 @@ public:
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
+	void AddMemoryUsage(MemoryReport &report) const;
 
 	uint32 CountActiveGuests() const;
 	uint32 CountGuestsInPark() const;
@@ -59,8 +62,9 @@ public:
 	Point16 start_voxel;  ///< Entry x/y coordinate of the voxel stack at the edge (negative X/Y coordinate means invalid).
 
 private:
-	Random rnd;           ///< Random number generator for creating new guests.
-	int daily_frac;       ///< Frame counter.
+	Random rnd;                ///< Random number generator for creating new guests.
+	int daily_frac;            ///< Frame counter.
+	uint32 next_guest_serial;  ///< Serial number of the next new guest, identifying its random number stream.
 
 	/** Holds statistics about guest complaints of a specific type. */
 	struct Complaint {
@@ -104,6 +108,7 @@ public:
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
+	void AddMemoryUsage(MemoryReport &report) const;
 
 private:
 	uint16 GenerateID();
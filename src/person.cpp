@@ -21,9 +21,12 @@
 #include "map.h"
 #include "messages.h"
 #include "path_finding.h"
+#include "path_graph.h"
+#include "queue.h"
 #include "scenery.h"
 #include "viewport.h"
 #include "weather.h"
+#include "memory_usage.h"
 
 #include <cmath>
 
@@ -32,6 +35,17 @@ static PersonTypeData _person_type_datas[PERSON_TYPE_COUNT]; ///< Data about eac
 static const int QUEUE_DISTANCE = 64;  // The pixel distance between two guests queuing for a ride.
 assert_compile(256 % QUEUE_DISTANCE == 0);
 
+/**
+ * Check whether two queuing guests are close enough to block each other.
+ * @param a Position of the first guest.
+ * @param b Position of the second guest.
+ * @return The guests are closer than #QUEUE_DISTANCE.
+ */
+static inline bool IsQueuingDistance(const XYZPoint32 &a, const XYZPoint32 &b)
+{
+	return hypot(a.x - b.x, a.y - b.y) < QUEUE_DISTANCE;
+}
+
 const std::map<PersonType, Money> StaffMember::SALARY = {
 	{PERSON_MECHANIC,    Money(270)},  ///< Daily salary of a mechanic.
 	{PERSON_HANDYMAN,    Money(150)},  ///< Daily salary of a handyman.
@@ -41,12 +55,13 @@ const std::map<PersonType, Money> StaffMember::SALARY = {
 
 /**
  * Construct a recolour mapping of this person type.
+ * @param rnd Random number generator for picking the colours.
  * @return The constructed recolouring.
  */
-Recolouring PersonTypeGraphics::MakeRecolouring() const
+Recolouring PersonTypeGraphics::MakeRecolouring(Random &rnd) const
 {
 	Recolouring recolour(this->recolours);
-	recolour.AssignRandomColours();
+	recolour.AssignRandomColours(rnd);
 	return recolour;
 }
 
@@ -103,7 +118,7 @@ void LoadPRSG(RcdFileReader *rcd_file)
 	}
 }
 
-Person::Person() : rnd(), type(PERSON_INVALID), offset(this->rnd.Uniform(100)), ride(nullptr), status(GUI_PERSON_STATUS_WANDER)
+Person::Person() : rnd(), type(PERSON_INVALID), offset(50), ride(nullptr), status(GUI_PERSON_STATUS_WANDER)
 {
 }
 
@@ -141,6 +156,15 @@ std::string Person::GetName() const
 	return DrawText(GUI_GUEST_NAME, &p);
 }
 
+/**
+ * Get the memory allocated for the custom name of the person.
+ * @return Number of bytes allocated outside the person.
+ */
+size_t Person::GetNameMemorySize() const
+{
+	return GetStringHeapSize(this->name);
+}
+
 /** Recompute the height of the person. */
 void Person::UpdateZPosition()
 {
@@ -395,17 +419,17 @@ void Person::Activate(const Point16 &start, PersonType person_type)
 	this->type = person_type;
 	this->name.clear();
 	this->SetStatus(GUI_PERSON_STATUS_WANDER);
+	this->offset = this->rnd.Uniform(100);
 
 	/* Set up the person sprite recolouring table. */
 	const PersonTypeData &person_type_data = GetPersonTypeData(this->type);
-	this->recolour = person_type_data.graphics.MakeRecolouring();
+	this->recolour = person_type_data.graphics.MakeRecolouring(this->rnd);
 
 	/* Set up initial position. */
 	this->vox_pos.x = start.x;
 	this->vox_pos.y = start.y;
 	this->vox_pos.z = _world.GetBaseGroundHeight(start.x, start.y);
 	this->AddSelf(_world.GetCreateVoxel(this->vox_pos, false));
-	this->queuing_blocked_on = nullptr;
 
 	if (start.x == 0) {
 		this->pix_pos.x = 0;
@@ -811,7 +835,7 @@ private:
 	uint16 value;  ///< Encoded value to store in savegames.
 };
 
-static const uint32 CURRENT_VERSION_Person      = 3;   ///< Currently supported version of %Person.
+static const uint32 CURRENT_VERSION_Person      = 4;   ///< Currently supported version of %Person.
 static const uint32 CURRENT_VERSION_Guest       = 3;   ///< Currently supported version of %Guest.
 static const uint32 CURRENT_VERSION_StaffMember = 2;   ///< Currently supported version of %StaffMember.
 static const uint32 CURRENT_VERSION_Mechanic    = 2;   ///< Currently supported version of %Mechanic.
@@ -829,8 +853,6 @@ void Person::Load(Loader &ldr)
 	if (version < 1 || version > CURRENT_VERSION_Person) ldr.VersionMismatch(version, CURRENT_VERSION_Person);
 	this->VoxelObject::Load(ldr);
 
-	this->queuing_blocked_on = nullptr;  // Will be recalculated later in OnAnimate().
-
 	this->type = (PersonType)ldr.GetByte();
 	this->offset = ldr.GetWord();
 	this->name = ldr.GetText();
@@ -841,7 +863,7 @@ void Person::Load(Loader &ldr)
 	}
 
 	const PersonTypeData &person_type_data = GetPersonTypeData(this->type);
-	this->recolour = person_type_data.graphics.MakeRecolouring();
+	this->recolour = person_type_data.graphics.MakeRecolouring(this->rnd);
 	this->recolour.Load(ldr);
 
 	this->walk = WalkEncoder::Decode(ldr.GetWord());
@@ -850,6 +872,13 @@ void Person::Load(Loader &ldr)
 
 	if (version >= 3) this->status = GUI_PERSON_STATUS_WANDER + ldr.GetWord();
 
+	if (version >= 4) {
+		this->rnd.LoadState(ldr);
+	} else {
+		/* Older games have no streams, pick one that is not used by new guests. */
+		this->rnd = Random(this->IsGuest() ? RSK_GUEST : RSK_STAFF, (1ULL << 32) | this->id);
+	}
+
 	const Animation *anim = _sprite_manager.GetAnimation(walk->anim_type, this->type);
 	assert(anim != nullptr && anim->frame_count != 0);
 
@@ -880,6 +909,7 @@ void Person::Save(Saver &svr)
 	svr.PutWord(this->frame_index);
 	svr.PutWord((uint16)this->frame_time);
 	svr.PutWord(this->status - GUI_PERSON_STATUS_WANDER);
+	this->rnd.SaveState(svr);
 	svr.EndPattern();
 }
 
@@ -925,7 +955,7 @@ RideVisitDesire Person::ComputeExitDesire(TileEdge current_edge, XYZPoint16 cur_
 
 	const TileEdge original_exit_edge = exit_edge;
 	const XYZPoint16 original_cur_pos = cur_pos;
-	bool travel = this->WalksOnQueuePaths() || TravelQueuePath(&cur_pos, &exit_edge);
+	bool travel = this->WalksOnQueuePaths() || _queues.TravelQueuePath(&cur_pos, &exit_edge);
 	if (!travel) return RVD_NO_VISIT; // Path leads to nowhere.
 
 	if (PathExistsAtBottomEdge(cur_pos, exit_edge)) return RVD_NO_RIDE; // Found a path.
@@ -946,9 +976,19 @@ RideVisitDesire Person::ComputeExitDesire(TileEdge current_edge, XYZPoint16 cur_
 			case EDGE_SE: tile_edge_pix_pos.y = 255; break;
 			default: NOT_REACHED();
 		}
-		if (!this->IsQueuingGuest() && this->GetQueuingGuestNearby(original_cur_pos, tile_edge_pix_pos, false) != nullptr) {
-			ri->NotifyLongQueue();
-			return RVD_NO_VISIT;
+		if (!this->IsQueuingGuest()) {
+			const Guest *last = nullptr;
+			bool long_queue;
+			if (_queues.GetLastGuest(original_cur_pos, original_exit_edge, &last)) {
+				/* Only the last guest of the queue can be close to its end. */
+				long_queue = last != nullptr && IsQueuingDistance(last->MergeCoordinates(), MergeCoordinates(original_cur_pos, tile_edge_pix_pos));
+			} else {
+				long_queue = this->GetQueuingGuestNearby(original_cur_pos, tile_edge_pix_pos) != nullptr;
+			}
+			if (long_queue) {
+				ri->NotifyLongQueue();
+				return RVD_NO_VISIT;
+			}
 		}
 
 		if (ri == this->ride) {  // Guest decided before that this shop/ride should be visited.
@@ -984,6 +1024,7 @@ void Guest::NotifyRideDeletion(const RideInstance *ri)
 	if (this->ride == ri) {
 		switch (this->activity) {
 			case GA_QUEUING:
+				_queues.RemoveGuest(this);
 				this->activity = GA_WANDER;
 				this->ride = nullptr;
 				break;
@@ -1312,6 +1353,7 @@ void Guest::DecideMoveDirection()
 	this->SetStatus(this->activity == GA_GO_HOME ? GUI_PERSON_STATUS_GOING_HOME :
 			this->ride != nullptr ? GUI_PERSON_STATUS_HEADING_TO_RIDE :
 			GUI_PERSON_STATUS_WANDER);
+	_queues.UpdateGuest(this);
 }
 
 /**
@@ -1420,10 +1462,9 @@ bool Person::IsQueuingGuest() const
  * Check whether another guest who is queuing for a ride is standing close to the specified position.
  * @param vox_pos Coordinates of the voxel in the world.
  * @param pix_pos Pixel position inside the voxel.
- * @param only_in_front Whether to consider only guests standing in front of this one.
  * @return A queuing guest close by, or \c nullptr if there isn't one.
  */
-const Person *Person::GetQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZPoint16& pix_pos, const bool only_in_front)
+const Person *Person::GetQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZPoint16& pix_pos)
 {
 	/*
 	 * To ensure that guests on a neighbouring tile are also considered, we also need to check
@@ -1448,15 +1489,7 @@ const Person *Person::GetQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZ
 				Guest *g = dynamic_cast<Guest*>(v);
 				if (g == nullptr || !g->IsQueuingGuest()) continue;
 
-				const XYZPoint32 coords = g->MergeCoordinates();
-				if (hypot(coords.x - merged_pos.x, coords.y - merged_pos.y) < QUEUE_DISTANCE) {
-					if (!only_in_front) return g;
-					const AnimationFrame &frame = this->frames[this->frame_index];
-					if (frame.dx > 0 && coords.x > merged_pos.x) return g;
-					if (frame.dx < 0 && coords.x < merged_pos.x) return g;
-					if (frame.dy > 0 && coords.y > merged_pos.y) return g;
-					if (frame.dy < 0 && coords.y < merged_pos.y) return g;
-				}
+				if (IsQueuingDistance(g->MergeCoordinates(), merged_pos)) return g;
 			}
 		}
 	}
@@ -1473,20 +1506,6 @@ AnimateResult Person::InteractWithPathObject([[maybe_unused]] PathObjectInstance
 	return OAR_CONTINUE;
 }
 
-/**
- * Detect whether a group of people queuing behind each other contains a cyclic dependency.
- * @return This person has a cyclic queuing dependency.
- */
-bool Person::HasCyclicQueuingDependency() const
-{
-	std::set<const Person *> iterated = {this};
-	for (const Person *it = this->queuing_blocked_on; it != nullptr; it = it->queuing_blocked_on) {
-		if (iterated.count(it) > 0) return true;
-		iterated.insert(it);
-	}
-	return false;
-}
-
 /**
  * Update the animation of a person.
  * @param delay Amount of milliseconds since the last update.
@@ -1495,7 +1514,6 @@ bool Person::HasCyclicQueuingDependency() const
  */
 AnimateResult Person::OnAnimate(int delay)
 {
-	this->queuing_blocked_on = nullptr;
 	this->frame_time -= delay;
 	if (this->frame_time > 0) return OAR_OK;
 
@@ -1521,14 +1539,12 @@ AnimateResult Person::OnAnimate(int delay)
 
 	const AnimationFrame *frame = &this->frames[this->frame_index];
 	if (this->IsQueuingGuest()) {
-		this->queuing_blocked_on = this->GetQueuingGuestNearby(this->vox_pos, this->pix_pos, true);
-		if (this->queuing_blocked_on != nullptr && !this->HasCyclicQueuingDependency()) {
-			/* Freeze in place if we are too close to the person queuing in front of us. */
+		/* Freeze in place if we are too close to the guest ahead in the queue. The queue lines are ordered, so guests cannot wait for each other in a cycle. */
+		const Guest *ahead = static_cast<const Guest *>(this)->queue_ahead;
+		if (ahead != nullptr && IsQueuingDistance(ahead->MergeCoordinates(), this->MergeCoordinates())) {
 			this->frame_time += delay;
 			return OAR_OK;
 		}
-		/* Either there is no one in front of this person, or each person is waiting for the other one to make the first move. */
-		this->queuing_blocked_on = nullptr;
 	}
 	this->pix_pos.x += frame->dx;
 	this->pix_pos.y += frame->dy;
@@ -1779,8 +1795,9 @@ void Person::DecideMoveDirectionOnPathlessLand(Voxel *former_voxel, const XYZPoi
  * @return Result code of the visit.
  */
 
-Guest::Guest()
-= default;
+Guest::Guest() : queue(INVALID_QUEUE), queue_line(QLD_FRONT), queue_tile(0), queue_ahead(nullptr), queue_behind(nullptr)
+{
+}
 
 Guest::~Guest()
 = default;
@@ -1825,6 +1842,7 @@ void Guest::Activate(const Point16 &start, PersonType person_type)
 void Guest::DeActivate(AnimateResult ar)
 {
 	_guests.NotifyGuestDeactivation(this->id);
+	_queues.RemoveGuest(this);
 
 	if (this->IsActive()) {
 		/* Close possible Guest Info window */
@@ -1956,6 +1974,7 @@ AnimateResult Guest::VisitRideOnAnimate(RideInstance *ri, TileEdge exit_edge)
 			this->activity = GA_QUEUING;
 			return OAR_HALT;
 		}
+		_queues.RemoveGuest(this, rer != RER_REFUSED);
 		if (rer != RER_REFUSED) {
 			this->BuyItem(ri);
 			/* Either the guest is already back at a path or he will be (through ExitRide). */
@@ -2416,6 +2435,39 @@ AnimateResult StaffMember::EdgeOfWorldOnAnimate()
 	return OAR_CONTINUE;
 }
 
+/**
+ * Store the route to the current destination.
+ * @param route_start Current position of the staff member in a found path to the destination, may be \c nullptr to drop the route.
+ */
+void StaffMember::SetRoute(const WalkedPosition *route_start)
+{
+	this->route.clear();
+	for (const WalkedPosition *wp = route_start; wp != nullptr; wp = wp->prev_pos) this->route.push_back(wp->cur_vox);
+	std::reverse(this->route.begin(), this->route.end());
+}
+
+/**
+ * Take the next step of the cached route to the current destination.
+ * @return Whether the staff member is still on the route, and the route can still be walked.
+ */
+bool StaffMember::FollowRoute()
+{
+	if (this->route.size() < 2 || this->route.back() != this->vox_pos) return false;
+
+	const XYZPoint16 &next = this->route[this->route.size() - 2];
+	const TileEdge edge = GetAdjacentEdge(this->vox_pos.x, this->vox_pos.y, next.x, next.y);
+	if (edge == INVALID_EDGE) return false;
+
+	/* Check that the path has not been changed since the route was made. */
+	const Voxel *v = _world.GetVoxel(this->vox_pos);
+	XYZPoint16 ngb;
+	if (v == nullptr || !GetPathNeighbour(this->vox_pos, GetPathExits(v), edge, &ngb) || ngb != next) return false;
+
+	this->route.pop_back();
+	this->StartAnimation(_walk_path_tile[this->GetCurrentEdge()][edge]);
+	return true;
+}
+
 void StaffMember::DecideMoveDirection()
 {
 	/* \todo Lots of shared code with Guest::DecideMoveDirection and Guest::GetExitDirections. */
@@ -2526,11 +2578,13 @@ void Mechanic::Save(Saver &svr)
 /**
  * Order this mechanic to inspect a ride.
  * @param ri Ride to inspect.
+ * @param route_start If not \c nullptr, the current position of the mechanic in a found path to the ride.
  */
-void Mechanic::Assign(RideInstance *ri)
+void Mechanic::Assign(RideInstance *ri, const WalkedPosition *route_start)
 {
 	assert(this->ride == nullptr);
 	this->ride = ri;
+	this->SetRoute(route_start);
 	this->SetStatus(GUI_PERSON_STATUS_HEADING_TO_RIDE);
 }
 
@@ -2540,13 +2594,27 @@ void Mechanic::Assign(RideInstance *ri)
  */
 void Mechanic::NotifyRideDeletion(const RideInstance *ri)
 {
-	if (ri == this->ride) this->ride = nullptr;
+	if (ri == this->ride) {
+		this->ride = nullptr;
+		this->route.clear();
+	}
 }
 
 void Mechanic::DecideMoveDirection()
 {
-	if (this->ride == nullptr) return StaffMember::DecideMoveDirection();
+	if (this->ride == nullptr) {
+		this->route.clear();
+		return StaffMember::DecideMoveDirection();
+	}
+
+	if (this->route.size() == 1 && this->route.back() == this->vox_pos) {
+		/* Arrived at the destination. Entering the ride is handled by the parent class method. */
+		this->route.clear();
+		return StaffMember::DecideMoveDirection();
+	}
+	if (this->FollowRoute()) return;
 
+	/* No usable route, plan a new one. */
 	EdgeCoordinate destination = this->ride->GetMechanicEntrance();
 	destination.coords.x += _tile_dxy[destination.edge].x;
 	destination.coords.y += _tile_dxy[destination.edge].y;
@@ -2558,6 +2626,7 @@ void Mechanic::DecideMoveDirection()
 
 	if (!ps.Search()) {
 		/* Could not find a path from our position to the destination ride, probably because no such path exists. */
+		this->route.clear();
 		_staff.RequestMechanic(this->ride);
 		this->ride = nullptr;
 		return StaffMember::DecideMoveDirection();
@@ -2569,9 +2638,11 @@ void Mechanic::DecideMoveDirection()
 
 	if (prev == nullptr) {
 		/* Already at destination. Entering the ride is handled by the parent class method. */
+		this->route.clear();
 		return StaffMember::DecideMoveDirection();
 	}
 
+	this->SetRoute(prev);
 	const TileEdge edge = GetAdjacentEdge(dest->cur_vox.x, dest->cur_vox.y, prev->cur_vox.x, prev->cur_vox.y);
 	this->StartAnimation(_walk_path_tile[this->GetCurrentEdge()][edge]);
 }
@@ -2605,6 +2676,7 @@ AnimateResult Mechanic::ActionAnimationCallback()
 
 	this->ride->MechanicArrived();
 	this->ride = nullptr;
+	this->route.clear();
 
 	return OAR_CONTINUE;
 }
@@ -2644,10 +2716,17 @@ void Entertainer::Save(Saver &svr)
 }
 
 /* Constructor. */
-Handyman::Handyman() : activity(HandymanActivity::WANDER)
+Handyman::Handyman() : activity(HandymanActivity::WANDER), task(XYZPoint16::invalid()), failed_search_pos(XYZPoint16::invalid()),
+		failed_search_tasks(0), failed_search_paths(0)
 {
 }
 
+/* Destructor. */
+Handyman::~Handyman()
+{
+	this->ReleasePathTask();
+}
+
 void Handyman::Load(Loader &ldr)
 {
 	const uint32 version = ldr.OpenPattern("hndy");
@@ -2687,59 +2766,15 @@ void Handyman::DecideMoveDirection()
 		return;
 	}
 
-	const Voxel *vx = _world.GetVoxel(this->vox_pos);
-	const bool is_on_path = HasValidPath(vx);
-	if (is_on_path && _scenery.CountLitterAndVomit(this->vox_pos) > 0) {
-		bool found_other_handyman = false;
-		for (VoxelObject *o = vx->voxel_objects; o != nullptr; o = o->next_object) {
-			if (Handyman *h = dynamic_cast<Handyman*>(o)) {
-				if (h->activity == HandymanActivity::SWEEP) {
-					found_other_handyman = true;
-					break;
-				}
-			}
-		}
-		if (!found_other_handyman) {
-			this->SetStatus(GUI_PERSON_STATUS_SWEEPING);
-			this->activity = HandymanActivity::SWEEP;
-			this->StartAnimation(_handyman_sweep[(start_edge + 2) % 4]);
-			return;
-		}
+	const bool is_on_path = HasValidPath(_world.GetVoxel(this->vox_pos));
+	if (is_on_path) {
+		if (this->StartPathTask(start_edge)) return;
+		if (this->task != XYZPoint16::invalid() && this->HeadToPathTask()) return;
 	}
 
-	/* Consider emptying a bin if an overflowing one is nearby. */
+	/* Check if a flowerbed in need of watering is nearby. */
 	std::set<TileEdge> possible_edges;
 	uint8 nr_possible_edges = 0;
-	const PathObjectInstance *obj = _scenery.GetPathObject(this->vox_pos);
-	if (obj != nullptr) {
-		if (obj->type == &PathObjectType::LITTERBIN) {
-			for (TileEdge e = EDGE_BEGIN; e != EDGE_COUNT; e++) {
-				if (obj->GetExistsOnTileEdge(e) && !obj->GetDemolishedOnTileEdge(e) && obj->BinNeedsEmptying(e)) {
-					bool found_other_handyman = false;
-					for (VoxelObject *o = vx->voxel_objects; o != nullptr; o = o->next_object) {
-						if (Handyman *h = dynamic_cast<Handyman*>(o)) {
-							if (h->activity == static_cast<Handyman::HandymanActivity>(static_cast<int>(HandymanActivity::EMPTY_NE) + e)) {
-								found_other_handyman = true;
-								break;
-							}
-						}
-					}
-					if (!found_other_handyman) {
-						possible_edges.insert(e);
-						nr_possible_edges++;
-					}
-				}
-			}
-		}
-	}
-	if (nr_possible_edges > 0) {
-		auto it = possible_edges.begin();
-		if (nr_possible_edges > 1) std::advance(it, rnd.Uniform(nr_possible_edges - 1));
-		this->StartAnimation(_center_path_tile[start_edge][*it]);
-		return;
-	}
-
-	/* Check if a flowerbed in need of watering is nearby. */
 	for (TileEdge edge = EDGE_BEGIN; edge != EDGE_COUNT; edge++) {
 		XYZPoint16 pos = this->vox_pos;
 		pos.x += _tile_dxy[edge].x;
@@ -2782,9 +2817,132 @@ void Handyman::DecideMoveDirection()
 		return;
 	}
 
+	if (is_on_path && this->FindPathTask()) return;
+
 	return StaffMember::DecideMoveDirection();
 }
 
+/**
+ * Start the work at the current path tile, if there is any that no other handyman claimed.
+ * @param start_edge Edge where the handyman entered the tile.
+ * @return Whether the handyman started working.
+ */
+bool Handyman::StartPathTask(TileEdge start_edge)
+{
+	const std::map<XYZPoint16, PathTask> &tasks = _scenery.GetPathTasks();
+	const auto task_it = tasks.find(this->vox_pos);
+	if (task_it == tasks.end()) return false;
+	if (task_it->second.handyman != UNCLAIMED_PATH_TASK && task_it->second.handyman != this->id) return false;
+
+	if (this->task != this->vox_pos) {
+		/* Work that is right here is preferred over the claimed work elsewhere. */
+		this->ReleasePathTask();
+		this->task = this->vox_pos;
+		_scenery.ClaimPathTask(this->task, this->id);
+	}
+	this->route.clear();
+
+	if ((task_it->second.work & PTF_LITTER) != 0) {
+		this->SetStatus(GUI_PERSON_STATUS_SWEEPING);
+		this->activity = HandymanActivity::SWEEP;
+		this->StartAnimation(_handyman_sweep[(start_edge + 2) % 4]);
+		return true;
+	}
+
+	/* Walk to an overflowing bin, emptying it is started by #InteractWithPathObject. */
+	assert((task_it->second.work & PTF_FULL_BIN) != 0);
+	const PathObjectInstance *obj = _scenery.GetPathObject(this->vox_pos);
+	std::vector<TileEdge> possible_edges;
+	for (TileEdge e = EDGE_BEGIN; e != EDGE_COUNT; e++) {
+		if (obj->GetExistsOnTileEdge(e) && !obj->GetDemolishedOnTileEdge(e) && obj->BinNeedsEmptying(e)) possible_edges.push_back(e);
+	}
+	assert(!possible_edges.empty());
+	this->StartAnimation(_center_path_tile[start_edge][possible_edges[this->rnd.Uniform(possible_edges.size() - 1)]]);
+	return true;
+}
+
+/**
+ * Take the next step towards the claimed path task.
+ * @return Whether the handyman is still heading to the task.
+ */
+bool Handyman::HeadToPathTask()
+{
+	const std::map<XYZPoint16, PathTask> &tasks = _scenery.GetPathTasks();
+	const auto task_it = tasks.find(this->task);
+	if (task_it == tasks.end() || task_it->second.handyman != this->id) {
+		/* The work is gone already. */
+		this->task = XYZPoint16::invalid();
+		this->route.clear();
+		return false;
+	}
+
+	if (this->FollowRoute()) return true;
+
+	/* No usable route, plan a new one. */
+	PathSearcher ps(this->vox_pos);
+	ps.AddStart(this->task);
+	if (!ps.Search() || ps.dest_pos->prev_pos == nullptr) {
+		this->ReleasePathTask();
+		return false;
+	}
+
+	const WalkedPosition *prev = ps.dest_pos->prev_pos;
+	this->SetRoute(prev);
+	const TileEdge edge = GetAdjacentEdge(this->vox_pos.x, this->vox_pos.y, prev->cur_vox.x, prev->cur_vox.y);
+	this->StartAnimation(_walk_path_tile[this->GetCurrentEdge()][edge]);
+	return true;
+}
+
+/**
+ * Claim the unclaimed path task that is nearest by path distance, and start walking to it.
+ * The search is skipped if an earlier search from the same part of the path network failed, and no unclaimed tasks
+ * appeared and no paths changed since.
+ * @return Whether the handyman found work and is heading to it.
+ */
+bool Handyman::FindPathTask()
+{
+	assert(this->task == XYZPoint16::invalid());
+
+	if (this->failed_search_pos != XYZPoint16::invalid() && this->failed_search_tasks == _scenery.GetPathTaskChanges() &&
+			this->failed_search_paths == _path_graph.GetChanges() && _path_graph.IsReachable(this->failed_search_pos, this->vox_pos)) {
+		return false;
+	}
+
+	/* Search from all reachable unclaimed tasks to the handyman, the found path starts at the nearest one. */
+	PathSearcher ps(this->vox_pos);
+	bool has_tasks = false;
+	for (const auto &pair : _scenery.GetPathTasks()) {
+		if (pair.second.handyman != UNCLAIMED_PATH_TASK || !_path_graph.IsReachable(this->vox_pos, pair.first)) continue;
+		ps.AddStart(pair.first);
+		has_tasks = true;
+	}
+	if (!has_tasks || !ps.Search() || ps.dest_pos->prev_pos == nullptr) {
+		this->failed_search_pos = this->vox_pos;
+		this->failed_search_tasks = _scenery.GetPathTaskChanges();
+		this->failed_search_paths = _path_graph.GetChanges();
+		return false;
+	}
+	this->failed_search_pos = XYZPoint16::invalid();
+
+	const WalkedPosition *prev = ps.dest_pos->prev_pos;
+	this->SetRoute(prev);
+	this->task = this->route.front();
+	_scenery.ClaimPathTask(this->task, this->id);
+	this->SetStatus(GUI_PERSON_STATUS_WANDER);  // Sweeping or emptying starts on arrival.
+
+	const TileEdge edge = GetAdjacentEdge(this->vox_pos.x, this->vox_pos.y, prev->cur_vox.x, prev->cur_vox.y);
+	this->StartAnimation(_walk_path_tile[this->GetCurrentEdge()][edge]);
+	return true;
+}
+
+/** Give up the claimed path task, if there is one. */
+void Handyman::ReleasePathTask()
+{
+	if (this->task != XYZPoint16::invalid()) _scenery.ReleasePathTask(this->task, this->id);
+	this->task = XYZPoint16::invalid();
+	this->route.clear();
+}
+
 AnimateResult Handyman::InteractWithPathObject(PathObjectInstance *obj)
 {
 	const TileEdge edge = this->GetCurrentEdge();
@@ -2825,6 +2983,7 @@ AnimateResult Handyman::ActionAnimationCallback()
 
 		default: NOT_REACHED();
 	}
+	if (this->activity != HandymanActivity::WATER) this->ReleasePathTask();
 	this->activity = HandymanActivity::WANDER;
 	return OAR_CONTINUE;
 }
@@ -18,6 +18,7 @@
 class PathObjectInstance;
 struct WalkInformation;
 class RideInstance;
+class WalkedPosition;
 
 /**
  * Limits that exist at the tile.
@@ -111,6 +112,16 @@ public:
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
 
+	/**
+	 * Attach the random number generator of the person to a new stream, before activating the person.
+	 * @param kind Kind of person.
+	 * @param id Identification of the person, unique among persons of the same \a kind.
+	 */
+	void SetRandomStream(RandomStreamKind kind, uint64 id)
+	{
+		this->rnd = Random(kind, id);
+	}
+
 	/**
 	 * Test whether this person is active in the game or not.
 	 * @return Whether the person is active in the game.
@@ -130,7 +141,7 @@ public:
 	}
 
 	bool IsQueuingGuest() const;
-	const Person *GetQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZPoint16& pix_pos, bool only_in_front);
+	const Person *GetQueuingGuestNearby(const XYZPoint16& vox_pos, const XYZPoint16& pix_pos);
 
 	/**
 	 * Test whether this person type treats queue paths like normal paths.
@@ -141,6 +152,7 @@ public:
 	void SetName(const std::string &name);
 	std::string GetName() const;
 	std::string GetStatus() const;
+	size_t GetNameMemorySize() const;
 
 protected:
 	Random rnd; ///< Random number generator for deciding how the person reacts.
@@ -161,7 +173,6 @@ public:
 protected:
 	std::string name; ///< Name of the person. \c "" means it has a default name (like "Guest XYZ").
 	StringID status;  ///< What the person is doing right now, for display in the GUI.
-	const Person *queuing_blocked_on;  ///< The person standing before this one in the queue, if this is a queuing guest.
 
 	TileEdge GetCurrentEdge() const;
 	uint8 GetInparkDirections();
@@ -179,7 +190,6 @@ protected:
 	virtual bool IsLeavingPath() const;
 	void UpdateZPosition();
 	void SetStatus(StringID s);
-	bool HasCyclicQueuingDependency() const;
 };
 
 /** Activities of the guest. */
@@ -258,6 +268,12 @@ public:
 	uint32 max_ride_nausea;            ///< Highest tolerated ride nausea rating.
 	uint32 min_ride_excitement;        ///< Lowest tolerated ride excitement rating.
 
+	uint32 queue;          ///< Number of the queue the guest is walking through (#INVALID_QUEUE if none), see #Queues.
+	uint8 queue_line;      ///< Direction of walking through the queue, see #QueueLineDirection.
+	uint32 queue_tile;     ///< Index of the current tile in the queue.
+	Guest *queue_ahead;    ///< Guest directly ahead in the queue, if any.
+	Guest *queue_behind;   ///< Guest directly behind in the queue, if any.
+
 protected:
 	void DecideMoveDirection() override;
 	uint8 GetExitDirections(const Voxel *v, TileEdge start_edge, bool *seen_wanted_ride, bool *queue_mode);
@@ -286,6 +302,12 @@ public:
 	RideVisitDesire WantToVisit(const RideInstance *ri, const XYZPoint16 &ride_pos, TileEdge exit_edge) override;
 
 	static const std::map<PersonType, Money> SALARY;   ///< The monthly salary for each staff member.
+
+	std::vector<XYZPoint16> route;  ///< Cached route to the current destination. The back is the current voxel, the front is the destination voxel.
+
+protected:
+	void SetRoute(const WalkedPosition *route_start);
+	bool FollowRoute();
 };
 
 /** A mechanic who can repair and inspect rides. */
@@ -298,7 +320,7 @@ public:
 	void Save(Saver &svr);
 
 	void DecideMoveDirection() override;
-	void Assign(RideInstance *ri);
+	void Assign(RideInstance *ri, const WalkedPosition *route_start = nullptr);
 	void NotifyRideDeletion(const RideInstance *ri);
 
 	AnimateResult VisitRideOnAnimate(RideInstance *ri, TileEdge exit_edge) override;
@@ -366,6 +388,7 @@ public:
 	};
 
 	Handyman();
+	~Handyman();
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
@@ -380,6 +403,18 @@ public:
 	}
 
 	HandymanActivity activity;  ///< What the handyman is doing right now.
+	XYZPoint16 task;            ///< Path tile with work claimed by the handyman, or XYZPoint16::invalid() if none.
+
+private:
+	/* Outcome of the last failed search for path tasks, to avoid repeating it while nothing changed (not saved). */
+	XYZPoint16 failed_search_pos;  ///< Position of the handyman in the last failed search, or XYZPoint16::invalid() if none.
+	uint32 failed_search_tasks;    ///< Path task change counter at the last failed search.
+	uint32 failed_search_paths;    ///< Path network change counter at the last failed search.
+
+	bool StartPathTask(TileEdge start_edge);
+	bool HeadToPathTask();
+	bool FindPathTask();
+	void ReleasePathTask();
 };
 
 #endif
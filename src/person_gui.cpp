@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "math_func.h"
 #include "window.h"
+#include "command.h"
 #include "person_type.h"
 #include "sprite_store.h"
 #include "ride_type.h"
@@ -203,7 +204,7 @@ void StaffInfoWindow::SetWidgetStringParameters(WidgetNumber wid_num) const
 
 void StaffInfoWindow::OnClick(WidgetNumber number, [[maybe_unused]] const Point16 &pos)
 {
-	if (number == SIW_DISMISS) _staff.Dismiss(this->person);  // This also deletes this window.
+	if (number == SIW_DISMISS) DoCommand(GCMD_DISMISS_STAFF, {this->person->type, this->person->id});  // This also deletes this window.
 }
 
 void StaffInfoWindow::OnChange(ChangeCode code, [[maybe_unused]] uint32 parameter)
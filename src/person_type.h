@@ -33,7 +33,7 @@ DECLARE_POSTFIX_INCREMENT(PersonType)
 struct PersonTypeGraphics {
 	Recolouring recolours; ///< Random colour remapping.
 
-	Recolouring MakeRecolouring() const;
+	Recolouring MakeRecolouring(Random &rnd) const;
 };
 
 /** Collection of data for each person type. */
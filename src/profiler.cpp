@@ -0,0 +1,177 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file profiler.cpp Measuring the time spent in the parts of the game. */
+
+#include "stdafx.h"
+#include "profiler.h"
+#include "fileio.h"
+#include "rev.h"
+#include <algorithm>
+#include <ctime>
+
+Profiler _profiler; ///< Profiler of the game.
+
+/** Names of the sections that are not a #TickSubsystem, starting at #PFS_SPRITE_COLLECT. */
+static const char * const _profile_section_names[PFS_COUNT - TSS_COUNT] = {
+	"collect",
+	"sort",
+	"blit",
+	"gui",
+	"present",
+};
+
+/**
+ * Convert a duration to milliseconds.
+ * @param duration Duration to convert.
+ * @return The duration in milliseconds.
+ */
+static double ToMilliseconds(std::chrono::nanoseconds duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+Profiler::Profiler() : enabled(false), history(HISTORY_LENGTH), next_sample(0), sample_count(0)
+{
+	std::fill_n(this->current, PFS_COUNT, std::chrono::nanoseconds::zero());
+}
+
+/**
+ * Get the name of a section, for displaying.
+ * @param section Section to get the name of.
+ * @return Name of the section.
+ */
+/* static */ const char *Profiler::GetSectionName(ProfileSection section)
+{
+	if (section < PFS_SPRITE_COLLECT) return _tick_subsystem_names[section];
+	return _profile_section_names[section - PFS_SPRITE_COLLECT];
+}
+
+/**
+ * Start or stop measuring. Starting clears the measurements of earlier frames.
+ * @param enable Whether to measure.
+ */
+void Profiler::SetEnabled(bool enable)
+{
+	if (enable && !this->enabled) {
+		std::fill_n(this->current, PFS_COUNT, std::chrono::nanoseconds::zero());
+		this->history.assign(HISTORY_LENGTH, FrameSample());
+		this->next_sample = 0;
+		this->sample_count = 0;
+	}
+	this->enabled = enable;
+}
+
+/**
+ * Add the time spent by the simulation to the current frame.
+ * @param times Time spent in each tick subsystem.
+ */
+void Profiler::AddTickTimes(const TickSubsystemTimes &times)
+{
+	for (int i = 0; i < TSS_COUNT; i++) this->current[i] += times.duration[i];
+}
+
+/**
+ * Finish measuring a frame, and store its measurements in the history.
+ * @param frame_time Time spent on the frame.
+ */
+void Profiler::EndFrame(std::chrono::nanoseconds frame_time)
+{
+	if (!this->enabled) return;
+
+	FrameSample &sample = this->history[this->next_sample];
+	std::copy_n(this->current, PFS_COUNT, sample.section);
+	sample.frame = frame_time;
+	std::fill_n(this->current, PFS_COUNT, std::chrono::nanoseconds::zero());
+	this->next_sample = (this->next_sample + 1) % HISTORY_LENGTH;
+	if (this->sample_count < HISTORY_LENGTH) this->sample_count++;
+}
+
+/**
+ * Compute the average and maximum time of a section over the frames in the history.
+ * @param section Section to examine.
+ * @return The statistics of the section.
+ */
+ProfileStatistics Profiler::GetStatistics(ProfileSection section) const
+{
+	if (this->sample_count == 0) return {0.0, 0.0};
+
+	std::chrono::nanoseconds total(0);
+	std::chrono::nanoseconds maximum(0);
+	for (uint32 i = 0; i < this->sample_count; i++) {
+		total += this->history[i].section[section];
+		maximum = std::max(maximum, this->history[i].section[section]);
+	}
+	return {ToMilliseconds(total) / this->sample_count, ToMilliseconds(maximum)};
+}
+
+/**
+ * Compute the average and maximum frame time over the frames in the history.
+ * @return The statistics of the frame time.
+ */
+ProfileStatistics Profiler::GetFrameStatistics() const
+{
+	if (this->sample_count == 0) return {0.0, 0.0};
+
+	std::chrono::nanoseconds total(0);
+	std::chrono::nanoseconds maximum(0);
+	for (uint32 i = 0; i < this->sample_count; i++) {
+		total += this->history[i].frame;
+		maximum = std::max(maximum, this->history[i].frame);
+	}
+	return {ToMilliseconds(total) / this->sample_count, ToMilliseconds(maximum)};
+}
+
+/**
+ * Compute a percentile of the frame times in the history.
+ * @param percentile Requested percentile, between \c 0 and \c 100.
+ * @return The frame time of the percentile, in milliseconds.
+ */
+double Profiler::GetFramePercentile(uint32 percentile) const
+{
+	assert(percentile <= 100);
+	if (this->sample_count == 0) return 0.0;
+
+	std::vector<std::chrono::nanoseconds> times;
+	times.reserve(this->sample_count);
+	for (uint32 i = 0; i < this->sample_count; i++) times.push_back(this->history[i].frame);
+
+	const uint32 index = std::min(this->sample_count - 1, percentile * this->sample_count / 100);
+	std::nth_element(times.begin(), times.begin() + index, times.end());
+	return ToMilliseconds(times[index]);
+}
+
+/**
+ * Write the measurements of the frames in the history to a CSV file in the user data directory, oldest frame first.
+ * @return Name of the written file, or the empty string if writing failed.
+ */
+std::string Profiler::ExportCsv() const
+{
+	char stamp[32];
+	const std::time_t now = std::time(nullptr);
+	std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+	const std::string fname = freerct_userdata_prefix() + DIR_SEP + "profile_" + stamp + ".csv";
+
+	FILE *fp = fopen(fname.c_str(), "w");
+	if (fp == nullptr) return std::string();
+
+	fprintf(fp, "frame,frame_ms");
+	for (int s = 0; s < PFS_COUNT; s++) fprintf(fp, ",%s_ms", GetSectionName(static_cast<ProfileSection>(s)));
+	fprintf(fp, "\n");
+
+	const uint32 first = (this->next_sample + HISTORY_LENGTH - this->sample_count) % HISTORY_LENGTH;
+	for (uint32 i = 0; i < this->sample_count; i++) {
+		const FrameSample &sample = this->history[(first + i) % HISTORY_LENGTH];
+		fprintf(fp, "%u,%.4f", i, ToMilliseconds(sample.frame));
+		for (int s = 0; s < PFS_COUNT; s++) fprintf(fp, ",%.4f", ToMilliseconds(sample.section[s]));
+		fprintf(fp, "\n");
+	}
+
+	const bool ok = ferror(fp) == 0;
+	fclose(fp);
+	return ok ? fname : std::string();
+}
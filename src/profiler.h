@@ -0,0 +1,114 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file profiler.h Measuring the time spent in the parts of the game. */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "gamecontrol.h"
+
+/**
+ * Parts of a frame measured by the profiler.
+ * The sections before #PFS_SPRITE_COLLECT are the #TickSubsystem of the simulation.
+ */
+enum ProfileSection {
+	PFS_SPRITE_COLLECT = TSS_COUNT,  ///< Collecting the sprites of the viewport.
+	PFS_SPRITE_SORT,                 ///< Sorting the sprites of the viewport.
+	PFS_SPRITE_BLIT,                 ///< Drawing the sprites of the viewport.
+	PFS_GUI,                         ///< Drawing the other windows.
+	PFS_PRESENT,                     ///< Displaying the finished frame.
+
+	PFS_COUNT,                       ///< Number of profiled sections.
+};
+
+/** Statistics of a profiled section over the recent frames. */
+struct ProfileStatistics {
+	double average; ///< Average time per frame, in milliseconds.
+	double maximum; ///< Highest time in a frame, in milliseconds.
+};
+
+/** Collects the time spent in the sections of the game over the recent frames. */
+class Profiler {
+public:
+	static constexpr uint32 HISTORY_LENGTH = 256; ///< Number of frames kept in the history.
+
+	Profiler();
+
+	/**
+	 * Whether the profiler is measuring.
+	 * @return The profiler is enabled.
+	 */
+	inline bool IsEnabled() const
+	{
+		return this->enabled;
+	}
+
+	/**
+	 * Add time spent in a section to the current frame.
+	 * @param section Section that was running.
+	 * @param duration Time spent in the section.
+	 */
+	inline void Add(ProfileSection section, std::chrono::nanoseconds duration)
+	{
+		this->current[section] += duration;
+	}
+
+	void SetEnabled(bool enable);
+	void AddTickTimes(const TickSubsystemTimes &times);
+	void EndFrame(std::chrono::nanoseconds frame_time);
+
+	ProfileStatistics GetStatistics(ProfileSection section) const;
+	ProfileStatistics GetFrameStatistics() const;
+	double GetFramePercentile(uint32 percentile) const;
+	std::string ExportCsv() const;
+
+	static const char *GetSectionName(ProfileSection section);
+
+private:
+	/** Measurements of one frame. */
+	struct FrameSample {
+		std::chrono::nanoseconds section[PFS_COUNT]; ///< Time spent in each section.
+		std::chrono::nanoseconds frame;              ///< Time spent on the entire frame, excluding waiting for the next frame.
+	};
+
+	bool enabled;                                 ///< Whether the profiler is measuring.
+	std::chrono::nanoseconds current[PFS_COUNT];  ///< Time spent in each section in the current frame.
+	std::vector<FrameSample> history;             ///< Ring buffer of the measurements of the recent frames.
+	uint32 next_sample;                           ///< Index in #history of the next frame to store.
+	uint32 sample_count;                          ///< Number of frames stored in #history.
+};
+
+extern Profiler _profiler;
+
+/** Adds the time spent in a scope to a section of the profiler, if it is enabled. */
+class ProfileScope {
+public:
+	/**
+	 * Start measuring a scope.
+	 * @param section Section to add the time to.
+	 */
+	explicit ProfileScope(ProfileSection section) : section(section), active(_profiler.IsEnabled())
+	{
+		if (this->active) this->start = std::chrono::steady_clock::now();
+	}
+
+	~ProfileScope()
+	{
+		if (this->active) _profiler.Add(this->section, std::chrono::steady_clock::now() - this->start);
+	}
+
+private:
+	ProfileSection section;                        ///< Section being measured.
+	bool active;                                   ///< Whether the scope is measured.
+	std::chrono::steady_clock::time_point start;   ///< Start of the scope.
+};
+
+#endif
@@ -0,0 +1,486 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file queue.cpp Queues of guests at the queue paths. */
+
+#include "stdafx.h"
+#include "queue.h"
+#include "map.h"
+#include "path.h"
+#include "person.h"
+#include "ride_type.h"
+
+Queues _queues; ///< Queues in the world.
+
+Queue::Queue() : ride(nullptr), admission_interval(0), last_admission(0)
+{
+	for (QueueLine &line : this->lines) line = {nullptr, nullptr, 0};
+}
+
+/** Queue path tiles connected to a queue path tile. */
+struct QueueTileLinks {
+	uint8 count;               ///< Number of connected queue path tiles.
+	TileEdge edges[2];         ///< Edges of the first two connected queue path tiles.
+	XYZPoint16 neighbours[2];  ///< Coordinates of the first two connected queue path tiles.
+};
+
+/**
+ * Is there a queue path at the given position?
+ * @param pos Coordinate of the voxel.
+ * @return Whether the voxel has a queue path.
+ */
+static bool IsQueuePath(const XYZPoint16 &pos)
+{
+	if (!IsVoxelstackInsideWorld(pos.x, pos.y) || pos.z < 0 || pos.z >= WORLD_Z_SIZE) return false;
+	const Voxel *v = _world.GetVoxel(pos);
+	return v != nullptr && HasValidPath(v) && GetPathStatus(v->GetInstanceData()) == PAS_QUEUE_PATH;
+}
+
+/**
+ * Select the edge where a queue leaves its last tile.
+ * @param pos Coordinate of the queue path tile at the end of the queue.
+ * @param used Edges of the tile leading to other tiles of the queue.
+ * @param inward Edge leading to the next tile of the queue, #INVALID_EDGE if the queue has a single tile.
+ * @return The edge leading out of the queue, preferably towards a ride.
+ */
+static TileEdge GetQueueExitEdge(const XYZPoint16 &pos, uint8 used, TileEdge inward)
+{
+	const uint8 exits = GetPathExits(_world.GetVoxel(pos));
+	TileEdge found = INVALID_EDGE;
+	for (TileEdge edge = EDGE_BEGIN; edge != EDGE_COUNT; edge++) {
+		if ((exits & (0x11 << edge)) == 0 || (used & (1 << edge)) != 0) continue;
+		if (RideExistsAtBottom(pos, edge) != nullptr) return edge;
+		if (found == INVALID_EDGE) found = edge;
+	}
+	if (found != INVALID_EDGE) return found;
+	return (inward == INVALID_EDGE) ? EDGE_NE : static_cast<TileEdge>((inward + 2) % 4);
+}
+
+/**
+ * Get the pixel distance to walk from a position in a tile to an edge of the tile.
+ * @param pix_pos Position inside the tile.
+ * @param edge Edge to walk to.
+ * @return Distance to the edge.
+ */
+static int GetEdgeDistance(const XYZPoint16 &pix_pos, TileEdge edge)
+{
+	switch (edge) {
+		case EDGE_NE: return pix_pos.x;
+		case EDGE_SE: return 255 - pix_pos.y;
+		case EDGE_SW: return 255 - pix_pos.x;
+		case EDGE_NW: return pix_pos.y;
+		default: NOT_REACHED();
+	}
+}
+
+Queues::Queues() : time(0), needs_rebuild(true), queues_valid(false)
+{
+}
+
+/** Remove all queues. They get rebuilt from the world when needed. */
+void Queues::Clear()
+{
+	this->queues.clear();
+	this->tiles.clear();
+	this->queue_paths.clear();
+	this->dirty.clear();
+	this->travels.clear();
+	this->time = 0;
+	this->needs_rebuild = true;
+}
+
+/** Construct the queues from all queue path tiles in the world. */
+void Queues::Rebuild()
+{
+	this->Clear();
+	this->needs_rebuild = false;
+
+	for (uint16 x = 0; x < _world.GetXSize(); x++) {
+		for (uint16 y = 0; y < _world.GetYSize(); y++) {
+			const VoxelStack *vs = _world.GetStack(x, y);
+			for (uint16 i = 0; i < vs->height; i++) {
+				const XYZPoint16 pos(x, y, vs->base + i);
+				if (IsQueuePath(pos)) this->queue_paths.insert(pos);
+			}
+		}
+	}
+	this->BuildQueues();
+}
+
+/**
+ * Some time has passed.
+ * @param delay Number of milliseconds that passed.
+ */
+void Queues::OnAnimate(int delay)
+{
+	this->time += delay;
+}
+
+/**
+ * Notify the queues of a change of a path tile.
+ * @param pos Coordinate of the changed path tile.
+ */
+void Queues::NotifyPathChanged(const XYZPoint16 &pos)
+{
+	this->dirty.insert(pos);
+	this->travels.clear();
+}
+
+/** Notify the queues of the removal of a ride. */
+void Queues::NotifyRideDeletion()
+{
+	this->queues_valid = false;
+}
+
+/** Process the recorded path changes. */
+void Queues::Update()
+{
+	if (this->needs_rebuild) {
+		this->Rebuild();
+		return;
+	}
+	if (!this->dirty.empty()) {
+		for (const XYZPoint16 &pos : this->dirty) {
+			for (int dz = -1; dz <= 1; dz++) this->UpdateQueuePath(XYZPoint16(pos.x, pos.y, pos.z + dz));
+		}
+		this->dirty.clear();
+		this->queues_valid = false;
+	}
+	if (!this->queues_valid) this->BuildQueues();
+}
+
+/**
+ * Update whether a voxel is a queue path tile.
+ * @param pos Coordinate of the voxel.
+ */
+void Queues::UpdateQueuePath(const XYZPoint16 &pos)
+{
+	if (IsQueuePath(pos)) {
+		this->queue_paths.insert(pos);
+	} else {
+		this->queue_paths.erase(pos);
+	}
+}
+
+/** Split the queue path tiles into queues, and move the queuing guests into the new queues. */
+void Queues::BuildQueues()
+{
+	/* Collect the queuing guests, and the admission statistics of the queues. */
+	std::vector<Guest *> guests;
+	std::map<XYZPoint16, std::pair<uint32, uint32>> admissions;
+	for (const Queue &q : this->queues) {
+		for (const QueueLine &line : q.lines) {
+			for (Guest *g = line.first; g != nullptr; g = g->queue_behind) guests.push_back(g);
+		}
+		if (q.admission_interval > 0) admissions[q.tiles.front()] = {q.admission_interval, q.last_admission};
+	}
+	for (Guest *g : guests) {
+		g->queue = INVALID_QUEUE;
+		g->queue_ahead = nullptr;
+		g->queue_behind = nullptr;
+	}
+	this->queues.clear();
+	this->tiles.clear();
+	this->queues_valid = true;
+
+	/* Find the connections between the queue path tiles, only keep unbranched ones. */
+	std::map<XYZPoint16, QueueTileLinks> links;
+	for (const XYZPoint16 &pos : this->queue_paths) {
+		QueueTileLinks &tile_links = links[pos];
+		tile_links.count = 0;
+		const uint8 exits = GetPathExits(_world.GetVoxel(pos));
+		for (TileEdge edge = EDGE_BEGIN; edge != EDGE_COUNT; edge++) {
+			XYZPoint16 ngb;
+			if (!GetPathNeighbour(pos, exits, edge, &ngb) || this->queue_paths.count(ngb) == 0) continue;
+			if (tile_links.count < 2) {
+				tile_links.edges[tile_links.count] = edge;
+				tile_links.neighbours[tile_links.count] = ngb;
+			}
+			tile_links.count++;
+		}
+	}
+	for (auto it = links.begin(); it != links.end();) {
+		if (it->second.count > 2) {
+			it = links.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (auto &pair : links) {
+		QueueTileLinks &tile_links = pair.second;
+		for (uint8 i = 0; i < tile_links.count;) {
+			/* Drop links to branching tiles, and links that only exist in one direction. */
+			const auto ngb = links.find(tile_links.neighbours[i]);
+			bool linked = false;
+			if (ngb != links.end()) {
+				for (uint8 j = 0; j < ngb->second.count && j < 2; j++) linked |= ngb->second.neighbours[j] == pair.first;
+			}
+			if (linked) {
+				i++;
+				continue;
+			}
+			tile_links.count--;
+			if (i == 0) {
+				tile_links.edges[0] = tile_links.edges[1];
+				tile_links.neighbours[0] = tile_links.neighbours[1];
+			}
+		}
+	}
+
+	/* Walk from the end tiles through the queues. Tiles in cycles stay without queue. */
+	std::set<XYZPoint16> done;
+	for (const auto &pair : links) {
+		if (pair.second.count == 2 || done.count(pair.first) > 0) continue;
+
+		Queue q;
+		std::vector<uint8> used_edges;
+		XYZPoint16 prev = XYZPoint16::invalid();
+		XYZPoint16 cur = pair.first;
+		for (;;) {
+			const QueueTileLinks &tile_links = links.at(cur);
+			q.tiles.push_back(cur);
+			done.insert(cur);
+
+			uint8 used = 0;
+			XYZPoint16 next = XYZPoint16::invalid();
+			for (uint8 i = 0; i < tile_links.count; i++) {
+				used |= 1 << tile_links.edges[i];
+				if (tile_links.neighbours[i] != prev) next = tile_links.neighbours[i];
+			}
+			used_edges.push_back(used);
+			if (next == XYZPoint16::invalid() || done.count(next) > 0) break;
+			prev = cur;
+			cur = next;
+		}
+
+		/* Edges between the tiles, and the edges leaving the queue at both ends. */
+		const uint32 length = q.tiles.size();
+		q.front_edges.resize(length);
+		q.back_edges.resize(length);
+		for (uint32 i = 0; i + 1 < length; i++) {
+			q.back_edges[i] = GetAdjacentEdge(q.tiles[i].x, q.tiles[i].y, q.tiles[i + 1].x, q.tiles[i + 1].y);
+			q.front_edges[i + 1] = static_cast<TileEdge>((q.back_edges[i] + 2) % 4);
+		}
+		q.front_edges[0] = GetQueueExitEdge(q.tiles[0], used_edges[0], length > 1 ? q.back_edges[0] : INVALID_EDGE);
+		q.back_edges[length - 1] = GetQueueExitEdge(q.tiles[length - 1], used_edges[length - 1] | (1 << q.front_edges[length - 1]),
+				length > 1 ? q.front_edges[length - 1] : q.front_edges[0]);
+
+		/* The front of the queue is at the ride. */
+		q.ride = RideExistsAtBottom(q.tiles[0], q.front_edges[0]);
+		if (q.ride == nullptr) {
+			RideInstance *ri = RideExistsAtBottom(q.tiles[length - 1], q.back_edges[length - 1]);
+			if (ri != nullptr) {
+				q.ride = ri;
+				std::reverse(q.tiles.begin(), q.tiles.end());
+				std::reverse(q.front_edges.begin(), q.front_edges.end());
+				std::reverse(q.back_edges.begin(), q.back_edges.end());
+				std::swap(q.front_edges, q.back_edges);
+			}
+		}
+
+		const auto adm = admissions.find(q.tiles.front());
+		if (adm != admissions.end()) {
+			q.admission_interval = adm->second.first;
+			q.last_admission = adm->second.second;
+		}
+
+		const uint32 number = this->queues.size();
+		for (uint32 i = 0; i < length; i++) this->tiles[q.tiles[i]] = {number, i};
+		this->queues.push_back(std::move(q));
+	}
+
+	/* Put the guests back in their queues, in the order they were queuing before. */
+	for (Guest *g : guests) this->UpdateGuest(g);
+}
+
+/**
+ * Get the queue at a tile.
+ * @param pos Coordinate of the queue path tile.
+ * @return The queue containing the tile, or \c nullptr if the tile is not part of an unbranched queue.
+ */
+const Queue *Queues::GetQueue(const XYZPoint16 &pos)
+{
+	this->Update();
+	const auto it = this->tiles.find(pos);
+	return (it == this->tiles.end()) ? nullptr : &this->queues[it->second.first];
+}
+
+/**
+ * Get the last guest queuing into a queue, for someone entering the queue from a path tile.
+ * @param pos Coordinate of the path tile before the queue.
+ * @param edge Edge of the path tile leading into the queue.
+ * @param guest [out] Last guest walking through the queue in the direction of entering it, \c nullptr if nobody does.
+ * @return Whether the edge of the path tile leads into the end of a queue.
+ */
+bool Queues::GetLastGuest(const XYZPoint16 &pos, TileEdge edge, const Guest **guest)
+{
+	this->Update();
+	const Voxel *v = _world.GetVoxel(pos);
+	XYZPoint16 ngb;
+	if (v == nullptr || !GetPathNeighbour(pos, GetPathExits(v), edge, &ngb)) return false;
+
+	const auto it = this->tiles.find(ngb);
+	if (it == this->tiles.end()) return false;
+
+	const Queue &q = this->queues[it->second.first];
+	const TileEdge entry = static_cast<TileEdge>((edge + 2) % 4);
+	if (it->second.second + 1 == q.tiles.size() && q.back_edges.back() == entry) {
+		*guest = q.lines[QLD_FRONT].last;
+		return true;
+	}
+	if (it->second.second == 0 && q.front_edges.front() == entry) {
+		*guest = q.lines[QLD_BACK].last;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Walk over a queue path, like #TravelQueuePath, with the result being cached until the paths change.
+ * @param voxel_pos [inout] Start voxel position before the queue path, updated to last voxel position.
+ * @param entry Direction used for entry to the path, updated to last edge exit direction.
+ * @return Whether a (possibly) new last voxel could be found, \c false means the path leads to nowhere.
+ */
+bool Queues::TravelQueuePath(XYZPoint16 *voxel_pos, TileEdge *entry)
+{
+	const auto key = std::make_pair(*voxel_pos, *entry);
+	auto it = this->travels.find(key);
+	if (it == this->travels.end()) {
+		QueueTravel travel = {false, *voxel_pos, *entry};
+		travel.found = ::TravelQueuePath(&travel.pos, &travel.edge);
+		it = this->travels.emplace(key, travel).first;
+	}
+	if (!it->second.found) return false;
+
+	*voxel_pos = it->second.pos;
+	*entry = it->second.edge;
+	return true;
+}
+
+/**
+ * Get the position of a queuing guest in the line of the queue.
+ * @param guest Guest to examine.
+ * @return Sort key of the guest, smaller values are further ahead in the line.
+ */
+uint32 Queues::GetGuestKey(const Guest *guest) const
+{
+	const Queue &q = this->queues[guest->queue];
+	const uint32 index = guest->queue_tile;
+	uint32 rank;
+	TileEdge exit, entry;
+	if (guest->queue_line == QLD_FRONT) {
+		rank = index;
+		exit = q.front_edges[index];
+		entry = q.back_edges[index];
+	} else {
+		rank = q.tiles.size() - 1 - index;
+		exit = q.back_edges[index];
+		entry = q.front_edges[index];
+	}
+	/* Guests walk from the entry edge to the centre of the tile, and from there to the exit edge. */
+	const int remaining = GetEdgeDistance(guest->pix_pos, exit) + std::max(0, 128 - GetEdgeDistance(guest->pix_pos, entry));
+	return rank * 512 + remaining;
+}
+
+/**
+ * Insert a guest at its place in a line of a queue.
+ * @param guest Guest to insert, with Guest::queue, Guest::queue_line, and Guest::queue_tile set.
+ */
+void Queues::InsertGuest(Guest *guest)
+{
+	QueueLine &line = this->queues[guest->queue].lines[guest->queue_line];
+	const uint32 key = this->GetGuestKey(guest);
+
+	/* Guests normally join at the back, search from there. */
+	Guest *ahead = line.last;
+	while (ahead != nullptr && this->GetGuestKey(ahead) > key) ahead = ahead->queue_ahead;
+
+	guest->queue_ahead = ahead;
+	guest->queue_behind = (ahead == nullptr) ? line.first : ahead->queue_behind;
+	if (guest->queue_ahead  == nullptr) line.first = guest; else guest->queue_ahead->queue_behind = guest;
+	if (guest->queue_behind == nullptr) line.last  = guest; else guest->queue_behind->queue_ahead = guest;
+	line.count++;
+}
+
+/**
+ * Update the place of a guest in the queues after it started walking over a new tile.
+ * @param guest Guest that moved.
+ */
+void Queues::UpdateGuest(Guest *guest)
+{
+	this->Update();
+
+	const auto it = (guest->activity == GA_QUEUING) ? this->tiles.find(guest->vox_pos) : this->tiles.end();
+	if (it == this->tiles.end()) {
+		this->RemoveGuest(guest);
+		return;
+	}
+
+	/* Find the walking direction from the current movement. */
+	const Queue &q = this->queues[it->second.first];
+	const uint32 index = it->second.second;
+	QueueLineDirection direction = QLD_FRONT;
+	if (guest->frames != nullptr && guest->frame_count > 0) {
+		const AnimationFrame &frame = guest->frames[guest->frame_index];
+		const Point16 &front = _tile_dxy[q.front_edges[index]];
+		const Point16 &back = _tile_dxy[q.back_edges[index]];
+		const int to_front = frame.dx * front.x + frame.dy * front.y;
+		const int to_back = frame.dx * back.x + frame.dy * back.y;
+		if (to_front <= 0 && to_back >= 0 && (to_front < 0 || to_back > 0)) direction = QLD_BACK;
+	}
+
+	if (guest->queue == it->second.first && guest->queue_line == direction) {
+		guest->queue_tile = index;
+
+		/* Restore the order if the guest passed the guest ahead. */
+		QueueLine &line = this->queues[guest->queue].lines[guest->queue_line];
+		while (guest->queue_ahead != nullptr && this->GetGuestKey(guest) < this->GetGuestKey(guest->queue_ahead)) {
+			Guest *ahead = guest->queue_ahead;
+			ahead->queue_behind = guest->queue_behind;
+			guest->queue_ahead = ahead->queue_ahead;
+			if (guest->queue_behind == nullptr) line.last = ahead; else guest->queue_behind->queue_ahead = ahead;
+			if (ahead->queue_ahead == nullptr) line.first = guest; else ahead->queue_ahead->queue_behind = guest;
+			ahead->queue_ahead = guest;
+			guest->queue_behind = ahead;
+		}
+		return;
+	}
+
+	this->RemoveGuest(guest);
+	guest->queue = it->second.first;
+	guest->queue_line = direction;
+	guest->queue_tile = index;
+	this->InsertGuest(guest);
+}
+
+/**
+ * Remove a guest from its queue, if it is in one.
+ * @param guest Guest leaving the queue.
+ * @param admitted The guest left the front of the queue by entering the ride.
+ */
+void Queues::RemoveGuest(Guest *guest, bool admitted)
+{
+	if (guest->queue == INVALID_QUEUE) return;
+
+	Queue &q = this->queues[guest->queue];
+	if (admitted && guest->queue_line == QLD_FRONT && guest->queue_tile == 0) {
+		if (q.last_admission != 0) {
+			const uint32 interval = this->time - q.last_admission;
+			q.admission_interval = (q.admission_interval == 0) ? interval : (3 * q.admission_interval + interval) / 4;
+		}
+		q.last_admission = this->time;
+	}
+
+	QueueLine &line = q.lines[guest->queue_line];
+	if (guest->queue_ahead  == nullptr) line.first = guest->queue_behind; else guest->queue_ahead->queue_behind = guest->queue_behind;
+	if (guest->queue_behind == nullptr) line.last  = guest->queue_ahead;  else guest->queue_behind->queue_ahead = guest->queue_ahead;
+	line.count--;
+
+	guest->queue = INVALID_QUEUE;
+	guest->queue_ahead = nullptr;
+	guest->queue_behind = nullptr;
+}
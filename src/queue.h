@@ -0,0 +1,129 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file queue.h Queues of guests at the queue paths. */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+#include "tile.h"
+
+class Guest;
+class RideInstance;
+
+static const uint32 INVALID_QUEUE = UINT32_MAX; ///< Queue number denoting 'not in a queue'.
+
+/** Directions of walking through a queue. */
+enum QueueLineDirection {
+	QLD_FRONT, ///< Walking to the front of the queue.
+	QLD_BACK,  ///< Walking to the back of the queue.
+
+	QLD_COUNT, ///< Number of directions.
+};
+
+/** Guests walking through a queue in the same direction, linked through Guest::queue_ahead and Guest::queue_behind. */
+struct QueueLine {
+	Guest *first;  ///< Guest nearest to the end being walked to, if any.
+	Guest *last;   ///< Guest furthest away from the end being walked to, if any.
+	uint32 count;  ///< Number of guests in the line.
+};
+
+/** A queue, an unbranched run of queue path tiles with the guests walking through it. */
+class Queue {
+public:
+	Queue();
+
+	/**
+	 * Get the length of the queue.
+	 * @return Number of queue path tiles of the queue.
+	 */
+	inline uint32 GetLength() const
+	{
+		return this->tiles.size();
+	}
+
+	/**
+	 * Get the number of guests queuing to the front of the queue.
+	 * @return Number of guests in the queue.
+	 */
+	inline uint32 GetGuestCount() const
+	{
+		return this->lines[QLD_FRONT].count;
+	}
+
+	/**
+	 * Estimate how long a guest joining at the back of the queue has to wait to reach the front.
+	 * @return Expected waiting time in milliseconds, \c 0 if unknown.
+	 */
+	inline uint32 EstimateWaitTime() const
+	{
+		return this->admission_interval * this->lines[QLD_FRONT].count;
+	}
+
+	std::vector<XYZPoint16> tiles;     ///< Queue path tiles, from the front to the back of the queue.
+	std::vector<TileEdge> front_edges; ///< For each tile, the edge leading to the front of the queue.
+	std::vector<TileEdge> back_edges;  ///< For each tile, the edge leading to the back of the queue.
+	RideInstance *ride;                ///< Ride at the front of the queue, if any.
+	QueueLine lines[QLD_COUNT];        ///< Guests walking to the front and to the back of the queue.
+	uint32 admission_interval;         ///< Average time between two guests leaving the front of the queue in milliseconds (\c 0 if unknown).
+	uint32 last_admission;             ///< Time of the last guest leaving the front of the queue.
+};
+
+/** Result of walking through the queue path tiles from a position, see #TravelQueuePath. */
+struct QueueTravel {
+	bool found;      ///< Whether the walk ends at a new voxel edge.
+	XYZPoint16 pos;  ///< Last voxel of the walk.
+	TileEdge edge;   ///< Exit edge at the last voxel.
+};
+
+/**
+ * All queues in the park.
+ * Changes of path tiles are recorded with #NotifyPathChanged, and processed before the next query.
+ */
+class Queues {
+public:
+	Queues();
+
+	void Clear();
+	void Rebuild();
+	void OnAnimate(int delay);
+	void NotifyPathChanged(const XYZPoint16 &pos);
+	void NotifyRideDeletion();
+
+	const Queue *GetQueue(const XYZPoint16 &pos);
+	bool GetLastGuest(const XYZPoint16 &pos, TileEdge edge, const Guest **guest);
+	bool TravelQueuePath(XYZPoint16 *voxel_pos, TileEdge *entry);
+
+	void UpdateGuest(Guest *guest);
+	void RemoveGuest(Guest *guest, bool admitted = false);
+
+private:
+	std::vector<Queue> queues;                                         ///< All queues.
+	std::map<XYZPoint16, std::pair<uint32, uint32>> tiles;             ///< Tiles of the queues, with the queue number and the index of the tile in the queue.
+	std::set<XYZPoint16> queue_paths;                                  ///< All queue path tiles in the world.
+	std::set<XYZPoint16> dirty;                                        ///< Changed path tiles that still need processing.
+	std::map<std::pair<XYZPoint16, TileEdge>, QueueTravel> travels;    ///< Cached results of #TravelQueuePath.
+	uint32 time;                                                       ///< Time in milliseconds, for measuring the admission intervals.
+	bool needs_rebuild;                                                ///< The queue path tiles should be collected from the world before use.
+	bool queues_valid;                                                 ///< Whether the queues are up to date with the queue path tiles.
+
+	void Update();
+	void BuildQueues();
+	void UpdateQueuePath(const XYZPoint16 &pos);
+	uint32 GetGuestKey(const Guest *guest) const;
+	void InsertGuest(Guest *guest);
+};
+
+extern Queues _queues;
+
+#endif
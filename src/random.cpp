@@ -12,14 +12,59 @@
 #include <time.h>
 #include <cmath>
 
-uint32 Random::seed = 0;
+uint64 Random::park_seed = 0;
 
-/** Reinitialize the random number generator. */
+/**
+ * Mix the bits of a number ('splitmix64' finaliser).
+ * @param z Number to mix.
+ * @return The mixed number.
+ */
+static inline uint64 Mix(uint64 z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/** Construct a generator that is not attached to an owner yet, see #SetStream. */
+Random::Random() : Random(RSK_NONE, 0)
+{
+}
+
+/**
+ * Construct a generator drawing from the start of a stream.
+ * @param kind Kind of owner of the stream.
+ * @param id Identification of the owner, unique among owners of the same  kind.
+ */
+Random::Random(RandomStreamKind kind, uint64 id) : counter(0)
+{
+	this->SetStream(kind, id);
+}
+
+/**
+ * Attach the generator to the stream of an owner. The number of draws is kept.
+ * @param kind Kind of owner of the stream.
+ * @param id Identification of the owner, unique among owners of the same \a kind.
+ */
+void Random::SetStream(RandomStreamKind kind, uint64 id)
+{
+	assert(id < (1ULL << 56));
+	this->stream = (static_cast<uint64>(kind) << 56) | id;
+}
+
+/** Pick a new park seed for a new game. */
 void Random::Initialize()
 {
-	seed = time(nullptr);
-	/* Shuffle it a bit with modular arithmetic to ensure seeds are not limited to a small range. */
-	seed = static_cast<uint64>(seed) * seed % 0x100000000;
+	SetParkSeed(Mix(time(nullptr)));
+}
+
+/**
+ * Set the seed of all the generators of the park.
+ * @param seed New park seed.
+ */
+void Random::SetParkSeed(uint64 seed)
+{
+	park_seed = seed;
 }
 
 /**
@@ -76,39 +121,67 @@ uint16 Random::Uniform(uint16 incl_upper)
 }
 
 /**
- * Draw a random 32 bit number ('ranqd1' generator in Numerical Recipes).
+ * Draw a random 32 bit number from the stream of the generator.
  * @return New random number on every call.
- * @note Higher bits are more random than the low ones.
  */
 uint32 Random::DrawNumber()
 {
-	seed = 1664525UL * seed + 1013904223UL;
-	return seed;
+	const uint64 key = Mix(park_seed ^ Mix(this->stream));
+	return Mix(key + this->counter++ * 0x9E3779B97F4A7C15ULL) >> 32;
+}
+
+/**
+ * Load the state of the generator.
+ * @param ldr Source of the data.
+ */
+void Random::LoadState(Loader &ldr)
+{
+	this->stream = ldr.GetLongLong();
+	this->counter = ldr.GetLongLong();
 }
 
-static const uint32 CURRENT_VERSION_RAND = 1;   ///< Currently supported version of the RAND pattern.
+/**
+ * Save the state of the generator.
+ * @param svr Destination of the data.
+ */
+void Random::SaveState(Saver &svr) const
+{
+	svr.PutLongLong(this->stream);
+	svr.PutLongLong(this->counter);
+}
+
+static const uint32 CURRENT_VERSION_RAND = 2;   ///< Currently supported version of the RAND pattern.
 
 /**
- * Load random number for the game.
+ * Load the park seed of the game.
  * @param ldr Source of the data.
  */
 void Random::Load(Loader &ldr)
 {
 	const uint32 version = ldr.OpenPattern("RAND");
-	/* Do nothing if version == 0, as any number in seed is fine. */
-	if (version > CURRENT_VERSION_RAND) ldr.VersionMismatch(version, CURRENT_VERSION_RAND);
-	if (version > 0) Random::seed = ldr.GetLong();
+	switch (version) {
+		case 0:
+			break; // Any seed is fine.
+		case 1:
+			park_seed = ldr.GetLong();
+			break;
+		case 2:
+			park_seed = ldr.GetLongLong();
+			break;
+		default:
+			ldr.VersionMismatch(version, CURRENT_VERSION_RAND);
+	}
 	ldr.ClosePattern();
 }
 
 /**
- * Save random number of the game.
+ * Save the park seed of the game.
  * @param svr Destination of the data.
  */
 void Random::Save(Saver &svr)
 {
 	svr.CheckNoOpenPattern();
 	svr.StartPattern("RAND", CURRENT_VERSION_RAND);
-	svr.PutLong(Random::seed);
+	svr.PutLongLong(park_seed);
 	svr.EndPattern();
 }
@@ -10,20 +10,50 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
-/** A random generator class. */
+/** Kinds of owners of a random number stream, to keep the streams of different kinds of owners apart. */
+enum RandomStreamKind {
+	RSK_NONE,           ///< Generator not (yet) attached to an owner.
+	RSK_GUEST,          ///< Stream of a guest, identified by its guest serial number.
+	RSK_STAFF,          ///< Stream of a staff member, identified by its person id.
+	RSK_RIDE,           ///< Stream of a ride instance, identified by its ride number and slot generation.
+	RSK_GUEST_SPAWN,    ///< Stream deciding the arrival of new guests.
+	RSK_PARK_RATING,    ///< Stream of the park rating computation.
+	RSK_WEATHER,        ///< Stream of the weather.
+	RSK_SCENERY,        ///< Stream of the scenery items.
+	RSK_PARK_GENERATOR, ///< Stream of the park generator.
+};
+
+/**
+ * A random generator class.
+ * Every generator draws from its own stream, identified by its owner. Numbers are computed by hashing the
+ * park seed, the stream, and the number of draws done so far. Generators thus do not influence each other,
+ * and a stream is fully restored by saving the number of draws.
+ */
 class Random {
 public:
+	Random();
+	Random(RandomStreamKind kind, uint64 id);
+
+	void SetStream(RandomStreamKind kind, uint64 id);
+
 	bool Success1024(uint upper);
 	bool Success(int perc);
 	uint16 Uniform(uint16 incl_upper);
 	uint16 Exponential(uint16 mean);
 
+	void LoadState(Loader &ldr);
+	void SaveState(Saver &svr) const;
+
 	static void Initialize();
+	static void SetParkSeed(uint64 seed);
 	static void Load(Loader &ldr);
 	static void Save(Saver &svr);
 
 private:
-	static uint32 seed; ///< Seed of the generators.
+	static uint64 park_seed; ///< Seed of all generators of the park.
+
+	uint64 stream;  ///< Stream of the generator.
+	uint64 counter; ///< Number of numbers drawn from the stream.
 
 	uint32 DrawNumber();
 };
@@ -12,6 +12,7 @@
 #include "fileio.h"
 #include "string_func.h"
 #include "rev.h"
+#include "trace.h"
 #include <memory>
 
 RcdFileCollection _rcd_collection; ///< Available RCD files.
@@ -69,6 +70,7 @@ void RcdFileCollection::AddFile(const RcdFileInfo &rcd)
 /** Scan directories, looking for RCD and FTK files to add. */
 void RcdFileCollection::ScanDirectories()
 {
+	TraceScope trace("RcdFileCollection::ScanDirectories");
 	const std::string _rcd_paths[] = {
 		".",
 		freerct_install_prefix() + DIR_SEP + "rcd",
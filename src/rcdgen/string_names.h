@@ -63,6 +63,8 @@ static const char *_gui_string_names[] = {
 	"MAIN_MENU_LAUNCH_EDITOR",
 	"TOOLBAR_GUI_DROPDOWN_SPEED",
 	"TOOLBAR_GUI_DROPDOWN_SPEED_TOOLTIP",
+	"TOOLBAR_GUI_SPEED_TURBO_TOOLTIP",
+	"TOOLBAR_GUI_SPEED_MULTIPLIER",
 	"TOOLBAR_GUI_DROPDOWN_VIEW",
 	"TOOLBAR_GUI_DROPDOWN_VIEW_TOOLTIP",
 	/* Do not change the order of the strings between here… */
@@ -71,6 +73,7 @@ static const char *_gui_string_names[] = {
 	"TOOLBAR_GUI_DROPDOWN_SPEED_2",
 	"TOOLBAR_GUI_DROPDOWN_SPEED_4",
 	"TOOLBAR_GUI_DROPDOWN_SPEED_8",
+	"TOOLBAR_GUI_DROPDOWN_SPEED_TURBO",
 	/* …and here. */
 	"TOOLBAR_GUI_DROPDOWN_VIEW_MINIMAP",
 	"TOOLBAR_GUI_DROPDOWN_VIEW_ZOOM_OUT",
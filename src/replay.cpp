@@ -0,0 +1,289 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file replay.cpp Recording the commands of the player, and replaying them to verify that the simulation is deterministic. */
+
+#include "stdafx.h"
+#include "replay.h"
+#include "command.h"
+#include "gamecontrol.h"
+#include "loadsave.h"
+#include "dates.h"
+#include "trace.h"
+
+/*
+ * A replay file starts with a normal saved game, followed by an "RPLY" pattern with the game speed at the start.
+ * After it, records are appended while the game runs, each stating the tick at which it happened:
+ * - "RCMD": A command of the player, see #GameCommand, with whether it succeeded.
+ * - "RSUM": The checksum of the game state (see #ComputeGameChecksum) at the start of a day.
+ *   Version 1 checksums also covered the inbox messages, they are not compared.
+ * - "REND": The end of the recording.
+ * A file without "REND" record (for example because the program crashed) is replayed up to its last complete record.
+ */
+
+static const uint32 CURRENT_VERSION_RPLY = 1;  ///< Currently supported version of the RPLY pattern.
+static const uint32 CURRENT_VERSION_RCMD = 2;  ///< Currently supported version of the RCMD pattern.
+static const uint32 CURRENT_VERSION_RSUM = 2;  ///< Currently supported version of the RSUM pattern.
+static const uint32 CURRENT_VERSION_REND = 1;  ///< Currently supported version of the REND pattern.
+
+ReplayRecorder _replay_recorder; ///< Recorder of the game.
+
+ReplayRecorder::ReplayRecorder() : fp(nullptr), tick(0)
+{
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+	this->Stop();
+}
+
+/**
+ * Start recording the current game.
+ * @param fname Name of the replay file to write.
+ * @return Whether the file could be created.
+ */
+bool ReplayRecorder::Start(const std::string &fname)
+{
+	TraceScope trace("ReplayRecorder::Start");
+	this->Stop();
+
+	this->fp = fopen(fname.c_str(), "wb");
+	if (this->fp == nullptr) {
+		fprintf(stderr, "ERROR: Cannot open replay file '%s' for writing.\n", fname.c_str());
+		return false;
+	}
+	this->tick = 0;
+
+	Saver svr(this->fp);
+	SaveGame(svr);
+	svr.StartPattern("RPLY", CURRENT_VERSION_RPLY);
+	svr.PutByte(_game_control.speed);
+	svr.EndPattern();
+
+	/* The checksum at the start catches differences between the running game and the saved game. */
+	svr.StartPattern("RSUM", CURRENT_VERSION_RSUM);
+	svr.PutLong(this->tick);
+	svr.PutLongLong(ComputeGameChecksum());
+	svr.EndPattern();
+	fflush(this->fp);
+
+	printf("Recording the game to '%s'.\n", fname.c_str());
+	return true;
+}
+
+/** Stop recording the game, and finish the replay file. */
+void ReplayRecorder::Stop()
+{
+	if (this->fp == nullptr) return;
+
+	Saver svr(this->fp);
+	svr.StartPattern("REND", CURRENT_VERSION_REND);
+	svr.PutLong(this->tick);
+	svr.EndPattern();
+	fclose(this->fp);
+	this->fp = nullptr;
+}
+
+/**
+ * Record a command of the player, if a game is being recorded.
+ * @param cmd Command that was executed.
+ * @param result Whether the command succeeded.
+ */
+void ReplayRecorder::RecordCommand(const GameCommand &cmd, bool result)
+{
+	if (this->fp == nullptr) return;
+
+	Saver svr(this->fp);
+	svr.StartPattern("RCMD", CURRENT_VERSION_RCMD);
+	svr.PutLong(this->tick);
+	svr.PutWord(cmd.type);
+	svr.PutWord(cmd.pos.x);
+	svr.PutWord(cmd.pos.y);
+	svr.PutWord(cmd.pos.z);
+	for (int64 arg : cmd.args) svr.PutLongLong(arg);
+	svr.PutByte(result ? 1 : 0);
+	svr.PutText(cmd.text);
+	svr.EndPattern();
+	fflush(this->fp);
+}
+
+/** Count the tick, and record the checksum of the game at the start of a day. */
+void ReplayRecorder::RecordTick()
+{
+	this->tick++;
+	if (_date.frac != 0) return;
+
+	Saver svr(this->fp);
+	svr.StartPattern("RSUM", CURRENT_VERSION_RSUM);
+	svr.PutLong(this->tick);
+	svr.PutLongLong(ComputeGameChecksum());
+	svr.EndPattern();
+	fflush(this->fp);
+}
+
+/** Replays the records of a replay file. */
+class Replayer {
+public:
+	explicit Replayer(Loader &ldr) : ldr(ldr), tick(0), commands(0), failed_commands(0), checksums(0), mismatches(0)
+	{
+	}
+
+	void ReadHeader();
+	bool ReplayRecord();
+
+	/**
+	 * Run the game simulation up to a tick of the recording.
+	 * @param target Tick to run to.
+	 */
+	void RunTo(uint32 target)
+	{
+		for (; this->tick < target; this->tick++) OnNewTick(FRAME_DELAY);
+	}
+
+	Loader &ldr;             ///< Replay file being read.
+	uint32 tick;             ///< Number of ticks run since the start of the recording.
+	uint32 commands;         ///< Number of replayed commands.
+	uint32 failed_commands;  ///< Number of commands with a different result than in the recording.
+	uint32 checksums;        ///< Number of verified checksums.
+	uint32 mismatches;       ///< Number of checksums that differ from the recording.
+};
+
+/** Read the replay header after the saved game. */
+void Replayer::ReadHeader()
+{
+	const uint32 version = this->ldr.OpenPattern("RPLY");
+	if (version != CURRENT_VERSION_RPLY) this->ldr.VersionMismatch(version, CURRENT_VERSION_RPLY);
+	const uint8 speed = this->ldr.GetByte();
+	this->ldr.ClosePattern();
+
+	if (speed >= GSP_COUNT) throw LoadingError("Invalid game speed %u", speed);
+	_game_control.speed = static_cast<GameSpeed>(speed);
+}
+
+/**
+ * Read the next record of the replay file, and replay it.
+ * @return Whether there are more records.
+ */
+bool Replayer::ReplayRecord()
+{
+	uint32 version = this->ldr.OpenPattern("RCMD", true);
+	if (version != UINT32_MAX) {
+		if (version < 1 || version > CURRENT_VERSION_RCMD) this->ldr.VersionMismatch(version, CURRENT_VERSION_RCMD);
+		const uint32 tick = this->ldr.GetLong();
+		GameCommand cmd;
+		cmd.type = static_cast<GameCommandType>(this->ldr.GetWord());
+		cmd.pos.x = this->ldr.GetWord();
+		cmd.pos.y = this->ldr.GetWord();
+		cmd.pos.z = this->ldr.GetWord();
+		for (int64 &arg : cmd.args) arg = this->ldr.GetLongLong();
+		const bool recorded_result = this->ldr.GetByte() != 0;
+		if (version >= 2) cmd.text = this->ldr.GetText();
+		this->ldr.ClosePattern();
+
+		if (tick < this->tick || cmd.type >= GCMD_COUNT) throw LoadingError("Invalid command record");
+		this->RunTo(tick);
+		const bool result = ExecuteCommand(cmd);
+		this->commands++;
+		if (result != recorded_result) {
+			if (this->failed_commands == 0) {
+				printf("Command %u at tick %u (%d-%02d-%02d) %s, but it %s in the recording.\n", static_cast<uint>(cmd.type), tick, _date.year, _date.month, _date.day,
+						result ? "succeeded" : "failed", recorded_result ? "succeeded" : "failed");
+			}
+			this->failed_commands++;
+		}
+		return true;
+	}
+
+	version = this->ldr.OpenPattern("RSUM", true);
+	if (version != UINT32_MAX) {
+		if (version < 1 || version > CURRENT_VERSION_RSUM) this->ldr.VersionMismatch(version, CURRENT_VERSION_RSUM);
+		const uint32 tick = this->ldr.GetLong();
+		const uint64 recorded_checksum = this->ldr.GetLongLong();
+		this->ldr.ClosePattern();
+
+		if (tick < this->tick) throw LoadingError("Invalid checksum record");
+		this->RunTo(tick);
+		if (version < 2) return true;
+		const uint64 checksum = ComputeGameChecksum();
+		this->checksums++;
+		if (checksum != recorded_checksum) {
+			if (this->mismatches == 0) {
+				printf("Checksum mismatch at tick %u (%d-%02d-%02d): recorded %016llx, replayed %016llx.\n", tick, _date.year, _date.month, _date.day,
+						static_cast<unsigned long long>(recorded_checksum), static_cast<unsigned long long>(checksum));
+			}
+			this->mismatches++;
+		}
+		return true;
+	}
+
+	version = this->ldr.OpenPattern("REND");
+	if (version != CURRENT_VERSION_REND) this->ldr.VersionMismatch(version, CURRENT_VERSION_REND);
+	const uint32 tick = this->ldr.GetLong();
+	this->ldr.ClosePattern();
+
+	if (tick < this->tick) throw LoadingError("Invalid end record");
+	this->RunTo(tick);
+	return false;
+}
+
+/**
+ * Replay a recorded game without creating any window, and verify that the game state matches the recording every day.
+ * @param fname Name of the replay file to load.
+ * @param save_fname If not empty, the file to save the resulting park to.
+ * @return Exit code of the program.
+ * @pre The RCD files and the language must have been loaded.
+ */
+int RunReplay(const std::string &fname, const std::string &save_fname)
+{
+	FILE *fp = fopen(fname.c_str(), "rb");
+	if (fp == nullptr) {
+		fprintf(stderr, "ERROR: Cannot open replay file '%s' for reading.\n", fname.c_str());
+		return 1;
+	}
+
+	Loader ldr(fp);
+	Replayer replayer(ldr);
+	try {
+		LoadGame(ldr);
+		_game_mode_mgr.SetGameMode(GM_PLAY);
+		replayer.ReadHeader();
+	} catch (const LoadingError &e) {
+		fprintf(stderr, "ERROR: Loading replay '%s' failed: %s\n", fname.c_str(), e.what());
+		fclose(fp);
+		return 1;
+	}
+
+	printf("Replaying '%s'.\n", fname.c_str());
+	bool complete = true;
+	try {
+		while (replayer.ReplayRecord()) {}
+	} catch (const LoadingError &e) {
+		/* The recording was not finished properly, replay what was recorded. */
+		printf("Replay file ends unexpectedly: %s\n", e.what());
+		complete = false;
+	}
+	fclose(fp);
+
+	printf("Replayed %u ticks (%.1f days) up to %d-%02d-%02d%s.\n", replayer.tick, replayer.tick / static_cast<double>(TICK_COUNT_PER_DAY),
+			_date.year, _date.month, _date.day, complete ? "" : " (incomplete recording)");
+	printf("  Commands  : %u (%u with a different result)\n", replayer.commands, replayer.failed_commands);
+	printf("  Checksums : %u (%u mismatches)\n", replayer.checksums, replayer.mismatches);
+
+	int result = (replayer.failed_commands == 0 && replayer.mismatches == 0) ? 0 : 1;
+	printf("%s\n", result == 0 ? "The replay matches the recording." : "The replay DIFFERS from the recording.");
+	if (!save_fname.empty()) {
+		if (SaveGameFile(save_fname.c_str())) {
+			printf("Saved the park to '%s'.\n", save_fname.c_str());
+		} else {
+			fprintf(stderr, "ERROR: Saving to '%s' failed.\n", save_fname.c_str());
+			result = 1;
+		}
+	}
+
+	_game_control.Uninitialize();
+	return result;
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file replay.h Recording the commands of the player, and replaying them to verify that the simulation is deterministic. */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <string>
+
+struct GameCommand;
+
+/**
+ * Records a game into a replay file: the saved game at the start, followed by the commands
+ * of the player and a checksum of the game state at the start of every day, all keyed by tick.
+ */
+class ReplayRecorder {
+public:
+	ReplayRecorder();
+	~ReplayRecorder();
+
+	bool Start(const std::string &fname);
+	void Stop();
+
+	/**
+	 * Whether a game is being recorded.
+	 * @return A replay file is being written.
+	 */
+	inline bool IsRecording() const
+	{
+		return this->fp != nullptr;
+	}
+
+	/** A tick of the game simulation has been run. */
+	inline void OnTick()
+	{
+		if (this->IsRecording()) this->RecordTick();
+	}
+
+	void RecordCommand(const GameCommand &cmd, bool result);
+
+	std::string requested_file;  ///< File to record the next game into, empty to not record.
+
+private:
+	void RecordTick();
+
+	FILE *fp;     ///< Replay file being written, \c nullptr if not recording.
+	uint32 tick;  ///< Number of ticks run since the start of the recording.
+};
+
+extern ReplayRecorder _replay_recorder;
+
+int RunReplay(const std::string &fname, const std::string &save_fname);
+
+#endif
@@ -14,6 +14,7 @@
 #include "gentle_thrill_ride_type.h"
 #include "mouse_mode.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "finances.h"
 
 #include "gui_sprites.h"
@@ -86,7 +87,6 @@ private:
 	TileEdge orientation;   ///< Orientation of the simple ride.
 	BestErrorMessageReason build_forbidden_reason;  ///< Reason why we may not place the instance at the given location, if any.
 
-	bool CanPlaceFixedRide(const FixedRideType *selected_ride, const XYZPoint16 &pos, uint8 ride_orient, ViewOrientation vp_orient);
 	RidePlacementResult ComputeFixedRideVoxel(XYZPoint32 world_pos, ViewOrientation vp_orient);
 };
 
@@ -177,115 +177,6 @@ void RideBuildWindow::OnClick(WidgetNumber wid_num, [[maybe_unused]] const Point
 	}
 }
 
-/**
- * Checks whether the air space above the ground at the given location is suited to place a fixed ride of the given height.
- * @param position Coordinate of the base voxel.
- * @param height Height of the object.
- * @return The space is suited to build the ride.
- */
-static bool CheckSufficientVerticalSpace(const XYZPoint16& position, const int8 height)
-{
-	for (int8 h = 0; h < height; ++h) {
-		const Voxel *v = _world.GetVoxel(position + XYZPoint16(0, 0, h));
-		if (v == nullptr) continue;
-
-		if (h > 0 && v->GetGroundType() != GTP_INVALID) return false;
-		if (!v->CanPlaceInstance() || v->GetGroundSlope() != SL_FLAT) return false;
-	}
-	return true;
-}
-
-/**
- * Checks whether the given location is suited to place a fixed ride on flat ground.
- * @param position Coordinate of the base voxel.
- * @return The space is flat and suited to build the ride.
- */
-static bool CanPlaceFixedRideOnFlatGround(const XYZPoint16& position)
-{
-	const Voxel *vx = _world.GetVoxel(position);
-	return vx != nullptr && vx->GetGroundType() != GTP_INVALID && vx->GetGroundSlope() == SL_FLAT;
-}
-
-/**
- * Checks whether the given location is suited to place a fixed ride on a slope.
- * @param position Coordinate of the base voxel.
- * @return The space is suited to build the ride.
- */
-static bool CanPlaceFixedRideOnSlope(const XYZPoint16& position)
-{
-	const Voxel *vx = _world.GetVoxel(position + XYZPoint16(0, 0, -1));
-	if (vx == nullptr || vx->GetGroundType() == GTP_INVALID || vx->GetGroundSlope() == SL_FLAT) return false;
-	const Voxel *top_voxel = _world.GetVoxel(position);
-	return top_voxel == nullptr || !IsImplodedSteepSlope(top_voxel->GetGroundSlope());
-}
-
-/**
- * Can a fixed ride be placed at the given voxel?
- * @param selected_ride Ride to place.
- * @param pos Coordinate of the voxel.
- * @param ride_orient Orientation of the ride.
- * @param vp_orient Orientation of the viewport.
- * @pre voxel coordinate must be valid in the world.
- * @pre \a selected_ride may not be \c nullptr.
- * @return Ride can be placed at the given position.
- * @note Sets the value of #build_forbidden_reason if appropriate.
- */
-bool RideBuildWindow::CanPlaceFixedRide(const FixedRideType *selected_ride, const XYZPoint16 &pos, uint8 ride_orient, ViewOrientation vp_orient)
-{
-	/* 1. Can the position itself be used to build a ride? */
-	for (int x = 0; x < selected_ride->width_x; ++x) {
-		for (int y = 0; y < selected_ride->width_y; ++y) {
-			const XYZPoint16 location = OrientatedOffset(ride_orient, x, y) + pos;
-			if (!IsVoxelstackInsideWorld(location.x, location.y)) {
-				this->build_forbidden_reason.UpdateReason(GUI_ERROR_MESSAGE_BAD_LOCATION);
-				return false;
-			}
-			if (_world.GetTileOwner(location.x, location.y) != OWN_PARK) {
-				this->build_forbidden_reason.UpdateReason(GUI_ERROR_MESSAGE_UNOWNED_LAND);
-				return false;
-			}
-		}
-	}
-	bool can_place_base = false;
-	bool can_place_air = true;
-	for (int x = 0; x < selected_ride->width_x; ++x) {
-		for (int y = 0; y < selected_ride->width_y; ++y) {
-			const XYZPoint16 location = pos + OrientatedOffset(ride_orient, x, y);
-			can_place_base |= CanPlaceFixedRideOnFlatGround(location);
-			can_place_air &= CheckSufficientVerticalSpace(location, selected_ride->GetHeight(x, y));
-		}
-	}
-	if (!can_place_air) {
-		this->build_forbidden_reason.UpdateReason(can_place_base ? GUI_ERROR_MESSAGE_OCCUPIED : GUI_ERROR_MESSAGE_BAD_LOCATION);
-		return false;
-	}
-	if (can_place_base) return true;
-
-	/* 2. Is the ride just above non-flat ground? */
-	if (pos.z > 0) {
-		for (int x = 0; x < selected_ride->width_x; ++x) {
-			for (int y = 0; y < selected_ride->width_y; ++y) {
-				const XYZPoint16 location = pos + OrientatedOffset(ride_orient, x, y);
-				if (CanPlaceFixedRideOnSlope(location)) return true;
-			}
-		}
-	}
-
-	/* 3. For shops only: Is there a path at the right place? */
-	if (selected_ride->kind != RTK_SHOP) {
-		this->build_forbidden_reason.UpdateReason(GUI_ERROR_MESSAGE_BAD_LOCATION);
-		return false;
-	}
-	const ShopType *selected_shop = static_cast<const ShopType*>(selected_ride);
-	for (TileEdge entrance = EDGE_BEGIN; entrance < EDGE_COUNT; entrance++) { // Loop over the 4 unrotated directions.
-		if ((selected_shop->flags & (1 << entrance)) == 0) continue; // No entrance here.
-		TileEdge entr = static_cast<TileEdge>((entrance + vp_orient + this->orientation) & 3); // Perform rotation specified by the user in the GUI.
-		if (PathExistsAtBottomEdge(pos, entr)) return true;
-	}
-	this->build_forbidden_reason.UpdateReason(GUI_ERROR_MESSAGE_BAD_LOCATION);
-	return false;
-}
-
 /**
  * Decide at which voxel to place a fixed ride. It should be placed at a voxel intersecting with the view line through the given point in the world.
  * @param world_pos Coordinate of the point.
@@ -312,8 +203,8 @@ RidePlacementResult RideBuildWindow::ComputeFixedRideVoxel(XYZPoint32 world_pos,
 	while (vox_pos.z >= 0) {
 		vox_pos.x = world_pos.x / 256;
 		vox_pos.y = world_pos.y / 256;
-		if (IsVoxelstackInsideWorld(vox_pos.x, vox_pos.y) && this->CanPlaceFixedRide(
-				this->instance->GetFixedRideType(), vox_pos, this->orientation + vp_orient, vp_orient)) {
+		if (IsVoxelstackInsideWorld(vox_pos.x, vox_pos.y) && CanPlaceFixedRide(
+				this->instance->GetFixedRideType(), vox_pos, (this->orientation + vp_orient) & 3, &this->build_forbidden_reason)) {
 			/* Position of the ride the same as previously? */
 			if (this->instance->vox_pos != vox_pos || this->instance->orientation != this->orientation) {
 				this->instance->SetRide((this->orientation + vp_orient) & 3, vox_pos);
@@ -394,16 +285,13 @@ void RideBuildWindow::SelectorMouseButtonEvent(MouseButtons state)
 		this->build_forbidden_reason.ShowErrorMessage();
 		return;
 	}
-	const Money build_cost = this->instance->ComputeBuildCost();
-	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, build_cost)) return;
-
 	const SmallRideInstance inst_number = static_cast<SmallRideInstance>(this->instance->GetIndex());
 	const RideTypeKind kind = this->instance->GetKind();
+	const RideType *type = this->instance->GetRideType();
+	uint16 type_index = 0;
+	while (_rides_manager.GetRideType(type_index) != type) type_index++;
 
-	_rides_manager.NewInstanceAdded(inst_number);
-	AddRemovePathEdges(this->instance->vox_pos, PATH_EMPTY, this->instance->GetEntranceDirections(this->instance->vox_pos), PAS_QUEUE_PATH);
-	_finances_manager.PayRideConstruct(build_cost);
-	_window_manager.GetViewport()->AddFloatawayMoneyAmount(build_cost, this->instance->vox_pos);
+	if (!DoCommand(GCMD_BUILD_FIXED_RIDE, {inst_number, type_index, this->instance->orientation}, this->instance->vox_pos)) return;
 
 	this->instance = nullptr;  // Delete this window.
 	delete this;
@@ -18,6 +18,7 @@
 #include "coaster.h"
 
 #include "gui_sprites.h"
+#include "command.h"
 
 /**
  * GUI for selecting a ride to build.
@@ -270,18 +271,17 @@ void RideSelectGui::OnClick(WidgetNumber wid_num, const Point16 &pos)
 				uint16 instance = _rides_manager.GetFreeInstance(ride_type);
 				if (instance == INVALID_RIDE_INSTANCE) return;
 
-				RideInstance *ri = _rides_manager.CreateInstance(ride_type, instance);
 				assert(this->current_kind == ride_type->kind);
 				switch (ride_type->kind) {
 					case RTK_SHOP:
 					case RTK_GENTLE:
 					case RTK_THRILL:
 						assert(ride_type->designs.empty());  // Fixed rides can't have designs.
-						ShowRideBuildGui(static_cast<FixedRideInstance*>(ri));
+						ShowRideBuildGui(static_cast<FixedRideInstance*>(_rides_manager.CreateInstance(ride_type, instance)));
 						break;
 					case RTK_COASTER:
-						_rides_manager.NewInstanceAdded(instance);
-						ShowCoasterBuildGui(static_cast<CoasterInstance*>(ri), this->current_design);
+						if (!DoCommand(GCMD_CREATE_COASTER, {instance, this->current_ride})) return;
+						ShowCoasterBuildGui(static_cast<CoasterInstance*>(_rides_manager.GetRideInstance(instance)), this->current_design);
 						break;
 					default: NOT_REACHED(); // Add cases for more ride types here when they get implemented.
 				}
@@ -15,6 +15,7 @@
 #include "map.h"
 #include "fileio.h"
 #include "ride_type.h"
+#include "queue.h"
 #include "bitmath.h"
 #include "gamelevel.h"
 #include "viewport.h"
@@ -25,6 +26,7 @@
 #include "people.h"
 #include "random.h"
 #include "rcdfile.h"
+#include "trace.h"
 #include "generated/entrance_exit_strings.h"
 #include "generated/entrance_exit_strings.cpp"
 
@@ -218,6 +220,7 @@ void SetRideRatingStringParam(const uint32 rating)
  */
 RideInstance::RideInstance(const RideType *rt)
 :
+	index(INVALID_RIDE_INSTANCE),
 	state(RIS_ALLOCATED),
 	flags(0),
 	recolours(rt->recolours),
@@ -236,10 +239,6 @@ RideInstance::RideInstance(const RideType *rt)
 	this->SetEntranceType(0);
 	this->SetExitType(0);
 
-	this->recolours.AssignRandomColours();
-	this->entrance_recolours.AssignRandomColours();
-	this->exit_recolours.AssignRandomColours();
-
 	std::fill_n(this->item_price, NUMBER_ITEM_TYPES_SOLD, 12345); // Arbitrary non-zero amount.
 	std::fill_n(this->item_count, NUMBER_ITEM_TYPES_SOLD, 0);
 }
@@ -453,6 +452,19 @@ void RideInstance::SetExitType(const int type)
 	this->exit_recolours = _rides_manager.exits[type]->recolours;
 }
 
+/**
+ * Attach the random number generator of a new ride to its stream, and pick the colours of the ride.
+ * @param stream Identification of the ride, unique among all rides of the game.
+ */
+void RideInstance::InitializeRandom(uint64 stream)
+{
+	this->rnd = Random(RSK_RIDE, stream);
+
+	this->recolours.AssignRandomColours(this->rnd);
+	this->entrance_recolours.AssignRandomColours(this->rnd);
+	this->exit_recolours.AssignRandomColours(this->rnd);
+}
+
 /**
  * Whether a path edge to/from this ride should be drawn at the given location.
  * @param vox Coordinates in the world.
@@ -612,7 +624,7 @@ void RideInstance::NotifyLongQueue()
 	}
 }
 
-static const uint32 CURRENT_VERSION_RideInstance = 2;   ///< Currently supported version of %RideInstance.
+static const uint32 CURRENT_VERSION_RideInstance = 3;   ///< Currently supported version of %RideInstance.
 
 void RideInstance::Load(Loader &ldr)
 {
@@ -643,6 +655,7 @@ void RideInstance::Load(Loader &ldr)
 	this->excitement_rating = ldr.GetLong();
 	this->intensity_rating = ldr.GetLong();
 	this->nausea_rating = ldr.GetLong();
+	if (version >= 3) this->rnd.LoadState(ldr);
 	ldr.ClosePattern();
 }
 
@@ -671,6 +684,7 @@ void RideInstance::Save(Saver &svr)
 	svr.PutLong(this->excitement_rating);
 	svr.PutLong(this->intensity_rating);
 	svr.PutLong(this->nausea_rating);
+	this->rnd.SaveState(svr);
 	svr.EndPattern();
 }
 
@@ -680,37 +694,50 @@ void RideInstance::Save(Saver &svr)
  */
 void RidesManager::OnAnimate(int delay)
 {
-	for (auto &pair : this->instances) {
-		if (pair.second->state == RIS_ALLOCATED) continue;
-		pair.second->OnAnimate(delay);
+	for (auto &kind : this->kind_instances) {
+		for (RideInstance *ri : kind) {
+			if (ri->state == RIS_ALLOCATED) continue;
+			ri->OnAnimate(delay);
+		}
 	}
 }
 
 /** A new month has started; perform monthly payments. */
 void RidesManager::OnNewMonth()
 {
-	for (auto &pair : this->instances) {
-		if (pair.second->state == RIS_ALLOCATED) continue;
-		pair.second->OnNewMonth();
+	for (auto &kind : this->kind_instances) {
+		for (RideInstance *ri : kind) {
+			if (ri->state == RIS_ALLOCATED) continue;
+			ri->OnNewMonth();
+		}
 	}
 }
 
 /** A new day has started; break rides randomly. */
 void RidesManager::OnNewDay()
 {
-	for (auto &pair : this->instances) {
-		if (pair.second->state == RIS_ALLOCATED) continue;
-		pair.second->OnNewDay();
+	for (auto &kind : this->kind_instances) {
+		for (RideInstance *ri : kind) {
+			if (ri->state == RIS_ALLOCATED) continue;
+			ri->OnNewDay();
+		}
 	}
 }
 
-static const uint32 CURRENT_VERSION_RIDS = 4;   ///< Currently supported version of the RIDS Pattern.
+static const uint32 CURRENT_VERSION_RIDS = 5;   ///< Currently supported version of the RIDS Pattern.
 
 void RidesManager::Load(Loader &ldr)
 {
 	uint32 version = ldr.OpenPattern("RIDS");
 
 	if (version >= 1 && version <= CURRENT_VERSION_RIDS) {
+		if (version >= 5) {
+			const uint16 slot_count = ldr.GetWord();
+			if (slot_count > SRI_LAST - SRI_FULL_RIDES) throw LoadingError("Too many ride numbers (%u).", slot_count);
+			this->AddSlots(slot_count);
+			for (RideInstanceSlot &slot : this->instances) slot.generation = ldr.GetWord();
+		}
+
 		uint16 allocated_ride_count = ldr.GetWord();
 		for (uint16 i = 0; i < allocated_ride_count; i++) {
 			const RideType *ride_type = nullptr;
@@ -757,17 +784,19 @@ void RidesManager::Save(Saver &svr)
 	svr.CheckNoOpenPattern();
 	svr.StartPattern("RIDS", CURRENT_VERSION_RIDS);
 
-	std::set<uint16> allocated_ride_indexes;
-	for (const auto &pair : this->instances) {
-		if (pair.second->state != RIS_ALLOCATED) {
-			allocated_ride_indexes.insert(pair.first);
-		}
+	svr.PutWord(this->instances.size());
+	for (const RideInstanceSlot &slot : this->instances) svr.PutWord(slot.generation);
+
+	uint16 allocated_ride_count = 0;
+	for (const RideInstanceSlot &slot : this->instances) {
+		if (slot.instance != nullptr && slot.instance->state != RIS_ALLOCATED) allocated_ride_count++;
 	}
-	svr.PutWord(allocated_ride_indexes.size());
+	svr.PutWord(allocated_ride_count);
 
-	for (size_t index : allocated_ride_indexes) {
+	for (size_t index = 0; index < this->instances.size(); index++) {
+		RideInstance *r = this->instances[index].instance.get();
+		if (r == nullptr || r->state == RIS_ALLOCATED) continue;
 		svr.PutWord(index);
-		RideInstance *r = this->instances.at(index).get();
 		svr.PutByte(static_cast<uint8>(r->GetKind()));
 		svr.PutText(r->GetRideType()->InternalName());
 		r->Save(svr);
@@ -776,6 +805,17 @@ void RidesManager::Save(Saver &svr)
 	svr.EndPattern();
 }
 
+/**
+ * Add the memory used by the ride instances to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void RidesManager::AddMemoryUsage(MemoryReport &report) const
+{
+	for (const RideInstanceSlot &slot : this->instances) {
+		if (slot.instance != nullptr) slot.instance->AddMemoryUsage(report);
+	}
+}
+
 /**
  * Get the requested ride instance.
  * @param num Ride number to retrieve.
@@ -784,8 +824,8 @@ void RidesManager::Save(Saver &svr)
 RideInstance *RidesManager::GetRideInstance(uint16 num)
 {
 	assert(num >= SRI_FULL_RIDES && num < SRI_LAST);
-	const auto it = this->instances.find(num - SRI_FULL_RIDES);
-	return (it == this->instances.end()) ? nullptr : it->second.get();
+	num -= SRI_FULL_RIDES;
+	return (num < this->instances.size()) ? this->instances[num].instance.get() : nullptr;
 }
 
 /**
@@ -796,8 +836,32 @@ RideInstance *RidesManager::GetRideInstance(uint16 num)
 const RideInstance *RidesManager::GetRideInstance(uint16 num) const
 {
 	assert(num >= SRI_FULL_RIDES && num < SRI_LAST);
-	const auto it = this->instances.find(num - SRI_FULL_RIDES);
-	return (it == this->instances.end()) ? nullptr : it->second.get();
+	num -= SRI_FULL_RIDES;
+	return (num < this->instances.size()) ? this->instances[num].instance.get() : nullptr;
+}
+
+/**
+ * Get the requested ride instance, if it is still the ride that was known by the caller.
+ * @param num Ride number to retrieve.
+ * @param generation Generation of the ride number when the ride was known, see #GetGeneration.
+ * @return The requested ride, or \c nullptr if the ride was deleted since (even if the ride number is used by another ride now).
+ */
+RideInstance *RidesManager::GetRideInstance(uint16 num, uint16 generation)
+{
+	if (this->GetGeneration(num) != generation) return nullptr;
+	return this->GetRideInstance(num);
+}
+
+/**
+ * Get the generation of a ride number. It changes when the ride using the number is deleted.
+ * @param num Ride number to examine.
+ * @return Current generation of the ride number.
+ */
+uint16 RidesManager::GetGeneration(uint16 num) const
+{
+	assert(num >= SRI_FULL_RIDES && num < SRI_LAST);
+	num -= SRI_FULL_RIDES;
+	return (num < this->instances.size()) ? this->instances[num].generation : 0;
 }
 
 /**
@@ -806,12 +870,8 @@ const RideInstance *RidesManager::GetRideInstance(uint16 num) const
  */
 uint16 RideInstance::GetIndex() const
 {
-	for (const auto &pair : _rides_manager.instances) {
-		if (pair.second.get() == this) {
-			return pair.first + SRI_FULL_RIDES;
-		}
-	}
-	NOT_REACHED();
+	assert(this->index != INVALID_RIDE_INSTANCE);
+	return this->index;
 }
 
 /**
@@ -848,8 +908,15 @@ void RidesManager::AddRideEntranceExitType(std::unique_ptr<RideEntranceExitType>
 uint16 RidesManager::GetFreeInstance(const RideType *type)
 {
 	if (!type->CanMakeInstance()) return INVALID_RIDE_INSTANCE;
-	if (this->instances.empty()) return SRI_FULL_RIDES;
-	return this->instances.rbegin()->first + 1 + SRI_FULL_RIDES;  // In a non-empty map, rbegin() always holds the highest key.
+
+	/* Drop the listed slots that got used by rides created with an explicit ride number. */
+	while (!this->free_slots.empty() && this->instances[this->free_slots.back()].instance != nullptr) {
+		this->instances[this->free_slots.back()].listed_free = false;
+		this->free_slots.pop_back();
+	}
+	if (!this->free_slots.empty()) return this->free_slots.back() + SRI_FULL_RIDES;
+	if (this->instances.size() + SRI_FULL_RIDES >= SRI_LAST) return INVALID_RIDE_INSTANCE;
+	return this->instances.size() + SRI_FULL_RIDES;
 }
 
 /**
@@ -862,9 +929,20 @@ RideInstance *RidesManager::CreateInstance(const RideType *type, uint16 num)
 {
 	assert(num >= SRI_FULL_RIDES && num < SRI_LAST);
 	num -= SRI_FULL_RIDES;
-	assert(this->instances.count(num) == 0);
-	this->instances.emplace(num, std::unique_ptr<RideInstance>(type->CreateInstance()));
-	return this->instances.at(num).get();
+	this->AddSlots(num + 1);
+
+	RideInstanceSlot &slot = this->instances[num];
+	assert(slot.instance == nullptr);
+	/* A slot elsewhere in the free list stays listed, #GetFreeInstance skips it. */
+	if (slot.listed_free && this->free_slots.back() == num) {
+		slot.listed_free = false;
+		this->free_slots.pop_back();
+	}
+	slot.instance.reset(type->CreateInstance());
+	slot.instance->index = num + SRI_FULL_RIDES;
+	slot.instance->InitializeRandom((static_cast<uint64>(slot.generation) << 16) | slot.instance->index);
+	this->kind_instances[type->kind].push_back(slot.instance.get());
+	return slot.instance.get();
 }
 
 /**
@@ -907,9 +985,11 @@ int RidesManager::GetExitIndex(const std::string &internal_name) const
  */
 RideInstance *RidesManager::FindRideByName(const std::string &name)
 {
-	for (auto &pair : this->instances) {
-		if (pair.second->state == RIS_ALLOCATED) continue;
-		if (name == pair.second->name) return pair.second.get();
+	for (auto &kind : this->kind_instances) {
+		for (RideInstance *ri : kind) {
+			if (ri->state == RIS_ALLOCATED) continue;
+			if (name == ri->name) return ri;
+		}
 	}
 	return nullptr;
 }
@@ -980,21 +1060,50 @@ void RidesManager::DeleteInstance(uint16 num)
 	assert(num >= SRI_FULL_RIDES && num < SRI_LAST);
 	num -= SRI_FULL_RIDES;
 
-	auto it = this->instances.find(num);
-	assert(it != this->instances.end());
-	it->second->RemoveAllPeople();
+	assert(num < this->instances.size());
+	RideInstanceSlot &slot = this->instances[num];
+	RideInstance *ri = slot.instance.get();
+	assert(ri != nullptr);
+	ri->RemoveAllPeople();
 
 	_inbox.NotifyRideDeletion(num + SRI_FULL_RIDES);
-	_guests.NotifyRideDeletion(it->second.get());
-	_staff.NotifyRideDeletion(it->second.get());
+	_guests.NotifyRideDeletion(ri);
+	_staff.NotifyRideDeletion(ri);
+	_queues.NotifyRideDeletion();
+
+	ri->RemoveFromWorld();
+	std::vector<RideInstance *> &kind = this->kind_instances[ri->GetKind()];
+	kind.erase(std::find(kind.begin(), kind.end(), ri));
+	/* Nothing can refer to a ride that was never built, so cancelling a ride does not need a new generation.
+	 * This keeps the random stream of the next ride independent of rides tried by the user interface. */
+	if (ri->state != RIS_ALLOCATED) slot.generation++;
+	slot.instance.reset();  // Deletes the instance.
+	if (!slot.listed_free) {
+		slot.listed_free = true;
+		this->free_slots.push_back(num);
+	}
+}
 
-	it->second->RemoveFromWorld();
-	this->instances.erase(it);  // Deletes the instance.
+/**
+ * Make sure that a number of ride number slots exist. New slots are free.
+ * @param count Minimal number of slots.
+ */
+void RidesManager::AddSlots(uint16 count)
+{
+	while (this->instances.size() < count) {
+		this->free_slots.push_back(this->instances.size());
+		this->instances.emplace_back();
+		this->instances.back().listed_free = true;
+	}
 }
 
 void RidesManager::DeleteAllRideInstances()
 {
-	while (!this->instances.empty()) this->DeleteInstance(this->instances.begin()->first + SRI_FULL_RIDES);
+	for (uint16 i = 0; i < this->instances.size(); i++) {
+		if (this->instances[i].instance != nullptr) this->DeleteInstance(i + SRI_FULL_RIDES);
+	}
+	this->instances.clear();
+	this->free_slots.clear();
 }
 
 /**
@@ -1003,6 +1112,7 @@ void RidesManager::DeleteAllRideInstances()
  */
 void RidesManager::LoadDesigns()
 {
+	TraceScope trace("RidesManager::LoadDesigns");
 	for (const std::string &file : _rcd_collection.ftkfiles) this->LoadDesign(file);
 }
 
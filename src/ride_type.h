@@ -23,6 +23,7 @@ constexpr int NUMBER_ITEM_TYPES_SOLD = 2;         ///< Number of different items
 constexpr int BREAKDOWN_GRACE_PERIOD = 30;        ///< Number of days to wait before random breakdowns after first time opening ride.
 
 class RideInstance;
+class MemoryReport;
 struct TrackedRideDesign;
 
 /**
@@ -210,6 +211,7 @@ public:
 	void MechanicArrived();
 	void SetEntranceType(int type);
 	void SetExitType(int type);
+	void InitializeRandom(uint64 stream);
 	virtual bool IsEntranceLocation(const XYZPoint16& pos) const;
 	virtual bool IsExitLocation(const XYZPoint16& pos) const;
 	virtual EdgeCoordinate GetMechanicEntrance() const = 0;
@@ -217,8 +219,18 @@ public:
 	virtual void Load(Loader &ldr);
 	virtual void Save(Saver &svr);
 
+	/**
+	 * Add the memory used by the large data structures of the ride to a memory report.
+	 * Most rides have none, so by default nothing is added.
+	 * @param report [inout] Report to add to.
+	 */
+	virtual void AddMemoryUsage([[maybe_unused]] MemoryReport &report) const
+	{
+	}
+
 	uint16 GetIndex() const;
 
+	uint16 index;                   ///< Ride number of the instance, assigned by RidesManager::CreateInstance.
 	std::string name;               ///< Name of the ride, if it is instantiated.
 	uint8 state;                    ///< State of the instance. @see RideInstanceState
 	uint8 flags;                    ///< Flags of the instance. @see RideInstanceFlags
@@ -248,17 +260,26 @@ protected:
 	virtual void RecalculateRatings() = 0;
 
 	const RideType *type;   ///< Ride type used.
-	Random rnd;             ///< Random number generator for determining ride breakage.
+	Random rnd;             ///< Random number generator of the ride.
 	bool mechanic_pending;  ///< Whether a mechanic has been called and did not arrive yet.
 };
 
 void SetRideRatingStringParam(uint32 rating);
 
+/** Slot of a ride number in the #RidesManager. */
+struct RideInstanceSlot {
+	std::unique_ptr<RideInstance> instance; ///< Ride instance using the ride number, or \c nullptr if the number is free.
+	uint16 generation = 0;                  ///< Number of built ride instances deleted from the slot, to detect a stale ride number and give a reused ride number a fresh random stream.
+	bool listed_free = false;               ///< Whether the slot is in RidesManager::free_slots.
+};
+
 /** Storage of available ride types. */
 class RidesManager {
 public:
 	RideInstance *GetRideInstance(uint16 num);
 	const RideInstance *GetRideInstance(uint16 num) const;
+	RideInstance *GetRideInstance(uint16 num, uint16 generation);
+	uint16 GetGeneration(uint16 num) const;
 	RideInstance *FindRideByName(const std::string &name);
 
 	void AddRideType(std::unique_ptr<RideType> type);
@@ -269,6 +290,7 @@ public:
 	void NewInstanceAdded(uint16 num);
 	void DeleteInstance(uint16 num);
 	void DeleteAllRideInstances();
+	void AddSlots(uint16 count);
 
 	void OnAnimate(int delay);
 	void OnNewMonth();
@@ -276,6 +298,7 @@ public:
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr);
+	void AddMemoryUsage(MemoryReport &report) const;
 	void LoadDesigns();
 	void LoadDesign(const std::string &file);
 	void LoadDesign(RcdFileReader *rcd_file);
@@ -295,7 +318,9 @@ public:
 	int GetExitIndex(const std::string &internal_name) const;
 
 	std::vector<std::unique_ptr<const RideType>> ride_types;             ///< Loaded types of rides.
-	std::map<uint16, std::unique_ptr<RideInstance>> instances;           ///< Rides available in the park.
+	std::vector<RideInstanceSlot> instances;                             ///< Rides available in the park, indexed by ride number minus #SRI_FULL_RIDES.
+	std::vector<uint16> free_slots;                                      ///< Indices of the unused entries in #instances, may contain entries of slots that got used since (see RideInstanceSlot::listed_free).
+	std::vector<RideInstance *> kind_instances[RTK_RIDE_KIND_COUNT];     ///< Rides of each kind in order of creation, for iterating over the rides.
 	std::vector<std::unique_ptr<const RideEntranceExitType>> entrances;  ///< Available ride entrance types.
 	std::vector<std::unique_ptr<const RideEntranceExitType>> exits;      ///< Available ride exit types.
 };
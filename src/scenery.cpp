@@ -17,6 +17,7 @@
 #include "people.h"
 #include "random.h"
 #include "viewport.h"
+#include "memory_usage.h"
 
 SceneryManager _scenery;
 
@@ -114,8 +115,7 @@ void PathObjectInstance::RecomputeExistenceState()
 
 	if (this->type->ignore_edges) {
 		if (this->state == 0xFF) {
-			Random r;
-			this->state = r.Uniform(PathDecoration::LITTER_VOMIT_COUNT - 1);
+			this->state = _scenery.rnd.Uniform(PathDecoration::LITTER_VOMIT_COUNT - 1);
 		}
 		return;
 	}
@@ -149,6 +149,7 @@ void PathObjectInstance::RecomputeExistenceState()
 		this->SetExistsOnTileEdge(EDGE_SW, (path_edges_bitset & PATHMASK_SW) == 0);
 		this->SetExistsOnTileEdge(EDGE_NW, (path_edges_bitset & PATHMASK_NW) == 0);
 	}
+	if (_scenery.GetPathObject(this->vox_pos) == this) _scenery.UpdatePathTask(this->vox_pos);
 }
 
 /**
@@ -166,7 +167,7 @@ void PathObjectInstance::Demolish(const TileEdge e)
 	if (this->type == &PathObjectType::LITTERBIN) {
 		XYZPoint16 offset;
 		if (GetImplodedPathSlope(_world.GetVoxel(this->vox_pos)) >= PATH_FLAT_COUNT) offset.z = 128;
-		Random r;
+		Random &r = _scenery.rnd;
 
 		/* Spread the bin's contents all over the path in front of the bin. */
 		for (; this->data[e] > 0; this->data[e]--) {
@@ -193,6 +194,7 @@ void PathObjectInstance::Demolish(const TileEdge e)
 			_scenery.AddLitter(this->vox_pos, offset);
 		}
 	}
+	_scenery.UpdatePathTask(this->vox_pos);
 }
 
 /**
@@ -371,6 +373,7 @@ uint16 PathObjectInstance::GetRightGuest(TileEdge e) const
  */
 void PathObjectInstance::AddItemToBin(TileEdge e) {
 	this->data[e]++;
+	if (this->BinNeedsEmptying(e)) _scenery.UpdatePathTask(this->vox_pos);
 }
 
 /**
@@ -380,6 +383,7 @@ void PathObjectInstance::AddItemToBin(TileEdge e) {
  */
 void PathObjectInstance::EmptyBin(TileEdge e) {
 	this->data[e] = 0;
+	_scenery.UpdatePathTask(this->vox_pos);
 }
 
 /**
@@ -704,7 +708,7 @@ void SceneryInstance::Save(Saver &svr) const
 }
 
 /** Default constructor. */
-SceneryManager::SceneryManager() : temp_item(nullptr), temp_path_object(nullptr)
+SceneryManager::SceneryManager() : temp_item(nullptr), temp_path_object(nullptr), rnd(RSK_SCENERY, 0), path_task_changes(0)
 {
 }
 
@@ -743,6 +747,7 @@ uint16 SceneryManager::GetSceneryTypeIndex(const SceneryType *type) const
  */
 const SceneryType *SceneryManager::GetType(const uint16 index) const
 {
+	if (index >= this->scenery_item_types.size()) return nullptr;
 	return this->scenery_item_types[index].get();
 }
 
@@ -782,6 +787,9 @@ void SceneryManager::Clear()
 	/* Do not use std::map::clear(), it may result in a heap-use-after-free. */
 	while (!this->litter_and_vomit.empty()) this->litter_and_vomit.erase(this->litter_and_vomit.begin());
 	while (!this->all_path_objects.empty()) this->all_path_objects.erase(this->all_path_objects.begin());
+	this->path_tasks.clear();
+	this->path_task_changes++;
+	this->rnd = Random(RSK_SCENERY, 0);
 }
 
 /**
@@ -856,6 +864,7 @@ void SceneryManager::SetPathObjectInstance(const XYZPoint16 &pos, const PathObje
 	} else {
 		this->all_path_objects[pos].reset(new PathObjectInstance(type, pos, XYZPoint16(/* Offset is ignored for user-placeable types. */)));
 	}
+	this->UpdatePathTask(pos);
 }
 
 /**
@@ -877,6 +886,7 @@ PathObjectInstance *SceneryManager::GetPathObject(const XYZPoint16 &pos)
 void SceneryManager::AddLitter(const XYZPoint16 &pos, const XYZPoint16 &offset)
 {
 	this->litter_and_vomit.emplace(pos, std::unique_ptr<PathObjectInstance>(new PathObjectInstance(&PathObjectType::LITTER, pos, offset)));
+	this->UpdatePathTask(pos);
 }
 
 /**
@@ -887,6 +897,7 @@ void SceneryManager::AddLitter(const XYZPoint16 &pos, const XYZPoint16 &offset)
 void SceneryManager::AddVomit(const XYZPoint16 &pos, const XYZPoint16 &offset)
 {
 	this->litter_and_vomit.emplace(pos, std::unique_ptr<PathObjectInstance>(new PathObjectInstance(&PathObjectType::VOMIT, pos, offset)));
+	this->UpdatePathTask(pos);
 }
 
 /**
@@ -896,6 +907,69 @@ void SceneryManager::AddVomit(const XYZPoint16 &pos, const XYZPoint16 &offset)
 void SceneryManager::RemoveLitterAndVomit(const XYZPoint16 &pos)
 {
 	this->litter_and_vomit.erase(pos);
+	this->UpdatePathTask(pos);
+}
+
+/**
+ * Recompute the work for handymen at a path tile, after a change of its litter or path objects.
+ * @param pos Coordinate of the path.
+ */
+void SceneryManager::UpdatePathTask(const XYZPoint16 &pos)
+{
+	uint8 work = PTF_NONE;
+	if (this->litter_and_vomit.count(pos) > 0) work |= PTF_LITTER;
+
+	const auto obj = this->all_path_objects.find(pos);
+	if (obj != this->all_path_objects.end() && obj->second->type == &PathObjectType::LITTERBIN) {
+		for (TileEdge e = EDGE_BEGIN; e != EDGE_COUNT; e++) {
+			if (obj->second->GetExistsOnTileEdge(e) && !obj->second->GetDemolishedOnTileEdge(e) && obj->second->BinNeedsEmptying(e)) {
+				work |= PTF_FULL_BIN;
+				break;
+			}
+		}
+	}
+
+	if (work == PTF_NONE) {
+		this->path_tasks.erase(pos);
+		return;
+	}
+	auto it = this->path_tasks.find(pos);
+	if (it == this->path_tasks.end()) {
+		this->path_tasks[pos] = {work, UNCLAIMED_PATH_TASK};
+		this->path_task_changes++;
+	} else {
+		it->second.work = work;
+	}
+}
+
+/**
+ * Claim the work at a path tile for a handyman, so other handymen leave it alone.
+ * @param pos Coordinate of the path.
+ * @param handyman ID of the handyman.
+ * @return Whether there is work at the tile, and it is now claimed by the handyman.
+ */
+bool SceneryManager::ClaimPathTask(const XYZPoint16 &pos, uint16 handyman)
+{
+	auto it = this->path_tasks.find(pos);
+	if (it == this->path_tasks.end()) return false;
+	if (it->second.handyman != UNCLAIMED_PATH_TASK && it->second.handyman != handyman) return false;
+
+	it->second.handyman = handyman;
+	return true;
+}
+
+/**
+ * Release the claim of a handyman on the work at a path tile.
+ * @param pos Coordinate of the path.
+ * @param handyman ID of the handyman.
+ */
+void SceneryManager::ReleasePathTask(const XYZPoint16 &pos, uint16 handyman)
+{
+	auto it = this->path_tasks.find(pos);
+	if (it != this->path_tasks.end() && it->second.handyman == handyman) {
+		it->second.handyman = UNCLAIMED_PATH_TASK;
+		this->path_task_changes++;
+	}
 }
 
 /**
@@ -909,11 +983,10 @@ std::vector<PathObjectInstance::PathObjectSprite> SceneryManager::DrawPathObject
 {
 	std::vector<PathObjectInstance::PathObjectSprite> result;
 
-	for (const auto &pair : this->litter_and_vomit) {
-		if (pair.first == pos) {
-			for (const PathObjectInstance::PathObjectSprite &image : pair.second->GetSprites(orientation, zoom)) {
-				result.push_back(image);
-			}
+	const auto litter = this->litter_and_vomit.equal_range(pos);
+	for (auto it = litter.first; it != litter.second; it++) {
+		for (const PathObjectInstance::PathObjectSprite &image : it->second->GetSprites(orientation, zoom)) {
+			result.push_back(image);
 		}
 	}
 
@@ -981,7 +1054,7 @@ SceneryInstance *SceneryManager::GetItem(const XYZPoint16 &pos)
 	return nullptr;
 }
 
-static const uint32 CURRENT_VERSION_SceneryInstance_SCNY = 3;   ///< Currently supported version of the SCNY Pattern.
+static const uint32 CURRENT_VERSION_SceneryInstance_SCNY = 4;   ///< Currently supported version of the SCNY Pattern.
 
 void SceneryManager::Load(Loader &ldr)
 {
@@ -993,6 +1066,8 @@ void SceneryManager::Load(Loader &ldr)
 		case 1:
 		case 2:
 		case 3:
+		case 4:
+			if (version >= 4) this->rnd.LoadState(ldr);
 			for (long l = ldr.GetLong(); l > 0; l--) {
 				SceneryInstance *i = new SceneryInstance(version >= 3 ? this->GetType(ldr.GetText()) : this->scenery_item_types[ldr.GetWord()].get());
 				i->Load(ldr);
@@ -1024,12 +1099,16 @@ void SceneryManager::Load(Loader &ldr)
 			ldr.VersionMismatch(version, CURRENT_VERSION_SceneryInstance_SCNY);
 	}
 	ldr.ClosePattern();
+
+	for (const auto &pair : this->all_path_objects) this->UpdatePathTask(pair.first);
+	for (const auto &pair : this->litter_and_vomit) this->UpdatePathTask(pair.first);
 }
 
 void SceneryManager::Save(Saver &svr) const
 {
 	svr.CheckNoOpenPattern();
 	svr.StartPattern("SCNY", CURRENT_VERSION_SceneryInstance_SCNY);
+	this->rnd.SaveState(svr);
 
 	svr.PutLong(this->all_items.size());
 	for (const auto &pair : this->all_items) {
@@ -1057,3 +1136,18 @@ void SceneryManager::Save(Saver &svr) const
 
 	svr.EndPattern();
 }
+
+/**
+ * Add the memory used by the scenery items and path objects in the world to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void SceneryManager::AddMemoryUsage(MemoryReport &report) const
+{
+	constexpr size_t ITEM_SIZE = sizeof(XYZPoint16) + sizeof(std::unique_ptr<SceneryInstance>) + MemoryReport::NODE_OVERHEAD + sizeof(SceneryInstance);
+	constexpr size_t OBJECT_SIZE = sizeof(XYZPoint16) + sizeof(std::unique_ptr<PathObjectInstance>) + MemoryReport::NODE_OVERHEAD + sizeof(PathObjectInstance);
+	constexpr size_t TASK_SIZE = sizeof(XYZPoint16) + sizeof(PathTask) + MemoryReport::NODE_OVERHEAD;
+
+	const size_t objects = this->all_path_objects.size() + this->litter_and_vomit.size();
+	report.Add(MO_SCENERY, this->all_items.size() + objects,
+			this->all_items.size() * ITEM_SIZE + objects * OBJECT_SIZE + this->path_tasks.size() * TASK_SIZE);
+}
@@ -19,6 +19,7 @@
 #include "loadsave.h"
 #include "map.h"
 #include "money.h"
+#include "random.h"
 #include "sprite_store.h"
 
 static const uint16 INVALID_VOXEL_DATA = 0xffff;     ///< Voxel instance data value that indicates that no scenery item should be drawn.
@@ -188,6 +189,21 @@ private:
 	uint8 state;         ///< Presence and demolishing states.
 };
 
+/** Kinds of work for handymen at a path tile (bit flags). */
+enum PathTaskFlags {
+	PTF_NONE     = 0,       ///< Nothing to do.
+	PTF_LITTER   = 1 << 0,  ///< The path has litter or vomit to sweep.
+	PTF_FULL_BIN = 1 << 1,  ///< A litter bin at the path needs emptying.
+};
+
+static const uint16 UNCLAIMED_PATH_TASK = 0xFFFF;  ///< Handyman ID denoting that nobody claimed a path task.
+
+/** Work for handymen at a path tile. */
+struct PathTask {
+	uint8 work;       ///< Work to do, bitset of #PathTaskFlags.
+	uint16 handyman;  ///< ID of the handyman who claimed the work, #UNCLAIMED_PATH_TASK if nobody did.
+};
+
 /** All the scenery items in the world. */
 class SceneryManager {
 public:
@@ -214,13 +230,37 @@ public:
 	uint8 CountDemolishedItems(const XYZPoint16 &pos) const;
 	PathObjectInstance *GetPathObject(const XYZPoint16 &pos);
 
+	void UpdatePathTask(const XYZPoint16 &pos);
+	bool ClaimPathTask(const XYZPoint16 &pos, uint16 handyman);
+	void ReleasePathTask(const XYZPoint16 &pos, uint16 handyman);
+
+	/**
+	 * Get the path tiles where handymen have work to do.
+	 * @return The path tasks, with the coordinate of the path tile as key.
+	 */
+	inline const std::map<XYZPoint16, PathTask> &GetPathTasks() const
+	{
+		return this->path_tasks;
+	}
+
+	/**
+	 * Get the number of times that unclaimed path tasks appeared so far, to detect that a handyman may find work now.
+	 * @return Change counter of the unclaimed path tasks.
+	 */
+	inline uint32 GetPathTaskChanges() const
+	{
+		return this->path_task_changes;
+	}
+
 	std::vector<PathObjectInstance::PathObjectSprite> DrawPathObjects(const XYZPoint16 &pos, uint8 orientation, int zoom) const;
 
 	void Load(Loader &ldr);
 	void Save(Saver &svr) const;
+	void AddMemoryUsage(MemoryReport &report) const;
 
 	SceneryInstance    *temp_item;         ///< A scenery item that is currently being placed (not owned).
 	PathObjectInstance *temp_path_object;  ///< A path object type that is currently being placed (not owned).
+	Random rnd;                            ///< Random number generator of the scenery items.
 
 private:
 	std::vector<std::unique_ptr<SceneryType>> scenery_item_types;  ///< All available scenery types.
@@ -228,6 +268,8 @@ private:
 	std::map     <XYZPoint16, std::unique_ptr<SceneryInstance   >> all_items       ;  ///< All scenery items                 in the world, with their base voxel as key.
 	std::map     <XYZPoint16, std::unique_ptr<PathObjectInstance>> all_path_objects;  ///< All     user-buyable path objects in the world, with their base voxel as key.
 	std::multimap<XYZPoint16, std::unique_ptr<PathObjectInstance>> litter_and_vomit;  ///< All non-user-buyable path objects in the world, with their base voxel as key.
+	std::map     <XYZPoint16, PathTask>                            path_tasks      ;  ///< Path tiles with litter or full bins, with the path voxel as key.
+	uint32 path_task_changes;                                                         ///< Number of times that unclaimed path tasks appeared, see #GetPathTaskChanges.
 };
 
 extern SceneryManager _scenery;
@@ -14,6 +14,7 @@
 #include "language.h"
 #include "finances.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "gui_sprites.h"
 #include "sprite_data.h"
 
@@ -291,20 +292,7 @@ void SceneryGui::SelectorMouseButtonEvent(const MouseButtons state)
 
 			SceneryInstance *i = _scenery.GetItem(location);
 			if (i != nullptr && i != _scenery.temp_item) {
-				if (i->type->category == SCC_SCENARIO && _game_mode_mgr.InPlayMode()) {
-					BestErrorMessageReason::ShowActionErrorMessage(BestErrorMessageReason::ACT_REMOVE, GUI_ERROR_MESSAGE_UNREMOVABLE);
-				} else {
-					const Money &cost = i->IsDry() ? i->type->return_cost_dry : i->type->return_cost;
-					if (BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_REMOVE, cost)) {
-						if (_game_control.action_test_mode) {
-							ShowCostOrReturnEstimate(cost);
-							return;
-						}
-						_finances_manager.PayLandscaping(cost);
-						_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, i->vox_pos);
-						_scenery.RemoveItem(i->vox_pos);
-					}
-				}
+				DoCommand(GCMD_REMOVE_SCENERY, {}, i->vox_pos);
 				return;
 			}
 		}
@@ -317,17 +305,11 @@ void SceneryGui::SelectorMouseButtonEvent(const MouseButtons state)
 		this->build_forbidden_reason.ShowErrorMessage();
 		return;
 	}
-	const Money &cost = this->selected_type->buy_cost;
-	if (!BestErrorMessageReason::CheckActionAllowed(BestErrorMessageReason::ACT_BUILD, cost)) return;
-	if (_game_control.action_test_mode) {
-		ShowCostOrReturnEstimate(cost);
-		return;
-	}
 
-	this->instance->RemoveFromWorld();  // The scenery manager will want to re-insert it, so we must unlink it first.
-	_finances_manager.PayLandscaping(cost);
-	_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->instance->vox_pos);
-	_scenery.AddItem(this->instance.release());
+	/* The command places a new item where the preview is, so the preview must leave the world first. */
+	this->instance->RemoveFromWorld();
+	_scenery.temp_item = nullptr;
+	DoCommand(GCMD_PLACE_SCENERY, {_scenery.GetSceneryTypeIndex(this->selected_type), this->instance->orientation}, this->instance->vox_pos);
 
 	this->SetType(this->selected_type);  // Prepare to place another instance.
 }
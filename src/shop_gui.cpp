@@ -17,6 +17,7 @@
 #include "entity_gui.h"
 #include "finances.h"
 #include "viewport.h"
+#include "command.h"
 
 /** Window to prompt for removing a shop. */
 class ShopRemoveWindow : public EntityRemoveWindow  {
@@ -25,29 +26,37 @@ public:
 
 	void OnClick(WidgetNumber number, const Point16 &pos) override;
 	void SetWidgetStringParameters(WidgetNumber wid_num) const override;
+	bool IsStale() const override;
 
 private:
-	ShopInstance *si; ///< Shop instance to remove.
+	ShopInstance *si;        ///< Shop instance to remove.
+	uint16 ride_generation;  ///< Generation of the ride number when the window was opened, see #IsStale.
 };
 
 /**
  * Constructor of the shop remove window.
  * @param si Shop instance to remove.
  */
-ShopRemoveWindow::ShopRemoveWindow(ShopInstance *instance) : EntityRemoveWindow(WC_SHOP_REMOVE, instance->GetIndex()), si(instance)
+ShopRemoveWindow::ShopRemoveWindow(ShopInstance *instance) : EntityRemoveWindow(WC_SHOP_REMOVE, instance->GetIndex()), si(instance),
+		ride_generation(_rides_manager.GetGeneration(instance->GetIndex()))
 {
 }
 
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool ShopRemoveWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 void ShopRemoveWindow::OnClick(WidgetNumber number, [[maybe_unused]] const Point16 &pos)
 {
 	if (number == ERW_YES) {
-		const Money cost = this->si->ComputeReturnCost();
-		_finances_manager.PayRideConstruct(cost);
-		_window_manager.GetViewport()->AddFloatawayMoneyAmount(cost, this->si->RepresentativeLocation());
-
 		delete GetWindowByType(WC_SHOP_MANAGER, this->si->GetIndex());
 
-		_rides_manager.DeleteInstance(this->si->GetIndex());
+		DoCommand(GCMD_REMOVE_RIDE, {this->si->GetIndex()});
 	}
 	delete this;
 }
@@ -174,9 +183,12 @@ public:
 	void UpdateWidgetSize(WidgetNumber wid_num, BaseWidget *wid) override;
 	void SetWidgetStringParameters(WidgetNumber wid_num) const override;
 	void OnClick(WidgetNumber wid_num, const Point16 &pos) override;
+	void OnChange(ChangeCode code, uint32 parameter) override;
+	bool IsStale() const override;
 
 private:
-	ShopInstance *shop; ///< Shop instance getting managed by this window.
+	ShopInstance *shop;      ///< Shop instance getting managed by this window.
+	uint16 ride_generation;  ///< Generation of the ride number when the window was opened, see #IsStale.
 
 	void SetShopToggleButtons();
 };
@@ -185,7 +197,8 @@ private:
  * Constructor of the shop management window.
  * @param ri Shop to manage.
  */
-ShopManagerWindow::ShopManagerWindow(ShopInstance *ri) : GuiWindow(WC_SHOP_MANAGER, ri->GetIndex()), shop(ri)
+ShopManagerWindow::ShopManagerWindow(ShopInstance *ri) : GuiWindow(WC_SHOP_MANAGER, ri->GetIndex()), shop(ri),
+		ride_generation(_rides_manager.GetGeneration(ri->GetIndex()))
 {
 	this->SetRideType(this->shop->GetShopType());
 	this->SetupWidgetTree(_shop_manager_gui_parts, lengthof(_shop_manager_gui_parts));
@@ -269,7 +282,7 @@ void ShopManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused]] const Poi
 		case SMW_OPEN_SHOP_LIGHT:
 		case SMW_OPEN_SHOP_PANEL:
 			if (this->shop->state != RIS_OPEN) {
-				this->shop->OpenRide();
+				DoCommand(GCMD_SET_RIDE_STATE, {this->shop->GetIndex(), RIS_OPEN});
 				this->SetShopToggleButtons();
 			}
 			break;
@@ -277,7 +290,7 @@ void ShopManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused]] const Poi
 		case SMW_CLOSE_SHOP_LIGHT:
 		case SMW_CLOSE_SHOP_PANEL:
 			if (this->shop->state != RIS_CLOSED) {
-				this->shop->CloseRide();
+				DoCommand(GCMD_SET_RIDE_STATE, {this->shop->GetIndex(), RIS_CLOSED});
 				this->SetShopToggleButtons();
 			}
 			break;
@@ -285,7 +298,7 @@ void ShopManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused]] const Poi
 		case SMW_RECOLOUR1:
 		case SMW_RECOLOUR2:
 		case SMW_RECOLOUR3: {
-			RecolourEntry *re = &this->shop->recolours.entries[wid_num - SMW_RECOLOUR1];
+			const RecolourEntry *re = &this->shop->recolours.entries[wid_num - SMW_RECOLOUR1];
 			if (re->IsValid()) {
 				this->ShowRecolourDropdown(wid_num, re, COL_RANGE_DARK_RED);
 			}
@@ -297,6 +310,25 @@ void ShopManagerWindow::OnClick(WidgetNumber wid_num, [[maybe_unused]] const Poi
 	}
 }
 
+void ShopManagerWindow::OnChange(const ChangeCode code, const uint32 parameter)
+{
+	if (code != CHG_DROPDOWN_RESULT) return;
+
+	const int widget = (parameter >> 16) & 0xFF;
+	if (widget >= SMW_RECOLOUR1 && widget <= SMW_RECOLOUR3) {
+		DoCommand(GCMD_SET_RIDE_COLOUR, {this->shop->GetIndex(), RCP_RIDE, widget - SMW_RECOLOUR1, parameter & 0xFF});
+	}
+}
+
+/**
+ * Is the ride of the window deleted?
+ * @return Whether the window should be closed.
+ */
+bool ShopManagerWindow::IsStale() const
+{
+	return _rides_manager.GetRideInstance(this->wnumber, this->ride_generation) == nullptr;
+}
+
 /**
  * Open a window to manage a given shop.
  * @param number Shop to manage.
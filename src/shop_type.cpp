@@ -182,9 +182,8 @@ RideEntryResult ShopInstance::EnterRide(int guest, [[maybe_unused]] const XYZPoi
 	/* Guest should wait for the ride to finish, find a spot. */
 	int free_batch = this->onride_guests.GetLoadingBatch();
 	if (free_batch >= 0) {
-		GuestBatch &gb = this->onride_guests.GetBatch(free_batch);
-		if (gb.AddGuest(guest, entry)) {
-			gb.Start(TOILET_TIME);
+		if (this->onride_guests.GetBatch(free_batch).AddGuest(guest, entry)) {
+			this->onride_guests.StartBatch(free_batch, TOILET_TIME);
 			return RER_ENTERED;
 		}
 	}
@@ -13,6 +13,7 @@
 #include "fileio.h"
 #include "bitmath.h"
 #include "video.h"
+#include "memory_usage.h"
 
 #include <cmath>
 #include <vector>
@@ -93,6 +94,28 @@ void ImageVariants::DropStale()
 	}
 }
 
+/** Delete all cached images. */
+void ImageVariants::Clear()
+{
+	this->cache.clear();
+}
+
+/**
+ * Add the memory used by the scaled images to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void ImageVariants::AddMemoryUsage(MemoryReport &report) const
+{
+	size_t count = 0;
+	size_t bytes = this->cache.capacity() * sizeof(Variant);
+	for (const Variant &v : this->cache) {
+		bytes += v.scaled.capacity() * sizeof(v.scaled[0]);
+		for (const auto &image : v.scaled) bytes += sizeof(ImageData) + image->GetPixelMemorySize();
+		count += v.scaled.size();
+	}
+	report.Add(MO_SCALED_SPRITES, count, bytes);
+}
+
 ImageVariants _image_variants;  ///< Singleton image variants tracker.
 
 static std::vector<std::unique_ptr<ImageData[]>> _sprites;  ///< Available sprites to the program.
@@ -410,6 +433,19 @@ std::unique_ptr<uint8[]> ImageData::GetRecoloured(GradientShift shift, const Rec
 	return result;
 }
 
+/**
+ * Get the memory allocated for the pixels of the image.
+ * @return Number of bytes of the pixel data.
+ */
+size_t ImageData::GetPixelMemorySize() const
+{
+	const size_t pixels = this->width * this->height;
+	size_t bytes = 0;
+	if (this->rgba != nullptr) bytes += pixels * 4;
+	if (this->recol != nullptr) bytes += pixels * (this->is_8bpp ? 1 : 2);
+	return bytes;
+}
+
 /**
  * Scale this image to a different size.
  * @param factor Factor by which to scale.
@@ -515,8 +551,20 @@ void InitImageStorage()
 	/* Nothing to do currently. */
 }
 
+/**
+ * Add the memory used by the loaded images to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void AddImageMemoryUsage(MemoryReport &report)
+{
+	size_t bytes = _sprites.capacity() * sizeof(_sprites[0]) + _sprites.size() * IMAGE_BATCH_SIZE * sizeof(ImageData);
+	for (uint32 i = 0; i < _sprites_loaded; i++) bytes += _sprites[i / IMAGE_BATCH_SIZE][i % IMAGE_BATCH_SIZE].GetPixelMemorySize();
+	report.Add(MO_SPRITES, _sprites_loaded, bytes);
+}
+
 /** Clear all memory. */
 void DestroyImageStorage()
 {
+	_image_variants.Clear();
 	_sprites.clear();
 }
@@ -18,6 +18,7 @@
 static const uint32 INVALID_JUMP = UINT32_MAX; ///< Invalid jump destination in image data.
 
 class RcdFileReader;
+class MemoryReport;
 
 /**
  * Image data of 8bpp images.
@@ -34,6 +35,7 @@ public:
 	std::unique_ptr<uint8[]> GetRecoloured(GradientShift shift, const Recolouring &recolour) const;
 
 	const ImageData *Scale(uint16 desired_width) const;
+	size_t GetPixelMemorySize() const;
 
 	/**
 	 * Is the sprite just a single pixel?
@@ -64,6 +66,8 @@ public:
 	void Insert(const ImageData *img, RecolourData key, uint8 *rgba);
 	void Insert(const ImageData *img, ImageData *scaled);
 	void DropStale();
+	void Clear();
+	void AddMemoryUsage(MemoryReport &report) const;
 
 	/** Frequent maintenance tasks. */
 	void Tick()
@@ -97,6 +101,7 @@ extern ImageVariants _image_variants;
 ImageData *LoadImage(RcdFileReader *rcd_file);
 
 void InitImageStorage();
+void AddImageMemoryUsage(MemoryReport &report);
 void DestroyImageStorage();
 
 #endif
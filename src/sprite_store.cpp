@@ -28,6 +28,7 @@
 #include "gamelevel.h"
 #include "scenery.h"
 #include "string_func.h"
+#include "trace.h"
 
 SpriteManager _sprite_manager; ///< Sprite manager.
 GuiSprites _gui_sprites;       ///< GUI sprites.
@@ -1652,9 +1653,14 @@ SpriteStorage *SpriteManager::GetSpriteStore(int width)
 	return &this->store[width];
 }
 
-/** Load all useful RCD files found by #_rcd_collection, into the program. */
-void SpriteManager::LoadRcdFiles()
+/**
+ * Load all useful RCD files found by #_rcd_collection, into the program.
+ * @param progress [out] If set, receives the fraction of the files loaded so far.
+ */
+void SpriteManager::LoadRcdFiles(std::atomic<float> *progress)
 {
+	TraceScope trace("SpriteManager::LoadRcdFiles");
+	size_t loaded = 0;
 	for (auto &entry : _rcd_collection.rcdfiles) {
 		const char *fname = entry.second.path.c_str();
 		try {
@@ -1662,6 +1668,8 @@ void SpriteManager::LoadRcdFiles()
 		} catch (const LoadingError &e) {
 			fprintf(stderr, "Error while reading \"%s\": %s\n", fname, e.what());
 		}
+		loaded++;
+		if (progress != nullptr) *progress = static_cast<float>(loaded) / _rcd_collection.rcdfiles.size();
 	}
 }
 
@@ -20,6 +20,7 @@
 #include "weather.h"
 #include "gui_sprites.h"
 #include "sprite_data.h"
+#include <atomic>
 #include <map>
 #include <set>
 
@@ -845,7 +846,7 @@ public:
 	SpriteManager();
 	~SpriteManager();
 
-	void LoadRcdFiles();
+	void LoadRcdFiles(std::atomic<float> *progress = nullptr);
 	void AddBlock(std::unique_ptr<RcdBlock> block);
 
 	void AddAnimation(Animation *anim);
@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "window.h"
+#include "command.h"
 #include "person.h"
 #include "people.h"
 #include "sprite_data.h"
@@ -119,22 +120,7 @@ void StaffManagementGui::OnClick(const WidgetNumber number, const Point16 &pos)
 {
 	switch (number) {
 		case STAFF_HIRE:
-			switch (this->selected) {
-				case PERSON_MECHANIC:
-					_staff.HireMechanic();
-					break;
-				case PERSON_HANDYMAN:
-					_staff.HireHandyman();
-					break;
-				case PERSON_GUARD:
-					_staff.HireGuard();
-					break;
-				case PERSON_ENTERTAINER:
-					_staff.HireEntertainer();
-					break;
-				default:
-					NOT_REACHED();
-			}
+			DoCommand(GCMD_HIRE_STAFF, {this->selected});
 			break;
 
 		case STAFF_CATEGORY_MECHANICS:    this->SelectTab(PERSON_MECHANIC);    break;
@@ -150,7 +136,7 @@ void StaffManagementGui::OnClick(const WidgetNumber number, const Point16 &pos)
 
 			StaffMember *m = _staff.Get(this->selected, index - first_index);
 			if (pos.x > this->GetWidget<BaseWidget>(STAFF_GUI_LIST)->pos.width * 4 / 5) {
-				_staff.Dismiss(m);
+				DoCommand(GCMD_DISMISS_STAFF, {this->selected, m->id});
 			} else {
 				ShowPersonInfoGui(m);
 			}
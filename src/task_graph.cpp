@@ -0,0 +1,174 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file task_graph.cpp Running a set of dependent tasks concurrently. */
+
+#include "stdafx.h"
+#include "task_graph.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+#include <thread>
+
+/**
+ * Add a task to the graph.
+ * @param name Name of the task, must be a string literal.
+ * @param work Work of the task.
+ * @param dependencies Tasks that must be finished before this task can start. They must have been added already.
+ * @param weight Share of the task in the total progress, relative to the other tasks.
+ * @param main_thread Whether the task must run on the thread calling #Run.
+ * @return Identification of the new task.
+ */
+TaskGraph::TaskID TaskGraph::Add(const char *name, Work work, std::initializer_list<TaskID> dependencies, float weight, bool main_thread)
+{
+	const TaskID id = this->tasks.size();
+	std::unique_ptr<Task> task(new Task);
+	task->name = name;
+	task->work = std::move(work);
+	task->waiting_for = dependencies.size();
+	task->weight = weight;
+	task->main_thread = main_thread;
+	task->progress = 0.0f;
+	for (TaskID dep : dependencies) {
+		assert(dep < id);
+		this->tasks[dep]->dependents.push_back(id);
+	}
+	this->tasks.push_back(std::move(task));
+	return id;
+}
+
+/**
+ * Queue a task whose dependencies have all finished.
+ * @param id Task to queue.
+ * @pre The caller holds #lock.
+ */
+void TaskGraph::Queue(TaskID id)
+{
+	if (this->tasks[id]->main_thread) {
+		this->ready_main.push_back(id);
+	} else {
+		this->ready_workers.push_back(id);
+	}
+}
+
+/**
+ * Run a task, and queue the tasks that were waiting only for it.
+ * @param id Task to run.
+ * @pre The caller does not hold #lock.
+ */
+void TaskGraph::Execute(TaskID id)
+{
+	Task &task = *this->tasks[id];
+	{
+		TraceScope trace(task.name);
+		task.work(task.progress);
+	}
+	task.progress = 1.0f;
+
+	std::lock_guard<std::mutex> guard(this->lock);
+	this->finished++;
+	for (TaskID dep : task.dependents) {
+		if (--this->tasks[dep]->waiting_for == 0) this->Queue(dep);
+	}
+	this->changed.notify_all();
+}
+
+/** Main function of a worker thread, runs ready tasks until all tasks have finished. */
+void TaskGraph::WorkerLoop()
+{
+	std::unique_lock<std::mutex> guard(this->lock);
+	for (;;) {
+		this->changed.wait(guard, [this]() { return !this->ready_workers.empty() || this->finished == this->tasks.size(); });
+		if (this->ready_workers.empty()) return;
+
+		const TaskID id = this->ready_workers.front();
+		this->ready_workers.pop_front();
+		guard.unlock();
+		this->Execute(id);
+		guard.lock();
+	}
+}
+
+/**
+ * Run all tasks of the graph, and wait until they have finished.
+ * Without worker threads, the calling thread runs all tasks in the order of their dependencies.
+ * @param idle If set, called regularly by the main thread while it has no task to run, for example to show the progress.
+ */
+void TaskGraph::Run(const std::function<void()> &idle)
+{
+	size_t worker_tasks = 0;
+	for (const auto &task : this->tasks) {
+		if (!task->main_thread) worker_tasks++;
+	}
+#ifdef WEBASSEMBLY
+	const size_t thread_count = 0;  // No threads, the tasks run on the main thread.
+#else
+	const size_t thread_count = std::min<size_t>(worker_tasks, std::max(1u, std::thread::hardware_concurrency()));
+#endif
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	for (TaskID id = 0; id < this->tasks.size(); id++) {
+		if (this->tasks[id]->waiting_for == 0) this->Queue(id);
+	}
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < thread_count; i++) {
+		try {
+			workers.emplace_back(&TaskGraph::WorkerLoop, this);
+		} catch (const std::system_error &) {
+			break;  // No more threads available, make do with the workers started so far.
+		}
+	}
+	const bool run_worker_tasks = workers.empty();  // Without workers, the main thread runs their tasks as well.
+
+	/* Queue of the next task for the main thread, if any. */
+	auto next_queue = [this, run_worker_tasks]() -> std::deque<TaskID> * {
+		if (!this->ready_main.empty()) return &this->ready_main;
+		if (run_worker_tasks && !this->ready_workers.empty()) return &this->ready_workers;
+		return nullptr;
+	};
+	auto can_continue = [this, &next_queue]() { return next_queue() != nullptr || this->finished == this->tasks.size(); };
+	while (this->finished < this->tasks.size()) {
+		std::deque<TaskID> *queue = next_queue();
+		if (queue != nullptr) {
+			const TaskID id = queue->front();
+			queue->pop_front();
+			guard.unlock();
+			this->Execute(id);
+			guard.lock();
+			continue;
+		}
+
+		if (idle == nullptr) {
+			this->changed.wait(guard, can_continue);
+		} else {
+			guard.unlock();
+			idle();
+			guard.lock();
+			this->changed.wait_for(guard, std::chrono::milliseconds(15), can_continue);
+		}
+	}
+	guard.unlock();
+
+	for (std::thread &worker : workers) worker.join();
+}
+
+/**
+ * Get the progress of the tasks together.
+ * @return Weighted progress of all tasks, between \c 0 and \c 1.
+ */
+float TaskGraph::GetProgress() const
+{
+	float done = 0.0f;
+	float total = 0.0f;
+	for (const auto &task : this->tasks) {
+		done += task->weight * task->progress;
+		total += task->weight;
+	}
+	return (total > 0.0f) ? done / total : 1.0f;
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file task_graph.h Running a set of dependent tasks concurrently. */
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Graph of tasks with dependencies between them. Tasks are run on a pool of worker threads as soon as all
+ * tasks they depend on have finished. Tasks that must run on the main thread (everything touching the
+ * OpenGL context) are run by the thread calling #Run. Without worker threads (WebAssembly), that thread runs all tasks.
+ */
+class TaskGraph {
+public:
+	using TaskID = size_t;  ///< Identification of a task in the graph.
+
+	/**
+	 * Work of a task.
+	 * The parameter is the progress of the task, between \c 0 (not started) and \c 1 (done); the work may update it while running.
+	 */
+	using Work = std::function<void(std::atomic<float> &progress)>;
+
+	TaskID Add(const char *name, Work work, std::initializer_list<TaskID> dependencies = {}, float weight = 1.0f, bool main_thread = false);
+	void Run(const std::function<void()> &idle = nullptr);
+
+	float GetProgress() const;
+
+private:
+	/** A task in the graph. */
+	struct Task {
+		const char *name;               ///< Name of the task, must be a string literal.
+		Work work;                      ///< Work to do.
+		std::vector<TaskID> dependents; ///< Tasks waiting for this task.
+		int waiting_for;                ///< Number of unfinished tasks this task depends on.
+		float weight;                   ///< Share of the task in the total progress.
+		bool main_thread;               ///< Whether the task must run on the main thread.
+		std::atomic<float> progress;    ///< Progress of the task, between \c 0 and \c 1.
+	};
+
+	void Queue(TaskID id);
+	void Execute(TaskID id);
+	void WorkerLoop();
+
+	std::vector<std::unique_ptr<Task>> tasks; ///< All tasks of the graph.
+	std::deque<TaskID> ready_workers;         ///< Tasks ready to be run by a worker thread.
+	std::deque<TaskID> ready_main;            ///< Tasks ready to be run by the main thread.
+	size_t finished = 0;                      ///< Number of finished tasks.
+	std::mutex lock;                          ///< Lock protecting the queues and the dependency counts.
+	std::condition_variable changed;          ///< Signalled when a task becomes ready or finishes.
+};
+
+#endif
@@ -458,9 +458,10 @@ static void SetYFoundations(int xpos, int ypos)
 /**
  * Perform the proposed changes.
  * @param direction Direction of change.
+ * @param pay Whether to pay money for the change.
  * @return Whether the change could actually be performed (else nothing is changed).
  */
-bool TerrainChanges::ModifyWorld(const int direction)
+bool TerrainChanges::ModifyWorld(const int direction, const bool pay)
 {
 	/* First iteration: Check that the world can be safely changed (no collisions with other game elements.) */
 	Money total_cost(0);
@@ -515,9 +516,11 @@ bool TerrainChanges::ModifyWorld(const int direction)
 		ShowCostOrReturnEstimate(total_cost);
 		return true;
 	}
-	_finances_manager.PayLandscaping(total_cost);
-	_window_manager.GetViewport()->AddFloatawayMoneyAmount(total_cost, XYZPoint16(
-			this->changes.begin()->first.x, this->changes.begin()->first.y, this->changes.begin()->second.height));
+	if (pay) {
+		_finances_manager.PayLandscaping(total_cost);
+		AddFloatawayMoneyAmount(total_cost, XYZPoint16(
+				this->changes.begin()->first.x, this->changes.begin()->first.y, this->changes.begin()->second.height));
+	}
 
 	/* Second iteration: Change the ground of the tiles. */
 	for (auto &iter : this->changes) {
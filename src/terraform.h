@@ -49,7 +49,7 @@ public:
 	void UpdatelevellingHeight(const Point16 &pos, int direction, uint8 *height);
 	bool ChangeVoxel(const Point16 &pos, uint8 height, int direction);
 	bool ChangeCorner(const Point16 &pos, TileCorner corner, int direction);
-	bool ModifyWorld(int direction);
+	bool ModifyWorld(int direction, bool pay = true);
 
 	GroundModificationMap changes; ///< Registered changes.
 
@@ -12,6 +12,7 @@
 #include "window.h"
 #include "viewport.h"
 #include "terraform.h"
+#include "command.h"
 #include "sprite_store.h"
 #include "sprite_data.h"
 #include "gui_sprites.h"
@@ -122,9 +123,11 @@ void TerraformGui::SelectorMouseWheelEvent(int direction)
 	if (this->selector == nullptr) return;
 
 	if (this->xsize <= 1 && this->ysize <= 1) { // 'dot' mode, or single tile mode..
-		ChangeTileCursorMode(this->tiles_selector.area.base, this->tiles_selector.cur_cursor, this->level, direction, (this->xsize == 0 && this->ysize == 0));
+		const XYZPoint16 pos(this->tiles_selector.area.base.x, this->tiles_selector.area.base.y, 0);
+		DoCommand(GCMD_TERRAFORM_TILE, {this->tiles_selector.cur_cursor, this->level, direction, this->xsize == 0 && this->ysize == 0}, pos);
 	} else {
-		ChangeAreaCursorMode(this->tiles_selector.area, this->level, direction);
+		const XYZPoint16 pos(this->tiles_selector.area.base.x, this->tiles_selector.area.base.y, 0);
+		DoCommand(GCMD_TERRAFORM_AREA, {this->tiles_selector.area.width, this->tiles_selector.area.height, this->level, direction}, pos);
 	}
 	this->tiles_selector.InitTileData();
 }
@@ -160,8 +163,8 @@ void TerraformGui::DoChangeLandOwner()
 	if (this->selector == nullptr || this->xsize < 1 || this->ysize < 1 || !_game_mode_mgr.InEditorMode()) return;
 
 	if (this->change_owner.has_value()) {
-		_world.SetTileOwnerRect(this->tiles_selector.area.base.x, this->tiles_selector.area.base.y,
-				this->tiles_selector.area.width, this->tiles_selector.area.height, *this->change_owner);
+		const Rectangle16 &area = this->tiles_selector.area;
+		DoCommand(GCMD_SET_TILE_OWNER, {area.width, area.height, *this->change_owner}, XYZPoint16(area.base.x, area.base.y, 0));
 	}
 }
 
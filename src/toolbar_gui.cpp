@@ -23,6 +23,7 @@
 #include "people.h"
 #include "viewport.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "weather.h"
 #include "gameobserver.h"
 
@@ -54,6 +55,7 @@ enum ToolbarGuiWidgets {
 	TB_SPEED_2,           ///< 2× game speed button.
 	TB_SPEED_4,           ///< 4× game speed button.
 	TB_SPEED_8,           ///< 8× game speed button.
+	TB_SPEED_TURBO,       ///< Turbo game speed button, displaying the achieved speed.
 	TB_GUI_PATHS,         ///< Build paths button.
 	TB_GUI_RIDE_SELECT,   ///< Select ride button.
 	TB_GUI_FENCE,         ///< Select fence button.
@@ -116,7 +118,8 @@ static const WidgetPart _toolbar_widgets[] = {
 				Widget(WT_IMAGE_BUTTON, TB_SPEED_1, COL_RANGE_ORANGE_BROWN), SetData(SPR_GUI_SPEED_1, GUI_TOOLBAR_GUI_DROPDOWN_SPEED_1), SetPadding(8, 0, 8, 0),
 				Widget(WT_IMAGE_BUTTON, TB_SPEED_2, COL_RANGE_ORANGE_BROWN), SetData(SPR_GUI_SPEED_2, GUI_TOOLBAR_GUI_DROPDOWN_SPEED_2), SetPadding(8, 0, 8, 0),
 				Widget(WT_IMAGE_BUTTON, TB_SPEED_4, COL_RANGE_ORANGE_BROWN), SetData(SPR_GUI_SPEED_4, GUI_TOOLBAR_GUI_DROPDOWN_SPEED_4), SetPadding(8, 0, 8, 0),
-				Widget(WT_IMAGE_BUTTON, TB_SPEED_8, COL_RANGE_ORANGE_BROWN), SetData(SPR_GUI_SPEED_8, GUI_TOOLBAR_GUI_DROPDOWN_SPEED_8), SetPadding(8, 8, 8, 0),
+				Widget(WT_IMAGE_BUTTON, TB_SPEED_8, COL_RANGE_ORANGE_BROWN), SetData(SPR_GUI_SPEED_8, GUI_TOOLBAR_GUI_DROPDOWN_SPEED_8), SetPadding(8, 0, 8, 0),
+				Widget(WT_TEXT_BUTTON, TB_SPEED_TURBO, COL_RANGE_ORANGE_BROWN), SetData(STR_ARG1, GUI_TOOLBAR_GUI_SPEED_TURBO_TOOLTIP), SetPadding(8, 8, 8, 0),
 			EndContainer(),
 		Widget(WT_EMPTY, INVALID_WIDGET_INDEX, COL_RANGE_ORANGE_BROWN), SetMinimalSize(16, 16),
 		Widget(WT_IMAGE_PUSHBUTTON, TB_GUI_TERRAFORM,    COL_RANGE_ORANGE_BROWN), SetData(SPR_GUI_TOOLBAR_TERRAIN, GUI_TOOLBAR_GUI_TOOLTIP_TERRAFORM),
@@ -152,6 +155,7 @@ void ToolbarWindow::OnDraw(MouseModeSelector *selector)
 	this->SetWidgetPressed(TB_SPEED_2, _game_control.speed == GSP_2);
 	this->SetWidgetPressed(TB_SPEED_4, _game_control.speed == GSP_4);
 	this->SetWidgetPressed(TB_SPEED_8, _game_control.speed == GSP_8);
+	this->SetWidgetPressed(TB_SPEED_TURBO, _game_control.speed == GSP_TURBO);
 
 	GuiWindow::OnDraw(selector);
 }
@@ -220,19 +224,22 @@ void ToolbarWindow::OnClick(WidgetNumber number, [[maybe_unused]] const Point16
 		}
 
 		case TB_SPEED_0:
-			_game_control.speed = GSP_PAUSE;
+			DoCommand(GCMD_SET_SPEED, {GSP_PAUSE});
 			break;
 		case TB_SPEED_1:
-			_game_control.speed = GSP_1;
+			DoCommand(GCMD_SET_SPEED, {GSP_1});
 			break;
 		case TB_SPEED_2:
-			_game_control.speed = GSP_2;
+			DoCommand(GCMD_SET_SPEED, {GSP_2});
 			break;
 		case TB_SPEED_4:
-			_game_control.speed = GSP_4;
+			DoCommand(GCMD_SET_SPEED, {GSP_4});
 			break;
 		case TB_SPEED_8:
-			_game_control.speed = GSP_8;
+			DoCommand(GCMD_SET_SPEED, {GSP_8});
+			break;
+		case TB_SPEED_TURBO:
+			DoCommand(GCMD_SET_SPEED, {GSP_TURBO});
 			break;
 
 		case TB_GUI_PATHS:
@@ -340,12 +347,32 @@ void ToolbarWindow::OnChange(ChangeCode code, uint32 parameter)
 	}
 }
 
-void ToolbarWindow::UpdateWidgetSize([[maybe_unused]] WidgetNumber wid_num, [[maybe_unused]] BaseWidget *wid)
+void ToolbarWindow::UpdateWidgetSize(WidgetNumber wid_num, BaseWidget *wid)
 {
+	static const int LARGE_MULTIPLIER = 9999; // Large enough to display all reasonable game speeds.
+
+	if (wid_num != TB_SPEED_TURBO) return;
+
+	/* Make room for the achieved speed, which is displayed instead of the button text at turbo speed. */
+	const DataWidget *dw = static_cast<const DataWidget *>(wid);
+	int width, height;
+	_str_params.SetNumber(1, LARGE_MULTIPLIER);
+	GetTextSize(GUI_TOOLBAR_GUI_SPEED_MULTIPLIER, &width, &height);
+	if (width > dw->value_width) wid->min_x += width - dw->value_width;
 }
 
-void ToolbarWindow::SetWidgetStringParameters([[maybe_unused]] WidgetNumber wid_num) const
+void ToolbarWindow::SetWidgetStringParameters(WidgetNumber wid_num) const
 {
+	if (wid_num != TB_SPEED_TURBO) return;
+
+	/* Show the achieved speed while running at turbo speed. */
+	if (_game_control.speed == GSP_TURBO) {
+		StringParameters params;
+		params.SetNumber(1, _game_control.speed_multiplier);
+		_str_params.SetText(1, DrawText(GUI_TOOLBAR_GUI_SPEED_MULTIPLIER, &params));
+	} else {
+		_str_params.SetStrID(1, GUI_TOOLBAR_GUI_DROPDOWN_SPEED_TURBO);
+	}
 }
 
 /**
@@ -0,0 +1,125 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file trace.cpp Recording a timeline of the game for viewing in a trace viewer. */
+
+#include "stdafx.h"
+#include "trace.h"
+#include <map>
+
+Tracer _tracer; ///< Tracer of the game.
+
+/**
+ * Get a small number identifying the current thread in the trace.
+ * @return Number of the calling thread, threads are numbered in the order of their first event.
+ */
+static uint32 GetTraceThread()
+{
+	static std::atomic<uint32> next_thread(1);
+	thread_local const uint32 thread = next_thread++;
+	return thread;
+}
+
+Tracer::Tracer() : enabled(false), next_event(0), wrapped(false)
+{
+}
+
+/**
+ * Start recording events. Events recorded before are discarded.
+ * @param fname Name of the file to write the trace to when tracing stops.
+ * @param capacity Number of events kept; when the buffer is full, the oldest events are overwritten.
+ */
+void Tracer::Start(const std::string &fname, uint32 capacity)
+{
+	assert(capacity > 0);
+	std::lock_guard<std::mutex> guard(this->lock);
+	this->filename = fname;
+	this->events.assign(capacity, TraceEvent());
+	this->next_event = 0;
+	this->wrapped = false;
+	this->start = std::chrono::steady_clock::now();
+	this->enabled = true;
+}
+
+/**
+ * Stop recording events, and write the recorded events to the trace file.
+ * @return Whether the trace file was written successfully; \c true if tracing was not enabled.
+ */
+bool Tracer::Stop()
+{
+	std::lock_guard<std::mutex> guard(this->lock);
+	if (!this->enabled) return true;
+	this->enabled = false;
+
+	bool ok = this->WriteFile();
+	if (ok) {
+		printf("Trace written to %s\n", this->filename.c_str());
+	} else {
+		fprintf(stderr, "Failed to write the trace to %s\n", this->filename.c_str());
+	}
+	this->events.clear();
+	this->events.shrink_to_fit();
+	return ok;
+}
+
+/**
+ * Record an event.
+ * @param name Name of the scope, must be a string literal.
+ * @param phase Phase of the event.
+ */
+void Tracer::Record(const char *name, TracePhase phase)
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const uint32 thread = GetTraceThread();
+
+	std::lock_guard<std::mutex> guard(this->lock);
+	if (!this->enabled) return;
+
+	this->events[this->next_event] = {name, now - this->start, thread, phase};
+	this->next_event++;
+	if (this->next_event == this->events.size()) {
+		this->next_event = 0;
+		this->wrapped = true;
+	}
+}
+
+/**
+ * Write the recorded events to the trace file, in the JSON trace event format.
+ * End events whose begin event was overwritten in the ring buffer are skipped.
+ * @return Whether the file was written successfully.
+ * @pre The lock is held.
+ */
+bool Tracer::WriteFile() const
+{
+	FILE *fp = fopen(this->filename.c_str(), "w");
+	if (fp == nullptr) return false;
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"FreeRCT\"}}");
+
+	std::map<uint32, uint32> depth; // Number of open scopes of each thread.
+	const size_t count = this->wrapped ? this->events.size() : this->next_event;
+	const size_t first = this->wrapped ? this->next_event : 0;
+	for (size_t i = 0; i < count; i++) {
+		const TraceEvent &event = this->events[(first + i) % this->events.size()];
+		uint32 &open = depth[event.thread];
+		if (event.phase == TP_END) {
+			if (open == 0) continue;
+			open--;
+		} else {
+			open++;
+		}
+
+		fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", event.name, static_cast<char>(event.phase),
+				std::chrono::duration<double, std::micro>(event.time).count(), event.thread);
+	}
+	fprintf(fp, "\n]}\n");
+
+	const bool ok = ferror(fp) == 0;
+	fclose(fp);
+	return ok;
+}
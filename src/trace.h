@@ -0,0 +1,91 @@
+/*
+ * This file is part of FreeRCT.
+ * FreeRCT is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * FreeRCT is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with FreeRCT. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file trace.h Recording a timeline of the game for viewing in a trace viewer. */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** Phase of a trace event, as defined by the Chrome trace event format. */
+enum TracePhase {
+	TP_BEGIN = 'B',  ///< Start of a scope.
+	TP_END   = 'E',  ///< End of a scope.
+};
+
+/** A recorded trace event. */
+struct TraceEvent {
+	const char *name;                ///< Name of the scope, must be a string literal.
+	std::chrono::nanoseconds time;   ///< Time of the event since the start of tracing.
+	uint32 thread;                   ///< Thread that recorded the event.
+	TracePhase phase;                ///< Phase of the event.
+};
+
+/**
+ * Records begin and end events of scopes in a ring buffer, and writes them as a Chrome/Perfetto JSON trace file.
+ * Events may be recorded from any thread.
+ */
+class Tracer {
+public:
+	static const uint32 DEFAULT_CAPACITY = 1 << 20; ///< Default number of events kept in the buffer.
+
+	Tracer();
+
+	/**
+	 * Whether events are being recorded.
+	 * @return The tracer is enabled.
+	 */
+	inline bool IsEnabled() const
+	{
+		return this->enabled.load(std::memory_order_relaxed);
+	}
+
+	void Start(const std::string &fname, uint32 capacity);
+	bool Stop();
+	void Record(const char *name, TracePhase phase);
+
+private:
+	bool WriteFile() const;
+
+	std::atomic<bool> enabled;                   ///< Whether events are being recorded.
+	std::mutex lock;                             ///< Lock protecting the buffer.
+	std::string filename;                        ///< File to write the trace to.
+	std::vector<TraceEvent> events;              ///< Ring buffer of recorded events.
+	size_t next_event;                           ///< Index in #events of the next event to record.
+	bool wrapped;                                ///< Whether the oldest events have been overwritten.
+	std::chrono::steady_clock::time_point start; ///< Start of tracing.
+};
+
+extern Tracer _tracer;
+
+/** Records the begin and end of a scope in the trace, if tracing is enabled. */
+class TraceScope {
+public:
+	/**
+	 * Begin a traced scope.
+	 * @param name Name of the scope, must be a string literal.
+	 */
+	explicit TraceScope(const char *name) : name(_tracer.IsEnabled() ? name : nullptr)
+	{
+		if (this->name != nullptr) _tracer.Record(this->name, TP_BEGIN);
+	}
+
+	~TraceScope()
+	{
+		if (this->name != nullptr) _tracer.Record(this->name, TP_END);
+	}
+
+private:
+	const char *name; ///< Name of the scope if it is being traced, else \c nullptr.
+};
+
+#endif
@@ -8,6 +8,7 @@
 /** @file track_piece.cpp Functions of the track pieces. */
 
 #include "stdafx.h"
+#include <cmath>
 #include "sprite_store.h"
 #include "fileio.h"
 #include "gamecontrol.h"
@@ -216,6 +217,24 @@ void TrackPiece::Load(RcdFileReader *rcd_file)
 	length -= this->internal_name.size();
 
 	rcd_file->CheckExactLength(length, 0, "end of block");
+
+	this->BakeSamples();
+}
+
+/** Sample the car curves of the track piece, so cars can be positioned without evaluating the curves. */
+void TrackPiece::BakeSamples()
+{
+	/* One sample beyond the end, so interpolation never needs to check the index. */
+	const uint32 count = (this->piece_length >> TRACK_SAMPLE_SHIFT) + 2;
+	this->samples.resize(count);
+	for (uint32 i = 0; i < count; i++) {
+		const uint32 distance = std::min(i << TRACK_SAMPLE_SHIFT, this->piece_length);
+		TrackSample &sample = this->samples[i];
+		sample.xpos = std::lround(this->car_xpos->GetValue(distance) * 256);
+		sample.ypos = std::lround(this->car_ypos->GetValue(distance) * 256);
+		sample.zpos = std::lround(this->car_zpos->GetValue(distance) * 256);
+		sample.roll = std::lround(this->car_roll->GetValue(distance) * 256);
+	}
 }
 
 /**
@@ -241,6 +260,7 @@ Rectangle16 TrackPiece::GetArea() const
 PositionedTrackPiece::PositionedTrackPiece(const XYZPoint16 &vox_pos, ConstTrackPiecePtr piece)
 {
 	this->base_voxel = vox_pos;
+	this->distance_base = 0;
 	this->piece = piece;
 }
 
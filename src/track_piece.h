@@ -155,12 +155,31 @@ public:
 	std::vector<CubicBezier> curve; ///< Curve describing the track piece.
 };
 
+static const uint TRACK_SAMPLE_SHIFT = 8; ///< Log2 of the distance between two baked track samples, in 1/256 pixel (that is, one sample every pixel).
+
+/** Values of the car curves at one position of a track piece, in 1/256 units. */
+struct TrackSample {
+	int32 xpos; ///< X position of the car.
+	int32 ypos; ///< Y position of the car.
+	int32 zpos; ///< Z position of the car.
+	int32 roll; ///< Roll of the car.
+};
+
+/** Car position and roll at a position of a track piece, interpolated between baked samples (positions in 1/256 voxel). */
+struct TrackPosition {
+	int32 xpos; ///< X position of the car.
+	int32 ypos; ///< Y position of the car.
+	int32 zpos; ///< Z position of the car, at the same scale as the X and Y positions.
+	uint roll;  ///< Roll of the car.
+};
+
 /** One track piece (type) of a roller coaster track. */
 class TrackPiece {
 public:
 	TrackPiece();
 
 	void Load(RcdFileReader *rcd_file);
+	void BakeSamples();
 	Rectangle16 GetArea() const;
 
 	uint8 entry_connect;      ///< Entry connection code
@@ -178,10 +197,35 @@ public:
 	std::unique_ptr<TrackCurve> car_pitch;    ///< Pitch of cars over this track piece, may be \c nullptr.
 	std::unique_ptr<TrackCurve> car_roll;     ///< Roll of cars over this track piece.
 	std::unique_ptr<TrackCurve> car_yaw;      ///< Yaw of cars over this track piece, may be \c null.
+	std::vector<TrackSample> samples;         ///< Car curves sampled every (1 << #TRACK_SAMPLE_SHIFT) distance units, for quick lookup.
 	std::string internal_name;                ///< Internal name of the piece.
 
 	void RemoveFromWorld(uint16 ride_index, XYZPoint16 base_voxel) const;
 
+	/**
+	 * Get the position and roll of a car at the track piece, from the baked samples.
+	 * @param distance Distance of the car at the track piece, in 1/256 pixel.
+	 * @return Position and roll of the car, with the position relative to the base voxel of the piece.
+	 * @pre \a distance must be at most #piece_length.
+	 */
+	inline TrackPosition GetCarPosition(uint32 distance) const
+	{
+		assert(distance <= this->piece_length);
+		const uint32 index = distance >> TRACK_SAMPLE_SHIFT;
+		const int64 frac = distance & ((1 << TRACK_SAMPLE_SHIFT) - 1);
+		const TrackSample &s0 = this->samples[index];
+		const TrackSample &s1 = this->samples[index + 1];
+		const int64 frac0 = (1 << TRACK_SAMPLE_SHIFT) - frac;
+		const uint shift = TRACK_SAMPLE_SHIFT + 8;
+
+		TrackPosition tp;
+		tp.xpos = (s0.xpos * frac0 + s1.xpos * frac) >> shift;
+		tp.ypos = (s0.ypos * frac0 + s1.ypos * frac) >> shift;
+		tp.zpos = (s0.zpos * frac0 + s1.zpos * frac) >> (shift - 1); // A voxel is half as high as it is wide.
+		tp.roll = ((s0.roll * frac0 + s1.roll * frac + (1 << (shift - 1))) >> shift) & 0xf;
+		return tp;
+	}
+
 	/**
 	 * Check whether the track piece is powered.
 	 * @return Whether the track piece enforces a non-zero speed.
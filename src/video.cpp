@@ -11,12 +11,17 @@
 
 #include "video.h"
 #include "gamecontrol.h"
+#include "math_func.h"
 #include "rev.h"
 #include "sprite_data.h"
 #include "sprite_store.h"
 #include "string_func.h"
 #include "window.h"
+#include "profiler.h"
+#include "memory_usage.h"
+#include "trace.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <sstream>
@@ -85,7 +90,22 @@ static uint32 NextCodepointToLoad(uint32 c)
  */
 void TextRenderer::LoadFont(const std::string &font_path, GLuint font_size)
 {
+	this->RasteriseFont(font_path, font_size);
+	this->UploadFont();
+}
+
+/**
+ * Render the glyphs of a font into bitmaps, without uploading them yet. This does not need the OpenGL context,
+ * so it may run on another thread while the window is being created. #UploadFont finishes loading the font.
+ * @param font_path File path of the font file.
+ * @param font_size Size of the font to load.
+ * @param progress [out] If set, receives the fraction of the codepoints rendered so far.
+ */
+void TextRenderer::RasteriseFont(const std::string &font_path, GLuint font_size, std::atomic<float> *progress)
+{
+	TraceScope trace("TextRenderer::RasteriseFont");
 	this->font_size = font_size;
+	this->pending_glyphs.clear();
 
 	FT_Library ft;
 	if (FT_Init_FreeType(&ft)) {
@@ -99,10 +119,10 @@ void TextRenderer::LoadFont(const std::string &font_path, GLuint font_size)
 	FT_Select_Charmap(face, FT_ENCODING_UNICODE);
 
 	FT_Set_Pixel_Sizes(face, 0, font_size);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 	/* Load all characters we may need. */
 	for (uint32 codepoint = 1; codepoint <= MAX_CODEPOINT; codepoint = NextCodepointToLoad(codepoint)) {
+		if (progress != nullptr) *progress = static_cast<float>(codepoint) / MAX_CODEPOINT;
 		if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER) != 0) {
 			this->characters[codepoint].valid = false;
 			char buffer[] = {0, 0, 0, 0, 0};
@@ -111,37 +131,56 @@ void TextRenderer::LoadFont(const std::string &font_path, GLuint font_size)
 			continue;
 		}
 
-		GLuint texture;
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		/* Copy the rows of the bitmap without the padding at their end. */
+		const FT_Bitmap &bitmap = face->glyph->bitmap;
+		PendingGlyph glyph{codepoint, std::vector<uint8>(bitmap.width * bitmap.rows)};
+		for (uint row = 0; row < bitmap.rows; row++) {
+			std::copy_n(bitmap.buffer + row * bitmap.pitch, bitmap.width, glyph.pixels.begin() + row * bitmap.width);
+		}
+		this->pending_glyphs.push_back(std::move(glyph));
+
+		this->characters[codepoint] = {
+			0,
+			Point16(bitmap.width, bitmap.rows),
+			Point16(face->glyph->bitmap_left, face->glyph->bitmap_top),
+			static_cast<GLuint>(face->glyph->advance.x),
+			true
+		};
+	}
+
+	FT_Done_Face(face);
+	FT_Done_FreeType(ft);
+}
+
+/** Create the textures of the glyphs rendered by #RasteriseFont. Must be called with the OpenGL context. */
+void TextRenderer::UploadFont()
+{
+	TraceScope trace("TextRenderer::UploadFont");
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (const PendingGlyph &glyph : this->pending_glyphs) {
+		FontGlyph &character = this->characters[glyph.codepoint];
+		glGenTextures(1, &character.texture_id);
+		glBindTexture(GL_TEXTURE_2D, character.texture_id);
 		glTexImage2D(
 				GL_TEXTURE_2D,
 				0,
 				GL_R8,
-				face->glyph->bitmap.width,
-				face->glyph->bitmap.rows,
+				character.size.x,
+				character.size.y,
 				0,
 				GL_RED,
 				GL_UNSIGNED_BYTE,
-				face->glyph->bitmap.buffer
+				glyph.pixels.data()
 		);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		this->characters[codepoint] = {
-			texture,
-			Point16(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-			Point16(face->glyph->bitmap_left, face->glyph->bitmap_top),
-			static_cast<GLuint>(face->glyph->advance.x),
-			true
-		};
 	}
-
 	glBindTexture(GL_TEXTURE_2D, 0);
-	FT_Done_Face(face);
-	FT_Done_FreeType(ft);
+	this->pending_glyphs.clear();
+	this->pending_glyphs.shrink_to_fit();
+	this->loaded = true;
 
 	/* Check that we have at least a bearing character and a glyph for invalid characters. */
 	std::string sample_text = {BEARING_CHARACTER};
@@ -189,6 +228,22 @@ const TextRenderer::FontGlyph &TextRenderer::GetFontGlyph(const char **text, siz
 	error("The font is missing essential characters\n");
 }
 
+/**
+ * Add the memory used by the textures of the glyphs to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void TextRenderer::AddMemoryUsage(MemoryReport &report) const
+{
+	size_t count = 0;
+	size_t bytes = 0;
+	for (const FontGlyph &glyph : this->characters) {
+		if (!glyph.valid) continue;
+		count++;
+		bytes += glyph.size.x * glyph.size.y;  // Glyphs have one byte per pixel.
+	}
+	report.Add(MO_GLYPH_TEXTURES, count, bytes);
+}
+
 /**
  * Render text to the screen.
  * @param text Text to draw.
@@ -535,11 +590,10 @@ void VideoSystem::Shutdown()
 }
 
 /**
- * Initialize the graphics system.
- * @param font Font file to load.
- * @param font_size Size in which to load the font.
+ * Initialize the graphics system. The font is loaded separately, see TextRenderer::RasteriseFont and TextRenderer::UploadFont.
+ * Input is not handled until #EnableInput is called.
  */
-void VideoSystem::Initialize(const std::string &font, int font_size)
+void VideoSystem::Initialize()
 {
 	if (!glfwInit()) error("Failed to initialize GLFW\n");
 
@@ -571,11 +625,6 @@ void VideoSystem::Initialize(const std::string &font, int font_size)
 #ifndef WEBASSEMBLY
 	glfwSetInputMode(this->window, GLFW_STICKY_KEYS, GL_TRUE);
 #endif
-	glfwSetCursorPosCallback(this->window, MouseMoveCallback);
-	glfwSetScrollCallback(this->window, ScrollCallback);
-	glfwSetMouseButtonCallback(this->window, MouseClickCallback);
-	glfwSetKeyCallback(this->window, KeyCallback);
-	glfwSetCharCallback(this->window, TextCallback);
 	GLFWimage img{WINDOW_ICON_WIDTH, WINDOW_ICON_HEIGHT, _icon_data.get()};
 	glfwSetWindowIcon(this->window, 1, &img);
 
@@ -604,7 +653,6 @@ void VideoSystem::Initialize(const std::string &font, int font_size)
 
 	/* Initialize the text renderer. */
 	_text_renderer.Initialize();
-	_text_renderer.LoadFont(font, font_size);
 
 	/* Initialize remaining data structures. */
 	this->last_frame = std::chrono::high_resolution_clock::now();
@@ -612,6 +660,43 @@ void VideoSystem::Initialize(const std::string &font, int font_size)
 	this->average_frametime = 1;
 }
 
+/**
+ * Start handling mouse and keyboard input. The input handlers expect the windows of the game to exist,
+ * so this is done only when the game has been loaded.
+ */
+void VideoSystem::EnableInput()
+{
+	glfwSetCursorPosCallback(this->window, MouseMoveCallback);
+	glfwSetScrollCallback(this->window, ScrollCallback);
+	glfwSetMouseButtonCallback(this->window, MouseClickCallback);
+	glfwSetKeyCallback(this->window, KeyCallback);
+	glfwSetCharCallback(this->window, TextCallback);
+}
+
+/**
+ * Draw a progress bar while the game is being loaded.
+ * @param progress Fraction of the loading done, between \c 0 and \c 1.
+ */
+void VideoSystem::ShowLoadingProgress(float progress)
+{
+	TraceScope trace("VideoSystem::ShowLoadingProgress");
+	glfwPollEvents();
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	const int bar_width = this->width / 2;
+	const int bar_height = 20;
+	Rectangle32 bar((this->width - bar_width) / 2, (this->height - bar_height) / 2, bar_width, bar_height);
+	this->DrawRectangle(bar, _palette[TEXT_WHITE]);
+	this->FillRectangle(Rectangle32(bar.base.x, bar.base.y, bar_width * Clamp(progress, 0.0f, 1.0f), bar_height), _palette[TEXT_WHITE]);
+
+	/* The font may not be loaded yet, and the language certainly is not, so only a number is shown. */
+	if (_text_renderer.IsLoaded()) {
+		this->BlitText(Format("%d%%", static_cast<int>(progress * 100)), _palette[TEXT_WHITE],
+				bar.base.x, bar.base.y + bar_height + 4, bar_width, ALG_CENTER);
+	}
+	this->FinishRepaint();
+}
+
 /** Run the main loop. */
 void VideoSystem::MainLoop()
 {
@@ -630,7 +715,7 @@ void VideoSystem::MainLoop()
  */
 bool VideoSystem::MainLoopDoCycle()
 {
-	constexpr uint32 FRAME_DELAY = 30;        ///< Minimum number of milliseconds between two frames.
+	TraceScope trace("MainLoopDoCycle");
 	constexpr double AVERAGE_FPS_STEPS = 15;  ///< Number of frame iterations in the average framerate computation.
 	this->last_frame = this->cur_frame;
 	this->cur_frame = std::chrono::high_resolution_clock::now();
@@ -651,9 +736,14 @@ bool VideoSystem::MainLoopDoCycle()
 	_game_control.DoNextAction();
 	if (!_game_control.running || glfwWindowShouldClose(this->window)) return false;
 
-	/* Cap the FPS rate. */
+	_profiler.EndFrame(std::chrono::high_resolution_clock::now() - this->cur_frame);
+
+	/* Cap the FPS rate, unless the game should run as fast as possible. */
 	double time = Delta(this->cur_frame);
-	if (time < FRAME_DELAY) std::this_thread::sleep_for(Duration(FRAME_DELAY - time));
+	if (time < FRAME_DELAY && _game_control.speed != GSP_TURBO) {
+		TraceScope trace_sleep("FrameDelay");
+		std::this_thread::sleep_for(Duration(FRAME_DELAY - time));
+	}
 
 	return true;
 }
@@ -661,6 +751,7 @@ bool VideoSystem::MainLoopDoCycle()
 /** Finish repainting, perform the final steps. */
 void VideoSystem::FinishRepaint()
 {
+	TraceScope trace("VideoSystem::FinishRepaint");
 	glfwSwapBuffers(this->window);
 }
 
@@ -865,6 +956,17 @@ GLuint VideoSystem::LoadShaders(const char *vp, const char *fp)
 	return program_id;
 }
 
+/**
+ * Add the memory used by the textures of the images to a memory report.
+ * @param report [inout] Report to add to.
+ */
+void VideoSystem::AddMemoryUsage(MemoryReport &report) const
+{
+	size_t bytes = 0;
+	for (const auto &entry : this->image_textures) bytes += entry.first.first->width * entry.first.first->height * 4;
+	report.Add(MO_SPRITE_TEXTURES, this->image_textures.size(), bytes);
+}
+
 /**
  * Create a texture for the given image if one did not exist yet.
  * @param img Image to load.
@@ -877,6 +979,7 @@ GLuint VideoSystem::GetImageTexture(const ImageData *img, const Recolouring &rec
 	const auto it = this->image_textures.find(map_key);
 	if (it != this->image_textures.end()) return it->second;
 
+	TraceScope trace("VideoSystem::GetImageTexture");
 	GLuint t = 0;
 	glGenTextures(1, &t);
 	glBindTexture(GL_TEXTURE_2D, t);
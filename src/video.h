@@ -16,15 +16,18 @@
 #include "time_func.h"
 #include "window_constants.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <GLFW/glfw3.h>
 
 struct FontGlyph;
 class ImageData;
+class MemoryReport;
 
 /** Class responsible for rendering text. */
 class TextRenderer {
@@ -33,11 +36,23 @@ public:
 
 	void Initialize();
 	void LoadFont(const std::string &font_path, GLuint font_size);
+	void RasteriseFont(const std::string &font_path, GLuint font_size, std::atomic<float> *progress = nullptr);
+	void UploadFont();
+
+	/**
+	 * Whether a font has been loaded, and text can be rendered.
+	 * @return A font is available.
+	 */
+	bool IsLoaded() const
+	{
+		return this->loaded;
+	}
 
 	GLuint GetTextHeight() const;
 	PointF EstimateBounds(const std::string &text, bool add_padding = true, float scale = 1.0f) const;
 
 	void Draw(const std::string &text, float x, float y, float max_width, uint32 colour, float scale = 1.0f);
+	void AddMemoryUsage(MemoryReport &report) const;
 
 private:
 	/** Helper struct representing a font glyph. */
@@ -49,10 +64,18 @@ private:
 		bool valid = false;  ///< If \c false, all data in this struct is invalid.
 	};
 
+	/** Bitmap of a glyph that has been rendered, but not uploaded to a texture yet. */
+	struct PendingGlyph {
+		uint32 codepoint;          ///< Codepoint of the glyph.
+		std::vector<uint8> pixels; ///< Grey values of the glyph, one byte per pixel, row by row.
+	};
+
 	const FontGlyph &GetFontGlyph(const char **text, size_t &length) const;
 
 	FontGlyph characters[MAX_CODEPOINT + 1];  ///< All character glyphs in the current font indexed by their unicode codepoint.
+	std::vector<PendingGlyph> pending_glyphs; ///< Glyphs waiting for #UploadFont.
 	GLuint font_size;                         ///< Current font size.
+	bool loaded = false;                      ///< Whether the textures of the font have been created.
 	GLuint shader;                            ///< The font shader.
 	GLuint vao;                               ///< The OpenGL vertex array.
 	GLuint vbo;                               ///< The OpenGL vertex buffer.
@@ -70,7 +93,9 @@ enum Alignment {
 /** Class providing the interface to the OpenGL rendering backend. */
 class VideoSystem {
 public:
-	void Initialize(const std::string &font, int font_size);
+	void Initialize();
+	void EnableInput();
+	void ShowLoadingProgress(float progress);
 
 	static void MainLoopCycle();
 	void MainLoop();
@@ -208,6 +233,8 @@ public:
 
 	void FinishRepaint();
 
+	void AddMemoryUsage(MemoryReport &report) const;
+
 private:
 	bool MainLoopDoCycle();
 
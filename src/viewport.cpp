@@ -25,9 +25,15 @@
 #include "weather.h"
 #include "fence.h"
 #include "gamecontrol.h"
+#include "command.h"
 #include "scenery.h"
+#include "coaster.h"
+#include "profiler.h"
+#include "memory_usage.h"
+#include "trace.h"
 
-#include <set>
+#include <algorithm>
+#include <vector>
 
 /**
  * \page the_world_page World
@@ -56,197 +62,6 @@
  * #SRI_SAME_AS_SOUTH ride instance numbers for the other corners.
  */
 
-/**
- * Convert 3D position to the horizontal 2D position.
- * @param x X position in the game world.
- * @param y Y position in the game world.
- * @param orient Orientation.
- * @param width Tile width in pixels.
- * @return X position in 2D.
- */
-static inline int32 ComputeXFunction(int32 x, int32 y, ViewOrientation orient, uint16 width)
-{
-	switch (orient) {
-		case VOR_NORTH: return ((y - x)  * width / 2) >> 8;
-		case VOR_WEST:  return (-(x + y) * width / 2) >> 8;
-		case VOR_SOUTH: return ((x - y)  * width / 2) >> 8;
-		case VOR_EAST:  return ((x + y)  * width / 2) >> 8;
-		default: NOT_REACHED();
-	}
-}
-
-/**
- * Convert 3D position to the vertical 2D position.
- * @param x X position in the game world.
- * @param y Y position in the game world.
- * @param z Z position in the game world.
- * @param orient Orientation.
- * @param width Tile width in pixels.
- * @param height Tile height in pixels.
- * @return Y position in 2D.
- */
-static inline int32 ComputeYFunction(int32 x, int32 y, int32 z, ViewOrientation orient, uint16 width, uint16 height)
-{
-	switch (orient) {
-		case VOR_NORTH: return ((x + y)  * width / 4 - z * height) >> 8;
-		case VOR_WEST:  return ((y - x)  * width / 4 - z * height) >> 8;
-		case VOR_SOUTH: return (-(x + y) * width / 4 - z * height) >> 8;
-		case VOR_EAST:  return ((x - y)  * width / 4 - z * height) >> 8;
-		default: NOT_REACHED();
-	}
-}
-
-/**
- * Search the world for voxels to render.
- * @ingroup viewport_group
- */
-class VoxelCollector {
-public:
-	VoxelCollector(Viewport *vp);
-	virtual ~VoxelCollector();
-
-	void SetWindowSize(int16 xpos, int16 ypos, uint16 width, uint16 height);
-
-	void Collect();
-	void SetSelector(MouseModeSelector *selector);
-
-	/**
-	 * Convert 3D position to the horizontal 2D position.
-	 * @param x X position in the game world.
-	 * @param y Y position in the game world.
-	 * @return X position in 2D.
-	 */
-	inline int32 ComputeX(int32 x, int32 y)
-	{
-		return ComputeXFunction(x, y, this->orient, TileWidth(this->zoom));
-	}
-
-	/**
-	 * Convert 3D position to the vertical 2D position.
-	 * @param x X position in the game world.
-	 * @param y Y position in the game world.
-	 * @param z Z position in the game world.
-	 * @return Y position in 2D.
-	 */
-	inline int32 ComputeY(int32 x, int32 y, int32 z)
-	{
-		return ComputeYFunction(x, y, z, this->orient, TileWidth(this->zoom), TileHeight(this->zoom));
-	}
-
-	XYZPoint32 view_pos;          ///< Position of the centre point of the display.
-	int zoom;                    ///< The current zoom scale (an index in #_zoom_scales).
-	ViewOrientation orient;       ///< Direction of view.
-	Viewport *vp;                 ///< Parent viewport for accessing the cursors if not \c nullptr.
-	MouseModeSelector *selector;  ///< Mouse mode selector.
-
-	Rectangle32 rect; ///< Screen area of interest.
-
-protected:
-	/**
-	 * Decide where supports should be raised.
-	 * @param stack %Voxel stack to examine.
-	 * @param xpos X position of the voxel stack.
-	 * @param ypos Y position of the voxel stack.
-	 */
-	virtual void SetupSupports([[maybe_unused]] const VoxelStack *stack, [[maybe_unused]] uint xpos, [[maybe_unused]] uint ypos)
-	{
-	}
-
-	/**
-	 * Handle a voxel that should be collected.
-	 * @param vx %Voxel to add, \c nullptr means 'cursor above stack'.
-	 * @param view_pos World position.
-	 * @param xnorth X coordinate of the north corner at the display.
-	 * @param ynorth y coordinate of the north corner at the display.
-	 * @note Implement in a derived class.
-	 */
-	virtual void CollectVoxel(const Voxel *vx, const XYZPoint16 &view_pos, int32 xnorth, int32 ynorth) = 0;
-};
-
-/**
- * Data temporary needed for ordering sprites and blitting them to the screen.
- * @ingroup viewport_group
- */
-struct DrawData {
-	/**
-	 * Setter method to initialize the other fields.
-	 * @param level Slice of this sprite (vertical row).
-	 * @param z_height Height of the voxel being drawn.
-	 * @param order Selection when to draw this sprite (sorts sprites within a voxel). @see SpriteOrder
-	 * @param sprite Mouse cursor to draw.
-	 * @param base Base coordinate of the image, relative to top-left of the window.
-	 * @param recolour Recolouring of the sprite.
-	 * @param gs Gradient shift of the sprite.
-	 */
-	inline void Set(int32 level, uint16 z_height, SpriteOrder order, const ImageData *sprite, const Point32 &base,
-			const Recolouring *recolour = nullptr, GradientShift gs = GS_INVALID)
-	{
-		this->level = level;
-		this->z_height = z_height;
-		this->order = order;
-		this->sprite = sprite;
-		this->base = base;
-		this->recolour = recolour;
-		this->gs = gs;
-		assert(this->sprite != nullptr);
-	}
-
-	const ImageData *sprite;     ///< Mouse cursor to draw.
-	const Recolouring *recolour; ///< Recolouring of the sprite.
-	int32 level;                 ///< Slice of this sprite (vertical row).
-	SpriteOrder order;           ///< Selection when to draw this sprite (sorts sprites within a voxel). @see SpriteOrder
-	Point32 base;                ///< Base coordinate of the image, relative to top-left of the window.
-	uint16 z_height;             ///< Height of the voxel being drawn.
-	GradientShift gs;            ///< Gradient shift of the sprite.
-};
-
-/**
- * Sort predicate of the draw data.
- * @param dd1 First value to compare.
- * @param dd2 Second value to compare.
- * @return \c true if \a dd1 should be drawn before \a dd2.
- */
-inline bool operator<(const DrawData &dd1, const DrawData &dd2)
-{
-	if (dd1.level != dd2.level) return dd1.level < dd2.level; // Order on slice first.
-	if (dd1.z_height != dd2.z_height) return dd1.z_height < dd2.z_height; // Lower in the same slice first.
-	if (dd1.order != dd2.order) return dd1.order < dd2.order; // Type of sprite.
-	return dd1.base.y < dd2.base.y;
-}
-
-/**
- * Collection of sprites to render to the screen.
- * @ingroup viewport_group
- */
-typedef std::multiset<DrawData> DrawImages;
-
-/**
- * Collect sprites to draw in a viewport.
- * @ingroup viewport_group
- */
-class SpriteCollector : public VoxelCollector {
-public:
-	SpriteCollector(Viewport *vp);
-	~SpriteCollector();
-
-	void SetXYOffset(int16 xoffset, int16 yoffset);
-
-	DrawImages draw_images; ///< Sprites to draw ordered by viewing distance.
-	int16 xoffset; ///< Horizontal offset of the top-left coordinate to the top-left of the display.
-	int16 yoffset; ///< Vertical offset of the top-left coordinate to the top-left of the display.
-
-protected:
-	void CollectVoxel(const Voxel *vx, const XYZPoint16 &voxel_pos, int32 xnorth, int32 ynorth) override;
-	void SetupSupports(const VoxelStack *stack, uint xpos, uint ypos) override;
-	const ImageData *GetCursorSpriteAtPos(CursorType ctype, const XYZPoint16 &voxel_pos, uint8 tslope);
-
-	/** For each orientation the location of the real northern corner of a tile relative to the northern displayed corner. */
-	Point16 north_offsets[4];
-
-	uint16 ground_height; ///< The height of the ground in the current voxel stack. \c -1 means no valid ground found.
-	uint8 ground_slope;   ///< Imploded ground slope if #ground_height is valid.
-};
-
 /**
  * Find the sprite and pixel under the mouse cursor.
  * @ingroup viewport_group
@@ -506,7 +321,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 		dd.Set(slice, voxel_pos.z, SO_PATH, _sprite_manager.GetSprite(this->zoom, &SpriteStorage::GetPathSprite,
 				GetPathType(instance_data), GetPathStatus(instance_data), GetImplodedPathSlope(instance_data), this->orient),
 				north_point, nullptr, highlight ? GS_SEMI_TRANSPARENT : GS_INVALID);
-		this->draw_images.insert(dd);
+		this->draw_images.push_back(dd);
 
 		for (const PathObjectInstance::PathObjectSprite &image : _scenery.DrawPathObjects(voxel_pos, this->orient, this->zoom)) {
 			const int x_off = ComputeX(image.offset.x, image.offset.y);
@@ -516,7 +331,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 
 			dd.Set(slice, voxel_pos.z, SO_PATH_OBJECTS, image.sprite, pos, nullptr,
 					image.semi_transparent ? GS_SEMI_TRANSPARENT : this->vp->GetDisplayFlag(DF_WIREFRAME_SCENERY) ? GS_WIREFRAME : GS_INVALID);
-			this->draw_images.insert(dd);
+			this->draw_images.push_back(dd);
 		}
 	} else if (sri >= SRI_FULL_RIDES || sri == SRI_SCENERY) { // A normal ride, or a scenery item.
 		DrawData dd[4];
@@ -528,13 +343,13 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 					(this->vp->GetDisplayFlag(DF_WIREFRAME_SCENERY) && sri == SRI_SCENERY)) {
 				dd[i].gs = GS_WIREFRAME;
 			}
-			this->draw_images.insert(dd[i]);
+			this->draw_images.push_back(dd[i]);
 		}
 	}
 	if (background_sprite != nullptr) {
 		DrawData dd;
 		dd.Set(slice, voxel_pos.z, SO_CURSOR, background_sprite, north_point);
-		this->draw_images.insert(dd);
+		this->draw_images.push_back(dd);
 	}
 
 	/* Foundations. */
@@ -553,7 +368,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			if (img != nullptr) {
 				DrawData dd;
 				dd.Set(slice, voxel_pos.z, SO_FOUNDATION, img, north_point);
-				this->draw_images.insert(dd);
+				this->draw_images.push_back(dd);
 			}
 		}
 		if (se != 0) {
@@ -561,7 +376,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			if (img != nullptr) {
 				DrawData dd;
 				dd.Set(slice, voxel_pos.z, SO_FOUNDATION, img, north_point);
-				this->draw_images.insert(dd);
+				this->draw_images.push_back(dd);
 			}
 		}
 	}
@@ -573,12 +388,12 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 		uint8 type = (this->vp->GetDisplayFlag(DF_UNDERGROUND_MODE)) ? GTP_UNDERGROUND : voxel->GetGroundType();
 		DrawData dd;
 		dd.Set(slice, voxel_pos.z, SO_GROUND, _sprite_manager.GetSprite(this->zoom, &SpriteStorage::GetSurfaceSprite, type, slope, this->orient), north_point);
-		this->draw_images.insert(dd);
+		this->draw_images.push_back(dd);
 
 		if (this->vp->GetDisplayFlag(DF_GRID)) {
 			dd.Set(slice, voxel_pos.z, SO_GROUND, _sprite_manager.GetSprite(this->zoom, &SpriteStorage::GetCursorSprite, slope, this->orient),
 					north_point, nullptr, GS_SEMI_TRANSPARENT);
-			this->draw_images.insert(dd);
+			this->draw_images.push_back(dd);
 		}
 
 		switch (slope) {
@@ -623,7 +438,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 						_sprite_manager.GetSprite(this->zoom, &SpriteStorage::GetFenceSprite, fence_type, edge, gslope, this->orient), north_point);
 				if (IsImplodedSteepSlope(gslope) && !IsImplodedSteepSlopeTop(gslope)) dd.z_height++;
 				if (GB(fences, 16 + edge, 1) != 0) dd.gs = GS_SEMI_TRANSPARENT;
-				this->draw_images.insert(dd);
+				this->draw_images.push_back(dd);
 			}
 		}
 	}
@@ -637,7 +452,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 				DrawData dd;
 				dd.Set(slice, voxel_pos.z, SO_CURSOR, mspr, north_point);
 				if (ctype >= CUR_TYPE_EDGE_NE && ctype <= CUR_TYPE_EDGE_NW && IsImplodedSteepSlope(gslope) && !IsImplodedSteepSlopeTop(gslope)) dd.z_height++;
-				this->draw_images.insert(dd);
+				this->draw_images.push_back(dd);
 			}
 		}
 	}
@@ -656,7 +471,7 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 		if (pl_spr != nullptr) {
 			DrawData dd;
 			dd.Set(slice, voxel_pos.z, SO_PLATFORM, pl_spr, north_point);
-			this->draw_images.insert(dd);
+			this->draw_images.push_back(dd);
 		}
 
 		/* XXX Use the shape to draw handle bars. */
@@ -690,39 +505,93 @@ void SpriteCollector::CollectVoxel(const Voxel *voxel, const XYZPoint16 &voxel_p
 			if (img != nullptr) {
 				DrawData dd;
 				dd.Set(slice, height, SO_SUPPORT, img, Point32(north_point.x, north_point.y + yoffset));
-				this->draw_images.insert(dd);
+				this->draw_images.push_back(dd);
 			}
 		}
 	}
 
 	/* Add voxel objects (persons, ride cars, etc). */
 	/* Sprites on the bottom part of a steep slope need to be drawn at a higher Z layer to prevent the top slope part obscuring them. */
-	const VoxelObject *vo = (voxel == nullptr) ? nullptr : voxel->voxel_objects;
 	const uint32 people_z_pos = (voxel == nullptr || voxel->GetGroundType() == GTP_INVALID ||
 			!IsImplodedSteepSlope(voxel->GetGroundSlope()) || IsImplodedSteepSlopeTop(voxel->GetGroundSlope())) ? voxel_pos.z : (voxel_pos.z + 1);
-	while (vo != nullptr) {
-		const Recolouring *recolour;
-		const ImageData *anim_spr = vo->GetSprite(this->orient, this->zoom, &recolour);
-		if (anim_spr != nullptr && (!this->vp->GetDisplayFlag(DF_HIDE_PEOPLE) || dynamic_cast<const Person*>(vo) == nullptr)) {
-			int x_off = ComputeX(vo->pix_pos.x, vo->pix_pos.y);
-			int y_off = ComputeY(vo->pix_pos.x, vo->pix_pos.y, vo->pix_pos.z);
-			Point32 pos(north_point.x + this->north_offsets[this->orient].x + x_off,
-			            north_point.y + this->north_offsets[this->orient].y + y_off);
+	if (voxel != nullptr) {
+		for (const VoxelObject *vo = voxel->voxel_objects; vo != nullptr; vo = vo->next_object) {
+			this->CollectVoxelObject(vo, slice, people_z_pos, north_point);
+		}
+	}
+	if (voxel != nullptr && voxel->GetInstance() >= SRI_FULL_RIDES) {
+		this->CollectCoasterCars(voxel->GetInstance(), slice, people_z_pos, voxel_pos, north_point);
+	}
+}
 
-			DrawData dd;
-			dd.Set(slice, people_z_pos, SO_PERSON, anim_spr, pos, recolour);
-			this->draw_images.insert(dd);
-
-			if (!this->vp->GetDisplayFlag(DF_HIDE_PEOPLE)) {
-				for (const VoxelObject::Overlay &overlay : vo->GetOverlays(this->orient, this->zoom)) {
-					if (overlay.sprite != nullptr) {
-						dd.Set(slice, people_z_pos, SO_PERSON_OVERLAY, overlay.sprite, pos, overlay.recolour);
-						this->draw_images.insert(dd);
-					}
+/**
+ * Add the sprites of the cars of a coaster at a track voxel to the collected sprites.
+ * Cars are not in the voxel object lists, but they are always at a track voxel of their coaster. The cars of a coaster
+ * are looked up once, when the first of its track voxels is drawn, so coasters outside the viewport cost nothing.
+ * @param ride_number Ride using the voxel.
+ * @param slice Slice of the voxel.
+ * @param z_pos Z layer to draw the cars at.
+ * @param voxel_pos Position of the voxel.
+ * @param north_point Screen position of the northern corner of the voxel.
+ */
+void SpriteCollector::CollectCoasterCars(uint16 ride_number, int32 slice, uint32 z_pos, const XYZPoint16 &voxel_pos, const Point32 &north_point)
+{
+	auto voxel_less = [](const RideCar &a, const RideCar &b) { return a.first < b.first; };
+
+	if (std::find(this->car_coasters.begin(), this->car_coasters.end(), ride_number) == this->car_coasters.end()) {
+		this->car_coasters.push_back(ride_number);
+		const RideInstance *ri = _rides_manager.GetRideInstance(ride_number);
+		if (ri == nullptr || ri->GetKind() != RTK_COASTER) return;
+
+		const size_t old_size = this->ride_cars.size();
+		for (const CoasterTrain &train : static_cast<const CoasterInstance *>(ri)->trains) {
+			for (const CoasterCar &car : train.cars) {
+				for (const DisplayCoasterCar *dcc : {&car.back, &car.front}) {
+					if (dcc->yaw != 0xff) this->ride_cars.emplace_back(dcc->vox_pos, dcc);
 				}
 			}
 		}
-		vo = vo->next_object;
+		if (this->ride_cars.size() == old_size) return;
+		/* Stable sorting keeps the cars of a voxel in train order. */
+		std::stable_sort(this->ride_cars.begin() + old_size, this->ride_cars.end(), voxel_less);
+		std::inplace_merge(this->ride_cars.begin(), this->ride_cars.begin() + old_size, this->ride_cars.end(), voxel_less);
+	}
+
+	const auto cars = std::equal_range(this->ride_cars.begin(), this->ride_cars.end(), RideCar(voxel_pos, nullptr), voxel_less);
+	for (auto iter = cars.first; iter != cars.second; ++iter) {
+		this->CollectVoxelObject(iter->second, slice, z_pos, north_point);
+	}
+}
+
+/**
+ * Add the sprites of a voxel object to the collected sprites.
+ * @param vo Object to draw.
+ * @param slice Slice of the voxel containing the object.
+ * @param z_pos Z layer to draw the object at.
+ * @param north_point Screen position of the northern corner of the voxel.
+ */
+void SpriteCollector::CollectVoxelObject(const VoxelObject *vo, int32 slice, uint32 z_pos, const Point32 &north_point)
+{
+	const Recolouring *recolour;
+	const ImageData *anim_spr = vo->GetSprite(this->orient, this->zoom, &recolour);
+	if (anim_spr == nullptr || (this->vp->GetDisplayFlag(DF_HIDE_PEOPLE) && dynamic_cast<const Person*>(vo) != nullptr)) return;
+
+	int x_off = ComputeX(vo->pix_pos.x, vo->pix_pos.y);
+	int y_off = ComputeY(vo->pix_pos.x, vo->pix_pos.y, vo->pix_pos.z);
+	Point32 pos(north_point.x + this->north_offsets[this->orient].x + x_off,
+	            north_point.y + this->north_offsets[this->orient].y + y_off);
+
+	DrawData dd;
+	dd.Set(slice, z_pos, SO_PERSON, anim_spr, pos, recolour);
+	this->draw_images.push_back(dd);
+
+	if (!this->vp->GetDisplayFlag(DF_HIDE_PEOPLE)) {
+		for (const VoxelObject::Overlay &overlay : vo->GetOverlays(this->orient, this->zoom)) {
+			if (overlay.sprite != nullptr) {
+				dd.Set(slice, z_pos, SO_PERSON_OVERLAY, overlay.sprite, pos, overlay.recolour);
+				this->draw_images.push_back(dd);
+			}
+		}
 	}
 }
 
@@ -981,6 +850,17 @@ void Viewport::AddFloatawayMoneyAmount(const Money &money, const XYZPoint16 &vox
 			money < 0 ? 0x00ff0000 : 0xff000000);
 }
 
+/**
+ * Show a money amount floating away from a voxel in the main display, if there is one.
+ * @param money Amount of money to show.
+ * @param voxel Voxel of the action that cost the money.
+ */
+void AddFloatawayMoneyAmount(const Money &money, const XYZPoint16 &voxel)
+{
+	Viewport *vp = _window_manager.GetViewport();
+	if (vp != nullptr) vp->AddFloatawayMoneyAmount(money, voxel);
+}
+
 /**
  * Get relative X position of a point in the world (used for marking window parts dirty).
  * @param xpos X world position.
@@ -1029,36 +909,50 @@ void Viewport::OnDraw(MouseModeSelector *selector)
 	SpriteCollector collector(this);
 	collector.SetWindowSize(-static_cast<int>(this->rect.width / 2), -static_cast<int>(this->rect.height / 2), this->rect.width, this->rect.height);
 	collector.SetSelector(selector);
-	collector.Collect();
+	{
+		ProfileScope profile(PFS_SPRITE_COLLECT);
+		TraceScope trace("Viewport::Collect");
+		collector.Collect();
+	}
+	{
+		/* Stable sorting keeps sprites at equal distance in the order of collecting. */
+		ProfileScope profile(PFS_SPRITE_SORT);
+		TraceScope trace("Viewport::Sort");
+		std::stable_sort(collector.draw_images.begin(), collector.draw_images.end());
+	}
 
 	_video.FillRectangle(this->rect, MakeRGBA(0, 0, 0, OPAQUE)); // Black background.
 
 	assert(this->rect.base.x >= 0 && this->rect.base.y >= 0);
 	_video.PushClip(this->rect);
 
-	GradientShift gs = static_cast<GradientShift>(GS_LIGHT - _weather.GetWeatherType());
-	for (const DrawData &dd : collector.draw_images) {
-		const Recolouring &rec = (dd.recolour == nullptr) ? _no_recolour : *dd.recolour;
-		_video.BlitImage(dd.base, dd.sprite, rec, dd.gs != GS_INVALID ? dd.gs : gs);
-
-		/* Draw height markers if applicable. */
-		GuiTextColours marker_colour;
-		if (this->GetDisplayFlag(DF_HEIGHT_MARKERS_RIDES) && dd.order == SO_RIDE) {
-			marker_colour = HEIGHT_MARKER_RIDES;
-		} else if (this->GetDisplayFlag(DF_HEIGHT_MARKERS_PATHS) && dd.order == SO_PATH) {
-			marker_colour = HEIGHT_MARKER_PATHS;
-		} else if (this->GetDisplayFlag(DF_HEIGHT_MARKERS_TERRAIN) && dd.order == SO_GROUND) {
-			marker_colour = HEIGHT_MARKER_TERRAIN;
-		} else {
-			continue;
-		}
+	{
+		ProfileScope profile(PFS_SPRITE_BLIT);
+		TraceScope trace("Viewport::Blit");
+		GradientShift gs = static_cast<GradientShift>(GS_LIGHT - _weather.GetWeatherType());
+		for (const DrawData &dd : collector.draw_images) {
+			const Recolouring &rec = (dd.recolour == nullptr) ? _no_recolour : *dd.recolour;
+			_video.BlitImage(dd.base, dd.sprite, rec, dd.gs != GS_INVALID ? dd.gs : gs);
+
+			/* Draw height markers if applicable. */
+			GuiTextColours marker_colour;
+			if (this->GetDisplayFlag(DF_HEIGHT_MARKERS_RIDES) && dd.order == SO_RIDE) {
+				marker_colour = HEIGHT_MARKER_RIDES;
+			} else if (this->GetDisplayFlag(DF_HEIGHT_MARKERS_PATHS) && dd.order == SO_PATH) {
+				marker_colour = HEIGHT_MARKER_PATHS;
+			} else if (this->GetDisplayFlag(DF_HEIGHT_MARKERS_TERRAIN) && dd.order == SO_GROUND) {
+				marker_colour = HEIGHT_MARKER_TERRAIN;
+			} else {
+				continue;
+			}
 
-		std::string text = std::to_string(dd.z_height);
-		int w, h;
-		_video.GetTextSize(text, &w, &h);
-		Rectangle32 r(dd.base.x + dd.sprite->xoffset + (dd.sprite->width - w) / 2, dd.base.y + dd.sprite->yoffset + (dd.sprite->height - h) / 2, w, h);
-		_video.FillRectangle(r, SetA(_palette[marker_colour], OPACITY_SEMI_TRANSPARENT));
-		_video.BlitText(text, _palette[TEXT_BLACK], r.base.x, r.base.y, r.width, ALG_CENTER);
+			std::string text = std::to_string(dd.z_height);
+			int w, h;
+			_video.GetTextSize(text, &w, &h);
+			Rectangle32 r(dd.base.x + dd.sprite->xoffset + (dd.sprite->width - w) / 2, dd.base.y + dd.sprite->yoffset + (dd.sprite->height - h) / 2, w, h);
+			_video.FillRectangle(r, SetA(_palette[marker_colour], OPACITY_SEMI_TRANSPARENT));
+			_video.BlitText(text, _palette[TEXT_BLACK], r.base.x, r.base.y, r.width, ALG_CENTER);
+		}
 	}
 
 	for (uint i = 0; i < this->floataway_texts.size();) {
@@ -1083,10 +977,65 @@ void Viewport::OnDraw(MouseModeSelector *selector)
 		_video.BlitText(Format("FPS: %2.1f (avg. %2.1f)", _video.FPS(), _video.AvgFPS()),
 				_palette[TEXT_WHITE], SPACING, SPACING, _video.Width() - 2 * SPACING, ALG_RIGHT);
 	}
+	if (this->GetDisplayFlag(DF_PROFILER)) this->DrawProfiler();
+	if (this->GetDisplayFlag(DF_MEMORY_REPORT)) this->DrawMemoryReport();
 
 	_video.PopClip();
 }
 
+/**
+ * Draw lines of text on a semi-transparent panel, for the developer overlays of the viewport.
+ * @param lines Lines of text to draw.
+ * @param x Left edge of the panel.
+ * @param y Top edge of the panel, or its bottom edge if \a at_bottom is set.
+ * @param at_bottom Whether \a y is the bottom edge of the panel.
+ */
+static void DrawOverlayPanel(const std::vector<std::string> &lines, int32 x, int32 y, bool at_bottom)
+{
+	constexpr const int SPACING = 4;
+	int width = 0;
+	int line_height = 0;
+	for (const std::string &line : lines) {
+		int w, h;
+		_video.GetTextSize(line, &w, &h);
+		width = std::max(width, w);
+		line_height = std::max(line_height, h);
+	}
+
+	const int height = lines.size() * line_height + 2 * SPACING;
+	Rectangle32 panel(x, at_bottom ? y - height : y, width + 2 * SPACING, height);
+	_video.FillRectangle(panel, SetA(_palette[TEXT_BLACK], OPACITY_SEMI_TRANSPARENT));
+	int line_y = panel.base.y + SPACING;
+	for (const std::string &line : lines) {
+		_video.BlitText(line, _palette[TEXT_WHITE], panel.base.x + SPACING, line_y);
+		line_y += line_height;
+	}
+}
+
+/** Draw the measurements of the profiler in the top-left corner of the viewport. */
+void Viewport::DrawProfiler() const
+{
+	/* Like the FPS counter, the profiler is only interesting for developers. */
+	std::vector<std::string> lines;
+	for (int s = 0; s < PFS_COUNT; s++) {
+		const ProfileStatistics stats = _profiler.GetStatistics(static_cast<ProfileSection>(s));
+		lines.push_back(Format("%-10s %7.3f avg %7.3f max", Profiler::GetSectionName(static_cast<ProfileSection>(s)), stats.average, stats.maximum));
+	}
+	const ProfileStatistics frame = _profiler.GetFrameStatistics();
+	lines.push_back(Format("frame      %7.3f avg %7.3f max", frame.average, frame.maximum));
+	lines.push_back(Format("p50 %.3f  p95 %.3f  p99 %.3f", _profiler.GetFramePercentile(50),
+			_profiler.GetFramePercentile(95), _profiler.GetFramePercentile(99)));
+
+	DrawOverlayPanel(lines, 4, 4, false);
+}
+
+/** Draw the memory used by the parts of the program in the bottom-left corner of the viewport. */
+void Viewport::DrawMemoryReport() const
+{
+	/* Collecting the report walks over the whole world, so it is refreshed only once a second. */
+	DrawOverlayPanel(GetRecentMemoryReport().GetLines(), 4, this->rect.height - 4, true);
+}
+
 /**
  * Compute position of the mouse cursor, and return the result.
  * @param fdata [inout] Parameters and results of the finding process.
@@ -1240,29 +1189,32 @@ bool Viewport::OnKeyEvent(WmKeyCode key_code, WmKeyMod mod, const std::string &s
 			return true;
 
 		case KS_INGAME_SPEED_PAUSE:
-			_game_control.speed = GSP_PAUSE;
+			DoCommand(GCMD_SET_SPEED, {GSP_PAUSE});
 			return true;
 		case KS_INGAME_SPEED_1:
-			_game_control.speed = GSP_1;
+			DoCommand(GCMD_SET_SPEED, {GSP_1});
 			return true;
 		case KS_INGAME_SPEED_2:
-			_game_control.speed = GSP_2;
+			DoCommand(GCMD_SET_SPEED, {GSP_2});
 			return true;
 		case KS_INGAME_SPEED_4:
-			_game_control.speed = GSP_4;
+			DoCommand(GCMD_SET_SPEED, {GSP_4});
 			return true;
 		case KS_INGAME_SPEED_8:
-			_game_control.speed = GSP_8;
+			DoCommand(GCMD_SET_SPEED, {GSP_8});
+			return true;
+		case KS_INGAME_SPEED_TURBO:
+			DoCommand(GCMD_SET_SPEED, {GSP_TURBO});
 			return true;
 		case KS_INGAME_SPEED_UP:
 			if (_game_control.speed + 1 < GSP_COUNT) {
-				_game_control.speed++;
+				DoCommand(GCMD_SET_SPEED, {_game_control.speed + 1});
 				return true;
 			}
 			return false;
 		case KS_INGAME_SPEED_DOWN:
 			if (_game_control.speed > GSP_PAUSE) {
-				_game_control.speed--;
+				DoCommand(GCMD_SET_SPEED, {_game_control.speed - 1});
 				return true;
 			}
 			return false;
@@ -1337,6 +1289,32 @@ bool Viewport::OnKeyEvent(WmKeyCode key_code, WmKeyMod mod, const std::string &s
 		case KS_FPS:
 			this->ToggleDisplayFlag(DF_FPS);
 			return true;
+		case KS_PROFILER:
+			this->ToggleDisplayFlag(DF_PROFILER);
+			_profiler.SetEnabled(this->GetDisplayFlag(DF_PROFILER));
+			return true;
+		case KS_PROFILER_EXPORT: {
+			if (!_profiler.IsEnabled()) return true;
+			const std::string fname = _profiler.ExportCsv();
+			if (fname.empty()) {
+				fprintf(stderr, "Failed to write the profiler measurements.\n");
+			} else {
+				printf("Profiler measurements written to %s\n", fname.c_str());
+			}
+			return true;
+		}
+		case KS_MEMORY_REPORT:
+			this->ToggleDisplayFlag(DF_MEMORY_REPORT);
+			return true;
+		case KS_MEMORY_EXPORT: {
+			const std::string fname = ExportMemoryReport();
+			if (fname.empty()) {
+				fprintf(stderr, "Failed to write the memory report.\n");
+			} else {
+				printf("Memory report written to %s\n", fname.c_str());
+			}
+			return true;
+		}
 		case KS_INGAME_GRID:
 			this->ToggleDisplayFlag(DF_GRID);
 			return true;
@@ -33,6 +33,8 @@ enum DisplayFlags {
 	DF_HEIGHT_MARKERS_RIDES   = 1 << 10,  ///< Draw height markers on rides.
 	DF_HEIGHT_MARKERS_PATHS   = 1 << 11,  ///< Draw height markers on paths.
 	DF_HEIGHT_MARKERS_TERRAIN = 1 << 12,  ///< Draw height markers on the terrain.
+	DF_PROFILER               = 1 << 13,  ///< Whether to draw the profiler overlay.
+	DF_MEMORY_REPORT          = 1 << 14,  ///< Whether to draw the memory report overlay.
 };
 DECLARE_ENUM_AS_BIT_SET(DisplayFlags)
 
@@ -144,6 +146,8 @@ public:
 	int32 ComputeX(int32 xpos, int32 ypos);
 	int32 ComputeY(int32 xpos, int32 ypos, int32 zpos);
 	Point32 ComputeScreenCoordinate(const XYZPoint32 &pixel) const;
+	void DrawProfiler() const;
+	void DrawMemoryReport() const;
 
 	/**
 	 * Check whether a given display flag is currently active.
@@ -199,6 +203,205 @@ protected:
 	void OnMouseWheelEvent(int direction) override;
 };
 
+/**
+ * Convert 3D position to the horizontal 2D position.
+ * @param x X position in the game world.
+ * @param y Y position in the game world.
+ * @param orient Orientation.
+ * @param width Tile width in pixels.
+ * @return X position in 2D.
+ */
+inline int32 ComputeXFunction(int32 x, int32 y, ViewOrientation orient, uint16 width)
+{
+	switch (orient) {
+		case VOR_NORTH: return ((y - x)  * width / 2) >> 8;
+		case VOR_WEST:  return (-(x + y) * width / 2) >> 8;
+		case VOR_SOUTH: return ((x - y)  * width / 2) >> 8;
+		case VOR_EAST:  return ((x + y)  * width / 2) >> 8;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Convert 3D position to the vertical 2D position.
+ * @param x X position in the game world.
+ * @param y Y position in the game world.
+ * @param z Z position in the game world.
+ * @param orient Orientation.
+ * @param width Tile width in pixels.
+ * @param height Tile height in pixels.
+ * @return Y position in 2D.
+ */
+inline int32 ComputeYFunction(int32 x, int32 y, int32 z, ViewOrientation orient, uint16 width, uint16 height)
+{
+	switch (orient) {
+		case VOR_NORTH: return ((x + y)  * width / 4 - z * height) >> 8;
+		case VOR_WEST:  return ((y - x)  * width / 4 - z * height) >> 8;
+		case VOR_SOUTH: return (-(x + y) * width / 4 - z * height) >> 8;
+		case VOR_EAST:  return ((x - y)  * width / 4 - z * height) >> 8;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Search the world for voxels to render.
+ * @ingroup viewport_group
+ */
+class VoxelCollector {
+public:
+	VoxelCollector(Viewport *vp);
+	virtual ~VoxelCollector();
+
+	void SetWindowSize(int16 xpos, int16 ypos, uint16 width, uint16 height);
+
+	void Collect();
+	void SetSelector(MouseModeSelector *selector);
+
+	/**
+	 * Convert 3D position to the horizontal 2D position.
+	 * @param x X position in the game world.
+	 * @param y Y position in the game world.
+	 * @return X position in 2D.
+	 */
+	inline int32 ComputeX(int32 x, int32 y)
+	{
+		return ComputeXFunction(x, y, this->orient, TileWidth(this->zoom));
+	}
+
+	/**
+	 * Convert 3D position to the vertical 2D position.
+	 * @param x X position in the game world.
+	 * @param y Y position in the game world.
+	 * @param z Z position in the game world.
+	 * @return Y position in 2D.
+	 */
+	inline int32 ComputeY(int32 x, int32 y, int32 z)
+	{
+		return ComputeYFunction(x, y, z, this->orient, TileWidth(this->zoom), TileHeight(this->zoom));
+	}
+
+	XYZPoint32 view_pos;          ///< Position of the centre point of the display.
+	int zoom;                    ///< The current zoom scale (an index in #_zoom_scales).
+	ViewOrientation orient;       ///< Direction of view.
+	Viewport *vp;                 ///< Parent viewport for accessing the cursors if not \c nullptr.
+	MouseModeSelector *selector;  ///< Mouse mode selector.
+
+	Rectangle32 rect; ///< Screen area of interest.
+
+protected:
+	/**
+	 * Decide where supports should be raised.
+	 * @param stack %Voxel stack to examine.
+	 * @param xpos X position of the voxel stack.
+	 * @param ypos Y position of the voxel stack.
+	 */
+	virtual void SetupSupports([[maybe_unused]] const VoxelStack *stack, [[maybe_unused]] uint xpos, [[maybe_unused]] uint ypos)
+	{
+	}
+
+	/**
+	 * Handle a voxel that should be collected.
+	 * @param vx %Voxel to add, \c nullptr means 'cursor above stack'.
+	 * @param view_pos World position.
+	 * @param xnorth X coordinate of the north corner at the display.
+	 * @param ynorth y coordinate of the north corner at the display.
+	 * @note Implement in a derived class.
+	 */
+	virtual void CollectVoxel(const Voxel *vx, const XYZPoint16 &view_pos, int32 xnorth, int32 ynorth) = 0;
+};
+
+/**
+ * Data temporary needed for ordering sprites and blitting them to the screen.
+ * @ingroup viewport_group
+ */
+struct DrawData {
+	/**
+	 * Setter method to initialize the other fields.
+	 * @param level Slice of this sprite (vertical row).
+	 * @param z_height Height of the voxel being drawn.
+	 * @param order Selection when to draw this sprite (sorts sprites within a voxel). @see SpriteOrder
+	 * @param sprite Mouse cursor to draw.
+	 * @param base Base coordinate of the image, relative to top-left of the window.
+	 * @param recolour Recolouring of the sprite.
+	 * @param gs Gradient shift of the sprite.
+	 */
+	inline void Set(int32 level, uint16 z_height, SpriteOrder order, const ImageData *sprite, const Point32 &base,
+			const Recolouring *recolour = nullptr, GradientShift gs = GS_INVALID)
+	{
+		this->level = level;
+		this->z_height = z_height;
+		this->order = order;
+		this->sprite = sprite;
+		this->base = base;
+		this->recolour = recolour;
+		this->gs = gs;
+		assert(this->sprite != nullptr);
+	}
+
+	const ImageData *sprite;     ///< Mouse cursor to draw.
+	const Recolouring *recolour; ///< Recolouring of the sprite.
+	int32 level;                 ///< Slice of this sprite (vertical row).
+	SpriteOrder order;           ///< Selection when to draw this sprite (sorts sprites within a voxel). @see SpriteOrder
+	Point32 base;                ///< Base coordinate of the image, relative to top-left of the window.
+	uint16 z_height;             ///< Height of the voxel being drawn.
+	GradientShift gs;            ///< Gradient shift of the sprite.
+};
+
+/**
+ * Sort predicate of the draw data.
+ * @param dd1 First value to compare.
+ * @param dd2 Second value to compare.
+ * @return \c true if \a dd1 should be drawn before \a dd2.
+ */
+inline bool operator<(const DrawData &dd1, const DrawData &dd2)
+{
+	if (dd1.level != dd2.level) return dd1.level < dd2.level; // Order on slice first.
+	if (dd1.z_height != dd2.z_height) return dd1.z_height < dd2.z_height; // Lower in the same slice first.
+	if (dd1.order != dd2.order) return dd1.order < dd2.order; // Type of sprite.
+	return dd1.base.y < dd2.base.y;
+}
+
+/**
+ * Collection of sprites to render to the screen, sorted by viewing distance after collecting.
+ * @ingroup viewport_group
+ */
+typedef std::vector<DrawData> DrawImages;
+
+/**
+ * Collect sprites to draw in a viewport.
+ * @ingroup viewport_group
+ */
+class SpriteCollector : public VoxelCollector {
+public:
+	SpriteCollector(Viewport *vp);
+	~SpriteCollector();
+
+	void SetXYOffset(int16 xoffset, int16 yoffset);
+
+	DrawImages draw_images; ///< Sprites to draw ordered by viewing distance.
+	int16 xoffset; ///< Horizontal offset of the top-left coordinate to the top-left of the display.
+	int16 yoffset; ///< Vertical offset of the top-left coordinate to the top-left of the display.
+
+protected:
+	void CollectVoxel(const Voxel *vx, const XYZPoint16 &voxel_pos, int32 xnorth, int32 ynorth) override;
+	void SetupSupports(const VoxelStack *stack, uint xpos, uint ypos) override;
+	const ImageData *GetCursorSpriteAtPos(CursorType ctype, const XYZPoint16 &voxel_pos, uint8 tslope);
+	void CollectVoxelObject(const VoxelObject *vo, int32 slice, uint32 z_pos, const Point32 &north_point);
+	void CollectCoasterCars(uint16 ride_number, int32 slice, uint32 z_pos, const XYZPoint16 &voxel_pos, const Point32 &north_point);
+
+	typedef std::pair<XYZPoint16, const VoxelObject *> RideCar; ///< Displayed car of a coaster, with its voxel.
+	std::vector<RideCar> ride_cars;        ///< Displayed cars of the coasters in #car_coasters, sorted by voxel.
+	std::vector<uint16> car_coasters;      ///< Coasters with drawn track voxels, in the order of drawing.
+
+	/** For each orientation the location of the real northern corner of a tile relative to the northern displayed corner. */
+	Point16 north_offsets[4];
+
+	uint16 ground_height; ///< The height of the ground in the current voxel stack. \c -1 means no valid ground found.
+	uint8 ground_slope;   ///< Imploded ground slope if #ground_height is valid.
+};
+
+void AddFloatawayMoneyAmount(const Money &money, const XYZPoint16 &voxel);
+
 /**
  * Convert a voxel coordinate to the pixel coordinate of its top-left corner.
  * @param voxel The voxel coordinate.
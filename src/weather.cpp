@@ -31,7 +31,7 @@ public:
 
 	int TotalAmount() const;
 	WeatherType GetWeatherType(int amount) const;
-	int Draw() const;
+	int Draw(Random &rnd) const;
 };
 
 /**
@@ -77,12 +77,11 @@ WeatherType AverageWeather::GetWeatherType(int amount) const
 
 /**
  * Draw a random weather.
+ * @param rnd Random number generator to use.
  * @return Amount representing the weather.
  */
-int AverageWeather::Draw() const
+int AverageWeather::Draw(Random &rnd) const
 {
-	Random rnd;
-
 	return rnd.Uniform(this->TotalAmount());
 }
 
@@ -109,7 +108,7 @@ static const AverageWeather _yearly_weather[12] = {
 	AverageWeather( 69,  40, 70, 82, 76, 1),
 };
 
-Weather::Weather()
+Weather::Weather() : rnd(RSK_WEATHER, 0)
 {
 #ifndef NDEBUG
 	/* Verify that each month has the same amount of weather in total. */
@@ -123,7 +122,8 @@ Weather::Weather()
 /** Initialize the weather for a new game. */
 void Weather::Initialize()
 {
-	this->current = _yearly_weather[_date.month - 1].Draw();
+	this->rnd = Random(RSK_WEATHER, 0);
+	this->current = _yearly_weather[_date.month - 1].Draw(this->rnd);
 	this->next = this->current;
 	this->change = 0;
 
@@ -145,13 +145,13 @@ void Weather::OnNewDay()
 
 	if (_date.day != 12 && _date.day != 27) return;
 	int month = (_date.day == 12) ? _date.month : _date.GetNextMonth();
-	this->next = _yearly_weather[month - 1].Draw();
+	this->next = _yearly_weather[month - 1].Draw(this->rnd);
 	if (this->current == this->next) return;
 	this->change = (this->next - this->current) / 5;
 	if (this->change == 0) this->change = (this->next - this->current > 0) ? 1 : -1;
 }
 
-static const uint32 CURRENT_VERSION_WTHR = 1;   ///< Currently supported version of the WTHR Pattern.
+static const uint32 CURRENT_VERSION_WTHR = 2;   ///< Currently supported version of the WTHR Pattern.
 
 /**
  * Load weather data from the save game.
@@ -166,10 +166,13 @@ void Weather::Load(Loader &ldr)
 			break;
 
 		case 1:
+		case 2:
+			this->rnd = Random(RSK_WEATHER, 0);
 			this->temperature = ldr.GetLong();
 			this->current = ldr.GetLong();
 			this->next = ldr.GetLong();
 			this->change = ldr.GetLong();
+			if (version >= 2) this->rnd.LoadState(ldr);
 			break;
 
 		default:
@@ -190,6 +193,7 @@ void Weather::Save(Saver &svr)
 	svr.PutLong(this->current);
 	svr.PutLong(this->next);
 	svr.PutLong(this->change);
+	this->rnd.SaveState(svr);
 	svr.EndPattern();
 }
 
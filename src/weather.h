@@ -10,6 +10,8 @@
 #ifndef WEATHER_H
 #define WEATHER_H
 
+#include "random.h"
+
 /** Types of weather. */
 enum WeatherType {
 	WTP_SUNNY,        ///< Sunny weather.
@@ -41,6 +43,8 @@ public:
 
 private:
 	void SetTemperature();
+
+	Random rnd;  ///< Random number generator of the weather.
 };
 
 extern Weather _weather;
@@ -29,6 +29,8 @@
 #include "viewport.h"
 #include "mouse_mode.h"
 #include "config_reader.h"
+#include "profiler.h"
+#include "trace.h"
 #include <cmath>
 
 /**
@@ -271,6 +273,16 @@ void Window::TimeoutCallback()
 {
 }
 
+/**
+ * Does the window show something that does not exist any more? Such windows are closed by #WindowManager::CloseStaleWindows.
+ * Base class shows nothing that can disappear.
+ * @return Whether the window should be closed.
+ */
+bool Window::IsStale() const
+{
+	return false;
+}
+
 /**
  * Enable or disable highlighting. Base class does nothing.
  * If enabled, the #timeout is used to automatically disable it again.
@@ -696,6 +708,19 @@ void WindowManager::CloseAllWindows()
 	while (this->top != nullptr) delete this->top;
 }
 
+/** Close the windows showing something that disappeared during the game ticks, for example a ride removed by a replayed command. */
+void WindowManager::CloseStaleWindows()
+{
+	for (Window *w = this->top; w != nullptr;) {
+		if (w->IsStale()) {
+			delete w;
+			w = this->top;  // Deleting a window may close other windows too.
+		} else {
+			w = w->lower;
+		}
+	}
+}
+
 /** Reinitialize all windows in the display. */
 void WindowManager::ResetAllWindows()
 {
@@ -1048,6 +1073,7 @@ bool WindowManager::KeyEvent(WmKeyCode key_code, WmKeyMod mod, const std::string
  */
 void WindowManager::UpdateWindows()
 {
+	TraceScope trace("WindowManager::UpdateWindows");
 	BaseWidget *tooltip_widget = nullptr;
 	Window *tooltip_window = nullptr;
 	if (_video.GetMouseDragging() == MB_NONE && this->current_window != nullptr) {
@@ -1063,14 +1089,23 @@ void WindowManager::UpdateWindows()
 
 	GuiWindow *sel_window = this->GetSelector();
 	MouseModeSelector *selector = (sel_window == nullptr) ? nullptr : sel_window->selector;
-	for (Window *w = this->bottom; w != nullptr; w = w->higher) w->OnDraw(selector);
+	for (Window *w = this->bottom; w != nullptr; w = w->higher) {
+		if (w->wtype == WC_MAINDISPLAY) {
+			w->OnDraw(selector); // The viewport profiles its own parts.
+		} else {
+			ProfileScope profile(PFS_GUI);
+			w->OnDraw(selector);
+		}
+	}
 
 	_str_params.Clear();
 	if (tooltip_widget != nullptr) {
+		ProfileScope profile(PFS_GUI);
 		tooltip_window->SetTooltipStringParameters(tooltip_widget);
 		tooltip_widget->DrawTooltip(tooltip_window->rect.base);
 	}
 
+	ProfileScope profile(PFS_PRESENT);
 	_video.FinishRepaint();
 }
 
@@ -1298,6 +1333,10 @@ Shortcuts::Shortcuts()
 {
 	/* Create all the default keybindings. */
 	this->values[KS_FPS] = ShortcutInfo("fps", Keybinding("f"), Scope::GLOBAL);
+	this->values[KS_PROFILER] = ShortcutInfo("profiler", Keybinding("p"), Scope::GLOBAL);
+	this->values[KS_PROFILER_EXPORT] = ShortcutInfo("profiler_export", Keybinding("p", WMKM_CTRL), Scope::GLOBAL);
+	this->values[KS_MEMORY_REPORT] = ShortcutInfo("memory_report", Keybinding("k"), Scope::GLOBAL);
+	this->values[KS_MEMORY_EXPORT] = ShortcutInfo("memory_export", Keybinding("k", WMKM_CTRL), Scope::GLOBAL);
 
 	this->values[KS_MAINMENU_NEW] = ShortcutInfo("mainmenu_new", Keybinding("n"), Scope::MAIN_MENU);
 	this->values[KS_MAINMENU_LOAD] = ShortcutInfo("mainmenu_load", Keybinding("l"), Scope::MAIN_MENU);
@@ -1316,6 +1355,7 @@ Shortcuts::Shortcuts()
 	this->values[KS_INGAME_SPEED_2] = ShortcutInfo("speed_2", Keybinding("2", WMKM_ALT), Scope::INGAME);
 	this->values[KS_INGAME_SPEED_4] = ShortcutInfo("speed_4", Keybinding("3", WMKM_ALT), Scope::INGAME);
 	this->values[KS_INGAME_SPEED_8] = ShortcutInfo("speed_8", Keybinding("4", WMKM_ALT), Scope::INGAME);
+	this->values[KS_INGAME_SPEED_TURBO] = ShortcutInfo("speed_turbo", Keybinding("5", WMKM_ALT), Scope::INGAME);
 	this->values[KS_INGAME_SPEED_UP] = ShortcutInfo("speed_up", Keybinding(WMKC_CURSOR_PAGEUP, WMKM_ALT), Scope::INGAME);
 	this->values[KS_INGAME_SPEED_DOWN] = ShortcutInfo("speed_down", Keybinding(WMKC_CURSOR_PAGEDOWN, WMKM_ALT), Scope::INGAME);
 
@@ -105,6 +105,7 @@ public:
 	virtual void SetHighlight(bool value);
 	virtual void OnChange(ChangeCode code, uint32 parameter);
 	virtual void ResetSize();
+	virtual bool IsStale() const;
 
 	virtual BaseWidget *FindTooltipWidget(Point16 pt);
 	virtual void SetTooltipStringParameters(BaseWidget *tooltip_widget) const;
@@ -195,7 +196,7 @@ protected:
 
 	/* In dropdown.cpp */
 	void ShowDropdownMenu(WidgetNumber widnum, const DropdownList &items, int selected_index, ColourRange colour = COL_RANGE_INVALID);
-	void ShowRecolourDropdown(WidgetNumber widnum, RecolourEntry *entry, ColourRange colour = COL_RANGE_INVALID);
+	void ShowRecolourDropdown(WidgetNumber widnum, const RecolourEntry *entry, ColourRange colour = COL_RANGE_INVALID);
 
 	bool closeable;  ///< This window can be closed by the user.
 
@@ -271,6 +272,7 @@ public:
 	void SetSelector(GuiWindow *w, MouseModeSelector *selector);
 
 	void CloseAllWindows();
+	void CloseStaleWindows();
 	void ResetAllWindows();
 	void RepositionAllWindows(uint new_width, uint new_height);
 
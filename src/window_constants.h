@@ -148,7 +148,11 @@ enum ParkManagementGuiTabs {
 /** All keyboard shortcuts. */
 enum KeyboardShortcut {
 	KS_BEGIN = 0,       ///< First shortcut ID.
-	KS_FPS = KS_BEGIN,  ///< Toggle FPS counter.
+	KS_FPS = KS_BEGIN,   ///< Toggle FPS counter.
+	KS_PROFILER,         ///< Toggle profiler overlay.
+	KS_PROFILER_EXPORT,  ///< Export the profiler measurements.
+	KS_MEMORY_REPORT,    ///< Toggle memory report overlay.
+	KS_MEMORY_EXPORT,    ///< Export the memory report.
 
 	KS_MAINMENU_NEW,            ///< Main menu start new game.
 	KS_MAINMENU_LOAD,           ///< Main menu load savegame.
@@ -167,6 +171,7 @@ enum KeyboardShortcut {
 	KS_INGAME_SPEED_2,      ///< Set speed to 2x.
 	KS_INGAME_SPEED_4,      ///< Set speed to 4x.
 	KS_INGAME_SPEED_8,      ///< Set speed to 8x.
+	KS_INGAME_SPEED_TURBO,  ///< Set speed to turbo.
 	KS_INGAME_SPEED_UP,     ///< Set speed one level faster.
 	KS_INGAME_SPEED_DOWN,   ///< Set speed one level slower.
 